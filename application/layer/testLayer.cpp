@@ -65,12 +65,15 @@ void TestLayer::onInit() {
 	);
 	VertexBuffer* vbo = new VertexBuffer(testUniforms.data(), testUniforms.size() * sizeof(Uniform));
 
-	mesh = ResourceManager::add<MeshResource>("ball", "../res/models/ball.bobj");
+	// the ball is parsed in the background, it is drawn from the first frame after it is published
+	ResourceManager::addAsync<MeshResource>("ball", "../res/models/ball.bobj", [vbo, layout](MeshResource* ball) {
+		mesh = ball;
+		if (mesh != nullptr)
+			mesh->getMesh()->addUniformBuffer(vbo, layout);
+	});
 
 	//mesh = ResourceManager::add<MeshResource>("plane", "../res/models/plane.obj");
 	//mesh = ResourceManager::add<MeshResource>("sphere", "../res/models/sphere.obj");
-	
-	mesh->getMesh()->addUniformBuffer(vbo, layout);
 
 	ResourceManager::add<TextureResource>("ball_color", "../res/textures/ball/ball_color.png");
 	ResourceManager::add<TextureResource>("ball_normal", "../res/textures/ball/ball_normal.png");
@@ -124,7 +127,8 @@ void TestLayer::onRender() {
 
 	ApplicationShaders::lightingShader.updateProjection(screen->camera.viewMatrix, screen->camera.projectionMatrix, screen->camera.cframe.position);
 
-	mesh->getMesh()->renderInstanced(testUniforms.size(), FILL);
+	if (mesh != nullptr)
+		mesh->getMesh()->renderInstanced(testUniforms.size(), FILL);
 
 	endScene();
 }
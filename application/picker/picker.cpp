@@ -2,6 +2,8 @@
 
 #include "picker.h"
 
+#include <vector>
+
 #include "../physics/math/mathUtil.h"
 
 #include "../engine/event/event.h"
@@ -23,7 +25,6 @@
 #include "../physics/physical.h"
 #include "../physics/sharedLockGuard.h"
 #include "../physics/geometry/shape.h"
-#include "../physics/misc/filters/rayIntersectsBoundsFilter.h"
 
 namespace Application {
 
@@ -74,18 +75,15 @@ void intersectPhysicals(Screen& screen, const Ray& ray) {
 	//TODO graphicsMeasure.mark(GraphicsProcess::WAIT_FOR_LOCK);
 	screen.world->syncReadOnlyOperation([&screen, &closestIntersectDistance, &closestIntersectedPart, &closestIntersectedPoint, &ray] () {
 		//TODO graphicsMeasure.mark(GraphicsProcess::PICKER);
-		for (ExtendedPart& part : screen.world->iterPartsFiltered(RayIntersectBoundsFilter(ray), FREE_PARTS)) {
-			if (&part == screen.camera.attachment) continue;
-			Vec3 relPos = part.getPosition() - ray.start;
-			if (pointToLineDistanceSquared(ray.direction, relPos) > part.maxRadius* part.maxRadius)
-				continue;
-
-			float distance = intersect(ray, part.hitbox, part.getCFrame());
-
-			if (distance < closestIntersectDistance && distance > 0) {
-				closestIntersectDistance = distance;
-				closestIntersectedPart = &part;
-			}
+		// every hit sorted by distance, so the part the camera is attached to can be skipped
+		RayQuery query(ray);
+		std::vector<QueryHit> hits;
+		screen.world->raycastAll(&query, 1, &hits, FREE_PARTS);
+		for (const QueryHit& hit : hits) {
+			if (hit.part == screen.camera.attachment) continue;
+			closestIntersectDistance = static_cast<float>(hit.distance);
+			closestIntersectedPart = static_cast<ExtendedPart*>(hit.part);
+			break;
 		}
 		});
 
@@ -34,7 +34,7 @@ void TickerThread::start() {
 			} else {
 				// We're behind schedule
 				if (nextTarget < curTime - this->tickSkipTimeout) {
-					Log::warn("Can't keep up! Skipping %d ticks!", (int) ((curTime - nextTarget).count() / (1E3 * this->tickSkipTimeout.count())));
+					LOG_RATE_LIMITED(1000, Log::warn("Can't keep up! Skipping %d ticks!", (int) ((curTime - nextTarget).count() / (1E3 * this->tickSkipTimeout.count()))));
 
 					nextTarget = curTime;
 				}
@@ -233,6 +233,9 @@ void Screen::onUpdate() {
 			Graphics::Renderer::closeGLFWWindow();
 	}
 
+	// Publish resources loaded in the background
+	ResourceManager::update();
+
 	// Update camera
 	camera.onUpdate();
 
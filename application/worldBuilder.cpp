@@ -5,6 +5,7 @@
 #include "application.h"
 #include "../physics/math/mathUtil.h"
 #include "../physics/geometry/basicShapes.h"
+#include "../physics/geometry/triangleShapes.h"
 
 #include "../graphics/gui/gui.h"
 
@@ -160,31 +161,22 @@ void buildTerrain(double width, double depth) {
 	Log::subject s("Terrain");
 	Log::info("Starting terrain building!");
 
-	int maxProgress = 10;
-
-	int lastProgress = 0;
-
-	Log::info("0%%");
-	for (double x = -width / 2; x < width / 2; x += 3.0) {
-		for (double z = -depth / 2; z < depth / 2; z += 3.0) {
-			double yOffset = getYOffset(x, z);
-			Position pos((x / 3.0 + fRand(0.0, 1.0)) * 3.0, fRand(0.0, 1.0) + yOffset, (z / 3.0 + fRand(0.0, 1.0)) * 3.0);
-			GlobalCFrame cf(pos, Rotation::fromEulerAngles(fRand(0.0, 3.1415), fRand(0.0, 3.1415), fRand(0.0, 3.1415)));
-			ExtendedPart* newPart = new ExtendedPart(icosahedron.scaled(4.0, 4.0, 4.0), cf, { 1.0, 1.0, 0.3 }, "terrain");
-			newPart->material.albedo = Color(0.0, yOffset / 40.0 + 0.5, 0.0, 1.0);
-			world.addTerrainPart(newPart);
-		}
-
-		double progress = (x + width / 2) / width;
-
-		int progressToInt = progress * maxProgress;
-
-		if (progressToInt > lastProgress) {
-			Log::info("%d%%", int(progressToInt * 100.0 / maxProgress));
+	// one height sample every 3 units, the heightfield is a single part instead of a part per sample
+	int sampleCountX = int(width / 3.0) + 1;
+	int sampleCountZ = int(depth / 3.0) + 1;
+	std::vector<float> heights(sampleCountX * sampleCountZ);
+	for (int z = 0; z < sampleCountZ; z++) {
+		for (int x = 0; x < sampleCountX; x++) {
+			double sampleX = -width / 2 + width * x / (sampleCountX - 1);
+			double sampleZ = -depth / 2 + depth * z / (sampleCountZ - 1);
+			heights[x + z * sampleCountX] = float(getYOffset(sampleX, sampleZ));
 		}
-		lastProgress = progressToInt;
 	}
-	Log::info("100%%");
+	Shape heightfield = Heightfield(heights.data(), sampleCountX, sampleCountZ, width, depth);
+	Vec3 heightfieldCenter = static_cast<const HeightfieldShapeClass*>(heightfield.baseShape)->originalCenter;
+	ExtendedPart* terrainPart = new ExtendedPart(heightfield, GlobalCFrame(Position(heightfieldCenter.x, heightfieldCenter.y, heightfieldCenter.z)), { 1.0, 1.0, 0.3 }, "terrain");
+	terrainPart->material.albedo = Color(0.0, 0.5, 0.0, 1.0);
+	world.addTerrainPart(terrainPart);
 
 
 	Log::info("Finished terrain, adding trees!");
@@ -0,0 +1,141 @@
+#include "batchJob.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#define BATCH_DEFAULT_DELTA_T (1.0 / 100.0)
+
+double BatchParameters::getDouble(const std::string& name, double defaultValue) const {
+	auto found = values.find(name);
+	if(found == values.end()) return defaultValue;
+
+	size_t used;
+	double value = std::stod(found->second, &used);
+	if(used != found->second.size()) throw std::invalid_argument("Parameter " + name + " is not a number: " + found->second);
+	return value;
+}
+
+long long BatchParameters::getInt(const std::string& name, long long defaultValue) const {
+	auto found = values.find(name);
+	if(found == values.end()) return defaultValue;
+
+	size_t used;
+	long long value = std::stoll(found->second, &used);
+	if(used != found->second.size()) throw std::invalid_argument("Parameter " + name + " is not an integer: " + found->second);
+	return value;
+}
+
+std::string BatchParameters::getString(const std::string& name, const std::string& defaultValue) const {
+	auto found = values.find(name);
+	return (found != values.end()) ? found->second : defaultValue;
+}
+
+std::string BatchParameters::toString() const {
+	std::string result;
+	for(const std::pair<const std::string, std::string>& value : values) {
+		if(!result.empty()) result += ' ';
+		result += value.first + '=' + value.second;
+	}
+	return result;
+}
+
+struct ParameterRange {
+	std::string name;
+	long long first;
+	long long last;
+};
+
+/*
+	Returns whether value has the form first..last, with both integers
+*/
+static bool parseRange(const std::string& value, long long& first, long long& last) {
+	size_t separator = value.find("..");
+	if(separator == std::string::npos) return false;
+
+	try {
+		size_t usedFirst;
+		size_t usedLast;
+		std::string lastText = value.substr(separator + 2);
+		first = std::stoll(value.substr(0, separator), &usedFirst);
+		last = std::stoll(lastText, &usedLast);
+		return usedFirst == separator && usedLast == lastText.size();
+	} catch(const std::logic_error&) {
+		return false;
+	}
+}
+
+/*
+	Adds one job for every combination of the values of ranges[rangeIndex..]
+*/
+static void expandRanges(const BatchJob& job, const std::vector<ParameterRange>& ranges, size_t rangeIndex, std::vector<BatchJob>& jobs) {
+	if(rangeIndex == ranges.size()) {
+		BatchJob expanded = job;
+		expanded.index = jobs.size();
+		expanded.deltaT = job.parameters.getDouble("deltaT", BATCH_DEFAULT_DELTA_T);
+		jobs.push_back(std::move(expanded));
+		return;
+	}
+
+	const ParameterRange& range = ranges[rangeIndex];
+	for(long long value = range.first; value <= range.last; value++) {
+		BatchJob withValue = job;
+		withValue.parameters.set(range.name, std::to_string(value));
+		expandRanges(withValue, ranges, rangeIndex + 1, jobs);
+	}
+}
+
+std::vector<BatchJob> parseBatchJobs(std::istream& input) {
+	std::vector<BatchJob> jobs;
+
+	std::string line;
+	size_t lineNumber = 0;
+	while(std::getline(input, line)) {
+		lineNumber++;
+		if(!line.empty() && line.back() == '\r') line.pop_back();
+
+		std::istringstream words(line);
+		std::string type;
+		if(!(words >> type) || type[0] == '#') continue;
+
+		BatchJob job;
+		if(type == "builder") {
+			job.sourceType = BatchSource::BUILDER;
+		} else if(type == "file") {
+			job.sourceType = BatchSource::WORLD_FILE;
+		} else {
+			throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": unknown job type " + type + ", expected builder or file");
+		}
+
+		long long tickCount;
+		if(!(words >> job.source >> tickCount) || tickCount < 0) {
+			throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": expected " + type + " <source> <tick count>");
+		}
+		job.tickCount = static_cast<size_t>(tickCount);
+
+		std::vector<ParameterRange> ranges;
+		std::string parameter;
+		while(words >> parameter) {
+			size_t separator = parameter.find('=');
+			if(separator == std::string::npos || separator == 0) {
+				throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": expected name=value, got " + parameter);
+			}
+			std::string name = parameter.substr(0, separator);
+			std::string value = parameter.substr(separator + 1);
+
+			ParameterRange range{name, 0, 0};
+			if(parseRange(value, range.first, range.last)) {
+				ranges.push_back(range);
+			} else {
+				job.parameters.set(name, value);
+			}
+		}
+
+		try {
+			expandRanges(job, ranges, 0, jobs);
+		} catch(const std::logic_error& error) {
+			throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": " + error.what());
+		}
+	}
+
+	return jobs;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+
+/*
+	The name=value pairs of a job, passed to its world builder
+*/
+class BatchParameters {
+	std::map<std::string, std::string> values;
+
+public:
+	void set(const std::string& name, const std::string& value) { values[name] = value; }
+	bool has(const std::string& name) const { return values.find(name) != values.end(); }
+
+	/*
+		Return the value of the parameter, or defaultValue if the job does not set it
+		Throw std::invalid_argument if the value is not a number
+	*/
+	double getDouble(const std::string& name, double defaultValue) const;
+	long long getInt(const std::string& name, long long defaultValue) const;
+	std::string getString(const std::string& name, const std::string& defaultValue) const;
+
+	/*
+		The parameters as "name=value name=value", in name order
+	*/
+	std::string toString() const;
+};
+
+enum class BatchSource {
+	BUILDER,
+	WORLD_FILE
+};
+
+struct BatchJob {
+	size_t index;
+	BatchSource sourceType;
+	// the name of the builder or the path of the world file
+	std::string source;
+	size_t tickCount;
+	double deltaT;
+	BatchParameters parameters;
+};
+
+/*
+	Reads a job file, one job per line:
+		builder <builder name> <tick count> [name=value ...]
+		file <world file path> <tick count> [name=value ...]
+	Empty lines and lines starting with # are skipped.
+
+	A value written as first..last, both integers, expands the line into one job per value,
+	several ranges on one line give every combination. The parameter deltaT sets the tick length, 1/100 by default.
+
+	Throws std::invalid_argument with the line number for malformed lines
+*/
+std::vector<BatchJob> parseBatchJobs(std::istream& input);
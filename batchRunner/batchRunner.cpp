@@ -0,0 +1,197 @@
+#include "batchRunner.h"
+
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/physical.h"
+#include "../physics/misc/worldFile.h"
+#include "../physics/misc/worldStateHash.h"
+#include "../physics/profiling.h"
+
+#include "../util/parallelFor.h"
+#include "../util/log.h"
+
+#include "worldBuilder.h"
+
+/*
+	A world file is mapped and its polyhedra are built once, all jobs on that file read their world from the same reader
+*/
+struct LoadedWorldFile {
+	std::unique_ptr<WorldFileReader> reader;
+	std::string error;
+};
+
+static std::map<std::string, LoadedWorldFile> loadWorldFiles(const std::vector<BatchJob>& jobs) {
+	std::map<std::string, LoadedWorldFile> files;
+	for(const BatchJob& job : jobs) {
+		if(job.sourceType != BatchSource::WORLD_FILE || files.find(job.source) != files.end()) continue;
+
+		LoadedWorldFile& file = files[job.source];
+		try {
+			file.reader.reset(new WorldFileReader(job.source));
+			// readWorld only builds the polyhedra lazily on the first read, which is not safe to do from several workers at once
+			file.reader->materializeShapeClasses();
+		} catch(const std::exception& error) {
+			file.reader.reset();
+			file.error = error.what();
+			Log::error("Could not load world file %s: %s", job.source.c_str(), error.what());
+		}
+	}
+	return files;
+}
+
+/*
+	The world does not own its parts, detaching the physicals from it first keeps every delete from updating the bounds trees
+*/
+static void deleteWorldContents(World<Part>& world) {
+	std::vector<Part*> parts;
+	for(Part& part : world.iterParts(ALL_PARTS)) {
+		parts.push_back(&part);
+	}
+	for(MotorizedPhysical* phys : world.physicals) {
+		phys->world = nullptr;
+	}
+	for(Part* part : parts) {
+		delete part;
+	}
+	for(ExternalForce* force : world.externalForces) {
+		delete force;
+	}
+}
+
+static double millisSince(std::chrono::high_resolution_clock::time_point start) {
+	return (std::chrono::high_resolution_clock::now() - start).count() / 1000000.0;
+}
+
+static BatchResult runJob(const BatchJob& job, const std::map<std::string, LoadedWorldFile>& worldFiles) {
+	BatchResult result;
+	result.jobIndex = job.index;
+
+	World<Part> world(job.deltaT);
+	try {
+		auto setupStart = std::chrono::high_resolution_clock::now();
+		if(job.sourceType == BatchSource::BUILDER) {
+			const WorldBuilder* builder = findWorldBuilder(job.source.c_str());
+			if(builder == nullptr) throw std::invalid_argument("Unknown world builder " + job.source);
+			builder->build(world, job.parameters);
+		} else {
+			const LoadedWorldFile& file = worldFiles.at(job.source);
+			if(file.reader == nullptr) throw std::runtime_error("Could not load world file: " + file.error);
+			file.reader->readWorld(world);
+		}
+		result.setupMillis = millisSince(setupStart);
+
+		auto tickStart = std::chrono::high_resolution_clock::now();
+		for(size_t i = 0; i < job.tickCount; i++) {
+			world.tick();
+		}
+		result.tickMillis = millisSince(tickStart);
+
+		// getPartCount also counts terrain parts
+		for(const MotorizedPhysical* phys : world.physicals) {
+			phys->forEachPart([&result](const Part&) { result.partCount++; });
+		}
+		result.age = world.age;
+		result.kineticEnergy = world.getTotalKineticEnergy();
+		result.potentialEnergy = world.getTotalPotentialEnergy();
+		result.stateHash = WorldStateHash::hashWorld(world);
+	} catch(const std::exception& error) {
+		result.error = error.what();
+	}
+
+	deleteWorldContents(world);
+	return result;
+}
+
+/*
+	Parameters and errors are quoted, they may contain commas
+*/
+static std::string quoteCSV(const std::string& text) {
+	std::string quoted = "\"";
+	for(char c : text) {
+		if(c == '"') quoted += '"';
+		quoted += c;
+	}
+	return quoted + '"';
+}
+
+static void writeResultHeader(std::ostream& resultStream) {
+	resultStream << "job,source,parameters,ticks,parts,age,kineticEnergy,potentialEnergy,stateHash,setupMs,tickMs,status\n";
+}
+
+static void writeResult(std::ostream& resultStream, const BatchJob& job, const BatchResult& result) {
+	char hash[17];
+	std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(result.stateHash));
+	char times[64];
+	std::snprintf(times, sizeof(times), "%.3f,%.3f", result.setupMillis, result.tickMillis);
+
+	resultStream << job.index << ',' << quoteCSV(job.source) << ',' << quoteCSV(job.parameters.toString()) << ',' << job.tickCount << ','
+		<< result.partCount << ',' << result.age << ',' << result.kineticEnergy << ',' << result.potentialEnergy << ',' << hash << ','
+		<< times << ',' << (result.error.empty() ? std::string("ok") : quoteCSV(result.error)) << '\n';
+	// flushed per job, so the results of a long batch can be followed and survive a crash in a later job
+	resultStream.flush();
+}
+
+BatchSummary runBatch(const std::vector<BatchJob>& jobs, std::ostream& resultStream, size_t threadCount) {
+	BatchSummary summary;
+	summary.jobCount = jobs.size();
+
+	auto wallStart = std::chrono::high_resolution_clock::now();
+
+	std::map<std::string, LoadedWorldFile> worldFiles = loadWorldFiles(jobs);
+	writeResultHeader(resultStream);
+	// enough digits to tell apart the energies of runs that differ in the last bit
+	resultStream.precision(17);
+
+	std::atomic<size_t> nextJob(0);
+	std::mutex resultLock;
+
+	auto worker = [&]() {
+		size_t previousThreadLimit = Util::getThreadLimit();
+		Util::getThreadLimit() = 1;
+		// the global physics profilers are not synchronized, none of the workers records into them
+		bool previousProfiling = isProfilingEnabled();
+		isProfilingEnabled() = false;
+
+		for(size_t jobIndex = nextJob++; jobIndex < jobs.size(); jobIndex = nextJob++) {
+			const BatchJob& job = jobs[jobIndex];
+			BatchResult result = runJob(job, worldFiles);
+
+			std::lock_guard<std::mutex> lock(resultLock);
+			writeResult(resultStream, job, result);
+			if(result.error.empty()) {
+				summary.totalTicks += job.tickCount;
+				summary.totalPartTicks += job.tickCount * result.partCount;
+			} else {
+				summary.failedJobCount++;
+				Log::error("Job %d (%s) failed: %s", static_cast<int>(job.index), job.source.c_str(), result.error.c_str());
+			}
+		}
+
+		Util::getThreadLimit() = previousThreadLimit;
+		isProfilingEnabled() = previousProfiling;
+	};
+
+	size_t workerCount = std::max<size_t>(1, std::min(threadCount, jobs.size()));
+	std::vector<std::thread> workers;
+	for(size_t i = 1; i < workerCount; i++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for(std::thread& thread : workers) {
+		thread.join();
+	}
+
+	summary.wallMillis = millisSince(wallStart);
+	return summary;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "batchJob.h"
+
+struct BatchResult {
+	size_t jobIndex = 0;
+	size_t partCount = 0;
+	size_t age = 0;
+	double kineticEnergy = 0.0;
+	double potentialEnergy = 0.0;
+	// WorldStateHash::hashWorld after the last tick
+	uint64_t stateHash = 0;
+	double setupMillis = 0.0;
+	double tickMillis = 0.0;
+	// empty if the job ran to completion
+	std::string error;
+};
+
+struct BatchSummary {
+	size_t jobCount = 0;
+	size_t failedJobCount = 0;
+	size_t totalTicks = 0;
+	// the sum over all jobs of ticks times free parts
+	size_t totalPartTicks = 0;
+	double wallMillis = 0.0;
+};
+
+/*
+	Runs every job on its own World<Part>, threadCount worlds at a time, each world is only ever touched by one thread
+	The parallel loops inside the physics run serially on the workers, a thread per world keeps every core busy without them
+
+	Every result is written to resultStream as one CSV line as soon as its job finishes, in order of completion,
+	after a header line naming the columns. A job that throws is reported with its error and does not stop the others
+*/
+BatchSummary runBatch(const std::vector<BatchJob>& jobs, std::ostream& resultStream, size_t threadCount);
@@ -0,0 +1,94 @@
+#include "worldBuilder.h"
+
+#include <cstdint>
+
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/misc/gravityForce.h"
+#include "../physics/math/mathUtil.h"
+
+/*
+	splitmix64, the standard distributions produce different sequences on different standard libraries
+	and a job has to build the same world everywhere
+*/
+class BuilderRandom {
+	uint64_t state;
+public:
+	BuilderRandom(uint64_t seed) : state(seed) {}
+
+	uint64_t next() {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// in [min, max)
+	double range(double min, double max) {
+		return min + (next() >> 11) * (1.0 / 9007199254740992.0) * (max - min);
+	}
+};
+
+static void addFloorAndGravity(World<Part>& world, double floorSize, const BatchParameters& parameters) {
+	world.addTerrainPart(new Part(Box(floorSize, 1.0, floorSize), GlobalCFrame(0.0, -0.5, 0.0), {1.0, 0.5, 0.5}));
+	world.addExternalForce(new DirectionalGravity(Vec3(0.0, -parameters.getDouble("gravity", 10.0), 0.0)));
+}
+
+class FallingBoxesBuilder : public WorldBuilder {
+public:
+	FallingBoxesBuilder() : WorldBuilder("fallingBoxes", "count boxes and spheres of random size dropped onto a floor, seed spread height") {}
+
+	virtual void build(World<Part>& world, const BatchParameters& parameters) const override {
+		long long count = parameters.getInt("count", 500);
+		double spread = parameters.getDouble("spread", 20.0);
+		double height = parameters.getDouble("height", 20.0);
+		BuilderRandom random(static_cast<uint64_t>(parameters.getInt("seed", 0)));
+
+		std::vector<Part*> parts;
+		parts.reserve(count);
+		for(long long i = 0; i < count; i++) {
+			// every draw is its own statement, the evaluation order of function arguments is unspecified
+			double x = random.range(-spread, spread) / 2;
+			double y = random.range(1.0, 1.0 + height);
+			double z = random.range(-spread, spread) / 2;
+			double alpha = random.range(0.0, 2 * PI);
+			double beta = random.range(0.0, 2 * PI);
+			double gamma = random.range(0.0, 2 * PI);
+			GlobalCFrame cframe(x, y, z, Rotation::fromEulerAngles(alpha, beta, gamma));
+
+			if(random.next() % 4 == 0) {
+				parts.push_back(new Part(Sphere(random.range(0.2, 0.6)), cframe, {1.0, 0.5, 0.3}));
+			} else {
+				double width = random.range(0.3, 1.2);
+				double boxHeight = random.range(0.3, 1.2);
+				double depth = random.range(0.3, 1.2);
+				parts.push_back(new Part(Box(width, boxHeight, depth), cframe, {1.0, 0.5, 0.3}));
+			}
+		}
+		world.addParts(parts.data(), parts.size());
+		addFloorAndGravity(world, spread + 20.0, parameters);
+	}
+} fallingBoxesBuilder;
+
+class BoxStackBuilder : public WorldBuilder {
+public:
+	BoxStackBuilder() : WorldBuilder("boxStack", "a width x width grid of towers of height unit boxes resting on a floor") {}
+
+	virtual void build(World<Part>& world, const BatchParameters& parameters) const override {
+		long long width = parameters.getInt("width", 5);
+		long long height = parameters.getInt("height", 10);
+		double spacing = 1.5;
+
+		std::vector<Part*> parts;
+		parts.reserve(width * width * height);
+		for(long long x = 0; x < width; x++) {
+			for(long long z = 0; z < width; z++) {
+				for(long long y = 0; y < height; y++) {
+					GlobalCFrame cframe((x - (width - 1) / 2.0) * spacing, 0.5 + y * 1.0, (z - (width - 1) / 2.0) * spacing);
+					parts.push_back(new Part(Box(1.0, 1.0, 1.0), cframe, {1.0, 0.5, 0.0}));
+				}
+			}
+		}
+		world.addParts(parts.data(), parts.size());
+		addFloorAndGravity(world, width * spacing + 20.0, parameters);
+	}
+} boxStackBuilder;
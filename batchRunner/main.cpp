@@ -0,0 +1,89 @@
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <exception>
+
+#include "../util/log.h"
+#include "../util/parallelFor.h"
+
+#include "batchJob.h"
+#include "batchRunner.h"
+#include "worldBuilder.h"
+
+/*
+	Runs a batch of worlds without any graphics and writes the results of every world to a CSV file
+
+		batchRunner <job file> <result file> [--threads <count>]
+		batchRunner --list
+
+	See parseBatchJobs for the job file format
+*/
+
+static void printUsage() {
+	Log::print("usage: batchRunner <job file> <result file> [--threads <count>]\n");
+	Log::print("       batchRunner --list\n");
+}
+
+static void printWorldBuilders() {
+	Log::print("The following world builders are available:\n");
+	for(const WorldBuilder* builder : getWorldBuilders()) {
+		Log::print(Log::Color::INFO, "  %s", builder->name);
+		Log::print(": %s\n", builder->description);
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	std::vector<const char*> paths;
+	size_t threadCount = Util::getHardwareThreadCount();
+
+	for(int i = 1; i < argc; i++) {
+		if(std::strcmp(argv[i], "--list") == 0) {
+			printWorldBuilders();
+			return 0;
+		} else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			int count = std::atoi(argv[++i]);
+			if(count <= 0) {
+				Log::error("--threads expects a positive count, got %s", argv[i]);
+				return 1;
+			}
+			threadCount = static_cast<size_t>(count);
+		} else {
+			paths.push_back(argv[i]);
+		}
+	}
+
+	if(paths.size() != 2) {
+		printUsage();
+		return 1;
+	}
+
+	std::vector<BatchJob> jobs;
+	try {
+		std::ifstream jobFile(paths[0]);
+		if(!jobFile) {
+			Log::error("Could not open job file %s", paths[0]);
+			return 1;
+		}
+		jobs = parseBatchJobs(jobFile);
+	} catch(const std::exception& error) {
+		Log::error("Invalid job file %s: %s", paths[0], error.what());
+		return 1;
+	}
+
+	std::ofstream resultFile(paths[1]);
+	if(!resultFile) {
+		Log::error("Could not create result file %s", paths[1]);
+		return 1;
+	}
+
+	Log::print("Running %d jobs on %d threads\n", static_cast<int>(jobs.size()), static_cast<int>(threadCount));
+	BatchSummary summary = runBatch(jobs, resultFile, threadCount);
+
+	double seconds = summary.wallMillis / 1000.0;
+	Log::print("%d jobs, %d failed, %llu ticks in %f s\n", static_cast<int>(summary.jobCount), static_cast<int>(summary.failedJobCount), static_cast<unsigned long long>(summary.totalTicks), seconds);
+	Log::print("%f ticks per second, %f part ticks per second\n", summary.totalTicks / seconds, summary.totalPartTicks / seconds);
+
+	return (summary.failedJobCount == 0) ? 0 : 2;
+}
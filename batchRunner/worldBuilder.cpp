@@ -0,0 +1,24 @@
+#include "worldBuilder.h"
+
+#include <cstring>
+
+static std::vector<WorldBuilder*>* knownWorldBuilders = nullptr;
+
+WorldBuilder::WorldBuilder(const char* name, const char* description) : name(name), description(description) {
+	if(knownWorldBuilders == nullptr) { knownWorldBuilders = new std::vector<WorldBuilder*>(); }
+	knownWorldBuilders->push_back(this);
+}
+
+const std::vector<WorldBuilder*>& getWorldBuilders() {
+	if(knownWorldBuilders == nullptr) { knownWorldBuilders = new std::vector<WorldBuilder*>(); }
+	return *knownWorldBuilders;
+}
+
+const WorldBuilder* findWorldBuilder(const char* name) {
+	for(const WorldBuilder* builder : getWorldBuilders()) {
+		if(std::strcmp(builder->name, name) == 0) {
+			return builder;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+
+#include "batchJob.h"
+
+/*
+	Fills an empty world for a job, subclasses are instantiated once as globals and register themselves by name, like benchmarks
+	build is called concurrently for different worlds, it must not modify shared state
+*/
+class WorldBuilder {
+public:
+	const char* name;
+	const char* description;
+
+	WorldBuilder(const char* name, const char* description);
+	virtual ~WorldBuilder() {}
+
+	virtual void build(World<Part>& world, const BatchParameters& parameters) const = 0;
+};
+
+const std::vector<WorldBuilder*>& getWorldBuilders();
+/*
+	Returns nullptr if no builder has the given name
+*/
+const WorldBuilder* findWorldBuilder(const char* name);
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <cmath>
+
+#include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/quantizedBoundsTree.h"
+#include "../util/log.h"
+
+/*
+	Finds all overlapping pairs among many boxes scattered in a volume, like findColissions does every tick
+	The exact variant walks the TreeNodes directly, testing one child at a time
+	The quantized variant rebuilds a QuantizedBoundsTree every iteration, as the world does
+*/
+class BroadphaseBenchmark : public Benchmark {
+	std::vector<int> objects;
+	BoundsTree<int> tree;
+	QuantizedBoundsTree quantizedTree;
+	bool quantized;
+	int boxCount;
+	int iterationCount;
+	size_t pairCount = 0;
+
+	static void findPairsBetween(TreeNode& first, TreeNode& second, size_t& pairCount) {
+		if(!intersects(first.bounds, second.bounds)) return;
+		if(first.isLeafNode() && second.isLeafNode()) {
+			pairCount++;
+		} else if((computeCost(first.bounds) <= computeCost(second.bounds) && !first.isLeafNode()) || second.isLeafNode()) {
+			for(TreeNode& node : first) findPairsBetween(node, second, pairCount);
+		} else {
+			for(TreeNode& node : second) findPairsBetween(first, node, pairCount);
+		}
+	}
+	static void findPairsWithin(TreeNode& node, size_t& pairCount) {
+		if(node.isLeafNode() || node.isGroupHead) return;
+		for(int i = 0; i < node.nodeCount; i++) {
+			findPairsWithin(node[i], pairCount);
+			for(int j = i + 1; j < node.nodeCount; j++) {
+				findPairsBetween(node[i], node[j], pairCount);
+			}
+		}
+	}
+
+public:
+	BroadphaseBenchmark(const char* name, bool quantized, int boxCount, int iterationCount) :
+		Benchmark(name), quantized(quantized), boxCount(boxCount), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		objects.resize(boxCount);
+		double spread = std::cbrt(static_cast<double>(boxCount)) * 1.5;
+		for(int i = 0; i < boxCount; i++) {
+			objects[i] = i;
+			Position min(std::sin(i * 0.37) * spread, std::sin(i * 0.71) * spread, std::sin(i * 0.13) * spread);
+			tree.add(&objects[i], Bounds(min, min + Vec3(1.0, 1.0, 1.0)));
+		}
+		tree.improveStructure();
+	}
+
+	virtual void run() override {
+		for(int iteration = 0; iteration < iterationCount; iteration++) {
+			pairCount = 0;
+			if(quantized) {
+				quantizedTree.rebuild(tree.rootNode);
+				quantizedTree.forEachOverlappingPair([this](TreeNode& first, TreeNode& second) {
+					pairCount++;
+				});
+			} else {
+				findPairsWithin(tree.rootNode, pairCount);
+			}
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d overlapping pairs, %f ms per search\n", static_cast<int>(pairCount), timeTakenMillis / iterationCount);
+	}
+};
+
+BroadphaseBenchmark broadphaseExact("broadphaseExact", false, 20000, 100);
+BroadphaseBenchmark broadphaseQuantized("broadphaseQuantized", true, 20000, 100);
@@ -0,0 +1,41 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <climits>
+
+#include "../physics/geometry/polyhedron.h"
+#include "../physics/geometry/convexHull.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../util/log.h"
+
+/*
+	Builds the hull of the vertices of a finely tesselated sphere, where every point is on the hull like for a smooth imported mesh
+*/
+class ConvexHullBenchmark : public Benchmark {
+	int sphereSteps;
+	int maxVertices;
+	std::vector<Vec3f> points;
+	int resultVertexCount = 0;
+	float maxError = 0.0f;
+
+public:
+	ConvexHullBenchmark(const char* name, int sphereSteps, int maxVertices) : Benchmark(name), sphereSteps(sphereSteps), maxVertices(maxVertices) {}
+
+	virtual void init() override {
+		Polyhedron sphere = Library::createSphere(1.0f, sphereSteps);
+		points.resize(sphere.vertexCount);
+		sphere.getVertices(points.data());
+	}
+
+	virtual void run() override {
+		Polyhedron hull = buildConvexHull(points.data(), points.size(), maxVertices, &maxError);
+		resultVertexCount = hull.vertexCount;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d points to %d vertices, max error %f\n", static_cast<int>(points.size()), resultVertexCount, maxError);
+	}
+};
+
+ConvexHullBenchmark convexHullExact("convexHull", 6, INT_MAX);
+ConvexHullBenchmark convexHullReduced("convexHullReduced", 6, 256);
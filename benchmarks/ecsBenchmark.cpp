@@ -0,0 +1,91 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <cmath>
+
+#include "core.h"
+#include "../engine/ecs/tree.h"
+#include "../engine/ecs/entity.h"
+#include "../util/log.h"
+
+/*
+	Stand-ins for the transform and material components of the application, which depend on the renderer
+*/
+struct BenchmarkTransform : public Engine::Component {
+	DEFINE_COMPONENT(Transform, true);
+
+	Vec3 position;
+	double scale;
+};
+
+struct BenchmarkMaterial : public Engine::Component {
+	DEFINE_COMPONENT(Material, true);
+
+	Vec3 albedo;
+};
+
+enum class ECSIteration {
+	ENTITY_LOOKUP,
+	VIEW
+};
+
+/*
+	Visits the transform and material of many entities, as the renderer does every frame
+	The lookup variant walks the nodes of the tree and asks each entity for its components
+	The view variant scans the component storages of the tree
+*/
+class ECSBenchmark : public Benchmark {
+	Engine::ECSTree tree;
+	std::vector<BenchmarkTransform> transforms;
+	std::vector<BenchmarkMaterial> materials;
+	ECSIteration iteration;
+	int entityCount;
+	int iterationCount;
+	double checksum = 0.0;
+
+public:
+	ECSBenchmark(const char* name, ECSIteration iteration, int entityCount, int iterationCount) :
+		Benchmark(name), iteration(iteration), entityCount(entityCount), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		transforms.resize(entityCount);
+		materials.resize(entityCount);
+		for (int i = 0; i < entityCount; i++) {
+			transforms[i].position = Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13));
+			transforms[i].scale = 1.0 + std::sin(i * 0.29) * 0.5;
+			materials[i].albedo = Vec3(std::sin(i * 0.53), std::sin(i * 0.17), std::sin(i * 0.91));
+
+			Engine::Entity* entity = tree.createEntity(tree.getRoot(), "Entity");
+			entity->addComponent(&transforms[i]);
+			// every fourth entity is invisible and has no material
+			if (i % 4 != 0)
+				entity->addComponent(&materials[i]);
+		}
+	}
+
+	virtual void run() override {
+		Vec3 total(0.0, 0.0, 0.0);
+		for (int i = 0; i < iterationCount; i++) {
+			if (iteration == ECSIteration::VIEW) {
+				for (auto [entity, transform, material] : tree.view<BenchmarkTransform, BenchmarkMaterial>())
+					total += transform->position * transform->scale + material->albedo;
+				continue;
+			}
+			for (Engine::Node* node : tree.getRoot()->getChildren()) {
+				Engine::Entity* entity = static_cast<Engine::Entity*>(node);
+				BenchmarkTransform* transform = entity->getComponent<BenchmarkTransform>();
+				BenchmarkMaterial* material = entity->getComponent<BenchmarkMaterial>();
+				if (transform != nullptr && material != nullptr)
+					total += transform->position * transform->scale + material->albedo;
+			}
+		}
+		checksum = total.x + total.y + total.z;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f ns per entity (checksum %f)\n", timeTakenMillis * 1000000.0 / (static_cast<double>(entityCount) * iterationCount), checksum);
+	}
+};
+
+ECSBenchmark ecsEntityLookup("ecsEntityLookup", ECSIteration::ENTITY_LOOKUP, 100000, 100);
+ECSBenchmark ecsView("ecsView", ECSIteration::VIEW, 100000, 100);
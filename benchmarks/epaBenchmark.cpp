@@ -0,0 +1,38 @@
+#include "benchmark.h"
+
+#include <optional>
+#include <cmath>
+
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/geometry/intersection.h"
+#include "../physics/math/rotation.h"
+#include "../util/log.h"
+
+/*
+	Spheres sunk deep into a box, the round support function makes EPA run many iterations before it converges
+*/
+class DeepSphereBoxBenchmark : public Benchmark {
+	Shape box;
+	Shape sphere;
+	int intersectionCount;
+	double totalDepth = 0.0;
+
+public:
+	DeepSphereBoxBenchmark(const char* name, double sphereRadius, int intersectionCount) : 
+		Benchmark(name), box(Box(2.0, 2.0, 2.0)), sphere(Sphere(sphereRadius)), intersectionCount(intersectionCount) {}
+
+	virtual void run() override {
+		for(int i = 0; i < intersectionCount; i++) {
+			Vec3 offset(0.3 * std::sin(i * 0.37), 0.3 * std::sin(i * 0.71), 0.3 * std::sin(i * 0.13));
+			std::optional<Intersection> result = intersectsTransformed(box, sphere, CFrame(offset, Rotation::fromEulerAngles(i * 0.1, i * 0.3, i * 0.7)));
+			if(result) totalDepth += length(result.value().exitVector);
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f us per intersection, average depth %f\n", timeTakenMillis * 1000.0 / intersectionCount, totalDepth / intersectionCount);
+	}
+};
+
+DeepSphereBoxBenchmark epaDeepSphereBox("epaDeepSphereBox", 1.0, 200000);
+DeepSphereBoxBenchmark epaLargeSphereBox("epaLargeSphereBox", 3.0, 200000);
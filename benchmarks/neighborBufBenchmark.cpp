@@ -0,0 +1,43 @@
+#include "benchmark.h"
+
+#include <vector>
+
+#include "../physics/geometry/polyhedron.h"
+#include "../physics/geometry/indexedShape.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../util/log.h"
+
+/*
+	Fills the triangle neighbors of the same shape repeatCount times
+	The tetrahedron is what every EPA call starts from, the large sphere stands in for an imported mesh
+*/
+class NeighborBufBenchmark : public Benchmark {
+	int sphereSteps;
+	int repeatCount;
+	std::vector<Triangle> triangles;
+	std::vector<TriangleNeighbors> neighbors;
+
+public:
+	NeighborBufBenchmark(const char* name, int sphereSteps, int repeatCount) : Benchmark(name), sphereSteps(sphereSteps), repeatCount(repeatCount) {}
+
+	virtual void init() override {
+		Polyhedron shape = (sphereSteps == 0) ? Library::trianglePyramid : Library::createSphere(1.0f, sphereSteps);
+		triangles.resize(shape.triangleCount);
+		neighbors.resize(shape.triangleCount);
+		shape.getTriangles(triangles.data());
+	}
+
+	virtual void run() override {
+		for(int i = 0; i < repeatCount; i++) {
+			fillNeighborBuf(triangles.data(), static_cast<int>(triangles.size()), neighbors.data());
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d triangles, %f us per fill\n", static_cast<int>(triangles.size()), timeTakenMillis * 1000.0 / repeatCount);
+	}
+};
+
+NeighborBufBenchmark neighborBufTetrahedron("neighborBufTetrahedron", 0, 10000000);
+NeighborBufBenchmark neighborBufSphere("neighborBufSphere", 2, 100000);
+NeighborBufBenchmark neighborBufLargeMesh("neighborBufLargeMesh", 6, 10);
@@ -0,0 +1,105 @@
+#include "benchmark.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../engine/core.h"
+#include "../engine/io/import.h"
+#include "../engine/io/meshCache.h"
+#include "../graphics/visualShape.h"
+#include "../util/log.h"
+
+static const char* objBenchmarkFile = "objImportBenchmark.obj";
+
+/*
+	Generates a grid of gridSize x gridSize quads with positions, uvs and normals, 2 * gridSize^2 triangles
+*/
+static void writeGridObj(const char* path, int gridSize) {
+	std::ofstream output(path);
+	int verticesPerSide = gridSize + 1;
+
+	for (int x = 0; x < verticesPerSide; x++) {
+		for (int z = 0; z < verticesPerSide; z++) {
+			output << "v " << x * 0.01 << " " << 0.001 * ((x * 7 + z * 13) % 100) << " " << z * -0.01 << "\n";
+		}
+	}
+	for (int x = 0; x < verticesPerSide; x++) {
+		for (int z = 0; z < verticesPerSide; z++) {
+			output << "vt " << double(x) / gridSize << " " << double(z) / gridSize << "\n";
+		}
+	}
+	output << "vn 0.0 1.0 0.0\n";
+
+	for (int x = 0; x < gridSize; x++) {
+		for (int z = 0; z < gridSize; z++) {
+			int a = x * verticesPerSide + z + 1;
+			int b = a + verticesPerSide;
+			output << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 " << b + 1 << "/" << b + 1 << "/1 " << a + 1 << "/" << a + 1 << "/1\n";
+		}
+	}
+}
+
+class OBJImportBenchmark : public Benchmark {
+protected:
+	int gridSize;
+	int triangleCount = 0;
+
+public:
+	OBJImportBenchmark(const char* name, int gridSize) : Benchmark(name), gridSize(gridSize) {}
+
+	virtual void init() override {
+		writeGridObj(objBenchmarkFile, gridSize);
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		std::remove(objBenchmarkFile);
+		Log::print("Loaded %d triangles, %f triangles per second\n", triangleCount, triangleCount / (timeTakenMillis / 1000.0));
+	}
+};
+
+class StreamingOBJImport : public OBJImportBenchmark {
+public:
+	StreamingOBJImport() : OBJImportBenchmark("objImport", 1000) {}
+
+	virtual void run() override {
+		Graphics::VisualShape shape = OBJImport::load(std::string(objBenchmarkFile));
+		triangleCount = shape.triangleCount;
+	}
+} streamingOBJImport;
+
+class LineByLineOBJImport : public OBJImportBenchmark {
+public:
+	LineByLineOBJImport() : OBJImportBenchmark("objImportLineByLine", 1000) {}
+
+	virtual void run() override {
+		std::ifstream input(objBenchmarkFile);
+		Graphics::VisualShape shape = OBJImport::loadLineByLine(input);
+		triangleCount = shape.triangleCount;
+	}
+} lineByLineOBJImport;
+
+static const char* meshCacheBenchmarkDirectory = "meshCacheBenchmark";
+
+class MeshCacheLoad : public OBJImportBenchmark {
+public:
+	MeshCacheLoad() : OBJImportBenchmark("meshCacheLoad", 1000) {}
+
+	virtual void init() override {
+		OBJImportBenchmark::init();
+
+		// the first load parses the source and fills the cache, run only measures loads from the cache
+		MeshCache::load(objBenchmarkFile, meshCacheBenchmarkDirectory);
+	}
+
+	virtual void run() override {
+		CachedMesh mesh = MeshCache::load(objBenchmarkFile, meshCacheBenchmarkDirectory);
+		triangleCount = mesh.shape.triangleCount;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		std::filesystem::remove_all(meshCacheBenchmarkDirectory);
+		OBJImportBenchmark::printResults(timeTakenMillis);
+	}
+} meshCacheLoad;
@@ -0,0 +1,196 @@
+#include "benchmark.h"
+
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#include "../physics/world.h"
+#include "../physics/physicsProfiler.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/math/linalg/trigonometry.h"
+#include "../util/log.h"
+
+/*
+	Counts the hardware cache misses of the calling thread, where the platform allows it
+	Virtual machines and locked down kernels often don't expose the counter, isAvailable then returns false
+*/
+class CacheMissCounter {
+#ifdef __linux__
+	int fd = -1;
+#endif
+public:
+	CacheMissCounter() {
+#ifdef __linux__
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.size = sizeof(attributes);
+		attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+		attributes.disabled = 1;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+	}
+	~CacheMissCounter() {
+#ifdef __linux__
+		if(fd >= 0) close(fd);
+#endif
+	}
+
+	bool isAvailable() const {
+#ifdef __linux__
+		return fd >= 0;
+#else
+		return false;
+#endif
+	}
+
+	void start() {
+#ifdef __linux__
+		if(fd < 0) return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+
+	long long stop() {
+#ifdef __linux__
+		if(fd < 0) return 0;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		long long count = 0;
+		if(read(fd, &count, sizeof(count)) != sizeof(count)) return 0;
+		return count;
+#else
+		return 0;
+#endif
+	}
+};
+
+/*
+	Runs only the colission detection of a tick, without moving anything
+*/
+class ColissionDetectionWorld : public World<Part> {
+public:
+	ColissionDetectionWorld() : World<Part>(0.005) {}
+
+	void detectColissions() {
+		findColissions();
+	}
+};
+
+template<typename T>
+static void extendRange(const T& field, uintptr_t& begin, uintptr_t& end) {
+	uintptr_t address = reinterpret_cast<uintptr_t>(&field);
+	begin = std::min(begin, address);
+	end = std::max(end, address + sizeof(T));
+}
+
+/*
+	The number of cache lines the fields read for every tested pair of parts span, for this part at its actual address
+*/
+static size_t getCollisionCacheLineCount(const Part& part) {
+	uintptr_t begin = UINTPTR_MAX;
+	uintptr_t end = 0;
+	extendRange(part.isTerrainPart, begin, end);
+	extendRange(part.maxRadius, begin, end);
+	extendRange(part.getCFrame(), begin, end);
+	extendRange(part.hitbox, begin, end);
+	return (end - 1) / 64 - begin / 64 + 1;
+}
+
+/*
+	Many boxes scattered through a volume, added one at a time like most worlds are built, so every part is allocated right after its physical
+
+	The leaf pass reads the fields of every part that colission detection reads first, in the order of the leaves of the bounds tree,
+	which is the cost of dereferencing a leaf. The colission detection pass runs the whole findColissions, narrowphase included
+*/
+class PartLayoutBenchmark : public Benchmark {
+	ColissionDetectionWorld world;
+	int partCount;
+	int leafPassCount;
+	int detectionPassCount;
+	CacheMissCounter cacheMisses;
+
+	double leafPassMillis = 0.0;
+	long long leafPassMisses = 0;
+	double detectionPassMillis = 0.0;
+	long long detectionPassMisses = 0;
+	long long testedPairCount = 0;
+	double checksum = 0.0;
+
+	static double millisSince(std::chrono::high_resolution_clock::time_point start) {
+		return (std::chrono::high_resolution_clock::now() - start).count() / 1000000.0;
+	}
+
+public:
+	PartLayoutBenchmark() : Benchmark("partLayout"), partCount(100000), leafPassCount(50), detectionPassCount(5) {}
+
+	virtual void init() override {
+		double spread = std::cbrt(static_cast<double>(partCount)) * 2.5;
+		std::mt19937 random(42);
+		std::uniform_real_distribution<double> coordinate(-spread / 2, spread / 2);
+		for(int i = 0; i < partCount; i++) {
+			double x = coordinate(random);
+			double y = coordinate(random);
+			double z = coordinate(random);
+			GlobalCFrame cframe(x, y, z, Rotation::fromEulerAngles(i * 0.1, i * 0.2, 0.0));
+			world.addPart(new Part(Box(1.0, 0.4, 0.7), cframe, {1.0, 0.5, 0.5}));
+		}
+	}
+
+	virtual void run() override {
+		auto leafStart = std::chrono::high_resolution_clock::now();
+		cacheMisses.start();
+		for(int pass = 0; pass < leafPassCount; pass++) {
+			for(const Part& part : world.iterParts(FREE_PARTS)) {
+				if(!part.isTerrainPart) checksum += part.maxRadius + static_cast<double>(part.getPosition().x);
+			}
+		}
+		leafPassMisses = cacheMisses.stop();
+		leafPassMillis = millisSince(leafStart) / leafPassCount;
+
+		auto detectionStart = std::chrono::high_resolution_clock::now();
+		cacheMisses.start();
+		for(int pass = 0; pass < detectionPassCount; pass++) {
+			world.detectColissions();
+			intersectionStatistics.nextTally();
+		}
+		detectionPassMisses = cacheMisses.stop();
+		detectionPassMillis = millisSince(detectionStart) / detectionPassCount;
+
+		ParallelArray<long long, static_cast<size_t>(IntersectionResult::COUNT)> lastTally = intersectionStatistics.history.front();
+		testedPairCount = 0;
+		for(size_t i = 0; i < static_cast<size_t>(IntersectionResult::COUNT); i++) {
+			testedPairCount += lastTally[i];
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		size_t collisionLineCount = 0;
+		for(const Part& part : world.iterParts()) {
+			collisionLineCount += getCollisionCacheLineCount(part);
+		}
+
+		Log::print("%d parts, sizeof(Part) %d\n", partCount, static_cast<int>(sizeof(Part)));
+		Log::print("%.2f cache lines of collision data per part\n", static_cast<double>(collisionLineCount) / partCount);
+		Log::print("%f ns per part in the leaf pass (checksum %f)\n", leafPassMillis * 1000000.0 / partCount, checksum);
+		Log::print("%d pairs tested, %f ms per colission detection pass\n", static_cast<int>(testedPairCount), detectionPassMillis);
+		if(cacheMisses.isAvailable()) {
+			Log::print("%.2f cache misses per part in the leaf pass, %.1f per tested pair in the colission detection pass\n",
+				static_cast<double>(leafPassMisses) / (static_cast<double>(partCount) * leafPassCount), static_cast<double>(detectionPassMisses) / (static_cast<double>(testedPairCount) * detectionPassCount));
+		} else {
+			Log::print("hardware cache miss counter not available\n");
+		}
+	}
+} partLayout;
@@ -0,0 +1,63 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <memory>
+
+#include "../physics/part.h"
+#include "../physics/physical.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/constraints/fixedConstraint.h"
+#include "../physics/constraints/motorConstraint.h"
+#include "../util/log.h"
+
+/*
+	Updates many physicals outside of a world, so only the integration and the mass property refresh are measured
+	Every physical is a chain of chainLength parts, attached with fixed constraints or with motors
+*/
+class PhysicalUpdateBenchmark : public Benchmark {
+	std::vector<std::unique_ptr<Part>> parts;
+	std::vector<MotorizedPhysical*> physicals;
+	int physicalCount;
+	int chainLength;
+	bool motorized;
+	int tickCount;
+
+public:
+	PhysicalUpdateBenchmark(const char* name, int physicalCount, int chainLength, bool motorized, int tickCount) :
+		Benchmark(name), physicalCount(physicalCount), chainLength(chainLength), motorized(motorized), tickCount(tickCount) {}
+
+	virtual void init() override {
+		for(int i = 0; i < physicalCount; i++) {
+			Part* first = new Part(Box(1.0, 0.5, 0.7), GlobalCFrame(i * 3.0, 0.0, 0.0), {1.0, 0.2, 0.5});
+			parts.emplace_back(first);
+			Part* previous = first;
+			for(int j = 1; j < chainLength; j++) {
+				Part* next = new Part(Box(1.0, 0.5, 0.7), GlobalCFrame(), {1.0, 0.2, 0.5});
+				parts.emplace_back(next);
+				HardConstraint* constraint = motorized ? static_cast<HardConstraint*>(new ConstantSpeedMotorConstraint(0.3 * j)) : new FixedConstraint();
+				previous->attach(next, constraint, CFrame(0.5, 0.0, 0.0), CFrame(-0.5, 0.0, 0.0));
+				previous = next;
+			}
+			first->ensureHasParent();
+			MotorizedPhysical* phys = first->parent->mainPhysical;
+			phys->motionOfCenterOfMass = Motion(Vec3(0.1, 0.0, 0.2), Vec3(0.01, 0.03, -0.02));
+			physicals.push_back(phys);
+		}
+	}
+
+	virtual void run() override {
+		for(int tick = 0; tick < tickCount; tick++) {
+			for(MotorizedPhysical* phys : physicals) {
+				phys->update(0.005);
+			}
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f us per physical update\n", timeTakenMillis * 1000.0 / (static_cast<double>(tickCount) * physicalCount));
+	}
+};
+
+PhysicalUpdateBenchmark physicalUpdateSinglePart("physicalUpdateSinglePart", 10000, 1, false, 200);
+PhysicalUpdateBenchmark physicalUpdateFixedChain("physicalUpdateFixedChain", 2000, 5, false, 200);
+PhysicalUpdateBenchmark physicalUpdateMotorChain("physicalUpdateMotorChain", 2000, 5, true, 200);
@@ -0,0 +1,44 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <cmath>
+
+#include "../physics/geometry/polyhedron.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../util/log.h"
+
+/*
+	Casts rays at and tests points against a tesselated sphere, like the picker does when hovering over a detailed mesh
+*/
+class PolyhedronRayBenchmark : public Benchmark {
+	int sphereSteps;
+	int queryCount;
+	Polyhedron sphere;
+	int hitCount = 0;
+	int insideCount = 0;
+
+public:
+	PolyhedronRayBenchmark(const char* name, int sphereSteps, int queryCount) : Benchmark(name), sphereSteps(sphereSteps), queryCount(queryCount) {}
+
+	virtual void init() override {
+		sphere = Library::createSphere(1.0f, sphereSteps);
+	}
+
+	virtual void run() override {
+		hitCount = 0;
+		insideCount = 0;
+		for(int i = 0; i < queryCount; i++) {
+			Vec3f origin = Vec3f(std::cos(i * 0.5f), std::sin(i * 0.5f), std::sin(i * 0.9f)) * 3.0f;
+			Vec3f target = Vec3f(std::sin(i * 0.37f), std::sin(i * 0.71f), std::sin(i * 0.13f)) * 1.2f;
+			if(sphere.getIntersectionDistance(origin, target - origin) != INFINITY) hitCount++;
+			if(sphere.containsPoint(target)) insideCount++;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d triangles, %d/%d rays hit, %d/%d points inside, %f us per ray and point\n", sphere.triangleCount, hitCount, queryCount, insideCount, queryCount, timeTakenMillis * 1000.0 / queryCount);
+	}
+};
+
+PolyhedronRayBenchmark polyhedronRaySmall("polyhedronRaySmall", 1, 200000);
+PolyhedronRayBenchmark polyhedronRayLarge("polyhedronRayLarge", 5, 2000);
@@ -0,0 +1,56 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <cmath>
+
+#include "../physics/math/rotation.h"
+#include "../util/log.h"
+
+/*
+	Composes and applies many rotations in both representations, independent of which one PHYSICS_QUATERNION_ROTATIONS selects
+	A world tick mostly composes cframes and transforms vectors with them, the cframes are spread over a large array like the parts of a world
+	Compare full tick times between builds with and without PHYSICS_QUATERNION_ROTATIONS using the manyCubes benchmark
+*/
+template<typename Rot>
+class RotationBenchmark : public Benchmark {
+	std::vector<Vec3> positions;
+	std::vector<Rot> rotations;
+	int rotationCount;
+	int iterationCount;
+	double checksum = 0.0;
+
+public:
+	RotationBenchmark(const char* name, int rotationCount, int iterationCount) :
+		Benchmark(name), rotationCount(rotationCount), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		positions.resize(rotationCount);
+		rotations.resize(rotationCount);
+		for(int i = 0; i < rotationCount; i++) {
+			positions[i] = Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13));
+			rotations[i] = Rot::fromEulerAngles(std::sin(i * 0.29) * 3.0, std::sin(i * 0.53) * 3.0, std::sin(i * 0.17) * 3.0);
+		}
+	}
+
+	virtual void run() override {
+		Rot step = Rot::fromEulerAngles(0.001, 0.002, 0.003);
+		Vec3 total(0.0, 0.0, 0.0);
+		for(int iteration = 0; iteration < iterationCount; iteration++) {
+			for(int i = 0; i < rotationCount; i++) {
+				// integrate the rotation, then bring a point of the object into global space and back into the space of its neighbour
+				rotations[i] = step * rotations[i];
+				Vec3 global = rotations[i].localToGlobal(positions[i]);
+				total += rotations[(i + 1) % rotationCount].globalToLocal(global);
+			}
+		}
+		checksum = total.x + total.y + total.z;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		double operations = static_cast<double>(rotationCount) * iterationCount;
+		Log::print("%d bytes per rotation, %f ns per update (checksum %f)\n", static_cast<int>(sizeof(Rot)), timeTakenMillis * 1000000.0 / operations, checksum);
+	}
+};
+
+RotationBenchmark<MatrixRotationTemplate<double>> matrixRotation("matrixRotation", 100000, 200);
+RotationBenchmark<QuaternionRotationTemplate<double>> quaternionRotation("quaternionRotation", 100000, 200);
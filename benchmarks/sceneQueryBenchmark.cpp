@@ -0,0 +1,86 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <cmath>
+
+#include "../physics/world.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/misc/filters/rayIntersectsBoundsFilter.h"
+#include "../util/log.h"
+
+enum class RaycastMethod {
+	FILTERED_ITERATION,
+	CLOSEST,
+	ANY
+};
+
+/*
+	Casts many rays between random points in a world full of boxes, like line of sight checks between agents
+	The filtered variant walks the parts one ray at a time through iterPartsFiltered, as the picker used to
+	The other variants use the batched queries of the world
+*/
+class RaycastBenchmark : public Benchmark {
+	World<Part> world;
+	std::vector<RayQuery> queries;
+	std::vector<QueryHit> results;
+	RaycastMethod method;
+	int partCount;
+	int rayCount;
+	int hitCount = 0;
+
+public:
+	RaycastBenchmark(const char* name, RaycastMethod method, int partCount, int rayCount) :
+		Benchmark(name), world(0.01), method(method), partCount(partCount), rayCount(rayCount) {}
+
+	virtual void init() override {
+		double spread = std::cbrt(static_cast<double>(partCount)) * 2.0;
+		std::vector<Part*> parts;
+		for(int i = 0; i < partCount; i++) {
+			GlobalCFrame cframe(std::sin(i * 0.37) * spread, std::sin(i * 0.71) * spread, std::sin(i * 0.13) * spread);
+			parts.push_back(new Part(Box(1.0, 1.0, 1.0), cframe, {1.0, 0.5, 0.5}));
+		}
+		world.addParts(parts.data(), parts.size());
+		for(int i = 0; i < rayCount; i++) {
+			Position from(std::sin(i * 0.53) * spread, std::sin(i * 0.29) * spread, std::sin(i * 0.91) * spread);
+			Position to(std::sin(i * 0.17) * spread, std::sin(i * 0.83) * spread, std::sin(i * 0.47) * spread);
+			// the ray ends at to, line of sight is blocked by anything before distance 1
+			queries.push_back(RayQuery(Ray{from, to - from}, 1.0));
+		}
+		results.resize(rayCount);
+	}
+
+	virtual void run() override {
+		switch(method) {
+		case RaycastMethod::FILTERED_ITERATION:
+			for(int i = 0; i < rayCount; i++) {
+				const Ray& ray = queries[i].ray;
+				QueryHit best;
+				best.distance = queries[i].maxDistance;
+				for(Part& part : world.iterPartsFiltered(RayIntersectBoundsFilter(ray))) {
+					double distance = part.hitbox.getIntersectionDistance(part.getCFrame().globalToLocal(ray.start), part.getCFrame().relativeToLocal(ray.direction));
+					if(distance > 0.0 && distance < best.distance) best = QueryHit{&part, distance};
+				}
+				results[i] = best;
+			}
+			break;
+		case RaycastMethod::CLOSEST:
+			world.raycastClosest(queries.data(), queries.size(), results.data());
+			break;
+		case RaycastMethod::ANY:
+			world.raycastAny(queries.data(), queries.size(), results.data());
+			break;
+		}
+		hitCount = 0;
+		for(const QueryHit& hit : results) {
+			if(hit.hasHit()) hitCount++;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d of %d rays blocked, %f us per ray\n", hitCount, rayCount, timeTakenMillis * 1000.0 / rayCount);
+	}
+};
+
+RaycastBenchmark raycastFiltered("raycastFiltered", RaycastMethod::FILTERED_ITERATION, 20000, 10000);
+RaycastBenchmark raycastClosest("raycastClosest", RaycastMethod::CLOSEST, 20000, 10000);
+RaycastBenchmark raycastAny("raycastAny", RaycastMethod::ANY, 20000, 10000);
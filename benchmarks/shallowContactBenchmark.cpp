@@ -0,0 +1,48 @@
+#include "benchmark.h"
+
+#include <optional>
+#include <cmath>
+
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/geometry/shapeClass.h"
+#include "../physics/geometry/intersection.h"
+#include "../physics/math/rotation.h"
+#include "../util/log.h"
+
+/*
+	A sphere or capsule resting on a box, sinking in slightly or hovering just above it, like a character standing on the ground
+	The full variant runs GJK and EPA on both shapes, the core variant lets intersectsTransformed test the point or segment core instead
+*/
+class ShallowContactBenchmark : public Benchmark {
+	Shape ground;
+	Shape shape;
+	bool useCores;
+	int intersectionCount;
+	int hitCount = 0;
+
+public:
+	ShallowContactBenchmark(const char* name, const Shape& shape, bool useCores, int intersectionCount) :
+		Benchmark(name), ground(Box(4.0, 1.0, 4.0)), shape(shape), useCores(useCores), intersectionCount(intersectionCount) {}
+
+	virtual void run() override {
+		hitCount = 0;
+		double restingHeight = 0.5 + shape.getBounds().max.y;
+		for(int i = 0; i < intersectionCount; i++) {
+			Vec3 offset(std::sin(i * 0.37), restingHeight + 0.05 * std::sin(i * 0.71), std::sin(i * 0.13));
+			CFrame relativeTransform(offset, Rotation::fromEulerAngles(0.05 * std::sin(i * 0.3), i * 0.7, 0.05 * std::sin(i * 0.11)));
+			std::optional<Intersection> result = useCores ?
+				intersectsTransformed(ground, shape, relativeTransform) :
+				intersectsTransformed(*ground.baseShape, *shape.baseShape, relativeTransform, ground.scale, shape.scale);
+			if(result) hitCount++;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d of %d touching, %f us per intersection\n", hitCount, intersectionCount, timeTakenMillis * 1000.0 / intersectionCount);
+	}
+};
+
+ShallowContactBenchmark shallowSphereFull("shallowSphereFull", Sphere(0.5), false, 200000);
+ShallowContactBenchmark shallowSphereCore("shallowSphereCore", Sphere(0.5), true, 200000);
+ShallowContactBenchmark shallowCapsuleFull("shallowCapsuleFull", Capsule(0.3, 1.8), false, 200000);
+ShallowContactBenchmark shallowCapsuleCore("shallowCapsuleCore", Capsule(0.3, 1.8), true, 200000);
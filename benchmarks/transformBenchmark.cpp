@@ -0,0 +1,174 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "../physics/math/linalg/mat.h"
+#include "../physics/math/linalg/misc.h"
+#include "../physics/math/cframe.h"
+#include "../physics/geometry/polyhedron.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/part.h"
+#include "../physics/physical.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../util/log.h"
+
+static Vec3 benchmarkVec(int i) {
+	return Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13));
+}
+
+/*
+	Chains of double 3x3 products, like the response and inertia computations
+*/
+class MatrixProductBenchmark : public Benchmark {
+	std::vector<Mat3> matrices;
+	std::vector<SymmetricMat3> symmetricMatrices;
+	std::vector<Vec3> vectors;
+	int iterationCount;
+	double checksum = 0.0;
+
+public:
+	MatrixProductBenchmark(const char* name, int iterationCount) : Benchmark(name), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		for(int i = 0; i < 1024; i++) {
+			Vec3 a = benchmarkVec(i);
+			Vec3 b = benchmarkVec(i + 5000);
+			matrices.push_back(Mat3{a.x, a.y, a.z, b.x, b.y, b.z, a.y, b.z, a.x});
+			symmetricMatrices.push_back(SymmetricMat3{a.x + 2.0, a.y, b.x + 2.0, a.z, b.y, b.z + 2.0});
+			vectors.push_back(benchmarkVec(i + 10000));
+		}
+	}
+
+	virtual void run() override {
+		Vec3 total(0.0, 0.0, 0.0);
+		for(int iteration = 0; iteration < iterationCount; iteration++) {
+			for(size_t i = 0; i < matrices.size(); i++) {
+				const Mat3& m = matrices[i];
+				const Mat3& next = matrices[(i + 1) & 1023];
+				SymmetricMat3 turned = multiplyLeftRight(symmetricMatrices[i], m);
+				total += (m * next) * vectors[i] + turned * vectors[i];
+			}
+		}
+		checksum = total.x + total.y + total.z;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f ns per product chain (checksum %f)\n", timeTakenMillis * 1000000.0 / (static_cast<double>(iterationCount) * matrices.size()), checksum);
+	}
+};
+
+/*
+	Transforms an array of points with one CFrame, one at a time or with the batch functions of CFrame
+*/
+class CFrameTransformBenchmark : public Benchmark {
+	std::vector<Vec3> input;
+	std::vector<Vec3> output;
+	CFrame frame;
+	bool batched;
+	int iterationCount;
+
+public:
+	CFrameTransformBenchmark(const char* name, bool batched, int iterationCount) : Benchmark(name), batched(batched), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		for(int i = 0; i < 4096; i++) {
+			input.push_back(benchmarkVec(i));
+		}
+		output.resize(input.size());
+		frame = CFrame(Vec3(0.3, -2.0, 5.0), Rotation::fromEulerAngles(0.3, 0.7, -0.4));
+	}
+
+	virtual void run() override {
+		for(int iteration = 0; iteration < iterationCount; iteration++) {
+			if(batched) {
+				frame.localToGlobal(input.data(), output.data(), input.size());
+				frame.globalToLocal(output.data(), input.data(), input.size());
+				continue;
+			}
+			for(size_t i = 0; i < input.size(); i++) {
+				output[i] = frame.localToGlobal(input[i]);
+			}
+			for(size_t i = 0; i < input.size(); i++) {
+				input[i] = frame.globalToLocal(output[i]);
+			}
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f ns per vector transform\n", timeTakenMillis * 1000000.0 / (2.0 * iterationCount * input.size()));
+	}
+};
+
+/*
+	Moves a large polyhedron into global space and back, as done when baking meshes
+*/
+class PolyhedronTransformBenchmark : public Benchmark {
+	Polyhedron poly;
+	CFramef frame;
+	int iterationCount;
+	float checksum = 0.0f;
+
+public:
+	PolyhedronTransformBenchmark(const char* name, int iterationCount) : Benchmark(name), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		poly = Library::createSphere(1.0f, 5);
+		frame = CFramef(Vec3f(0.3f, -2.0f, 5.0f), Rotationf::fromEulerAngles(0.3, 0.7, -0.4));
+	}
+
+	virtual void run() override {
+		for(int iteration = 0; iteration < iterationCount; iteration++) {
+			Polyhedron global = poly.localToGlobal(frame);
+			Polyhedron local = global.globalToLocal(frame);
+			checksum += local[iteration % local.vertexCount].x;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%d vertices, %f us per transform (checksum %f)\n", poly.vertexCount, timeTakenMillis * 1000.0 / (2.0 * iterationCount), checksum);
+	}
+};
+
+/*
+	The effective inertia of a point of a physical in some direction, computed for every contact
+*/
+class PointInertiaBenchmark : public Benchmark {
+	std::unique_ptr<Part> part;
+	std::vector<Vec3> points;
+	std::vector<Vec3> directions;
+	int iterationCount;
+	double checksum = 0.0;
+
+public:
+	PointInertiaBenchmark(const char* name, int iterationCount) : Benchmark(name), iterationCount(iterationCount) {}
+
+	virtual void init() override {
+		part = std::make_unique<Part>(Box(1.0, 0.5, 0.7), GlobalCFrame(0.0, 0.0, 0.0, Rotation::fromEulerAngles(0.3, 0.7, -0.4)), PartProperties{1.0, 0.2, 0.5});
+		part->ensureHasParent();
+		for(int i = 0; i < 1024; i++) {
+			points.push_back(benchmarkVec(i));
+			directions.push_back(benchmarkVec(i + 777));
+		}
+	}
+
+	virtual void run() override {
+		const MotorizedPhysical& phys = *part->parent->mainPhysical;
+		double total = 0.0;
+		for(int i = 0; i < iterationCount; i++) {
+			total += phys.getInertiaOfPointInDirectionRelative(points[i & 1023], directions[i & 1023]);
+		}
+		checksum = total;
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		Log::print("%f ns per inertia (checksum %f)\n", timeTakenMillis * 1000000.0 / iterationCount, checksum);
+	}
+};
+
+MatrixProductBenchmark matrixProducts("matrixProducts", 10000);
+CFrameTransformBenchmark cframeTransform("cframeTransform", false, 5000);
+CFrameTransformBenchmark cframeTransformBatch("cframeTransformBatch", true, 5000);
+PolyhedronTransformBenchmark polyhedronTransform("polyhedronTransform", 20000);
+PointInertiaBenchmark pointInertia("pointInertia", 10000000);
@@ -3,6 +3,7 @@
 #include "../util/log.h"
 #include "../util/terminalColor.h"
 #include "../physics/physicsProfiler.h"
+#include "../physics/memoryProfiler.h"
 #include <iostream>
 #include <sstream>
 #include "../physics/misc/gravityForce.h"
@@ -21,6 +22,7 @@ WorldBenchmark::WorldBenchmark(const char* name, int tickCount) : Benchmark(name
 void WorldBenchmark::run() {
 	world.isValid();
 	Part& partToTrack = *world.physicals[0]->getMainPart();
+	resetAllocationTally();
 	for (int i = 0; i < tickCount; i++) {
 		if (i % (tickCount / 8) == 0) {
 			Log::print("Tick %d\n", i);
@@ -40,6 +42,7 @@ void WorldBenchmark::run() {
 		world.tick();
 
 		physicsMeasure.end();
+		nextAllocationTally();
 
 		GJKCollidesIterationStatistics.nextTally();
 		GJKNoCollidesIterationStatistics.nextTally();
@@ -100,8 +103,8 @@ void printBreakdown(const T* values, const char** labels, size_t N, std::string
 
 	for (size_t i = 0; i < N; i++) {
 		T v = values[i];
-		double fractionOfTotal = double(v) / total;
-		double fractionOfMax = double(v) / max;
+		double fractionOfTotal = (total != 0) ? double(v) / total : 0.0;
+		double fractionOfMax = (max != 0) ? double(v) / max : 0.0;
 
 		setColor(getColor(i));
 
@@ -167,6 +170,39 @@ void WorldBenchmark::printResults(double timeTakenMillis) {
 	setColor(TerminalColor::MAGENTA);
 	std::cout << "[Intersection Statistics]\n";
 	printBreakdown(intersectionStatistics.history.avg().values, intersectionStatistics.labels, intersectionStatistics.size(), "");
+
+	WorldMemoryUsage memoryUsage = getWorldMemoryUsage(world);
+
+	setColor(TerminalColor::WHITE);
+	std::cout << "\n";
+	setColor(TerminalColor::MAGENTA);
+	std::cout << "[Memory Usage]\n";
+	printBreakdown(memoryUsage.bytes, memoryCategoryLabels, static_cast<size_t>(MemoryCategory::COUNT), "B");
+	setColor(TerminalColor::WHITE);
+	Log::print("%d parts, %d physicals, %d tree nodes, %d polyhedra\n", memoryUsage.partCount, memoryUsage.physicalCount, memoryUsage.treeNodeCount, memoryUsage.polyhedronCount);
+	Log::print("%.1f bytes per part\n", memoryUsage.getBytesPerPart());
+
+	setColor(TerminalColor::WHITE);
+	std::cout << "\n";
+	setColor(TerminalColor::MAGENTA);
+	std::cout << "[Allocations per tick]\n";
+	if(isAllocationTrackingEnabled()) {
+		auto allocationSum = allocationStatistics.history.sum();
+		size_t talliedTicks = allocationStatistics.history.size();
+
+		double allocations[allocationStatistics.size()];
+		double totalAllocations = 0.0;
+		for(size_t i = 0; i < allocationStatistics.size(); i++) {
+			allocations[i] = (talliedTicks != 0) ? double(allocationSum[i]) / talliedTicks : 0.0;
+			totalAllocations += allocations[i];
+		}
+		printBreakdown(allocations, allocationStatistics.labels, allocationStatistics.size(), "");
+		setColor(TerminalColor::WHITE);
+		Log::print("%.2f allocations per tick over the last %d ticks\n", totalAllocations, talliedTicks);
+	} else {
+		setColor(TerminalColor::WHITE);
+		Log::print("Allocation tracking disabled, rebuild with -DPHYSICS_TRACK_ALLOCATIONS=ON\n");
+	}
 }
 
 
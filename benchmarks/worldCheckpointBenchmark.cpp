@@ -0,0 +1,67 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <chrono>
+
+#include "../physics/world.h"
+#include "../physics/physical.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/misc/worldCheckpoint.h"
+#include "../util/log.h"
+
+/*
+	Records a world of ~100k boxes of which every movingFraction'th one moves each tick, without simulating it, so only the cost of capturing is measured
+*/
+class WorldCheckpointBenchmark : public Benchmark {
+	World<Part> world;
+	WorldCheckpointRecorder recorder;
+	int gridSize;
+	int tickCount;
+	int movingFraction;
+
+	size_t snapshotSize = 0;
+	double captureMillis = 0.0;
+
+public:
+	WorldCheckpointBenchmark(const char* name, int gridSize, int tickCount, int movingFraction) :
+		Benchmark(name), world(0.005), recorder(256, 2), gridSize(gridSize), tickCount(tickCount), movingFraction(movingFraction) {}
+
+	virtual void init() override {
+		world.addTerrainPart(new Part(Box(gridSize * 2.0, 1.0, gridSize * 2.0), GlobalCFrame(0.0, -1.0, 0.0), {1.0, 0.7, 0.5}));
+		std::vector<Part*> parts;
+		for(int x = 0; x < gridSize; x++) {
+			for(int y = 0; y < gridSize; y++) {
+				for(int z = 0; z < gridSize; z++) {
+					parts.push_back(new Part(Box(0.8, 0.8, 0.8), GlobalCFrame(x * 1.0, y * 1.0, z * 1.0), {1.0, 0.2, 0.5}));
+				}
+			}
+		}
+		world.addParts(parts.data(), parts.size());
+
+		recorder.capture(world);
+		snapshotSize = recorder.getLastCaptureSize();
+	}
+
+	virtual void run() override {
+		for(int tick = 0; tick < tickCount; tick++) {
+			for(size_t i = tick % movingFraction; i < world.physicals.size(); i += movingFraction) {
+				MotorizedPhysical* phys = world.physicals[i];
+				phys->motionOfCenterOfMass = Motion(Vec3(0.0, -0.1 * tick, 0.0), Vec3(0.01, 0.0, 0.0));
+				phys->setCFrame(GlobalCFrame(phys->getPosition() + Vec3(0.0, -0.001 * tick, 0.0), Rotation::rotX(0.01 * tick)));
+			}
+			world.age++;
+			auto captureStart = std::chrono::high_resolution_clock::now();
+			recorder.capture(world);
+			captureMillis += (std::chrono::high_resolution_clock::now() - captureStart).count() / 1000000.0;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		size_t deltaCount = recorder.getTickCount() - 1;
+		Log::print("%d parts, snapshot %d bytes, %f bytes per delta tick\n", static_cast<int>(world.getPartCount()), static_cast<int>(snapshotSize), recorder.getDeltaBytes() / static_cast<double>(deltaCount));
+		Log::print("%f ms per capture, %f ms per tick including moving the parts\n", captureMillis / tickCount, timeTakenMillis / tickCount);
+	}
+};
+
+WorldCheckpointBenchmark worldCheckpointTenPercent("worldCheckpoint", 46, 100, 10);
+WorldCheckpointBenchmark worldCheckpointAllMoving("worldCheckpointAllMoving", 46, 100, 1);
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+
+#include <cstdio>
+
+#include "../physics/world.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/misc/worldFile.h"
+#include "../util/log.h"
+
+static const char* worldBenchmarkFile = "worldFileBenchmark.world";
+
+/*
+	Fills the world with gridSize^3 free boxes and a terrain floor
+*/
+static void createGridWorld(World<Part>& world, int gridSize) {
+	world.addTerrainPart(new Part(Box(gridSize * 2.0, 1.0, gridSize * 2.0), GlobalCFrame(0.0, -1.0, 0.0), {1.0, 0.7, 0.5}));
+	for(int x = 0; x < gridSize; x++) {
+		for(int y = 0; y < gridSize; y++) {
+			for(int z = 0; z < gridSize; z++) {
+				world.addPart(new Part(Box(0.8, 0.8, 0.8), GlobalCFrame(x * 1.0, y * 1.0, z * 1.0), {1.0, 0.2, 0.5}));
+			}
+		}
+	}
+}
+
+class WorldFileBenchmark : public Benchmark {
+protected:
+	int gridSize;
+	size_t partCount = 0;
+
+public:
+	WorldFileBenchmark(const char* name, int gridSize) : Benchmark(name), gridSize(gridSize) {}
+
+	virtual void printResults(double timeTakenMillis) override {
+		std::remove(worldBenchmarkFile);
+		Log::print("%d parts, %f parts per second\n", static_cast<int>(partCount), partCount / (timeTakenMillis / 1000.0));
+	}
+};
+
+class WorldFileSave : public WorldFileBenchmark {
+	World<Part> world;
+public:
+	WorldFileSave() : WorldFileBenchmark("worldFileSave", 46), world(0.005) {}
+
+	virtual void init() override {
+		createGridWorld(world, gridSize);
+	}
+
+	virtual void run() override {
+		WorldFileWriter().writeWorld(world, std::string(worldBenchmarkFile));
+		partCount = world.getPartCount();
+	}
+} worldFileSave;
+
+class WorldFileLoad : public WorldFileBenchmark {
+public:
+	WorldFileLoad() : WorldFileBenchmark("worldFileLoad", 46) {}
+
+	virtual void init() override {
+		World<Part> world(0.005);
+		createGridWorld(world, gridSize);
+		WorldFileWriter().writeWorld(world, std::string(worldBenchmarkFile));
+	}
+
+	virtual void run() override {
+		World<Part> world(0.005);
+		WorldFileReader reader{std::string(worldBenchmarkFile)};
+		reader.readWorld(world);
+		partCount = reader.getPartCount();
+	}
+} worldFileLoad;
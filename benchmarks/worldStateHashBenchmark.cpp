@@ -0,0 +1,79 @@
+#include "benchmark.h"
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "../physics/world.h"
+#include "../physics/physical.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/misc/worldStateHash.h"
+#include "../util/log.h"
+
+static double median(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	return values[values.size() / 2];
+}
+
+/*
+	Ticks a world of ~100k boxes, alternating ticks with and without hashStateEveryTick, and hashes it separately with hashWorld
+	The boxes do not touch, so the ticks are about as cheap as ticks of this many parts get
+	Only every movingInterval-th box is given a motion, the others stay at rest and keep their hash from the previous tick
+*/
+class WorldStateHashBenchmark : public Benchmark {
+	World<Part> world;
+	int gridSize;
+	int tickCount;
+	size_t movingInterval;
+
+	std::vector<double> plainTickMillis;
+	std::vector<double> hashedTickMillis;
+	double hashWorldMillis = 0.0;
+	uint64_t hash = 0;
+
+public:
+	WorldStateHashBenchmark(const char* name, int gridSize, int tickCount, size_t movingInterval) :
+		Benchmark(name), world(0.005), gridSize(gridSize), tickCount(tickCount), movingInterval(movingInterval) {}
+
+	virtual void init() override {
+		world.addTerrainPart(new Part(Box(gridSize * 2.0, 1.0, gridSize * 2.0), GlobalCFrame(0.0, -1.0, 0.0), {1.0, 0.7, 0.5}));
+		std::vector<Part*> parts;
+		for(int x = 0; x < gridSize; x++) {
+			for(int y = 0; y < gridSize; y++) {
+				for(int z = 0; z < gridSize; z++) {
+					parts.push_back(new Part(Box(0.8, 0.8, 0.8), GlobalCFrame(x * 1.0, y * 1.0, z * 1.0), {1.0, 0.2, 0.5}));
+				}
+			}
+		}
+		world.addParts(parts.data(), parts.size());
+		for(size_t i = 0; i < world.physicals.size(); i += movingInterval) {
+			world.physicals[i]->motionOfCenterOfMass = Motion(Vec3(0.0, 0.01 * (i % 7), 0.0), Vec3(0.0, 0.0, 0.01 * (i % 5)));
+		}
+	}
+
+	virtual void run() override {
+		for(int tick = 0; tick < tickCount; tick++) {
+			world.hashStateEveryTick = tick % 2 == 1;
+			auto tickStart = std::chrono::high_resolution_clock::now();
+			world.tick();
+			double tickMillis = (std::chrono::high_resolution_clock::now() - tickStart).count() / 1000000.0;
+			(world.hashStateEveryTick ? hashedTickMillis : plainTickMillis).push_back(tickMillis);
+
+			auto hashStart = std::chrono::high_resolution_clock::now();
+			hash = WorldStateHash::combine(hash, WorldStateHash::hashWorld(world));
+			hashWorldMillis += (std::chrono::high_resolution_clock::now() - hashStart).count() / 1000000.0;
+		}
+	}
+
+	virtual void printResults(double timeTakenMillis) override {
+		// medians, a single slow tick should not decide the comparison
+		double plainMillis = median(plainTickMillis);
+		double hashedMillis = median(hashedTickMillis);
+		Log::print("%d parts, hash %llx\n", static_cast<int>(world.getPartCount()), static_cast<unsigned long long>(hash));
+		Log::print("%f ms per tick, %f ms per tick with hashStateEveryTick, %f%% more\n", plainMillis, hashedMillis, 100.0 * (hashedMillis - plainMillis) / plainMillis);
+		Log::print("%f ms per hashWorld\n", hashWorldMillis / tickCount);
+	}
+};
+
+WorldStateHashBenchmark worldStateHash("worldStateHash", 46, 40, 1);
+WorldStateHashBenchmark worldStateHashMostlyAtRest("worldStateHashMostlyAtRest", 46, 40, 16);
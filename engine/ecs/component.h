@@ -35,7 +35,7 @@ private:
 	/*
 		The parent entity of this Component
 	*/
-	Entity* entity;
+	Entity* entity = nullptr;
 
 public:
 	/*
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "component.h"
+
+namespace Engine {
+
+class Entity;
+
+/*
+	The sparse index of an entity that has no component in a storage
+*/
+#define ECS_NULL_INDEX static_cast<std::size_t>(-1)
+
+/*
+	A sparse set of the components of a single type, indexed by the id that the tree gives to each of its entities
+
+	The components and their entities are packed in dense arrays, so iterating a storage is a linear scan
+	Removing a component moves the last component into its slot, the order of the dense arrays is not stable
+	An entity with several components of the same type is stored once, with its first component
+*/
+class ComponentStorage {
+private:
+	/*
+		The components of this storage, without gaps
+	*/
+	std::vector<Component*> components;
+
+	/*
+		The entity owning the component at the same index in components
+	*/
+	std::vector<Entity*> entities;
+
+	/*
+		The id of the entity at the same index in entities
+	*/
+	std::vector<std::size_t> entityIds;
+
+	/*
+		Maps an entity id to the dense index of its component, or ECS_NULL_INDEX
+	*/
+	std::vector<std::size_t> sparse;
+
+public:
+	/*
+		Adds the given component for the given entity, replacing the component the entity already has in this storage
+	*/
+	void insert(std::size_t entityId, Entity* entity, Component* component) {
+		if (entityId >= sparse.size())
+			sparse.resize(entityId + 1, ECS_NULL_INDEX);
+
+		std::size_t index = sparse[entityId];
+		if (index != ECS_NULL_INDEX) {
+			components[index] = component;
+			return;
+		}
+
+		sparse[entityId] = components.size();
+		components.push_back(component);
+		entities.push_back(entity);
+		entityIds.push_back(entityId);
+	}
+
+	/*
+		Removes the component of the given entity from this storage, if present
+	*/
+	void remove(std::size_t entityId) {
+		if (entityId >= sparse.size())
+			return;
+
+		std::size_t index = sparse[entityId];
+		if (index == ECS_NULL_INDEX)
+			return;
+
+		std::size_t last = components.size() - 1;
+		components[index] = components[last];
+		entities[index] = entities[last];
+		entityIds[index] = entityIds[last];
+		sparse[entityIds[index]] = index;
+		sparse[entityId] = ECS_NULL_INDEX;
+
+		components.pop_back();
+		entities.pop_back();
+		entityIds.pop_back();
+	}
+
+	/*
+		Returns whether the given entity has a component in this storage
+	*/
+	inline bool contains(std::size_t entityId) const {
+		return entityId < sparse.size() && sparse[entityId] != ECS_NULL_INDEX;
+	}
+
+	/*
+		Returns the component of the given entity if present, nullptr otherwise
+	*/
+	inline Component* get(std::size_t entityId) const {
+		return contains(entityId) ? components[sparse[entityId]] : nullptr;
+	}
+
+	/*
+		Returns the number of components in this storage
+	*/
+	inline std::size_t size() const {
+		return components.size();
+	}
+
+	inline Component* componentAt(std::size_t index) const {
+		return components[index];
+	}
+
+	inline Entity* entityAt(std::size_t index) const {
+		return entities[index];
+	}
+
+	inline std::size_t entityIdAt(std::size_t index) const {
+		return entityIds[index];
+	}
+
+	/*
+		Returns the entities with a component in this storage, in dense order
+	*/
+	inline const std::vector<Entity*>& getEntities() const {
+		return entities;
+	}
+};
+
+/*
+	A query over all entities of a tree that have a component of each of the given types
+
+	The view walks the dense arrays of the smallest storage and looks up the other components by entity id, nothing is allocated
+	Dereferencing an iterator gives a tuple of the entity and a pointer to each of its components, in the order of the template arguments
+
+	Adding or removing components of the queried types while iterating invalidates the iterators
+*/
+template<typename... Types>
+class ComponentView {
+private:
+	const ComponentStorage* storages[sizeof...(Types)];
+
+	/*
+		The storage that is iterated, the other storages are only probed
+	*/
+	const ComponentStorage* lead;
+
+	template<std::size_t... Indices>
+	inline std::tuple<Entity*, Types*...> fetch(std::size_t index, std::index_sequence<Indices...>) const {
+		std::size_t entityId = lead->entityIdAt(index);
+		return std::tuple<Entity*, Types*...>(lead->entityAt(index), static_cast<Types*>(storages[Indices]->get(entityId))...);
+	}
+
+	inline bool matches(std::size_t index) const {
+		std::size_t entityId = lead->entityIdAt(index);
+		for (const ComponentStorage* storage : storages) {
+			if (storage != lead && !storage->contains(entityId))
+				return false;
+		}
+
+		return true;
+	}
+
+public:
+	class Iterator {
+	private:
+		const ComponentView* view;
+		std::size_t index;
+
+		inline void skip() {
+			while (index < view->lead->size() && !view->matches(index))
+				index++;
+		}
+
+	public:
+		Iterator(const ComponentView* view, std::size_t index) : view(view), index(index) {
+			skip();
+		}
+
+		inline Iterator& operator++() {
+			index++;
+			skip();
+			return *this;
+		}
+
+		inline bool operator!=(const Iterator& other) const {
+			return index != other.index;
+		}
+
+		inline bool operator==(const Iterator& other) const {
+			return index == other.index;
+		}
+
+		inline std::tuple<Entity*, Types*...> operator*() const {
+			return view->fetch(index, std::index_sequence_for<Types...>());
+		}
+	};
+
+	/*
+		Creates a view over the given storages, one for each type in the same order
+	*/
+	ComponentView(std::initializer_list<const ComponentStorage*> storageList) {
+		std::size_t i = 0;
+		for (const ComponentStorage* storage : storageList)
+			storages[i++] = storage;
+
+		lead = storages[0];
+		for (const ComponentStorage* storage : storages) {
+			if (storage->size() < lead->size())
+				lead = storage;
+		}
+	}
+
+	inline Iterator begin() const {
+		return Iterator(this, 0);
+	}
+
+	inline Iterator end() const {
+		return Iterator(this, lead->size());
+	}
+};
+
+};
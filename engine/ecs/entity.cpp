@@ -9,6 +9,7 @@ namespace Engine {
 
 Entity::Entity(const std::string& name) : Node(name) {
 	parent = nullptr;
+	id = ECS_NULL_INDEX;
 }
 
 Entity::Entity(const std::string& name, std::initializer_list<Component*> components) : Entity(name) {
@@ -20,6 +21,10 @@ Entity::Entity(const std::string& name, std::initializer_list<Component*> compon
 
 #pragma region components
 
+std::size_t Entity::getId() const {
+	return id;
+}
+
 void Entity::addComponent(Component* component) {
 	if (component == nullptr)
 		return;
@@ -54,8 +59,12 @@ void Entity::removeComponent(Component* component) {
 	}
 
 	if (tree != nullptr) {
-		if (!containsComponentOfType(component))
+		auto remaining = components.find(component->getType());
+
+		if (remaining == components.end())
 			tree->onRemoveComponentFromEntity(this, component);
+		else
+			tree->onAddComponentToEntity(this, remaining->second);
 	}
 }
 
@@ -113,12 +122,20 @@ void Entity::removeChild(Node* child) {
 }
 
 void Entity::setTree(ECSTree* tree) {
+	if (this->tree == tree)
+		return;
+
+	if (this->tree != nullptr)
+		this->tree->onRemoveEntity(this);
+
 	Node::setTree(tree);
 
-	if (this->tree != nullptr) {
-		for (auto iterator : components) {
-			tree->onAddComponentToEntity(this, iterator.second);
-		}
+	if (tree != nullptr) {
+		tree->onAddEntity(this);
+
+		// only the first component of each type is stored
+		for (auto iterator = components.begin(); iterator != components.end(); iterator = components.upper_bound(iterator->first))
+			tree->onAddComponentToEntity(this, iterator->second);
 	}
 }
 
@@ -2,10 +2,18 @@
 
 #include "node.h"
 #include "component.h"
+#include "componentStorage.h"
 
 namespace Engine {
 
 class Entity : public Node {
+	friend ECSTree;
+private:
+	/*
+		The id of this entity in the component storages of its tree, ECS_NULL_INDEX if it is not part of a tree
+	*/
+	std::size_t id;
+
 protected:
 	/*
 		The components of this entity
@@ -26,6 +34,11 @@ public:
 #pragma endregion
 
 #pragma region components
+	/*
+		Returns the id of this entity in the component storages of its tree
+	*/
+	std::size_t getId() const;
+
 	/*
 		Adds the given component to this entity, if the component is unique and already is part of this entity, the component will overwrite the existing one
 	*/
@@ -7,6 +7,8 @@ namespace Engine {
 
 Node::Node(const std::string& name) {
 	this->name = name;
+	this->tree = nullptr;
+	this->parent = nullptr;
 }
 
 std::vector<Node*> Node::getChildren() {
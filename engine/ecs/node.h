@@ -34,6 +34,11 @@ public:
 	*/
 	Node(const std::string& name);
 
+	/*
+		Nodes are deleted through Node*, entities among them
+	*/
+	virtual ~Node() = default;
+
 	/*
 		Returns the children of this node
 	*/
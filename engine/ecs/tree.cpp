@@ -4,43 +4,45 @@
 
 namespace Engine {
 
+void ECSTree::onAddEntity(Entity* entity) {
+	if (freeEntityIds.empty()) {
+		entity->id = entityIdCount++;
+	} else {
+		entity->id = freeEntityIds.back();
+		freeEntityIds.pop_back();
+	}
+}
+
+void ECSTree::onRemoveEntity(Entity* entity) {
+	if (entity->id == ECS_NULL_INDEX)
+		return;
+
+	for (auto& iterator : storages)
+		iterator.second.remove(entity->id);
+
+	freeEntityIds.push_back(entity->id);
+	entity->id = ECS_NULL_INDEX;
+}
+
 void ECSTree::onAddComponentToEntity(Entity* entity, Component* component) {
 	if (component == nullptr || entity == nullptr)
 		return;
 
-	auto iterator = map.find(component->getType());
-
-	if (iterator == map.end()) {
-		std::multimap<std::string, Entity*> entities = {{ entity->getName(), entity }};
-		map.insert({ component->getType(), entities });
-	} else {
-		iterator->second.insert({ entity->getName(), entity });
-	}
+	storages[component->getType()].insert(entity->id, entity, component);
 }
 
 void ECSTree::onRemoveComponentFromEntity(Entity* entity, Component* component) {
 	if (component == nullptr || entity == nullptr)
 		return;
 
-	auto iterator = map.find(component->getType());
-	if (iterator == map.end()) {
-		return;
-	} else {
-		auto& list = iterator->second;
-		auto range = list.equal_range(entity->getName());
-		
-		for (auto element = range.first; element != range.second; ++element) {
-			if (element->second == entity) {
-				list.erase(element);
-				return;
-			}
-		}
-	}
+	auto iterator = storages.find(component->getType());
+	if (iterator != storages.end())
+		iterator->second.remove(entity->id);
 }
 
 ECSTree::ECSTree() {
 	root = new Node("Tree");
-	map = std::unordered_map<ComponentType, std::multimap<std::string, Entity*>>();
+	entityIdCount = 0;
 }
 
 Node* ECSTree::getRoot() {
@@ -55,6 +57,8 @@ Node* ECSTree::createGroup(Node* root, const std::string& name) {
 	group->setTree(this);
 
 	root->addChild(group);
+
+	return group;
 }
 
 Entity* ECSTree::createEntity(Node* root, const std::string& name) {
@@ -65,6 +69,8 @@ Entity* ECSTree::createEntity(Node* root, const std::string& name) {
 	entity->setTree(this);
 
 	root->addChild(entity);
+
+	return entity;
 }
 
 void ECSTree::addNode(Node* root, Node* node) {
@@ -87,17 +93,19 @@ void ECSTree::removeNode(Node* node, bool deleteChildren) {
 	}
 
 	node->getParent()->removeChild(node);
-
-	// todo remove links in map
 }
 
-std::multimap<std::string, Entity*> ECSTree::getEntitiesWithComponent(const ComponentType& type) {
-	auto list = map.find(type);
+const ComponentStorage& ECSTree::getStorage(const ComponentType& type) const {
+	auto iterator = storages.find(type);
 
-	if (list == map.end())
-		return std::multimap<std::string, Entity*>();
+	if (iterator == storages.end())
+		return emptyStorage;
+
+	return iterator->second;
+}
 
-	return list->second;
+const std::vector<Entity*>& ECSTree::getEntitiesWithComponent(const ComponentType& type) const {
+	return getStorage(type).getEntities();
 }
 
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "component.h"
+#include "componentStorage.h"
 #include "entity.h"
 #include "node.h"
 
@@ -15,17 +16,42 @@ private:
 	Node* root;
 
 	/*
-		The mapping from type to a multimap of entities containing a component of that type
+		The dense storage of the components of each type, indexed by entity id
 	*/
-	std::unordered_map<ComponentType, std::multimap<std::string, Entity*>> map;
+	std::unordered_map<ComponentType, ComponentStorage> storages;
 
 	/*
-		Adds a mapping from the given component type to the given entity
+		The storage returned for component types that no entity of this tree has
+	*/
+	ComponentStorage emptyStorage;
+
+	/*
+		The ids of removed entities, which are handed out again before new ids
+	*/
+	std::vector<std::size_t> freeEntityIds;
+
+	/*
+		The number of entity ids handed out so far
+	*/
+	std::size_t entityIdCount;
+
+	/*
+		Gives the given entity an id in this tree
+	*/
+	void onAddEntity(Entity* entity);
+
+	/*
+		Removes the components of the given entity from the storages and frees its id
+	*/
+	void onRemoveEntity(Entity* entity);
+
+	/*
+		Stores the given component for the given entity, replacing the component of the same type stored for it
 	*/
 	void onAddComponentToEntity(Entity* entity, Component* component);
 
 	/*
-		Removes a mapping from the given component type to the given entity
+		Removes the component of the same type as the given component from the storage of the given entity
 	*/
 	void onRemoveComponentFromEntity(Entity* entity, Component* component);
 
@@ -61,9 +87,23 @@ public:
 	void removeNode(Node* node, bool deleteChildren = true);
 
 	/*
-		Returns all entities with a component of the given type
+		Returns the storage of the components of the given type
+	*/
+	const ComponentStorage& getStorage(const ComponentType& type) const;
+
+	/*
+		Returns all entities with a component of the given type, in storage order
+	*/
+	const std::vector<Entity*>& getEntitiesWithComponent(const ComponentType& type) const;
+
+	/*
+		Returns a view over all entities with a component of each of the given types, see ComponentView
+		for (auto [entity, transform, material] : tree.view<Transform, Material>())
 	*/
-	std::multimap<std::string, Entity*> getEntitiesWithComponent(const ComponentType& type);
+	template<typename... Types>
+	ComponentView<Types...> view() const {
+		return ComponentView<Types...>({ &getStorage(Types::getStaticType())... });
+	}
 };
 
 };
\ No newline at end of file
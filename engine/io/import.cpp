@@ -3,8 +3,12 @@
 #include "import.h"
 
 #include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cmath>
 
 #include "../util/stringUtil.h"
+#include "../util/mappedFile.h"
 #include "../physics/physical.h"
 #include "../graphics/visualShape.h"
 /*
@@ -38,7 +42,7 @@ Vec3 Import::parseVec3(const std::string& vec) {
 
 Position Import::parsePosition(const std::string& vec) {
 	std::vector<std::string> tokens = Util::split(vec, ' ');
-	return Position(Fix<32>(Import::parseLong(tokens[0])), Fix<32>(Import::parseLong(tokens[1])), Fix<32>(Import::parseLong(tokens[2])));
+	return Position(Fix<32>(static_cast<int64_t>(Import::parseLong(tokens[0]))), Fix<32>(static_cast<int64_t>(Import::parseLong(tokens[1]))), Fix<32>(static_cast<int64_t>(Import::parseLong(tokens[2]))));
 }
 
 Vec4 Import::parseVec4(const std::string& vec) {
@@ -163,7 +167,7 @@ Graphics::VisualShape reorder(const std::vector<Vec3f>& positions, const std::ve
 	
 	// Positions
 	Vec3f* positionArray = new Vec3f[positions.size()];
-	for (int i = 0; i < positions.size(); i++) 
+	for (size_t i = 0; i < positions.size(); i++) 
 		positionArray[i] = positions[i];
 	
 	// Normals
@@ -182,7 +186,7 @@ Graphics::VisualShape reorder(const std::vector<Vec3f>& positions, const std::ve
 	}
 	// Triangles
 	Triangle* triangleArray = new Triangle[faces.size()];
-	for (int i = 0; i < faces.size(); i++) {
+	for (size_t i = 0; i < faces.size(); i++) {
 		const Face& face = faces[i];
 
 		// Save triangle
@@ -235,7 +239,6 @@ Graphics::VisualShape loadBinaryObj(std::istream& input) {
 	int vertexCount = Import::read<int>(input);
 	int triangleCount = Import::read<int>(input);
 
-	char V = 0;
 	char VN = 1;
 	char VT = 2;
 	char VNT = 3;
@@ -306,7 +309,7 @@ Graphics::VisualShape loadBinaryObj(std::istream& input) {
 	return Graphics::VisualShape(vertices, vertexCount, triangles, triangleCount, SharedArrayPtr<const Vec3f>(normals), SharedArrayPtr<const Vec2f>(uvs), SharedArrayPtr<const Vec3f>(tangents), SharedArrayPtr<const Vec3f>(bitangents));
 }
 
-Graphics::VisualShape loadNonBinaryObj(std::istream& input) {
+Graphics::VisualShape OBJImport::loadLineByLine(std::istream& input) {
 	std::vector<Vec3f> vertices;
 	std::vector<Vec3f> normals;
 	std::vector<Vec2f> uvs;
@@ -350,11 +353,357 @@ Graphics::VisualShape loadNonBinaryObj(std::istream& input) {
 	return reorder(vertices, normals, uvs, faces, flags);
 }
 
+/*
+	Streaming text OBJ parser, works directly on the file contents without splitting lines into strings
+
+	The file is scanned twice, the first pass only counts elements so every output array is allocated exactly once
+*/
+
+struct OBJCounts {
+	int vertices = 0;
+	int normals = 0;
+	int uvs = 0;
+	int triangles = 0;
+};
+
+struct OBJFaceVertex {
+	int position;
+	int uv;
+	int normal;
+};
+
+static inline bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+static inline const char* skipSpaces(const char* cur, const char* end) {
+	while (cur != end && isSpace(*cur))
+		cur++;
+	return cur;
+}
+
+static inline const char* skipToNextLine(const char* cur, const char* end) {
+	const char* newLine = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+	return (newLine != nullptr) ? newLine + 1 : end;
+}
+
+static inline bool isEndOfLine(const char* cur, const char* end) {
+	return cur == end || *cur == '\n' || *cur == '#';
+}
+
+static inline const char* parseInt(const char* cur, const char* end, int& result) {
+	bool negative = false;
+	if (cur != end && (*cur == '-' || *cur == '+')) {
+		negative = *cur == '-';
+		cur++;
+	}
+
+	int value = 0;
+	while (cur != end && isDigit(*cur)) {
+		value = value * 10 + (*cur - '0');
+		cur++;
+	}
+
+	result = negative ? -value : value;
+	return cur;
+}
+
+static const double powersOfTen[]{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline double scaleByPowerOfTen(double value, int exponent) {
+	if (exponent >= 0) {
+		return (exponent <= 22) ? value * powersOfTen[exponent] : value * std::pow(10.0, exponent);
+	} else {
+		return (exponent >= -22) ? value / powersOfTen[-exponent] : value * std::pow(10.0, exponent);
+	}
+}
+
+static inline const char* parseFloat(const char* cur, const char* end, float& result) {
+	cur = skipSpaces(cur, end);
+
+	bool negative = false;
+	if (cur != end && (*cur == '-' || *cur == '+')) {
+		negative = *cur == '-';
+		cur++;
+	}
+
+	// at most 19 significant digits fit in the mantissa, the rest only shift the exponent
+	unsigned long long mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+
+	while (cur != end && isDigit(*cur)) {
+		if (significantDigits < 19) {
+			mantissa = mantissa * 10 + (*cur - '0');
+			if (mantissa != 0)
+				significantDigits++;
+		} else {
+			exponent++;
+		}
+		cur++;
+	}
+
+	if (cur != end && *cur == '.') {
+		cur++;
+		while (cur != end && isDigit(*cur)) {
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10 + (*cur - '0');
+				if (mantissa != 0)
+					significantDigits++;
+				exponent--;
+			}
+			cur++;
+		}
+	}
+
+	if (cur != end && (*cur == 'e' || *cur == 'E')) {
+		int explicitExponent;
+		cur = parseInt(cur + 1, end, explicitExponent);
+		exponent += explicitExponent;
+	}
+
+	double value = scaleByPowerOfTen(static_cast<double>(mantissa), exponent);
+	result = static_cast<float>(negative ? -value : value);
+	return cur;
+}
+
+/*
+	Converts a 1-based or negative (relative to the end) OBJ index to a 0-based index, returns -1 if it is out of range
+*/
+static inline int resolveIndex(int index, int definedCount) {
+	int resolved = (index > 0) ? index - 1 : definedCount + index;
+	return (index != 0 && resolved >= 0 && resolved < definedCount) ? resolved : -1;
+}
+
+static inline const char* parseFaceVertex(const char* cur, const char* end, const OBJCounts& defined, OBJFaceVertex& result) {
+	int index;
+	cur = parseInt(cur, end, index);
+	result.position = resolveIndex(index, defined.vertices);
+	result.uv = -1;
+	result.normal = -1;
+
+	if (cur != end && *cur == '/') {
+		cur++;
+		if (cur != end && *cur != '/' && !isSpace(*cur) && *cur != '\n') {
+			cur = parseInt(cur, end, index);
+			result.uv = resolveIndex(index, defined.uvs);
+		}
+		if (cur != end && *cur == '/') {
+			cur++;
+			if (cur != end && !isSpace(*cur) && *cur != '\n') {
+				cur = parseInt(cur, end, index);
+				result.normal = resolveIndex(index, defined.normals);
+			}
+		}
+	}
+
+	// skip anything unexpected up to the next separator
+	while (cur != end && !isSpace(*cur) && *cur != '\n')
+		cur++;
+
+	return cur;
+}
+
+static inline int countFaceVertices(const char* cur, const char* end) {
+	int count = 0;
+	while (true) {
+		cur = skipSpaces(cur, end);
+		if (isEndOfLine(cur, end))
+			return count;
+
+		count++;
+		while (cur != end && !isSpace(*cur) && *cur != '\n')
+			cur++;
+	}
+}
+
+static OBJCounts countOBJElements(const char* cur, const char* end) {
+	OBJCounts counts;
+
+	while (cur != end) {
+		cur = skipSpaces(cur, end);
+
+		if (end - cur >= 2 && cur[0] == 'v') {
+			if (isSpace(cur[1]))
+				counts.vertices++;
+			else if (cur[1] == 'n')
+				counts.normals++;
+			else if (cur[1] == 't')
+				counts.uvs++;
+		} else if (end - cur >= 2 && cur[0] == 'f' && isSpace(cur[1])) {
+			int faceVertices = countFaceVertices(cur + 2, end);
+			if (faceVertices > 2)
+				counts.triangles += faceVertices - 2;
+		}
+
+		cur = skipToNextLine(cur, end);
+	}
+
+	return counts;
+}
+
+struct OBJBuilder {
+	OBJCounts defined;
+
+	std::vector<Vec3f> positions;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> uvs;
+	std::vector<Triangle> triangles;
+
+	Vec3f* normalArray = nullptr;
+	Vec2f* uvArray = nullptr;
+	Vec3f* tangentArray = nullptr;
+	Vec3f* bitangentArray = nullptr;
+
+	OBJBuilder(const OBJCounts& counts) : positions(counts.vertices), normals(counts.normals), uvs(counts.uvs) {
+		triangles.reserve(counts.triangles);
+
+		if (counts.normals > 0)
+			normalArray = new Vec3f[counts.vertices];
+
+		if (counts.uvs > 0) {
+			uvArray = new Vec2f[counts.vertices];
+			tangentArray = new Vec3f[counts.vertices];
+			bitangentArray = new Vec3f[counts.vertices];
+		}
+	}
+
+	~OBJBuilder() {
+		delete[] normalArray;
+		delete[] uvArray;
+		delete[] tangentArray;
+		delete[] bitangentArray;
+	}
+
+	void addTriangle(const OBJFaceVertex& v1, const OBJFaceVertex& v2, const OBJFaceVertex& v3) {
+		triangles.push_back(Triangle{v1.position, v2.position, v3.position});
+
+		// Calculate (bi)tangents
+		Vec3f tangent;
+		Vec3f bitangent;
+		if (uvArray != nullptr && v1.uv != -1 && v2.uv != -1 && v3.uv != -1) {
+			Vec3 edge1 = positions[v2.position] - positions[v1.position];
+			Vec3 edge2 = positions[v3.position] - positions[v1.position];
+			Vec2 dUV1 = uvs[v2.uv] - uvs[v1.uv];
+			Vec2 dUV2 = uvs[v3.uv] - uvs[v1.uv];
+
+			float f = 1.0f / (dUV1.x * dUV2.y - dUV2.x * dUV1.y);
+
+			tangent.x = f * (dUV2.y * edge1.x - dUV1.y * edge2.x);
+			tangent.y = f * (dUV2.y * edge1.y - dUV1.y * edge2.y);
+			tangent.z = f * (dUV2.y * edge1.z - dUV1.y * edge2.z);
+			tangent = normalize(tangent);
+
+			bitangent.x = f * (-dUV2.x * edge1.x + dUV1.x * edge2.x);
+			bitangent.y = f * (-dUV2.x * edge1.y + dUV1.x * edge2.y);
+			bitangent.z = f * (-dUV2.x * edge1.z + dUV1.x * edge2.z);
+			bitangent = normalize(bitangent);
+		}
+
+		for (const OBJFaceVertex* vertex : {&v1, &v2, &v3}) {
+			// Save normal
+			if (normalArray != nullptr && vertex->normal != -1)
+				normalArray[vertex->position] = normals[vertex->normal];
+
+			// Save uv
+			if (uvArray != nullptr && vertex->uv != -1) {
+				uvArray[vertex->position] = Vec2f(uvs[vertex->uv].x, 1.0f - uvs[vertex->uv].y);
+				tangentArray[vertex->position] = tangent;
+				bitangentArray[vertex->position] = bitangent;
+			}
+		}
+	}
+
+	// returns false if the face refers to a vertex which has not been defined
+	bool addFace(const char* cur, const char* end) {
+		OBJFaceVertex first;
+		OBJFaceVertex previous;
+		int vertexCount = 0;
+
+		while (true) {
+			cur = skipSpaces(cur, end);
+			if (isEndOfLine(cur, end))
+				return true;
+
+			OBJFaceVertex vertex;
+			cur = parseFaceVertex(cur, end, defined, vertex);
+			if (vertex.position == -1)
+				return false;
+
+			// polygons are split into a fan around their first vertex
+			if (vertexCount == 0)
+				first = vertex;
+			else if (vertexCount >= 2)
+				addTriangle(first, previous, vertex);
+
+			previous = vertex;
+			vertexCount++;
+		}
+	}
+
+	Graphics::VisualShape build() {
+		Graphics::VisualShape shape(positions.data(), defined.vertices, triangles.data(), static_cast<int>(triangles.size()), SharedArrayPtr<const Vec3f>(normalArray), SharedArrayPtr<const Vec2f>(uvArray), SharedArrayPtr<const Vec3f>(tangentArray), SharedArrayPtr<const Vec3f>(bitangentArray));
+
+		// ownership has been passed on to the shape
+		normalArray = nullptr;
+		uvArray = nullptr;
+		tangentArray = nullptr;
+		bitangentArray = nullptr;
+
+		return shape;
+	}
+};
+
+Graphics::VisualShape loadNonBinaryObj(const char* begin, const char* end) {
+	OBJBuilder builder(countOBJElements(begin, end));
+
+	const char* cur = begin;
+	while (cur != end) {
+		cur = skipSpaces(cur, end);
+
+		if (end - cur >= 2 && cur[0] == 'v') {
+			if (isSpace(cur[1])) {
+				Vec3f& vertex = builder.positions[builder.defined.vertices++];
+				cur = parseFloat(cur + 2, end, vertex.x);
+				cur = parseFloat(cur, end, vertex.y);
+				cur = parseFloat(cur, end, vertex.z);
+			} else if (cur[1] == 'n') {
+				Vec3f& normal = builder.normals[builder.defined.normals++];
+				cur = parseFloat(cur + 2, end, normal.x);
+				cur = parseFloat(cur, end, normal.y);
+				cur = parseFloat(cur, end, normal.z);
+			} else if (cur[1] == 't') {
+				Vec2f& uv = builder.uvs[builder.defined.uvs++];
+				cur = parseFloat(cur + 2, end, uv.x);
+				cur = parseFloat(cur, end, uv.y);
+			}
+		} else if (end - cur >= 2 && cur[0] == 'f' && isSpace(cur[1])) {
+			if (!builder.addFace(cur + 2, end)) {
+				Log::error("Invalid vertex index in face on line: %.*s", static_cast<int>(skipToNextLine(cur, end) - cur), cur);
+				return Graphics::VisualShape();
+			}
+		}
+
+		cur = skipToNextLine(cur, end);
+	}
+
+	return builder.build();
+}
+
 Graphics::VisualShape OBJImport::load(std::istream& file, bool binary) {
-	if (binary)
+	if (binary) {
 		return loadBinaryObj(file);
-	else
-		return loadNonBinaryObj(file);
+	} else {
+		std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return loadNonBinaryObj(contents.data(), contents.data() + contents.size());
+	}
 }
 
 Graphics::VisualShape OBJImport::load(const std::string& file) {
@@ -370,28 +719,31 @@ Graphics::VisualShape OBJImport::load(const std::string& file) {
 }
 
 Graphics::VisualShape OBJImport::load(const std::string& file, bool binary) {
-	struct stat buffer;
-	if (stat(file.c_str(), &buffer) == -1) {
-		Log::subject(file.c_str());
-		Log::error("File not found: %s", file.c_str());
+	if (binary) {
+		std::ifstream input(file, std::ios::binary);
 
-		return Graphics::VisualShape();
-	}
+		if (!input.is_open()) {
+			Log::subject s(file);
+			Log::error("File not found: %s", file.c_str());
 
-	std::ifstream input;
+			return Graphics::VisualShape();
+		}
 
-	if (binary)
-		input.open(file, std::ios::binary);
-	else
-		input.open(file);
+		return loadBinaryObj(input);
+	} else {
+		Util::MappedFile input(file);
 
-	Graphics::VisualShape shape = load(input, binary);
+		if (!input.isOpen()) {
+			Log::subject s(file);
+			Log::error("File not found: %s", file.c_str());
 
-	input.close();
+			return Graphics::VisualShape();
+		}
 
-	return shape;
+		return loadNonBinaryObj(input.begin(), input.end());
+	}
 }
 
 /*
 	End of OBJImport
-*/
\ No newline at end of file
+*/
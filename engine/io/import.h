@@ -27,4 +27,9 @@ namespace OBJImport {
 	Graphics::VisualShape load(std::istream& file, bool binary = false);
 	Graphics::VisualShape load(const std::string& file, bool binary);
 	Graphics::VisualShape load(const std::string& file);
+
+	/*
+		Reference implementation of the text loader which splits the input line by line, kept to benchmark the streaming loader against
+	*/
+	Graphics::VisualShape loadLineByLine(std::istream& file);
 };
\ No newline at end of file
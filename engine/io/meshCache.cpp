@@ -0,0 +1,251 @@
+#include "core.h"
+
+#include "meshCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <functional>
+
+#include "import.h"
+#include "../util/mappedFile.h"
+#include "../physics/geometry/polyhedronInternals.h"
+
+#define MESH_CACHE_HAS_NORMALS 0x1
+#define MESH_CACHE_HAS_UVS 0x2
+#define MESH_CACHE_HAS_TANGENTS 0x4
+#define MESH_CACHE_HAS_BITANGENTS 0x8
+
+static const char meshCacheMagic[8] = {'P', '3', 'D', 'M', 'E', 'S', 'H', '\0'};
+
+struct MeshCacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	uint64_t sourceHash;
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+};
+
+/*
+	The offsets of the buffers in a cache file, 0 for buffers that are not present
+*/
+struct MeshCacheLayout {
+	size_t vertexOffset;
+	size_t triangleOffset;
+	size_t normalOffset = 0;
+	size_t uvOffset = 0;
+	size_t tangentOffset = 0;
+	size_t bitangentOffset = 0;
+	size_t totalSize;
+};
+
+static size_t alignCacheOffset(size_t offset) {
+	return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+}
+
+static MeshCacheLayout computeLayout(uint32_t vertexCount, uint32_t triangleCount, uint32_t flags) {
+	MeshCacheLayout layout;
+	size_t offset = alignCacheOffset(sizeof(MeshCacheHeader));
+
+	layout.vertexOffset = offset;
+	offset = alignCacheOffset(offset + getOffset(vertexCount) * 3 * sizeof(float));
+	layout.triangleOffset = offset;
+	offset = alignCacheOffset(offset + getOffset(triangleCount) * 3 * sizeof(int));
+
+	if (flags & MESH_CACHE_HAS_NORMALS) {
+		layout.normalOffset = offset;
+		offset = alignCacheOffset(offset + vertexCount * sizeof(Vec3f));
+	}
+	if (flags & MESH_CACHE_HAS_UVS) {
+		layout.uvOffset = offset;
+		offset = alignCacheOffset(offset + vertexCount * sizeof(Vec2f));
+	}
+	if (flags & MESH_CACHE_HAS_TANGENTS) {
+		layout.tangentOffset = offset;
+		offset = alignCacheOffset(offset + vertexCount * sizeof(Vec3f));
+	}
+	if (flags & MESH_CACHE_HAS_BITANGENTS) {
+		layout.bitangentOffset = offset;
+		offset = alignCacheOffset(offset + vertexCount * sizeof(Vec3f));
+	}
+
+	layout.totalSize = offset;
+	return layout;
+}
+
+static uint64_t mixHash(uint64_t value) {
+	value ^= value >> 33;
+	value *= 0xFF51AFD7ED558CCDULL;
+	value ^= value >> 33;
+	value *= 0xC4CEB9FE1A85EC53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+uint64_t MeshCache::hashBytes(const char* data, size_t size, uint64_t seed) {
+	uint64_t hash = mixHash(seed ^ size);
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = (hash ^ mixHash(word)) * 0x9E3779B97F4A7C15ULL;
+	}
+
+	uint64_t tail = 0;
+	if (i < size)
+		std::memcpy(&tail, data + i, size - i);
+	return mixHash(hash ^ tail);
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath, const std::string& cacheDirectory) {
+	uint64_t pathHash = hashBytes(sourcePath.data(), sourcePath.size());
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.meshcache", static_cast<unsigned long long>(pathHash));
+
+	return (std::filesystem::path(cacheDirectory) / name).string();
+}
+
+template<typename T>
+static SharedArrayPtr<const T> copyCachedArray(const char* file, size_t offset, int count) {
+	if (offset == 0)
+		return SharedArrayPtr<const T>();
+
+	T* result = new T[count];
+	std::memcpy(result, file + offset, count * sizeof(T));
+	return SharedArrayPtr<const T>(result);
+}
+
+static bool readCacheFile(const std::string& cachePath, uint64_t sourceHash, CachedMesh& result) {
+	Util::MappedFile file(cachePath);
+
+	if (!file.isOpen() || file.size() < sizeof(MeshCacheHeader))
+		return false;
+
+	MeshCacheHeader header;
+	std::memcpy(&header, file.data(), sizeof(MeshCacheHeader));
+
+	if (std::memcmp(header.magic, meshCacheMagic, sizeof(meshCacheMagic)) != 0 || header.version != MESH_CACHE_VERSION_ID || header.sourceHash != sourceHash)
+		return false;
+
+	MeshCacheLayout layout = computeLayout(header.vertexCount, header.triangleCount, header.flags);
+	if (layout.totalSize != file.size())
+		return false;
+
+	// the stored buffers are already in the parallel layout, a single copy into aligned storage is enough
+	UniqueAlignedPointer<float> vertices = createParallelVecBuf(header.vertexCount);
+	UniqueAlignedPointer<int> triangles = createParallelTriangleBuf(header.triangleCount);
+	std::memcpy(vertices.get(), file.data() + layout.vertexOffset, getOffset(header.vertexCount) * 3 * sizeof(float));
+	std::memcpy(triangles.get(), file.data() + layout.triangleOffset, getOffset(header.triangleCount) * 3 * sizeof(int));
+
+	int vertexCount = static_cast<int>(header.vertexCount);
+	result.shape = Graphics::VisualShape(
+		Polyhedron::fromParallelBuffers(std::move(vertices), std::move(triangles), vertexCount, static_cast<int>(header.triangleCount)),
+		copyCachedArray<Vec3f>(file.data(), layout.normalOffset, vertexCount),
+		copyCachedArray<Vec2f>(file.data(), layout.uvOffset, vertexCount),
+		copyCachedArray<Vec3f>(file.data(), layout.tangentOffset, vertexCount),
+		copyCachedArray<Vec3f>(file.data(), layout.bitangentOffset, vertexCount)
+	);
+	result.fromCache = true;
+
+	return true;
+}
+
+static void writeCachedArray(std::ostream& output, const void* data, size_t offset, size_t size) {
+	if (offset == 0)
+		return;
+
+	output.seekp(offset);
+	output.write(static_cast<const char*>(data), size);
+}
+
+static void writeCacheFile(const std::string& cachePath, uint64_t sourceHash, const CachedMesh& mesh) {
+	const Graphics::VisualShape& shape = mesh.shape;
+
+	MeshCacheHeader header;
+	std::memcpy(header.magic, meshCacheMagic, sizeof(meshCacheMagic));
+	header.version = MESH_CACHE_VERSION_ID;
+	header.flags = 0;
+	if (shape.normals.get() != nullptr) header.flags |= MESH_CACHE_HAS_NORMALS;
+	if (shape.uvs.get() != nullptr) header.flags |= MESH_CACHE_HAS_UVS;
+	if (shape.tangents.get() != nullptr) header.flags |= MESH_CACHE_HAS_TANGENTS;
+	if (shape.bitangents.get() != nullptr) header.flags |= MESH_CACHE_HAS_BITANGENTS;
+	header.sourceHash = sourceHash;
+	header.vertexCount = static_cast<uint32_t>(shape.vertexCount);
+	header.triangleCount = static_cast<uint32_t>(shape.triangleCount);
+
+	MeshCacheLayout layout = computeLayout(header.vertexCount, header.triangleCount, header.flags);
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+
+	// written next to the cache file and moved over it, so concurrent loads never see a partial file
+	std::string temporaryPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) {
+			Log::warn("Could not write mesh cache file %s", temporaryPath.c_str());
+			return;
+		}
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+		writeCachedArray(output, shape.getVertexBuffer(), layout.vertexOffset, getOffset(shape.vertexCount) * 3 * sizeof(float));
+		writeCachedArray(output, shape.getTriangleBuffer(), layout.triangleOffset, getOffset(shape.triangleCount) * 3 * sizeof(int));
+		writeCachedArray(output, shape.normals.get(), layout.normalOffset, shape.vertexCount * sizeof(Vec3f));
+		writeCachedArray(output, shape.uvs.get(), layout.uvOffset, shape.vertexCount * sizeof(Vec2f));
+		writeCachedArray(output, shape.tangents.get(), layout.tangentOffset, shape.vertexCount * sizeof(Vec3f));
+		writeCachedArray(output, shape.bitangents.get(), layout.bitangentOffset, shape.vertexCount * sizeof(Vec3f));
+
+		// pad the last buffer up to the alignment
+		if (static_cast<size_t>(output.tellp()) < layout.totalSize) {
+			output.seekp(layout.totalSize - 1);
+			output.put('\0');
+		}
+
+		if (!output.good()) {
+			Log::warn("Could not write mesh cache file %s", temporaryPath.c_str());
+			output.close();
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error) {
+		Log::warn("Could not write mesh cache file %s", cachePath.c_str());
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+CachedMesh MeshCache::load(const std::string& sourcePath, const std::string& cacheDirectory) {
+	CachedMesh result;
+	result.fromCache = false;
+
+	uint64_t sourceHash;
+	{
+		Util::MappedFile source(sourcePath);
+
+		if (!source.isOpen()) {
+			Log::subject s(sourcePath);
+			Log::error("File not found: %s", sourcePath.c_str());
+			return result;
+		}
+
+		sourceHash = hashBytes(source.data(), source.size(), MESH_CACHE_VERSION_ID);
+	}
+
+	std::string cachePath = getCachePath(sourcePath, cacheDirectory);
+	if (readCacheFile(cachePath, sourceHash, result))
+		return result;
+
+	result.shape = OBJImport::load(sourcePath);
+	if (result.shape.vertexCount == 0)
+		return result;
+
+	writeCacheFile(cachePath, sourceHash, result);
+
+	return result;
+}
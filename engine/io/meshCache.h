@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "../graphics/visualShape.h"
+
+/*
+	On-disk cache of imported meshes
+
+	The first load of a source file parses it with OBJImport and writes the processed shape, with its computed tangents,
+	to a cache file. Later loads map the cache file and copy the buffers out,
+	without parsing or recomputing anything.
+
+	Each source path has one cache file, named after a hash of the path. The file stores a hash of the source contents and of the
+	processing version, a cache file whose hash does not match the current source is rebuilt, so editing a source invalidates it.
+	Bump MESH_CACHE_VERSION_ID whenever the import or the stored data changes.
+
+	Layout:
+		MeshCacheHeader
+		vertex buffer, in the parallel layout of Polyhedron, see polyhedronInternals.h
+		triangle buffer, in the parallel layout of Polyhedron
+		normals, uvs, tangents and bitangents, each only if present
+	every buffer starts at a multiple of MESH_CACHE_ALIGNMENT
+*/
+
+#define MESH_CACHE_VERSION_ID 2
+#define MESH_CACHE_ALIGNMENT 32
+#define MESH_CACHE_DEFAULT_DIRECTORY "../res/.cache/meshes"
+
+struct CachedMesh {
+	Graphics::VisualShape shape;
+
+	// false if the source was parsed because the cache file was missing or outdated
+	bool fromCache;
+};
+
+namespace MeshCache {
+	/*
+		A fast non cryptographic 64 bit hash, used to detect changed sources
+	*/
+	uint64_t hashBytes(const char* data, size_t size, uint64_t seed = 0);
+
+	/*
+		Returns the cache file used for the given source file
+	*/
+	std::string getCachePath(const std::string& sourcePath, const std::string& cacheDirectory = MESH_CACHE_DEFAULT_DIRECTORY);
+
+	/*
+		Loads the given obj or bobj file through the cache in cacheDirectory, which is created if needed
+		If the source cannot be read the returned shape is empty. If the cache cannot be written the parsed shape is still returned
+	*/
+	CachedMesh load(const std::string& sourcePath, const std::string& cacheDirectory = MESH_CACHE_DEFAULT_DIRECTORY);
+};
@@ -1,11 +1,23 @@
 #include "core.h"
 
 #include "meshResource.h"
-#include "../io/import.h"
+#include "../io/meshCache.h"
 #include "../graphics/visualShape.h"
 
 MeshResource* MeshAllocator::load(const std::string& name, const std::string& path) {
-	Graphics::VisualShape shape = OBJImport::load(path);
-	Graphics::IndexedMesh* mesh = new Graphics::IndexedMesh(shape);
-	return new MeshResource(name, path, mesh, shape);
+	std::function<MeshResource*()> finalize = decode(name, path);
+
+	return finalize ? finalize() : nullptr;
+}
+
+std::function<MeshResource*()> MeshAllocator::decode(const std::string& name, const std::string& path) {
+	Graphics::VisualShape shape = MeshCache::load(path).shape;
+
+	if (shape.vertexCount == 0)
+		return nullptr;
+
+	return [name, path, shape]() {
+		Graphics::IndexedMesh* mesh = new Graphics::IndexedMesh(shape);
+		return new MeshResource(name, path, mesh, shape);
+	};
 }
\ No newline at end of file
@@ -10,6 +10,11 @@ class MeshResource;
 class MeshAllocator : public ResourceAllocator<MeshResource> {
 public:
 	virtual MeshResource* load(const std::string& name, const std::string& path) override;
+
+	/*
+		Parses the file on the calling thread, the mesh is uploaded to the graphics card in the returned finalize stage
+	*/
+	virtual std::function<MeshResource*()> decode(const std::string& name, const std::string& path) override;
 };
 
 class MeshResource : public Resource {
@@ -39,6 +44,17 @@ public:
 		mesh->close();
 	}
 
+	virtual std::size_t getSize() const override {
+		std::size_t vertexSize = sizeof(Vec3f);
+		if (shape.normals.get() != nullptr) vertexSize += sizeof(Vec3f);
+		if (shape.uvs.get() != nullptr) vertexSize += sizeof(Vec2f);
+		if (shape.tangents.get() != nullptr) vertexSize += sizeof(Vec3f);
+		if (shape.bitangents.get() != nullptr) vertexSize += sizeof(Vec3f);
+
+		// the shape is kept in memory and uploaded to the graphics card
+		return 2 * (shape.vertexCount * vertexSize + shape.triangleCount * sizeof(Triangle));
+	}
+
 	static MeshAllocator getAllocator() {
 		return MeshAllocator();
 	}
@@ -102,7 +102,7 @@ unsigned int compileShader(const std::string& source, unsigned int type) {
 		char* message = (char*) alloca(length * sizeof(char));
 		glGetShaderInfoLog(id, length, &length, message);
 		Log::print(Log::Color::ERROR, "fail\n");
-		Log::error(message);
+		Log::print(Log::Color::ERROR, "%s\n", message);
 
 		glDeleteShader(id);
 		return 0;
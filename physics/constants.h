@@ -2,4 +2,8 @@
 
 #define GJK_MAX_ITER 200
 #define EPA_MAX_ITER 200
+// EPA stops once a new support point grows the squared distance to the nearest face by less than this fraction
+#define EPA_DEFAULT_TOLERANCE 0.01
+// GJK distance queries stop once the distance can shrink by less than this fraction
+#define GJK_DISTANCE_TOLERANCE 0.0001f
 #define COLLISSION_DEPTH_FORCE_MULTIPLIER 2000
@@ -12,4 +12,6 @@ public:
 	
 	virtual CFrame getRelativeCFrame() const override;
 	virtual RelativeMotion getRelativeMotion() const override;
+
+	virtual bool isConstant() const override { return true; }
 };
@@ -15,6 +15,11 @@ public:
 	virtual RelativeMotion getRelativeMotion() const = 0;
 	
 	virtual CFrame getRelativeCFrame() const;
+
+	/*
+		A constant constraint never changes its relative CFrame, so the mass properties of its parent don't need to be recomputed every tick
+	*/
+	virtual bool isConstant() const { return false; }
 	
 	virtual ~HardConstraint() {}
 };
@@ -3,6 +3,10 @@
 #include <stdlib.h>
 #include <exception>
 
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+#include "../memoryProfiler.h"
+#endif
+
 void deleteAligned(void* buf) {
 #ifdef _MSC_VER
 	_aligned_free(buf);
@@ -12,6 +16,9 @@ void deleteAligned(void* buf) {
 }
 
 void* createAligned(size_t size, size_t align) {
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+	recordAllocation(size);
+#endif
 #ifdef _MSC_VER
 	void* buf = _aligned_malloc(size, align);
 #else
@@ -5,6 +5,7 @@
 #include <utility>
 #include <new>
 #include <limits>
+#include <algorithm>
 
 long long computeCost(const Bounds& bounds) {
 	Vec3Fix d = bounds.getDiagonal();
@@ -44,6 +45,53 @@ TreeNode::TreeNode(TreeNode* subTrees, int nodeCount) :
 	bounds(computeBoundsOfList(subTrees, nodeCount)) {}
 
 
+/*
+	Splits nodes[0..count) in two halves along the longest axis of their combined bounds, returns the size of the first half
+*/
+static size_t splitNodesAlongLongestAxis(TreeNode* nodes, size_t count) {
+	Bounds totalBounds = computeBoundsOfList(nodes, count);
+	size_t half = count / 2;
+
+	Fix<32> Position::* axis = &Position::x;
+	if(totalBounds.getHeight() > totalBounds.getWidth() && totalBounds.getHeight() >= totalBounds.getDepth()) {
+		axis = &Position::y;
+	} else if(totalBounds.getDepth() > totalBounds.getWidth() && totalBounds.getDepth() > totalBounds.getHeight()) {
+		axis = &Position::z;
+	}
+
+	std::nth_element(nodes, nodes + half, nodes + count, [axis](const TreeNode& a, const TreeNode& b) {
+		// comparing min + max instead of the center avoids a division
+		return a.bounds.min.*axis + a.bounds.max.*axis < b.bounds.min.*axis + b.bounds.max.*axis;
+	});
+	return half;
+}
+
+TreeNode buildTreeFromNodes(TreeNode* nodes, size_t count) {
+	assert(count >= 1);
+	if(count == 1) {
+		return std::move(nodes[0]);
+	}
+
+	TreeNode* subTrees = new TreeNode[MAX_BRANCHES];
+	if(count <= MAX_BRANCHES) {
+		for(size_t i = 0; i < count; i++) {
+			subTrees[i] = std::move(nodes[i]);
+		}
+		return TreeNode(subTrees, static_cast<int>(count));
+	}
+
+	// split twice, into MAX_BRANCHES (4) groups of roughly equal size
+	size_t half = splitNodesAlongLongestAxis(nodes, count);
+	size_t firstQuarter = splitNodesAlongLongestAxis(nodes, half);
+	size_t thirdQuarter = half + splitNodesAlongLongestAxis(nodes + half, count - half);
+
+	subTrees[0] = buildTreeFromNodes(nodes, firstQuarter);
+	subTrees[1] = buildTreeFromNodes(nodes + firstQuarter, half - firstQuarter);
+	subTrees[2] = buildTreeFromNodes(nodes + half, thirdQuarter - half);
+	subTrees[3] = buildTreeFromNodes(nodes + thirdQuarter, count - thirdQuarter);
+	return TreeNode(subTrees, MAX_BRANCHES);
+}
+
 TreeNode::TreeNode(const TreeNode& original) :
 	nodeCount(original.nodeCount),
 	isGroupHead(original.isGroupHead),
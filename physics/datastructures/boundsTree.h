@@ -76,6 +76,12 @@ struct TreeNode {
 
 long long computeCost(const Bounds& bounds);
 
+/*
+	Builds a balanced tree out of the given nodes by recursively splitting them along their longest axis
+	The nodes are moved out of the given array, count must be at least 1
+*/
+TreeNode buildTreeFromNodes(TreeNode* nodes, size_t count);
+
 //Bounds computeBoundsOfList(const TreeNode* const* list, size_t count);
 
 //Bounds computeBoundsOfList(const TreeNode* list, size_t count);
@@ -296,6 +302,14 @@ struct BoundsTree {
 	void add(Boundable* obj, const Bounds& bounds) {
 		this->add(TreeNode(obj, bounds, true));
 	}
+
+	/*
+		Adds many nodes at once, much faster than adding them one by one as the new nodes are first built into a balanced subtree
+	*/
+	void addAll(TreeNode* nodes, size_t count) {
+		if(count == 0) return;
+		this->add(buildTreeFromNodes(nodes, count));
+	}
 	
 	void addToExistingGroup(Boundable* obj, const Bounds& bounds, TreeNode& groupNode) {
 		groupNode.addInside(TreeNode(obj, bounds, false));
@@ -300,13 +300,16 @@ public:
 	}
 
 	inline void add(const T& newObj) {
-		buf[curI] = newObj;
-		curI++;
+		// curI is only ever stored in range, so unsynchronized adds from several threads lose entries but never write out of bounds
+		size_t index = curI;
+		buf[index] = newObj;
+		index++;
 
-		if (curI >= capacity) {
-			curI = 0;
+		if (index >= capacity) {
+			index = 0;
 			hasComeAround = true;
 		}
+		curI = index;
 	}
 
 	inline T sum() const {
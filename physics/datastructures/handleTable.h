@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <assert.h>
+
+#define NULL_HANDLE_INDEX UINT32_MAX
+
+/*
+	Refers to an object in a HandleTable, stays valid when the object is moved to a different address
+	Once the object is removed from the table the handle no longer resolves, even if its slot is reused by another object
+*/
+template<typename T>
+struct Handle {
+	uint32_t index = NULL_HANDLE_INDEX;
+	uint32_t generation = 0;
+
+	inline bool isNull() const { return index == NULL_HANDLE_INDEX; }
+
+	inline bool operator==(const Handle<T>& other) const { return index == other.index && generation == other.generation; }
+	inline bool operator!=(const Handle<T>& other) const { return !(*this == other); }
+};
+
+/*
+	Maps handles to the current address of their objects in constant time
+
+	Every object gets a slot, a slot freed by remove is reused by the next add with its generation increased,
+	so handles to the removed object stop resolving instead of pointing to the new one
+*/
+template<typename T>
+class HandleTable {
+	struct Slot {
+		T* object;
+		uint32_t generation;
+		// the next free slot while this one is free
+		uint32_t nextFree;
+	};
+
+	std::vector<Slot> slots;
+	uint32_t firstFree = NULL_HANDLE_INDEX;
+	size_t objectCount = 0;
+
+public:
+	Handle<T> add(T* object) {
+		assert(object != nullptr);
+		Handle<T> handle;
+		if(firstFree != NULL_HANDLE_INDEX) {
+			handle.index = firstFree;
+			Slot& slot = slots[firstFree];
+			firstFree = slot.nextFree;
+			slot.object = object;
+			handle.generation = slot.generation;
+		} else {
+			assert(slots.size() < NULL_HANDLE_INDEX);
+			handle.index = static_cast<uint32_t>(slots.size());
+			slots.push_back(Slot{object, 0, NULL_HANDLE_INDEX});
+		}
+		objectCount++;
+		return handle;
+	}
+
+	/*
+		Returns nullptr for a null handle or a handle of which the object has been removed
+	*/
+	inline T* get(Handle<T> handle) const {
+		if(handle.index >= slots.size()) return nullptr;
+		const Slot& slot = slots[handle.index];
+		return (slot.generation == handle.generation) ? slot.object : nullptr;
+	}
+
+	inline bool contains(Handle<T> handle) const {
+		return get(handle) != nullptr;
+	}
+
+	void remove(Handle<T> handle) {
+		assert(contains(handle));
+		Slot& slot = slots[handle.index];
+		slot.object = nullptr;
+		slot.generation++;
+		slot.nextFree = firstFree;
+		firstFree = handle.index;
+		objectCount--;
+	}
+
+	/*
+		Called when the object of handle has been moved to newAddress
+	*/
+	inline void relocate(Handle<T> handle, T* newAddress) {
+		assert(contains(handle));
+		slots[handle.index].object = newAddress;
+	}
+
+	inline size_t size() const { return objectCount; }
+};
@@ -0,0 +1,49 @@
+#include "quantizedBoundsTree.h"
+
+int QuantizedBoundsTree::addNode(TreeNode& node) {
+	int index = static_cast<int>(nodes.size());
+	nodes.emplace_back();
+
+	int childNodes[MAX_BRANCHES];
+	for(int i = 0; i < node.nodeCount; i++) {
+		childNodes[i] = node[i].isLeafNode() ? -1 : addNode(node[i]);
+	}
+
+	// the children may have moved the array
+	QuantizedTreeNode& result = nodes[index];
+	result.childCount = node.nodeCount;
+	for(int i = 0; i < MAX_BRANCHES; i++) {
+		if(i < node.nodeCount) {
+			QuantizedBounds childBounds(node[i].bounds, origin);
+			for(int axis = 0; axis < 3; axis++) {
+				result.childBounds[axis][i] = -childBounds.negatedMin[axis];
+				result.childBounds[axis][i + MAX_BRANCHES] = -childBounds.max[axis];
+			}
+			result.children[i] = &node[i];
+			result.childNodes[i] = childNodes[i];
+		} else {
+			// empty slots never overlap anything
+			for(int axis = 0; axis < 3; axis++) {
+				result.childBounds[axis][i] = INFINITY;
+				result.childBounds[axis][i + MAX_BRANCHES] = INFINITY;
+			}
+			result.children[i] = nullptr;
+			result.childNodes[i] = -1;
+		}
+	}
+	return index;
+}
+
+void QuantizedBoundsTree::rebuild(TreeNode& rootNode, const Position& origin) {
+	nodes.clear();
+	this->origin = origin;
+	if(rootNode.nodeCount == 0) {
+		this->rootNode = nullptr;
+		return;
+	}
+	this->rootNode = &rootNode;
+	this->rootBounds = QuantizedBounds(rootNode.bounds, origin);
+	if(!rootNode.isLeafNode()) {
+		addNode(rootNode);
+	}
+}
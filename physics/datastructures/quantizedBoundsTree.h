@@ -0,0 +1,250 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <cfloat>
+
+#include "boundsTree.h"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+	Converting from Fix<32> to float rounds to the nearest float, these move the result far enough to be sure it is not past the exact value
+*/
+inline float roundDownToFloat(Fix<32> value) {
+	float result = static_cast<float>(value.value) * (1.0f / (1ULL << 32));
+	return result - std::abs(result) * (2 * FLT_EPSILON) - FLT_MIN;
+}
+inline float roundUpToFloat(Fix<32> value) {
+	float result = static_cast<float>(value.value) * (1.0f / (1ULL << 32));
+	return result + std::abs(result) * (2 * FLT_EPSILON) + FLT_MIN;
+}
+
+/*
+	Bounds relative to the origin of a QuantizedBoundsTree, rounded outward
+	The minimum is stored negated, this lets a single compare test both sides of an axis, see QuantizedTreeNode::getOverlapMask
+*/
+struct QuantizedBounds {
+	float max[3];
+	float negatedMin[3];
+
+	QuantizedBounds() = default;
+	inline QuantizedBounds(const Bounds& bounds, const Position& origin) {
+		Vec3Fix min = bounds.min - origin;
+		Vec3Fix max = bounds.max - origin;
+		for(int axis = 0; axis < 3; axis++) {
+			this->max[axis] = roundUpToFloat(max[axis]);
+			this->negatedMin[axis] = -roundDownToFloat(min[axis]);
+		}
+	}
+
+	// same metric as computeCost
+	inline float getCost() const {
+		return (max[0] + negatedMin[0]) + (max[1] + negatedMin[1]) + (max[2] + negatedMin[2]);
+	}
+};
+
+/*
+	An inner TreeNode whose children's bounds are stored as floats relative to the origin of the tree
+	For every axis: the minima of the 4 children, followed by their negated maxima
+	This way a single compare per axis tests a query against all children
+
+	The floats are rounded outward, so they always contain the exact bounds. Tests against them may report false overlaps, but never miss one
+*/
+struct alignas(32) QuantizedTreeNode {
+	float childBounds[3][2 * MAX_BRANCHES];
+	// the original nodes, for their objects, exact bounds and group flags
+	TreeNode* children[MAX_BRANCHES];
+	// index of the QuantizedTreeNode of every inner child, -1 for leaves
+	int childNodes[MAX_BRANCHES];
+	int childCount;
+
+	inline QuantizedBounds getChildBounds(int index) const {
+		QuantizedBounds result;
+		for(int axis = 0; axis < 3; axis++) {
+			result.max[axis] = -childBounds[axis][index + MAX_BRANCHES];
+			result.negatedMin[axis] = -childBounds[axis][index];
+		}
+		return result;
+	}
+
+	/*
+		Returns a mask with bit i set if child i may overlap the query
+	*/
+	inline unsigned int getOverlapMask(const QuantizedBounds& query) const {
+#ifdef __AVX__
+		unsigned int mask = 0xFF;
+		for(int axis = 0; axis < 3; axis++) {
+			// the maximum of the query 4 times, followed by its negated minimum 4 times
+			__m256 queryBounds = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(query.max[axis])), _mm_set1_ps(query.negatedMin[axis]), 1);
+			mask &= static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_load_ps(childBounds[axis]), queryBounds, _CMP_LE_OQ)));
+		}
+		// the low half compares the minima, the high half the maxima
+		return mask & (mask >> MAX_BRANCHES);
+#else
+		unsigned int mask = 0;
+		for(int i = 0; i < MAX_BRANCHES; i++) {
+			bool overlaps = true;
+			for(int axis = 0; axis < 3; axis++) {
+				overlaps &= childBounds[axis][i] <= query.max[axis];
+				overlaps &= childBounds[axis][i + MAX_BRANCHES] <= query.negatedMin[axis];
+			}
+			mask |= static_cast<unsigned int>(overlaps) << i;
+		}
+		return mask;
+#endif
+	}
+};
+
+/*
+	A read only copy of the inner nodes of a tree of TreeNodes, stored as QuantizedTreeNodes in a flat array, in depth first order
+	Queries on it test the children of a node 4 at a time instead of one by one, and only touch the original nodes for leaves that overlap
+
+	The copy refers to the nodes of the original tree, it must be rebuilt whenever the original tree changes
+*/
+class QuantizedBoundsTree {
+	std::vector<QuantizedTreeNode> nodes;
+	TreeNode* rootNode = nullptr;
+	QuantizedBounds rootBounds;
+	Position origin;
+
+	int addNode(TreeNode& node);
+
+	static inline int lowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	/*
+		A node of a QuantizedBoundsTree during traversal, index is the index of its QuantizedTreeNode, or -1 for leaves
+	*/
+	struct NodeRef {
+		TreeNode* node;
+		int index;
+		QuantizedBounds bounds;
+	};
+
+	/*
+		first and second are known to (roughly) overlap
+	*/
+	template<typename Func>
+	static void forEachOverlappingPairBetween(const QuantizedBoundsTree& firstTree, const NodeRef& first, const QuantizedBoundsTree& secondTree, const NodeRef& second, const Func& func) {
+		if(first.index == -1 && second.index == -1) {
+			if(intersects(first.node->bounds, second.node->bounds)) {
+				func(*first.node, *second.node);
+			}
+			return;
+		}
+		bool preferFirst = first.bounds.getCost() <= second.bounds.getCost();
+		if((preferFirst && first.index != -1) || second.index == -1) {
+			// split first
+			const QuantizedTreeNode& node = firstTree.nodes[first.index];
+			for(unsigned int mask = node.getOverlapMask(second.bounds); mask != 0; mask &= mask - 1) {
+				int i = lowestBit(mask);
+				forEachOverlappingPairBetween(firstTree, NodeRef{node.children[i], node.childNodes[i], node.getChildBounds(i)}, secondTree, second, func);
+			}
+		} else {
+			// split second
+			const QuantizedTreeNode& node = secondTree.nodes[second.index];
+			for(unsigned int mask = node.getOverlapMask(first.bounds); mask != 0; mask &= mask - 1) {
+				int i = lowestBit(mask);
+				forEachOverlappingPairBetween(firstTree, first, secondTree, NodeRef{node.children[i], node.childNodes[i], node.getChildBounds(i)}, func);
+			}
+		}
+	}
+
+	template<typename Func>
+	void forEachOverlappingPairWithin(int nodeIndex, const Func& func) const {
+		const QuantizedTreeNode& node = nodes[nodeIndex];
+		for(int i = 0; i < node.childCount; i++) {
+			NodeRef child{node.children[i], node.childNodes[i], node.getChildBounds(i)};
+			if(child.index != -1 && !child.node->isGroupHead) {
+				forEachOverlappingPairWithin(child.index, func);
+			}
+			// only the children after this one, every pair is visited once
+			unsigned int laterChildren = ~0U << (i + 1);
+			for(unsigned int mask = node.getOverlapMask(child.bounds) & laterChildren; mask != 0; mask &= mask - 1) {
+				int j = lowestBit(mask);
+				forEachOverlappingPairBetween(*this, child, *this, NodeRef{node.children[j], node.childNodes[j], node.getChildBounds(j)}, func);
+			}
+		}
+	}
+
+public:
+	QuantizedBoundsTree() = default;
+
+	/*
+		Replaces the contents of this tree with a copy of the given tree, reusing the memory of the previous copy
+		All bounds are stored relative to origin, trees that are queried against each other must share the same origin
+		Precision is best for bounds close to origin
+	*/
+	void rebuild(TreeNode& rootNode, const Position& origin);
+	inline void rebuild(TreeNode& rootNode) { rebuild(rootNode, rootNode.bounds.min); }
+
+	inline bool isEmpty() const { return rootNode == nullptr; }
+	inline const Position& getOrigin() const { return origin; }
+	inline size_t getNodeCount() const { return nodes.size(); }
+	inline size_t getMemoryUsage() const { return nodes.capacity() * sizeof(QuantizedTreeNode); }
+
+	/*
+		Calls func(TreeNode& leaf) for every leaf whose bounds intersect the given bounds
+	*/
+	template<typename Func>
+	void forEachLeafInBounds(const Bounds& bounds, const Func& func) const {
+		if(isEmpty()) return;
+		if(nodes.empty()) {
+			if(intersects(rootNode->bounds, bounds)) func(*rootNode);
+			return;
+		}
+		QuantizedBounds query(bounds, origin);
+		int stack[MAX_HEIGHT * MAX_BRANCHES];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while(stackSize > 0) {
+			const QuantizedTreeNode& node = nodes[stack[--stackSize]];
+			for(unsigned int mask = node.getOverlapMask(query); mask != 0; mask &= mask - 1) {
+				int i = lowestBit(mask);
+				if(node.childNodes[i] != -1) {
+					stack[stackSize++] = node.childNodes[i];
+				} else if(intersects(node.children[i]->bounds, bounds)) {
+					func(*node.children[i]);
+				}
+			}
+		}
+	}
+
+	/*
+		Calls func(TreeNode& a, TreeNode& b) for every pair of leaves in this tree with intersecting bounds
+		Like the original tree, pairs within the same group are skipped
+	*/
+	template<typename Func>
+	void forEachOverlappingPair(const Func& func) const {
+		if(nodes.empty() || rootNode->isGroupHead) return;
+		forEachOverlappingPairWithin(0, func);
+	}
+
+	/*
+		Calls func(TreeNode& a, TreeNode& b) for every leaf a of this tree and leaf b of other with intersecting bounds
+		Both trees must have been built with the same origin
+	*/
+	template<typename Func>
+	void forEachOverlappingPair(const QuantizedBoundsTree& other, const Func& func) const {
+		if(isEmpty() || other.isEmpty()) return;
+		assert(origin == other.origin);
+		if(!intersects(rootNode->bounds, other.rootNode->bounds)) return;
+		NodeRef first{rootNode, nodes.empty() ? -1 : 0, rootBounds};
+		NodeRef second{other.rootNode, other.nodes.empty() ? -1 : 0, other.rootBounds};
+		forEachOverlappingPairBetween(*this, first, other, second, func);
+	}
+};
@@ -2,6 +2,7 @@
 
 
 #include "shape.h"
+#include "shapeClass.h"
 
 // definitions in shapeClass.cpp
 
@@ -11,5 +12,39 @@ Shape Cylinder(double radius, double height);
 
 Shape Box(double width, double height, double depth);
 
+/*
+	A capsule along z, in the normalized -1..1 space the hemispheres become half ellipsoids with a z radius of capRatio
+	Once scaled by (r, r, r / capRatio) they are hemispheres of radius r again
+*/
+struct CapsuleClass : public ShapeClass {
+	// radius of the capsule divided by half of its total height
+	const double capRatio;
+	// half the length of the core segment
+	const double coreHalfLength;
+
+	static double getVolume(double capRatio);
+	static ScalableInertialMatrix getInertia(double capRatio);
+
+	CapsuleClass(double capRatio);
+
+	virtual bool containsPoint(Vec3 point) const override;
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
+	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+	virtual Polyhedron asPolyhedron() const override;
+	virtual bool getCore(const DiagonalMat3& scale, ShapeCore& core) const override;
+
+	void setScaleX(double newX, DiagonalMat3& scale) const override;
+	void setScaleY(double newY, DiagonalMat3& scale) const override;
+};
+
+/*
+	A cylinder along z with hemispheres on both ends, height is the total length including the hemispheres and must be at least 2 * radius
+	Capsules with the same ratio of radius to height share their ShapeClass
+	Stretching a capsule along z also stretches its caps, create a new capsule to keep them round
+*/
+Shape Capsule(double radius, double height);
+
 //Shape Wedge(double width, double height, double depth);
 
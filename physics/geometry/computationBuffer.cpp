@@ -38,6 +38,7 @@ void ComputationBuffers::createTriangleBuffersUnsafe(int newTriangleCapacity) {
 	neighborBuf = new TriangleNeighbors[newTriangleCapacity];
 	edgeBuf = new EdgePiece[newTriangleCapacity];
 	removalBuf = new int[newTriangleCapacity];
+	changedTriangleBuf = new int[newTriangleCapacity * 2];
 	this->triangleCapacity = newTriangleCapacity;
 }
 
@@ -51,4 +52,5 @@ void ComputationBuffers::deleteTriangleBuffers() {
 	delete[] neighborBuf;
 	delete[] edgeBuf;
 	delete[] removalBuf;
+	delete[] changedTriangleBuf;
 }
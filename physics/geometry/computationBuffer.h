@@ -2,18 +2,34 @@
 
 struct ComputationBuffers;
 
+#include <vector>
+
 #include "../math/linalg/vec.h"
 #include "convexShapeBuilder.h"
 
 struct MinkowskiPointIndices;
 
+/*
+	A face of the EPA polytope with its normal and distance to the origin cached
+	Stale once the triangle at triangleIndex is no longer this triangle
+*/
+struct EPAFace {
+	double distanceSquared;
+	int triangleIndex;
+	Triangle triangle;
+	Vec3f normal;
+};
+
 struct ComputationBuffers {
 	Vec3f* vertBuf;
 	Triangle* triangleBuf;
 	TriangleNeighbors* neighborBuf;
 	EdgePiece* edgeBuf;
 	int* removalBuf;
+	int* changedTriangleBuf;
 	MinkowskiPointIndices* knownVecs;
+	// min heap on distanceSquared, may contain stale faces
+	std::vector<EPAFace> faceHeap;
 
 	int vertexCapacity;
 	int triangleCapacity;
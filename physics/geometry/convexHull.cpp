@@ -0,0 +1,336 @@
+#include "convexHull.h"
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../../util/parallelFor.h"
+
+/*
+	Chunks with fewer points than this are not worth a thread of their own
+*/
+#define HULL_MIN_CHUNK_SIZE 4096
+
+namespace {
+struct HullFace {
+	// counterclockwise seen from outside
+	int vertices[3];
+	// neighbors[k] shares the edge opposite of vertices[k], like TriangleNeighbors
+	int neighbors[3] = {-1, -1, -1};
+	Vec3f normal;
+	float offset;
+
+	// points above this face which are not yet part of the hull
+	std::vector<int> outside;
+	int furthest = -1;
+	float furthestDistance = 0.0f;
+
+	int visibleStamp = 0;
+	bool alive = true;
+};
+
+struct HorizonEdge {
+	int from;
+	int to;
+	int visibleFace;
+	int outsideFace;
+};
+
+/*
+	Quickhull over a subset of points, always expands the hull towards the point that lies furthest above any face
+*/
+class QuickHull {
+	const Vec3f* points;
+	float epsilon;
+
+	std::vector<HullFace> faces;
+	std::priority_queue<std::pair<float, int>> faceQueue;
+	// the new face whose horizon edge starts at a vertex, only valid during addPoint
+	std::vector<int> horizonStart;
+	int stamp = 0;
+
+	std::vector<int> visible;
+	std::vector<HorizonEdge> horizon;
+	std::vector<int> stack;
+
+	float distance(int face, int point) const {
+		return faces[face].normal * points[point] - faces[face].offset;
+	}
+
+	int createFace(int a, int b, int c) {
+		HullFace face;
+		face.vertices[0] = a;
+		face.vertices[1] = b;
+		face.vertices[2] = c;
+		Vec3f normal = (points[b] - points[a]) % (points[c] - points[a]);
+		float normalLength = length(normal);
+		face.normal = (normalLength > 0.0f) ? normal / normalLength : normal;
+		face.offset = face.normal * points[a];
+		faces.push_back(std::move(face));
+		return static_cast<int>(faces.size() - 1);
+	}
+
+	void assignOutside(int point, const int* candidateFaces, size_t candidateCount) {
+		for(size_t i = 0; i < candidateCount; i++) {
+			int face = candidateFaces[i];
+			float d = distance(face, point);
+			if(d > epsilon) {
+				HullFace& f = faces[face];
+				f.outside.push_back(point);
+				if(d > f.furthestDistance) {
+					f.furthestDistance = d;
+					f.furthest = point;
+				}
+				return;
+			}
+		}
+	}
+
+	void queueFaces(const int* newFaces, size_t count) {
+		for(size_t i = 0; i < count; i++) {
+			if(!faces[newFaces[i]].outside.empty()) {
+				faceQueue.push(std::make_pair(faces[newFaces[i]].furthestDistance, newFaces[i]));
+			}
+		}
+	}
+
+	void addPoint(int eye, int startFace) {
+		stamp++;
+		visible.clear();
+		horizon.clear();
+
+		faces[startFace].visibleStamp = stamp;
+		visible.push_back(startFace);
+		stack.push_back(startFace);
+		while(!stack.empty()) {
+			int face = stack.back();
+			stack.pop_back();
+			for(int k = 0; k < 3; k++) {
+				int neighbor = faces[face].neighbors[k];
+				if(faces[neighbor].visibleStamp == stamp) continue;
+				if(distance(neighbor, eye) > epsilon) {
+					faces[neighbor].visibleStamp = stamp;
+					visible.push_back(neighbor);
+					stack.push_back(neighbor);
+				} else {
+					horizon.push_back(HorizonEdge{faces[face].vertices[(k + 1) % 3], faces[face].vertices[(k + 2) % 3], face, neighbor});
+				}
+			}
+		}
+
+		std::vector<int> newFaces;
+		newFaces.reserve(horizon.size());
+		for(const HorizonEdge& edge : horizon) {
+			int newFace = createFace(eye, edge.from, edge.to);
+			faces[newFace].neighbors[0] = edge.outsideFace;
+			HullFace& outsideFace = faces[edge.outsideFace];
+			for(int k = 0; k < 3; k++) {
+				if(outsideFace.neighbors[k] == edge.visibleFace) {
+					outsideFace.neighbors[k] = newFace;
+					break;
+				}
+			}
+			horizonStart[edge.from] = newFace;
+			newFaces.push_back(newFace);
+		}
+		// the horizon is a loop, the face after (eye, from, to) is the one starting at to
+		for(int newFace : newFaces) {
+			int next = horizonStart[faces[newFace].vertices[2]];
+			faces[newFace].neighbors[1] = next;
+			faces[next].neighbors[2] = newFace;
+		}
+
+		for(int face : visible) {
+			HullFace& f = faces[face];
+			f.alive = false;
+			for(int point : f.outside) {
+				if(point != eye) assignOutside(point, newFaces.data(), newFaces.size());
+			}
+			std::vector<int>().swap(f.outside);
+		}
+		queueFaces(newFaces.data(), newFaces.size());
+	}
+
+	bool createInitialSimplex(const int* indices, size_t count) {
+		// the two most distant of the extreme points along each axis
+		int extremes[6];
+		std::fill(extremes, extremes + 6, indices[0]);
+		for(size_t i = 1; i < count; i++) {
+			const Vec3f& p = points[indices[i]];
+			for(int axis = 0; axis < 3; axis++) {
+				if(p[axis] < points[extremes[axis * 2]][axis]) extremes[axis * 2] = indices[i];
+				if(p[axis] > points[extremes[axis * 2 + 1]][axis]) extremes[axis * 2 + 1] = indices[i];
+			}
+		}
+		int a = extremes[0];
+		int b = extremes[1];
+		for(int axis = 1; axis < 3; axis++) {
+			if(lengthSquared(points[extremes[axis * 2 + 1]] - points[extremes[axis * 2]]) > lengthSquared(points[b] - points[a])) {
+				a = extremes[axis * 2];
+				b = extremes[axis * 2 + 1];
+			}
+		}
+		if(length(points[b] - points[a]) <= epsilon) return false;
+
+		Vec3f lineDirection = normalize(points[b] - points[a]);
+		int c = -1;
+		float bestLineDistance = epsilon;
+		for(size_t i = 0; i < count; i++) {
+			float lineDistance = length((points[indices[i]] - points[a]) % lineDirection);
+			if(lineDistance > bestLineDistance) {
+				bestLineDistance = lineDistance;
+				c = indices[i];
+			}
+		}
+		if(c == -1) return false;
+
+		Vec3f planeNormal = normalize((points[b] - points[a]) % (points[c] - points[a]));
+		int d = -1;
+		float bestPlaneDistance = epsilon;
+		for(size_t i = 0; i < count; i++) {
+			float planeDistance = std::abs((points[indices[i]] - points[a]) * planeNormal);
+			if(planeDistance > bestPlaneDistance) {
+				bestPlaneDistance = planeDistance;
+				d = indices[i];
+			}
+		}
+		if(d == -1) return false;
+
+		// d must lie below the first face
+		if((points[d] - points[a]) * planeNormal > 0) std::swap(a, b);
+
+		int v[4]{a, b, c, d};
+		Triangle tetrahedron[4]{{0,1,2},{0,3,1},{0,2,3},{1,3,2}};
+		for(const Triangle& t : tetrahedron) {
+			createFace(v[t[0]], v[t[1]], v[t[2]]);
+		}
+		// every face of a tetrahedron lacks one vertex, the neighbor across an edge is the face lacking the vertex opposite of that edge
+		int faceLacking[4]{3, 2, 1, 0};
+		for(int f = 0; f < 4; f++) {
+			for(int k = 0; k < 3; k++) {
+				faces[f].neighbors[k] = faceLacking[tetrahedron[f][k]];
+			}
+		}
+
+		int initialFaces[4]{0, 1, 2, 3};
+		for(size_t i = 0; i < count; i++) {
+			int point = indices[i];
+			if(point == a || point == b || point == c || point == d) continue;
+			assignOutside(point, initialFaces, 4);
+		}
+		queueFaces(initialFaces, 4);
+		return true;
+	}
+
+public:
+	int vertexCount = 0;
+
+	QuickHull(const Vec3f* points, size_t pointCount, float epsilon) : points(points), epsilon(epsilon), horizonStart(pointCount) {}
+
+	/*
+		Returns false if the points do not span a volume
+	*/
+	bool build(const int* indices, size_t count, int maxVertices) {
+		if(count < 4 || !createInitialSimplex(indices, count)) return false;
+		vertexCount = 4;
+
+		while(!faceQueue.empty() && vertexCount < maxVertices) {
+			int face = faceQueue.top().second;
+			faceQueue.pop();
+			if(!faces[face].alive) continue;
+			addPoint(faces[face].furthest, face);
+			vertexCount++;
+		}
+		return true;
+	}
+
+	/*
+		The largest distance of a point that was not added to the hull above any face of the hull
+	*/
+	float getMaxError() const {
+		float maxError = 0.0f;
+		for(size_t face = 0; face < faces.size(); face++) {
+			if(!faces[face].alive) continue;
+			for(int point : faces[face].outside) {
+				for(size_t other = 0; other < faces.size(); other++) {
+					if(faces[other].alive) maxError = std::max(maxError, distance(static_cast<int>(other), point));
+				}
+			}
+		}
+		return maxError;
+	}
+
+	void getHullVertices(std::vector<int>& result) const {
+		for(const HullFace& face : faces) {
+			if(!face.alive) continue;
+			result.insert(result.end(), face.vertices, face.vertices + 3);
+		}
+		std::sort(result.begin(), result.end());
+		result.erase(std::unique(result.begin(), result.end()), result.end());
+	}
+
+	Polyhedron toPolyhedron() {
+		std::vector<int> hullVertices;
+		getHullVertices(hullVertices);
+
+		std::vector<Vec3f> vertices(hullVertices.size());
+		for(size_t i = 0; i < hullVertices.size(); i++) {
+			vertices[i] = points[hullVertices[i]];
+			// horizonStart is reused as the map from point to vertex index
+			horizonStart[hullVertices[i]] = static_cast<int>(i);
+		}
+		std::vector<Triangle> triangles;
+		for(const HullFace& face : faces) {
+			if(!face.alive) continue;
+			triangles.push_back(Triangle{horizonStart[face.vertices[0]], horizonStart[face.vertices[1]], horizonStart[face.vertices[2]]});
+		}
+		return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+	}
+};
+};
+
+Polyhedron buildConvexHull(const Vec3f* points, size_t pointCount, int maxVertices, float* maxError) {
+	if(maxVertices < 4) throw std::invalid_argument("buildConvexHull needs at least 4 vertices");
+
+	float maxCoordinates = 0.0f;
+	for(size_t i = 0; i < pointCount; i++) {
+		maxCoordinates = std::max(maxCoordinates, std::abs(points[i].x) + std::abs(points[i].y) + std::abs(points[i].z));
+	}
+	float epsilon = 3 * FLT_EPSILON * maxCoordinates;
+
+	// the hull of every chunk, the final hull is built from the vertices of these
+	size_t chunkCount = Util::getChunkCount(pointCount, HULL_MIN_CHUNK_SIZE);
+	std::vector<std::vector<int>> chunkVertices(chunkCount);
+	Util::parallelForChunks(pointCount, chunkCount, [&](size_t chunkIndex, size_t begin, size_t end) {
+		std::vector<int>& result = chunkVertices[chunkIndex];
+		for(size_t i = begin; i < end; i++) {
+			result.push_back(static_cast<int>(i));
+		}
+		if(chunkCount == 1) return;
+
+		QuickHull chunkHull(points, pointCount, epsilon);
+		// a flat chunk passes all its points on
+		if(chunkHull.build(result.data(), result.size(), INT_MAX)) {
+			result.clear();
+			chunkHull.getHullVertices(result);
+		}
+	});
+
+	std::vector<int> candidates;
+	for(const std::vector<int>& vertices : chunkVertices) {
+		candidates.insert(candidates.end(), vertices.begin(), vertices.end());
+	}
+
+	QuickHull hull(points, pointCount, epsilon);
+	if(!hull.build(candidates.data(), candidates.size(), maxVertices)) {
+		throw std::invalid_argument("buildConvexHull: points do not span a volume");
+	}
+	if(maxError != nullptr) {
+		*maxError = hull.getMaxError();
+	}
+	return hull.toPolyhedron();
+}
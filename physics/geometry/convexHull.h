@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <climits>
+
+#include "../math/linalg/vec.h"
+#include "polyhedron.h"
+
+/*
+	Builds the convex hull of a point cloud, for example the vertices of an imported mesh, to be used as a collision shape
+
+	The points are split into chunks whose hulls are built in parallel, the final hull is then built from the vertices of those hulls
+	Points are added to the hull furthest first, when the hull reaches maxVertices the remaining points are dropped
+	The result then lies inside the exact hull, maxError receives the largest distance of a dropped point outside of it, or 0 if none were dropped
+
+	maxVertices must be at least 4
+	Throws std::invalid_argument if the points do not span a volume
+*/
+Polyhedron buildConvexHull(const Vec3f* points, size_t pointCount, int maxVertices = INT_MAX, float* maxError = nullptr);
@@ -126,6 +126,12 @@ struct ConvexTriangleIterator {
 		shapeBuilder.neighborBuf[next].AB_Neighbor = previous;
 	}
 
+	void markTriangleChanged(int triangle) {
+		if(shapeBuilder.changedTriangleBuffer != nullptr) {
+			shapeBuilder.changedTriangleBuffer[shapeBuilder.changedTriangleCount++] = triangle;
+		}
+	}
+
 	void createTipTriangle(int newPointVertex, int previousVertex, int triangleToBeReplaced, EdgePiece replacingInfo) {
 		// int toBeReplaced = removalList[i];
 		// EdgePiece replacingInfo = newTrianglesList[i];
@@ -136,6 +142,7 @@ struct ConvexTriangleIterator {
 		
 		shapeBuilder.neighborBuf[triangleToBeReplaced].BC_Neighbor = edgeTriangle;
 		shapeBuilder.neighborBuf[edgeTriangle][replacingInfo.neighborIndexOfEdgeTriangle] = triangleToBeReplaced;
+		markTriangleChanged(triangleToBeReplaced);
 	}
 
 	void applyUpdates(int newPointVertex) {
@@ -202,6 +209,7 @@ struct ConvexTriangleIterator {
 					for(; replacingTriangleCursor < shapeBuilder.triangleCount; replacingTriangleCursor++) {
 						if(!isRemoved(replacingTriangleCursor)) {
 							moveTriangle(shapeBuilder.triangleBuf, shapeBuilder.neighborBuf, replacingTriangleCursor, triangleToRemove);
+							markTriangleChanged(triangleToRemove);
 							replacingTriangleCursor++;
 							goto nextTriangle;
 						}
@@ -220,6 +228,7 @@ void ConvexShapeBuilder::addPoint(const Vec3f& point, int oldTriangleIndex) {
 	catchable_assert(isVecValid(point));
 
 	ConvexTriangleIterator iter(point, *this, this->removalBuffer, this->newTriangleBuffer);
+	changedTriangleCount = 0;
 
 	TriangleNeighbors neighbors = neighborBuf[oldTriangleIndex];
 
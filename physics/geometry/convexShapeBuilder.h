@@ -25,6 +25,13 @@ public:
 	int* removalBuffer;
 	EdgePiece* newTriangleBuffer;
 
+	/*
+		If set, addPoint lists the indices of all triangles it created or moved here, triangles that were only removed are not listed
+		An index may be listed twice, so it needs room for twice the triangle count
+	*/
+	int* changedTriangleBuffer = nullptr;
+	int changedTriangleCount = 0;
+
 	ConvexShapeBuilder(Vec3f * vertBuf, Triangle* triangleBuf, int vertexCount, int triangleCount, TriangleNeighbors* neighborBuf, int* removalBuffer, EdgePiece* newTriangleBuffer);
 	ConvexShapeBuilder(const Polyhedron& s, Vec3f * newVertBuf, Triangle* newTriangleBuf, TriangleNeighbors* neighborBuf, int* removalBuffer, EdgePiece* newTriangleBuffer);
 
@@ -2,6 +2,24 @@
 
 #include "../math/linalg/vec.h"
 
+/*
+	Vertex indices of the support points last found for a pair of collidables, used as the starting points of the next search for that pair
+*/
+struct SupportHint {
+	int first = 0;
+	int second = 0;
+};
+
 struct GenericCollidable {
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const = 0;
+
+	/*
+		Same result as furthestInDirection, vertexHint is the index of the vertex to start searching from and is set to the index of the returned vertex
+		Any value is a valid hint, collidables that do not use hints ignore it
+	*/
+	virtual Vec3f furthestInDirectionFromHint(const Vec3f& direction, int& vertexHint) const { return furthestInDirection(direction); }
+	/*
+		Whether furthestInDirectionFromHint gets faster with a good hint, only then is it worth remembering hints between ticks
+	*/
+	virtual bool usesSupportHints() const { return false; }
 };
@@ -16,6 +16,7 @@
 #include "../catchable_assert.h"
 
 #include <stdexcept>
+#include <algorithm>
 
 
 inline static void incDebugTally(HistoricTally<long long, IterationTime>& tally, int iterTime) {
@@ -36,31 +37,30 @@ static Vec3f getNormalVec(Triangle t, Vec3f* vertices) {
 	return (v1 - v0) % (v2 - v0);
 }
 
-static double getDistanceOfTriangleToOriginSquared(Triangle t, Vec3f* vertices) {
-	return pointToPlaneDistanceSquared(getNormalVec(t, vertices), vertices[t[0]]);
+static bool isFurtherFace(const EPAFace& first, const EPAFace& second) {
+	return first.distanceSquared > second.distanceSquared;
 }
 
-struct NearestSurface {
-	int triangleIndex;
-	double distanceSquared;
-};
-
-static NearestSurface getNearestSurface(const ConvexShapeBuilder& builder) {
-	int best = 0;
-	double bestDistSq = getDistanceOfTriangleToOriginSquared(builder.triangleBuf[0], builder.vertexBuf);
-
-	for(int i = 1; i < builder.triangleCount; i++) {
-		Triangle t = builder.triangleBuf[i];
-
-		double distSq = getDistanceOfTriangleToOriginSquared(t, builder.vertexBuf);
+static void pushFace(ComputationBuffers& bufs, const ConvexShapeBuilder& builder, int triangleIndex) {
+	Triangle t = builder.triangleBuf[triangleIndex];
+	Vec3f normal = getNormalVec(t, builder.vertexBuf);
+	bufs.faceHeap.push_back(EPAFace{pointToPlaneDistanceSquared(normal, builder.vertexBuf[t[0]]), triangleIndex, t, normal});
+	std::push_heap(bufs.faceHeap.begin(), bufs.faceHeap.end(), isFurtherFace);
+}
 
-		if(distSq < bestDistSq) {
-			best = i;
-			bestDistSq = distSq;
+/*
+	Faces that were removed or replaced by addPoint are dropped from the heap when they come up
+*/
+static const EPAFace& getNearestFace(ComputationBuffers& bufs, const ConvexShapeBuilder& builder) {
+	while(true) {
+		catchable_assert(!bufs.faceHeap.empty());
+		const EPAFace& nearest = bufs.faceHeap.front();
+		if(nearest.triangleIndex < builder.triangleCount && builder.triangleBuf[nearest.triangleIndex] == nearest.triangle) {
+			return nearest;
 		}
+		std::pop_heap(bufs.faceHeap.begin(), bufs.faceHeap.end(), isFurtherFace);
+		bufs.faceHeap.pop_back();
 	}
-
-	return NearestSurface{best, bestDistSq};
 }
 
 static int furthestIndexInDirection(Vec3* vertices, int vertexCount, Vec3 direction) {
@@ -78,9 +78,9 @@ static int furthestIndexInDirection(Vec3* vertices, int vertexCount, Vec3 direct
 }
 
 static MinkPoint getSupport(const ColissionPair& info, const Vec3f& searchDirection) {
-	Vec3f furthest1 = info.scaleFirst * info.first.furthestInDirection(info.scaleFirst * searchDirection);  // in local space of first
+	Vec3f furthest1 = info.scaleFirst * info.first.furthestInDirectionFromHint(info.scaleFirst * searchDirection, info.hint.first);  // in local space of first
 	Vec3f transformedSearchDirection = -info.transform.relativeToLocal(searchDirection);
-	Vec3f furthest2 = info.scaleSecond * info.second.furthestInDirection(info.scaleSecond * transformedSearchDirection);  // in local space of second
+	Vec3f furthest2 = info.scaleSecond * info.second.furthestInDirectionFromHint(info.scaleSecond * transformedSearchDirection, info.hint.second);  // in local space of second
 	Vec3f secondVertex = info.transform.localToGlobal(furthest2);  // converted to local space of first
 
 	/*catchable_assert(isVecValid(furthest1));
@@ -212,11 +212,204 @@ std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& info, Vec3f se
 		}
 	}
 
-	Log::warn("GJK iteration limit reached!");
+	LOG_RATE_LIMITED(1000, Log::warn("GJK iteration limit reached!"));
 	incDebugTally(GJKNoCollidesIterationStatistics, GJK_MAX_ITER + 2);
 	return std::optional<Tetrahedron>();
 }
 
+/*
+	The simplices of runGJKDistanceTransformed are kept as up to 4 MinkPoints with the barycentric weights of the point closest to the origin
+	The reduce functions keep only the points needed to express that closest point, and return it
+*/
+struct DistanceSimplex {
+	MinkPoint points[4];
+	float weights[4];
+	int count;
+
+	void keep(int a, float weightA) {
+		points[0] = points[a];
+		weights[0] = weightA;
+		count = 1;
+	}
+	void keep(int a, int b, float weightA, float weightB) {
+		MinkPoint pa = points[a];
+		MinkPoint pb = points[b];
+		points[0] = pa;
+		points[1] = pb;
+		weights[0] = weightA;
+		weights[1] = weightB;
+		count = 2;
+	}
+	void keep(int a, int b, int c, float weightA, float weightB, float weightC) {
+		MinkPoint pa = points[a];
+		MinkPoint pb = points[b];
+		MinkPoint pc = points[c];
+		points[0] = pa;
+		points[1] = pb;
+		points[2] = pc;
+		weights[0] = weightA;
+		weights[1] = weightB;
+		weights[2] = weightC;
+		count = 3;
+	}
+
+	Vec3f getClosest() const {
+		Vec3f result(0.0f, 0.0f, 0.0f);
+		for(int i = 0; i < count; i++) result += points[i].p * weights[i];
+		return result;
+	}
+
+	void reduceSegment(int ia, int ib) {
+		Vec3f a = points[ia].p;
+		Vec3f ab = points[ib].p - a;
+		float lengthSq = lengthSquared(ab);
+		float t = (lengthSq > 0.0f) ? -(a * ab) / lengthSq : 0.0f;
+		if(t <= 0.0f) {
+			keep(ia, 1.0f);
+		} else if(t >= 1.0f) {
+			keep(ib, 1.0f);
+		} else {
+			keep(ia, ib, 1.0f - t, t);
+		}
+	}
+
+	// closest point of the triangle to the origin, by the regions of Ericson, Real-Time Collision Detection 5.1.5
+	void reduceTriangle(int ia, int ib, int ic) {
+		Vec3f a = points[ia].p;
+		Vec3f b = points[ib].p;
+		Vec3f c = points[ic].p;
+		Vec3f ab = b - a;
+		Vec3f ac = c - a;
+
+		float d1 = -(ab * a);
+		float d2 = -(ac * a);
+		if(d1 <= 0.0f && d2 <= 0.0f) { keep(ia, 1.0f); return; }
+
+		float d3 = -(ab * b);
+		float d4 = -(ac * b);
+		if(d3 >= 0.0f && d4 <= d3) { keep(ib, 1.0f); return; }
+
+		float vc = d1 * d4 - d3 * d2;
+		if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			float v = d1 / (d1 - d3);
+			keep(ia, ib, 1.0f - v, v);
+			return;
+		}
+
+		float d5 = -(ab * c);
+		float d6 = -(ac * c);
+		if(d6 >= 0.0f && d5 <= d6) { keep(ic, 1.0f); return; }
+
+		float vb = d5 * d2 - d1 * d6;
+		if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			float w = d2 / (d2 - d6);
+			keep(ia, ic, 1.0f - w, w);
+			return;
+		}
+
+		float va = d3 * d6 - d5 * d4;
+		if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			keep(ib, ic, 1.0f - w, w);
+			return;
+		}
+
+		float sum = va + vb + vc;
+		if(sum <= 0.0f) {
+			// degenerate triangle, the origin lies closest to its longest edge
+			if(lengthSquared(ab) >= lengthSquared(ac)) {
+				reduceSegment(ia, ib);
+			} else {
+				reduceSegment(ia, ic);
+			}
+			return;
+		}
+		float v = vb / sum;
+		float w = vc / sum;
+		keep(ia, ib, ic, 1.0f - v - w, v, w);
+	}
+
+	/*
+		Returns false if the tetrahedron contains the origin
+	*/
+	bool reduceTetrahedron() {
+		static const int faces[4][4]{{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+		DistanceSimplex best;
+		float bestDistanceSq = INFINITY;
+		for(const int* face : faces) {
+			Vec3f a = points[face[0]].p;
+			Vec3f normal = (points[face[1]].p - a) % (points[face[2]].p - a);
+			float originSide = -(normal * a);
+			float oppositeSide = normal * (points[face[3]].p - a);
+			// only faces with the origin on their outside can hold the closest point
+			if(originSide * oppositeSide >= 0.0f) continue;
+			DistanceSimplex candidate = *this;
+			candidate.reduceTriangle(face[0], face[1], face[2]);
+			float distanceSq = lengthSquared(candidate.getClosest());
+			if(distanceSq < bestDistanceSq) {
+				bestDistanceSq = distanceSq;
+				best = candidate;
+			}
+		}
+		if(bestDistanceSq == INFINITY) return false;
+		*this = best;
+		return true;
+	}
+};
+
+bool runGJKDistanceTransformed(const ColissionPair& info, Vec3f searchDirection, Vec3f& closestFirst, Vec3f& closestSecond) {
+	DistanceSimplex simplex;
+	simplex.points[0] = getSupport(info, searchDirection);
+	simplex.weights[0] = 1.0f;
+	simplex.count = 1;
+	Vec3f closest = simplex.points[0].p;
+
+	int iter = 0;
+	for(; iter < GJK_MAX_ITER; iter++) {
+		float distanceSq = lengthSquared(closest);
+		if(distanceSq == 0.0f) {
+			incDebugTally(GJKCollidesIterationStatistics, iter);
+			return false;
+		}
+
+		MinkPoint newPoint = getSupport(info, -closest);
+		// nothing lies further towards the origin than the current closest point, up to the tolerance
+		if(distanceSq - closest * newPoint.p <= distanceSq * GJK_DISTANCE_TOLERANCE) {
+			break;
+		}
+
+		simplex.points[simplex.count++] = newPoint;
+		switch(simplex.count) {
+		case 2: simplex.reduceSegment(0, 1); break;
+		case 3: simplex.reduceTriangle(0, 1, 2); break;
+		case 4:
+			if(!simplex.reduceTetrahedron()) {
+				incDebugTally(GJKCollidesIterationStatistics, iter);
+				return false;
+			}
+			break;
+		}
+
+		Vec3f newClosest = simplex.getClosest();
+		// rounding can stop the distance from shrinking before the tolerance is reached
+		if(lengthSquared(newClosest) >= distanceSq) {
+			break;
+		}
+		closest = newClosest;
+	}
+
+	incDebugTally(GJKNoCollidesIterationStatistics, iter);
+	Vec3f first(0.0f, 0.0f, 0.0f);
+	Vec3f second(0.0f, 0.0f, 0.0f);
+	for(int i = 0; i < simplex.count; i++) {
+		first += simplex.points[i].originFirst * simplex.weights[i];
+		second += simplex.points[i].originSecond * simplex.weights[i];
+	}
+	closestFirst = first;
+	closestSecond = second;
+	return true;
+}
+
 void initializeBuffer(const Tetrahedron& s, ComputationBuffers& b) {
 	b.vertBuf[0] = s.A.p;
 	b.vertBuf[1] = s.B.p;
@@ -234,16 +427,23 @@ void initializeBuffer(const Tetrahedron& s, ComputationBuffers& b) {
 	b.knownVecs[3] = MinkowskiPointIndices{s.D.originFirst, s.D.originSecond};
 }
 
-bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& intersection, Vec3f& exitVector, ComputationBuffers& bufs) {
+bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& intersection, Vec3f& exitVector, ComputationBuffers& bufs, double tolerance) {
 	initializeBuffer(s, bufs);
 
 	ConvexShapeBuilder builder(bufs.vertBuf, bufs.triangleBuf, 4, 4, bufs.neighborBuf, bufs.removalBuf, bufs.edgeBuf);
+	builder.changedTriangleBuffer = bufs.changedTriangleBuf;
+
+	bufs.faceHeap.clear();
+	for(int i = 0; i < builder.triangleCount; i++) {
+		pushFace(bufs, builder, i);
+	}
 
 	for(int iter = 0; iter < EPA_MAX_ITER; iter++) {
-		NearestSurface ns = getNearestSurface(builder);
-		int closestTriangleIndex = ns.triangleIndex;
-		double distSq = ns.distanceSquared;
-		Triangle closestTriangle = builder.triangleBuf[closestTriangleIndex];
+		EPAFace nearest = getNearestFace(bufs, builder);
+		int closestTriangleIndex = nearest.triangleIndex;
+		double distSq = nearest.distanceSquared;
+		Vec3f closestTriangleNormal = nearest.normal;
+		Triangle closestTriangle = nearest.triangle;
 		Vec3f a = builder.vertexBuf[closestTriangle[0]];
 		Vec3f b = builder.vertexBuf[closestTriangle[1]];
 		Vec3f c = builder.vertexBuf[closestTriangle[2]];
@@ -252,8 +452,6 @@ bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& i
 		catchable_assert(isVecValid(b));
 		catchable_assert(isVecValid(c));
 
-		Vec3f closestTriangleNormal = getNormalVec(closestTriangle, builder.vertexBuf);
-
 		MinkPoint point(getSupport(info, closestTriangleNormal));
 
 		
@@ -265,9 +463,13 @@ bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& i
 		MinkowskiPointIndices curIndices{point.originFirst, point.originSecond};
 
 		// Do not remove! The inversion catches NaN as well!
-		if(!(newPointDistSq <= distSq * 1.01)) {
+		if(!(newPointDistSq <= distSq * (1.0 + tolerance))) {
 			bufs.knownVecs[builder.vertexCount] = curIndices;
 			builder.addPoint(point.p, closestTriangleIndex);
+			for(int i = 0; i < builder.changedTriangleCount; i++) {
+				int changed = builder.changedTriangleBuffer[i];
+				if(changed < builder.triangleCount) pushFace(bufs, builder, changed);
+			}
 		} else {
 			// closestTriangle is an edge triangle, so our best direction is towards this triangle.
 
@@ -304,7 +506,7 @@ bool runEPATransformed(const ColissionPair& info, const Tetrahedron& s, Vec3f& i
 		}
 	}
 
-	Log::warn("EPA iteration limit exceeded! ");
+	LOG_RATE_LIMITED(1000, Log::warn("EPA iteration limit exceeded! "));
 	incDebugTally(EPAIterationStatistics, EPA_MAX_ITER);
 	return false;
 }
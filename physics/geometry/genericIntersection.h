@@ -5,6 +5,7 @@
 #include "../math/linalg/vec.h"
 #include "../math/transform.h"
 #include "genericCollidable.h"
+#include "../constants.h"
 
 struct ComputationBuffers;
 struct Simplex;
@@ -53,7 +54,16 @@ struct ColissionPair {
 	CFramef transform;
 	DiagonalMat3f scaleFirst;
 	DiagonalMat3f scaleSecond;
+	SupportHint& hint;
 };
 
 std::optional<Tetrahedron> runGJKTransformed(const ColissionPair& colissionPair, Vec3f initialSearchDirection);
-bool runEPATransformed(const ColissionPair& colissionPair, const Tetrahedron& s, Vec3f& intersection, Vec3f& exitVector, ComputationBuffers& bufs);
+/*
+	Finds the closest points of two shapes that do not intersect, local to first
+	Returns false if the shapes intersect or touch, closestFirst and closestSecond are then left unchanged
+*/
+bool runGJKDistanceTransformed(const ColissionPair& colissionPair, Vec3f initialSearchDirection, Vec3f& closestFirst, Vec3f& closestSecond);
+/*
+	tolerance is the fraction by which a new support point must grow the squared distance to the nearest face for EPA to continue
+*/
+bool runEPATransformed(const ColissionPair& colissionPair, const Tetrahedron& s, Vec3f& intersection, Vec3f& exitVector, ComputationBuffers& bufs, double tolerance = EPA_DEFAULT_TOLERANCE);
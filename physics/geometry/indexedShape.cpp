@@ -1,6 +1,8 @@
 #include "indexedShape.h"
 
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
 
 int& TriangleNeighbors::operator[](int index) {
 	return this->neighbors[index];
@@ -33,7 +35,7 @@ int TriangleNeighbors::getNeighborIndex(int neighbor) {
 
 IndexedShape::IndexedShape(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount, TriangleNeighbors * neighborBuf) : Polyhedron(vertices, triangles, vertexCount, triangleCount), neighbors(neighborBuf) {}
 
-void fillNeighborBuf(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf) {
+void fillNeighborBufQuadratic(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf) {
 	for(int i = 0; i < triangleCount; i++) {
 		for(int j = i + 1; j < triangleCount; j++) {
 			const Triangle& ti = triangles[i];
@@ -64,6 +66,55 @@ void fillNeighborBuf(const Triangle* triangles, int triangleCount, TriangleNeigh
 	}
 }
 
+/*
+	Half edge 3 * t + k of triangle t lies opposite of its vertex k, so its neighbor goes into neighbors[k]
+	The half edges are bucketed by their start vertex, the twin of a->b is the half edge b->a in the bucket of b
+*/
+void fillNeighborBufLinear(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf) {
+	int vertexCount = 0;
+	for(int t = 0; t < triangleCount; t++) {
+		for(int k = 0; k < 3; k++) {
+			vertexCount = std::max(vertexCount, triangles[t][k] + 1);
+		}
+	}
+
+	std::vector<int> firstEdge(vertexCount, -1);
+	std::vector<int> nextEdge(triangleCount * 3);
+	// end vertex of every half edge, next to nextEdge so walking a bucket doesn't touch the triangles
+	std::vector<int> edgeEnd(triangleCount * 3);
+	for(int t = 0; t < triangleCount; t++) {
+		const Triangle& triangle = triangles[t];
+		for(int k = 0; k < 3; k++) {
+			int e = 3 * t + k;
+			int from = triangle[(k + 1) % 3];
+			edgeEnd[e] = triangle[(k + 2) % 3];
+			nextEdge[e] = firstEdge[from];
+			firstEdge[from] = e;
+		}
+	}
+
+	for(int t = 0; t < triangleCount; t++) {
+		const Triangle& triangle = triangles[t];
+		for(int k = 0; k < 3; k++) {
+			int from = triangle[(k + 1) % 3];
+			int to = triangle[(k + 2) % 3];
+			for(int twin = firstEdge[to]; twin != -1; twin = nextEdge[twin]) {
+				if(edgeEnd[twin] == from) {
+					neighborBuf[t][k] = twin / 3;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void fillNeighborBuf(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf) {
+	if(triangleCount < LINEAR_NEIGHBOR_SEARCH_MIN_TRIANGLES) {
+		fillNeighborBufQuadratic(triangles, triangleCount, neighborBuf);
+	} else {
+		fillNeighborBufLinear(triangles, triangleCount, neighborBuf);
+	}
+}
 
 bool IndexedShape::isValid() const {
 	if(!Polyhedron::isValid()) { return false; };
@@ -31,4 +31,17 @@ struct IndexedShape : Polyhedron {
 	bool isValid() const;
 };
 
+/*
+	Below this many triangles comparing every pair of triangles is faster than bucketing the edges, this covers the tetrahedron EPA starts from
+*/
+#define LINEAR_NEIGHBOR_SEARCH_MIN_TRIANGLES 24
+
+/*
+	Sets neighborBuf[i][j] to the triangle sharing the edge of triangle i opposite of its vertex j, edges without a neighbor are left untouched
+*/
 void fillNeighborBuf(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf);
+/*
+	The two searches fillNeighborBuf picks from, they give the same result for any input
+*/
+void fillNeighborBufQuadratic(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf);
+void fillNeighborBufLinear(const Triangle* triangles, int triangleCount, TriangleNeighbors* neighborBuf);
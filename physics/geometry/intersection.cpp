@@ -10,20 +10,94 @@
 
 #include "../misc/validityHelper.h"
 #include "shapeClass.h"
+#include "triangleShapes.h"
 
 #include "../catchable_assert.h"
 
 #include <algorithm>
 
+/*
+	The segment along z at the center of a shape with a ShapeCore, a point if halfLength is 0
+*/
+struct CoreCollidable : public GenericCollidable {
+	float halfLength;
+
+	CoreCollidable(float halfLength) : halfLength(halfLength) {}
+
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
+		return Vec3f(0.0f, 0.0f, (direction.z >= 0.0f) ? halfLength : -halfLength);
+	}
+};
+
+static const DiagonalMat3 unitScale{1.0, 1.0, 1.0};
+
+/*
+	Intersection between two shapes of which at least one has a ShapeCore, GJK runs on the cores and the radii are added afterwards
+	Returns false if the cores themselves intersect, result is then not set and the full shapes must be tested instead
+*/
+static bool intersectsCoresTransformed(const Shape& first, const ShapeCore* firstCore, const Shape& second, const ShapeCore* secondCore, const CFrame& relativeTransform, SupportHint& hint, std::optional<Intersection>& result) {
+	CoreCollidable firstCoreCollidable(firstCore ? static_cast<float>(firstCore->halfLength) : 0.0f);
+	CoreCollidable secondCoreCollidable(secondCore ? static_cast<float>(secondCore->halfLength) : 0.0f);
+	const GenericCollidable& firstCollidable = firstCore ? static_cast<const GenericCollidable&>(firstCoreCollidable) : *first.baseShape;
+	const GenericCollidable& secondCollidable = secondCore ? static_cast<const GenericCollidable&>(secondCoreCollidable) : *second.baseShape;
+	double firstRadius = firstCore ? firstCore->radius : 0.0;
+	double secondRadius = secondCore ? secondCore->radius : 0.0;
+
+	ColissionPair info{firstCollidable, secondCollidable, relativeTransform, firstCore ? unitScale : first.scale, secondCore ? unitScale : second.scale, hint};
+	Vec3f closestFirst;
+	Vec3f closestSecond;
+	if(!runGJKDistanceTransformed(info, -relativeTransform.position, closestFirst, closestSecond)) return false;
+
+	Vec3 delta = Vec3(closestSecond) - Vec3(closestFirst);
+	double distance = length(delta);
+	double depth = firstRadius + secondRadius - distance;
+	if(depth <= 0.0) {
+		result = std::optional<Intersection>();
+		return true;
+	}
+	// the cores only just touch, there is no reliable normal
+	if(distance == 0.0) return false;
+
+	Vec3 normal = delta / distance;
+	Vec3 surfaceFirst = Vec3(closestFirst) + normal * firstRadius;
+	Vec3 surfaceSecond = Vec3(closestSecond) - normal * secondRadius;
+	result = Intersection((surfaceFirst + surfaceSecond) / 2, normal * depth);
+	return true;
+}
+
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform) {
-	return intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
+	SupportHint hint;
+	return intersectsTransformed(first, second, relativeTransform, hint);
+}
+std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, SupportHint& hint) {
+	ShapeCore firstCore;
+	ShapeCore secondCore;
+	bool firstHasCore = first.baseShape->getCore(first.scale, firstCore);
+	bool secondHasCore = second.baseShape->getCore(second.scale, secondCore);
+	if(firstHasCore || secondHasCore) {
+		physicsMeasure.mark(PhysicsProcess::GJK_COL);
+		std::optional<Intersection> result;
+		if(intersectsCoresTransformed(first, firstHasCore ? &firstCore : nullptr, second, secondHasCore ? &secondCore : nullptr, relativeTransform, hint, result)) {
+			if(!result) physicsMeasure.mark(PhysicsProcess::OTHER, PhysicsProcess::GJK_NO_COL);
+			return result;
+		}
+	}
+	return intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale, hint);
 }
 
 
-ComputationBuffers buffers(1000, 2000);
+/*
+	One per thread, worlds ticking on separate threads run EPA at the same time
+*/
+thread_local ComputationBuffers buffers(1000, 2000);
 
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond) {
-	ColissionPair info{first, second, relativeTransform, scaleFirst, scaleSecond};
+	SupportHint hint;
+	return intersectsTransformed(first, second, relativeTransform, scaleFirst, scaleSecond, hint);
+}
+
+std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond, SupportHint& hint) {
+	ColissionPair info{first, second, relativeTransform, scaleFirst, scaleSecond, hint};
 	physicsMeasure.mark(PhysicsProcess::GJK_COL);
 	std::optional collides = runGJKTransformed(info, -relativeTransform.position);
 
@@ -68,3 +142,82 @@ std::optional<Intersection> intersectsTransformed(const GenericCollidable& first
 		return std::optional<Intersection>();
 	}
 }
+
+/*
+	Collects the triangles of second that lie near first
+*/
+static void getTrianglesNear(const Shape& first, const Shape& second, const CFrame& relativeTransform, std::vector<TriangleCollidable>& candidates) {
+	const TriangleShapeClass& triangleShape = static_cast<const TriangleShapeClass&>(*second.baseShape);
+
+	// bounds of first in the normalized space of second
+	CFrame firstInSecond = ~relativeTransform;
+	BoundingBox firstBounds = first.getBounds(firstInSecond.getRotation());
+	DiagonalMat3 inverseScale = ~second.scale;
+	BoundingBox queryBounds(inverseScale * (firstBounds.min + firstInSecond.getPosition()), inverseScale * (firstBounds.max + firstInSecond.getPosition()));
+
+	candidates.clear();
+	triangleShape.getTrianglesInBounds(queryBounds, candidates);
+}
+
+void intersectsTrianglesTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, std::vector<Intersection>& result) {
+	thread_local std::vector<TriangleCollidable> candidates;
+	getTrianglesNear(first, second, relativeTransform, candidates);
+
+	physicsMeasure.mark(PhysicsProcess::GJK_COL);
+	for(const TriangleCollidable& triangle : candidates) {
+		Vec3 corners[3];
+		for(int i = 0; i < 3; i++) {
+			corners[i] = second.scale * Vec3(triangle.corners[i]);
+		}
+		relativeTransform.localToGlobal(corners, corners, 3);
+
+		SupportHint hint;
+		ColissionPair info{*first.baseShape, triangle, relativeTransform, first.scale, second.scale, hint};
+		if(!runGJKTransformed(info, -(corners[0] + corners[1] + corners[2]) / 3)) continue;
+
+		Vec3 normal = (corners[1] - corners[0]) % (corners[2] - corners[0]);
+		double normalLength = length(normal);
+		if(normalLength == 0.0) continue;
+		normal /= normalLength;
+
+		// the triangles are one sided, first is pushed out along the normal no matter from which side it entered
+		Vec3 deepestPoint = first.scale * Vec3(first.baseShape->furthestInDirection(Vec3f(first.scale * -normal)));
+		double depth = normal * (corners[0] - deepestPoint);
+		if(depth <= 0.0) continue;
+
+		result.push_back(Intersection(deepestPoint + normal * (depth / 2), -normal * depth));
+	}
+}
+
+bool overlapsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform) {
+	bool firstHasTriangles = first.baseShape->isTriangleShape();
+	bool secondHasTriangles = second.baseShape->isTriangleShape();
+	if(firstHasTriangles && secondHasTriangles) return false;
+	if(firstHasTriangles) return overlapsTransformed(second, first, ~relativeTransform);
+
+	if(secondHasTriangles) {
+		thread_local std::vector<TriangleCollidable> candidates;
+		getTrianglesNear(first, second, relativeTransform, candidates);
+		for(const TriangleCollidable& triangle : candidates) {
+			Vec3 center = relativeTransform.localToGlobal(second.scale * Vec3((triangle.corners[0] + triangle.corners[1] + triangle.corners[2]) / 3));
+			SupportHint hint;
+			ColissionPair info{*first.baseShape, triangle, relativeTransform, first.scale, second.scale, hint};
+			if(runGJKTransformed(info, -center)) return true;
+		}
+		return false;
+	}
+
+	SupportHint hint;
+	ShapeCore firstCore;
+	ShapeCore secondCore;
+	bool firstHasCore = first.baseShape->getCore(first.scale, firstCore);
+	bool secondHasCore = second.baseShape->getCore(second.scale, secondCore);
+	if(firstHasCore || secondHasCore) {
+		std::optional<Intersection> result;
+		if(intersectsCoresTransformed(first, firstHasCore ? &firstCore : nullptr, second, secondHasCore ? &secondCore : nullptr, relativeTransform, hint, result)) {
+			return result.has_value();
+		}
+	}
+	ColissionPair info{*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale, hint};
+	return runGJKTransformed(info, -relativeTransform.position).has_value();
+}
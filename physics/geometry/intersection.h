@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "../math/linalg/vec.h"
 #include "../math/cframe.h"
@@ -22,5 +23,19 @@ struct Intersection {
 
 std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform);
 std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond);
-
-
+/*
+	hint holds the support vertices of the previous test between these two shapes, and is updated for the next one
+*/
+std::optional<Intersection> intersectsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, SupportHint& hint);
+std::optional<Intersection> intersectsTransformed(const GenericCollidable& first, const GenericCollidable& second, const CFrame& relativeTransform, const DiagonalMat3& scaleFirst, const DiagonalMat3& scaleSecond, SupportHint& hint);
+/*
+	second must have a TriangleShapeClass, first is tested against every triangle of second that lies near it
+	Appends an Intersection local to first for every intersecting triangle, the exitVector points along the inverted normal of that triangle
+*/
+void intersectsTrianglesTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform, std::vector<Intersection>& result);
+/*
+	Only tells whether the shapes intersect, without computing the intersection, this skips EPA
+	Either shape may have a TriangleShapeClass, it is then tested per triangle. Two triangle shapes never overlap, as in the world
+	Does not touch the physics profiler, so it may run on several threads at once
+*/
+bool overlapsTransformed(const Shape& first, const Shape& second, const CFrame& relativeTransform);
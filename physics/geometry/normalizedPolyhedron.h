@@ -3,10 +3,19 @@
 #include "polyhedron.h"
 #include "shapeClass.h"
 
+/*
+	Below this many vertices a full SIMD scan is cheaper than walking the vertex adjacency graph
+*/
+#define HILL_CLIMBING_MIN_VERTEX_COUNT 64
+
 class NormalizedPolyhedron : public ShapeClass, public Polyhedron {
 	friend class Polyhedron;
 	NormalizedPolyhedron(Polyhedron&& poly, Vec3 originalCenter, DiagonalMat3 originalScale, double volume, Vec3 localCenterOfMass, ScalableInertialMatrix inertia) : 
-		Polyhedron(std::move(poly)), ShapeClass(volume, localCenterOfMass, inertia, CONVEX_POLYHEDRON_CLASS_ID), originalCenter(originalCenter), originalScale(originalScale) {}
+		ShapeClass(volume, localCenterOfMass, inertia, CONVEX_POLYHEDRON_CLASS_ID), Polyhedron(std::move(poly)), 
+		adjacency(vertexCount >= HILL_CLIMBING_MIN_VERTEX_COUNT ? computeVertexAdjacency() : VertexAdjacency()), originalCenter(originalCenter), originalScale(originalScale) {}
+
+	// empty for small polyhedra
+	VertexAdjacency adjacency;
 public:
 	const Vec3 originalCenter;
 	const DiagonalMat3 originalScale;
@@ -29,6 +38,14 @@ public:
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
 		return Polyhedron::furthestInDirection(direction);
 	}
+	virtual Vec3f furthestInDirectionFromHint(const Vec3f& direction, int& vertexHint) const override {
+		if(adjacency.empty()) return Polyhedron::furthestInDirection(direction);
+		vertexHint = furthestIndexInDirectionFrom(direction, vertexHint, adjacency);
+		return (*this)[vertexHint];
+	}
+	virtual bool usesSupportHints() const override {
+		return !adjacency.empty();
+	}
 
 	virtual Polyhedron asPolyhedron() const override {
 		return static_cast<Polyhedron>(*this);
@@ -4,7 +4,13 @@
 #include <cstring>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <math.h>
+#include <memory>
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 
 #include "../math/linalg/vec.h"
 #include "../math/linalg/trigonometry.h"
@@ -17,6 +23,7 @@
 #include "shape.h"
 
 #include "polyhedronInternals.h"
+#include "triangleBVH.h"
 
 bool Triangle::sharesEdgeWith(Triangle other) const {
 	return firstIndex == other.secondIndex && secondIndex == other.firstIndex ||
@@ -54,6 +61,10 @@ inline Polyhedron::Polyhedron(UniqueAlignedPointer<float>&& vertices, UniqueAlig
 	vertices(std::move(vertices)), triangles(std::move(triangles)), vertexCount(vertexCount), triangleCount(triangleCount) {
 }
 
+Polyhedron Polyhedron::fromParallelBuffers(UniqueAlignedPointer<float>&& vertices, UniqueAlignedPointer<int>&& triangles, int vertexCount, int triangleCount) {
+	return Polyhedron(std::move(vertices), std::move(triangles), vertexCount, triangleCount);
+}
+
 Polyhedron::~Polyhedron() {
 	
 }
@@ -69,6 +80,7 @@ Polyhedron::Polyhedron(const Vec3f* vertices, const Triangle* triangles, int ver
 Polyhedron::Polyhedron(Polyhedron&& poly) noexcept : 
 	vertices(std::move(poly.vertices)), 
 	triangles(std::move(poly.triangles)), 
+	triangleBVH(std::move(poly.triangleBVH)), 
 	vertexCount(poly.vertexCount), 
 	triangleCount(poly.triangleCount) {
 	
@@ -77,6 +89,7 @@ Polyhedron::Polyhedron(Polyhedron&& poly) noexcept :
 Polyhedron::Polyhedron(const Polyhedron& poly) : 
 	vertices(copy(poly.vertices, poly.vertexCount)), 
 	triangles(copy(poly.triangles, poly.triangleCount)), 
+	triangleBVH(std::atomic_load(&poly.triangleBVH)), 
 	vertexCount(poly.vertexCount), 
 	triangleCount(poly.triangleCount) {
 
@@ -86,6 +99,7 @@ Polyhedron::Polyhedron(const Polyhedron& poly) :
 Polyhedron& Polyhedron::operator=(Polyhedron&& poly) noexcept {
 	this->vertices = std::move(poly.vertices);
 	this->triangles = std::move(poly.triangles);
+	this->triangleBVH = std::move(poly.triangleBVH);
 	this->vertexCount = poly.vertexCount;
 	this->triangleCount = poly.triangleCount;
 
@@ -94,6 +108,7 @@ Polyhedron& Polyhedron::operator=(Polyhedron&& poly) noexcept {
 Polyhedron& Polyhedron::operator=(const Polyhedron& poly) {
 	this->vertices = copy(poly.vertices, poly.vertexCount);
 	this->triangles = copy(poly.triangles, poly.triangleCount);
+	this->triangleBVH = std::atomic_load(&poly.triangleBVH);
 	this->vertexCount = poly.vertexCount;
 	this->triangleCount = poly.triangleCount;
 
@@ -114,33 +129,67 @@ Polyhedron Polyhedron::translated(Vec3f offset) const {
 	return Polyhedron(std::move(newBuf), copy(triangles, triangleCount), vertexCount, triangleCount);
 }
 
-Polyhedron Polyhedron::rotated(Rotationf rotation) const {
-	UniqueAlignedPointer<float> newBuf = createParallelVecBuf(this->vertexCount);
-	for (int i = 0; i < this->vertexCount; i++) {
-		setInBuf(newBuf, vertexCount, i, rotation * (*this)[i]);
+/*
+	Writes transform * v + offset for every vertex of the parallel buffer source to target, both hold vertexCount vertices
+	Whole blocks of 8 are transformed, the padding of the final block stays a copy of the last vertex
+*/
+static void transformParallelVecBuf(const float* source, float* target, size_t vertexCount, const Mat3f& transform, const Vec3f& offset) {
+	size_t bufOffset = getOffset(vertexCount);
+	const float* xIn = source;
+	const float* yIn = source + bufOffset;
+	const float* zIn = source + 2 * bufOffset;
+	float* xOut = target;
+	float* yOut = target + bufOffset;
+	float* zOut = target + 2 * bufOffset;
+
+#ifdef __AVX__
+	__m256 m[3][3];
+	__m256 offsets[3];
+	for(int row = 0; row < 3; row++) {
+		for(int col = 0; col < 3; col++) {
+			m[row][col] = _mm256_set1_ps(transform[row][col]);
+		}
+		offsets[row] = _mm256_set1_ps(offset[row]);
+	}
+	for(size_t i = 0; i < bufOffset; i += 8) {
+		__m256 x = _mm256_load_ps(xIn + i);
+		__m256 y = _mm256_load_ps(yIn + i);
+		__m256 z = _mm256_load_ps(zIn + i);
+		__m256 results[3];
+		for(int row = 0; row < 3; row++) {
+			__m256 sum = _mm256_add_ps(_mm256_mul_ps(m[row][0], x), _mm256_mul_ps(m[row][1], y));
+			results[row] = _mm256_add_ps(_mm256_add_ps(sum, _mm256_mul_ps(m[row][2], z)), offsets[row]);
+		}
+		_mm256_store_ps(xOut + i, results[0]);
+		_mm256_store_ps(yOut + i, results[1]);
+		_mm256_store_ps(zOut + i, results[2]);
+	}
+#else
+	for(size_t i = 0; i < bufOffset; i++) {
+		Vec3f result = transform * Vec3f(xIn[i], yIn[i], zIn[i]) + offset;
+		xOut[i] = result.x;
+		yOut[i] = result.y;
+		zOut[i] = result.z;
 	}
+#endif
+}
 
-	fixFinalBlock(newBuf.get(), this->vertexCount);
+Polyhedron Polyhedron::rotated(Rotationf rotation) const {
+	UniqueAlignedPointer<float> newBuf = createParallelVecBuf(this->vertexCount);
+	transformParallelVecBuf(this->vertices, newBuf, vertexCount, rotation.asRotationMatrix(), Vec3f(0.0f, 0.0f, 0.0f));
 	return Polyhedron(std::move(newBuf), copy(triangles, triangleCount), vertexCount, triangleCount);
 }
 
 Polyhedron Polyhedron::localToGlobal(CFramef frame) const {
 	UniqueAlignedPointer<float> newBuf = createParallelVecBuf(this->vertexCount);
-	for (int i = 0; i < this->vertexCount; i++) {
-		setInBuf(newBuf, vertexCount, i, frame.localToGlobal((*this)[i]));
-	}
-
-	fixFinalBlock(newBuf.get(), this->vertexCount);
+	transformParallelVecBuf(this->vertices, newBuf, vertexCount, frame.getRotation().asRotationMatrix(), frame.getPosition());
 	return Polyhedron(std::move(newBuf), copy(triangles, triangleCount), vertexCount, triangleCount);
 }
 
 Polyhedron Polyhedron::globalToLocal(CFramef frame) const {
 	UniqueAlignedPointer<float> newBuf = createParallelVecBuf(this->vertexCount);
-	for (int i = 0; i < this->vertexCount; i++) {
-		setInBuf(newBuf, vertexCount, i, frame.globalToLocal((*this)[i]));
-	}
-
-	fixFinalBlock(newBuf.get(), this->vertexCount);
+	Mat3f inverseRotation = frame.getRotation().asRotationMatrix().transpose();
+	transformParallelVecBuf(this->vertices, newBuf, vertexCount, inverseRotation, -(inverseRotation * frame.getPosition()));
 	return Polyhedron(std::move(newBuf), copy(triangles, triangleCount), vertexCount, triangleCount);
 }
 Polyhedron Polyhedron::scaled(float scaleX, float scaleY, float scaleZ) const {
@@ -250,30 +299,160 @@ void Polyhedron::computeNormals(Vec3f* buffer) const {
 	}
 }
 
-//TODO parallelize
 bool Polyhedron::containsPoint(Vec3f point) const {
-	Vec3f ray(1, 0, 0);
-
-	bool isExiting = false;
-	double bestD = static_cast<double>(INFINITY);
+	return getNearestRayHit(point, Vec3f(1, 0, 0), 0.0f, 0.0f).isExiting;
+}
 
-	for(const Triangle& tri : iterTriangles()) {
-		RayIntersection<float> r = rayTriangleIntersection(point, ray, (*this)[tri.firstIndex], (*this)[tri.secondIndex], (*this)[tri.thirdIndex]);
-		if(r.d >= 0 && r.lineIntersectsTriangle()) {
-			if(r.d < bestD) {
-				bestD = r.d;
-				isExiting = (getNormalVecOfTriangle(tri) * ray >= 0);
-			}
+const TriangleBVH* Polyhedron::getTriangleBVH() const {
+	if(triangleCount < POLYHEDRON_BVH_MIN_TRIANGLES) return nullptr;
+
+	std::shared_ptr<const TriangleBVH> bvh = std::atomic_load(&triangleBVH);
+	if(bvh == nullptr) {
+		std::vector<Vec3f> vertexBuf(vertexCount);
+		std::vector<Triangle> triangleBuf(triangleCount);
+		getVertices(vertexBuf.data());
+		getTriangles(triangleBuf.data());
+		std::shared_ptr<const TriangleBVH> built = std::make_shared<const TriangleBVH>(vertexBuf.data(), triangleBuf.data(), triangleCount);
+		// another thread may have published its bvh in the meantime, that one is kept and ours is dropped
+		if(std::atomic_compare_exchange_strong(&triangleBVH, &bvh, built)) {
+			bvh = std::move(built);
 		}
 	}
+	// the polyhedron keeps its bvh alive until it is destroyed or reassigned
+	return bvh.get();
+}
 
-	return isExiting;
+/*
+	Möller–Trumbore, a is minus the dot product of direction with the unnormalized normal of the triangle
+*/
+inline static void testRayTriangle(Vec3f origin, Vec3f direction, Vec3f v0, Vec3f v1, Vec3f v2, float parallelEpsilon, float minDistance, float& bestDistance, bool& isExiting) {
+	Vec3f edge1 = v1 - v0;
+	Vec3f edge2 = v2 - v0;
+
+	Vec3f h = direction % edge2;
+	float a = edge1 * h;
+	if(std::abs(a) <= parallelEpsilon) return;
+
+	float f = 1.0f / a;
+	Vec3f s = origin - v0;
+	float u = f * (s * h);
+	if(u < 0.0f || u > 1.0f) return;
+
+	Vec3f q = s % edge1;
+	float v = f * (direction * q);
+	if(v < 0.0f || u + v > 1.0f) return;
+
+	float r = f * (edge2 * q);
+	if(r >= minDistance && r < bestDistance) {
+		bestDistance = r;
+		isExiting = a < 0.0f;
+	}
 }
 
+Polyhedron::RayHit Polyhedron::getNearestRayHit(Vec3f origin, Vec3f direction, float parallelEpsilon, float minDistance) const {
+	RayHit result{INFINITY, false};
 
+	const TriangleBVH* bvh = getTriangleBVH();
+	if(bvh != nullptr) {
+		bvh->forEachTriangleAlongRay(origin, direction, result.distance, [&](int triangleIndex) {
+			Triangle triangle = getTriangle(triangleIndex);
+			testRayTriangle(origin, direction, (*this)[triangle.firstIndex], (*this)[triangle.secondIndex], (*this)[triangle.thirdIndex], parallelEpsilon, minDistance, result.distance, result.isExiting);
+		});
+		return result;
+	}
+
+#ifdef __AVX__
+	size_t vertexOffset = getOffset(vertexCount);
+	const float* xValues = this->vertices;
+	const float* yValues = this->vertices + vertexOffset;
+	const float* zValues = this->vertices + 2 * vertexOffset;
+
+	size_t triangleOffset = getOffset(triangleCount);
+	const int* firstIndices = this->triangles;
+	const int* secondIndices = this->triangles + triangleOffset;
+	const int* thirdIndices = this->triangles + 2 * triangleOffset;
+
+	__m256 ox = _mm256_set1_ps(origin.x);
+	__m256 oy = _mm256_set1_ps(origin.y);
+	__m256 oz = _mm256_set1_ps(origin.z);
+	__m256 dx = _mm256_set1_ps(direction.x);
+	__m256 dy = _mm256_set1_ps(direction.y);
+	__m256 dz = _mm256_set1_ps(direction.z);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 epsilon = _mm256_set1_ps(parallelEpsilon);
+	__m256 minD = _mm256_set1_ps(minDistance);
+	__m256 signMask = _mm256_set1_ps(-0.0f);
+
+	__m256 bestDistance = _mm256_set1_ps(INFINITY);
+	__m256 bestIsExiting = zero;
+
+	// the final block is padded with copies of the last triangle, which do not change the result
+	for(size_t blockI = 0; blockI < triangleOffset / 8; blockI++) {
+		__m256i first = _mm256_load_si256(reinterpret_cast<const __m256i*>(firstIndices + blockI * 8));
+		__m256i second = _mm256_load_si256(reinterpret_cast<const __m256i*>(secondIndices + blockI * 8));
+		__m256i third = _mm256_load_si256(reinterpret_cast<const __m256i*>(thirdIndices + blockI * 8));
+
+		__m256 v0x = _mm256_i32gather_ps(xValues, first, 4);
+		__m256 v0y = _mm256_i32gather_ps(yValues, first, 4);
+		__m256 v0z = _mm256_i32gather_ps(zValues, first, 4);
+
+		__m256 e1x = _mm256_sub_ps(_mm256_i32gather_ps(xValues, second, 4), v0x);
+		__m256 e1y = _mm256_sub_ps(_mm256_i32gather_ps(yValues, second, 4), v0y);
+		__m256 e1z = _mm256_sub_ps(_mm256_i32gather_ps(zValues, second, 4), v0z);
+		__m256 e2x = _mm256_sub_ps(_mm256_i32gather_ps(xValues, third, 4), v0x);
+		__m256 e2y = _mm256_sub_ps(_mm256_i32gather_ps(yValues, third, 4), v0y);
+		__m256 e2z = _mm256_sub_ps(_mm256_i32gather_ps(zValues, third, 4), v0z);
+
+		// h = direction % edge2
+		__m256 hx = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+		__m256 hy = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+		__m256 hz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+		__m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, hx), _mm256_mul_ps(e1y, hy)), _mm256_mul_ps(e1z, hz));
+		__m256 f = _mm256_div_ps(one, a);
+
+		__m256 sx = _mm256_sub_ps(ox, v0x);
+		__m256 sy = _mm256_sub_ps(oy, v0y);
+		__m256 sz = _mm256_sub_ps(oz, v0z);
+		__m256 u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, hx), _mm256_mul_ps(sy, hy)), _mm256_mul_ps(sz, hz)));
+
+		// q = s % edge1
+		__m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+		__m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+		__m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+		__m256 v = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)));
+		__m256 r = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)));
+
+		// comparisons with NaN are false, so degenerate triangles never hit
+		__m256 hit = _mm256_cmp_ps(_mm256_andnot_ps(signMask, a), epsilon, _CMP_GT_OQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(r, minD, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(r, bestDistance, _CMP_LT_OQ));
+
+		bestDistance = _mm256_blendv_ps(bestDistance, r, hit);
+		bestIsExiting = _mm256_blendv_ps(bestIsExiting, _mm256_cmp_ps(a, zero, _CMP_LT_OQ), hit);
+	}
+
+	alignas(32) float distances[8];
+	_mm256_store_ps(distances, bestDistance);
+	int exitingMask = _mm256_movemask_ps(bestIsExiting);
+	for(int i = 0; i < 8; i++) {
+		if(distances[i] < result.distance) {
+			result.distance = distances[i];
+			result.isExiting = ((exitingMask >> i) & 1) != 0;
+		}
+	}
+#else
+	for(Triangle triangle : iterTriangles()) {
+		testRayTriangle(origin, direction, (*this)[triangle.firstIndex], (*this)[triangle.secondIndex], (*this)[triangle.thirdIndex], parallelEpsilon, minDistance, result.distance, result.isExiting);
+	}
+#endif
+	return result;
+}
 
 #ifdef __AVX__
-#include <immintrin.h>
 #if defined(_MSC_VER) && _MSC_VER == 1922
 inline static uint32_t __builtin_ctz(uint32_t x) {
 	unsigned long ret;
@@ -606,6 +785,63 @@ BoundingBox Polyhedron::getBounds(const Mat3f& referenceFrame) const {
 
 #endif
 
+int Polyhedron::furthestIndexInDirectionFrom(const Vec3f& direction, int startVertex, const VertexAdjacency& adjacency) const {
+	size_t offset = getOffset(vertexCount);
+	const float* xValues = this->vertices;
+	const float* yValues = this->vertices + offset;
+	const float* zValues = this->vertices + 2 * offset;
+
+	int current = (startVertex >= 0 && startVertex < vertexCount) ? startVertex : 0;
+	// a vertex that is on no triangle has no neighbours to climb to, only the full scan finds the furthest vertex from it
+	if(adjacency.offsets[current] == adjacency.offsets[current + 1]) {
+		return furthestIndexInDirection(direction);
+	}
+	float currentDot = xValues[current] * direction.x + yValues[current] * direction.y + zValues[current] * direction.z;
+
+	// steepest ascent, on a convex polyhedron every vertex that is not the furthest has a neighbour that is further
+	while(true) {
+		int best = current;
+		float bestDot = currentDot;
+		for(int i = adjacency.offsets[current]; i < adjacency.offsets[current + 1]; i++) {
+			int neighbour = adjacency.neighbours[i];
+			float dot = xValues[neighbour] * direction.x + yValues[neighbour] * direction.y + zValues[neighbour] * direction.z;
+			if(dot > bestDot) {
+				bestDot = dot;
+				best = neighbour;
+			}
+		}
+		if(best == current) return current;
+		current = best;
+		currentDot = bestDot;
+	}
+}
+
+VertexAdjacency Polyhedron::computeVertexAdjacency() const {
+	// both directions of every edge are added, so meshes that are not closed also get symmetric neighbour lists
+	std::vector<std::vector<int>> lists(vertexCount);
+	for(Triangle triangle : iterTriangles()) {
+		for(int i = 0; i < 3; i++) {
+			int from = triangle[i];
+			int to = triangle[(i + 1) % 3];
+			lists[from].push_back(to);
+			lists[to].push_back(from);
+		}
+	}
+
+	VertexAdjacency result;
+	result.offsets.resize(vertexCount + 1);
+	for(int i = 0; i < vertexCount; i++) {
+		std::vector<int>& list = lists[i];
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+		result.offsets[i] = static_cast<int>(result.neighbours.size());
+		result.neighbours.insert(result.neighbours.end(), list.begin(), list.end());
+	}
+	result.offsets[vertexCount] = static_cast<int>(result.neighbours.size());
+
+	return result;
+}
+
 double Polyhedron::getVolume() const {
 	double total = 0;
 	for (Triangle triangle : iterTriangles()) {
@@ -822,43 +1058,6 @@ void Polyhedron::getVertices(Vec3f* vertexBuf) const {
 
 float Polyhedron::getIntersectionDistance(Vec3f origin, Vec3f direction) const {
 	const float EPSILON = 0.0000001f;
-	float t = INFINITY;
-	for (Triangle triangle : iterTriangles()) {
-		Vec3f v0 = (*this)[triangle.firstIndex];
-		Vec3f v1 = (*this)[triangle.secondIndex];
-		Vec3f v2 = (*this)[triangle.thirdIndex];
-
-		Vec3f edge1, edge2, h, s, q;
-		float a, f, u, v;
-
-		edge1 = v1 - v0;
-		edge2 = v2 - v0;
-
-		h = direction % edge2;
-		a = edge1 * h;
-
-		if (a > -EPSILON && a < EPSILON) continue;   
-		
-		f = 1.0f / a;
-		s = origin - v0;
-		u = f * (s * h);
-
-		if (u < 0.0 || u > 1.0) continue;
-		
-		q = s % edge1;
-		v = direction * f * q;
-
-		if (v < 0.0f || u + v > 1.0f) continue;
-
-		float r = edge2 * f * q;
-		if (r > EPSILON) { 
-			if (r < t) t = r;
-		} else {
-			//Log::debug("Line intersection but not a ray intersection");
-			continue;
-		}
-	}
-
-	return t;
+	return getNearestRayHit(origin, direction, EPSILON, EPSILON).distance;
 }
 
@@ -11,6 +11,13 @@
 #include "scalableInertialMatrix.h"
 
 #include <utility>
+#include <vector>
+#include <memory>
+
+/*
+	Ray queries on polyhedra with at least this many triangles build a TriangleBVH on first use
+*/
+#define POLYHEDRON_BVH_MIN_TRIANGLES 256
 
 struct Triangle;
 class Polyhedron;
@@ -72,11 +79,39 @@ struct ShapeTriangleIter {
 
 class NormalizedPolyhedron;
 class Shape;
+class TriangleBVH;
+
+/*
+	The vertices connected to each vertex by an edge, the neighbours of vertex i are neighbours[offsets[i]] to neighbours[offsets[i+1]]
+*/
+struct VertexAdjacency {
+	std::vector<int> offsets;
+	std::vector<int> neighbours;
+
+	bool empty() const { return offsets.empty(); }
+};
 
 class Polyhedron : public GenericCollidable {
 	UniqueAlignedPointer<float> vertices;
 	UniqueAlignedPointer<int> triangles;
+	/*
+		Built lazily by getTriangleBVH, copies share it as they have the same triangles
+		Concurrent first queries may each build one, the first one published is kept and used by all of them
+	*/
+	mutable std::shared_ptr<const TriangleBVH> triangleBVH;
 	Polyhedron(UniqueAlignedPointer<float>&& vertices, UniqueAlignedPointer<int>&& triangles, int vertexCount, int triangleCount);
+
+	struct RayHit {
+		float distance;
+		// the ray leaves the polyhedron through the hit triangle
+		bool isExiting;
+	};
+	/*
+		The nearest hit of the ray origin + distance * direction with distance >= minDistance
+		Triangles for which |direction * (unnormalized normal)| is not above parallelEpsilon are skipped, distance is INFINITY if nothing is hit
+	*/
+	RayHit getNearestRayHit(Vec3f origin, Vec3f direction, float parallelEpsilon, float minDistance) const;
+	const TriangleBVH* getTriangleBVH() const;
 public:
 	int vertexCount;
 	int triangleCount;
@@ -124,6 +159,12 @@ public:
 
 	int furthestIndexInDirection(const Vec3f& direction) const;
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+	/*
+		Walks along the edges of adjacency from startVertex to the furthest vertex, only valid for convex polyhedra
+		startVertex may be any int, it is clamped to a valid vertex index
+	*/
+	int furthestIndexInDirectionFrom(const Vec3f& direction, int startVertex, const VertexAdjacency& adjacency) const;
+	VertexAdjacency computeVertexAdjacency() const;
 
 	Vec3f operator[](int index) const;
 
@@ -132,6 +173,17 @@ public:
 
 	Triangle getTriangle(int index) const;
 
+	/*
+		The raw vertex and triangle buffers, in the parallel layout described in polyhedronInternals.h
+		sizes are getOffset(vertexCount) * 3 and getOffset(triangleCount) * 3
+	*/
+	inline const float* getVertexBuffer() const { return vertices.get(); }
+	inline const int* getTriangleBuffer() const { return triangles.get(); }
+	/*
+		Takes ownership of vertex and triangle buffers which are already in the parallel layout, see polyhedronInternals.h
+	*/
+	static Polyhedron fromParallelBuffers(UniqueAlignedPointer<float>&& vertices, UniqueAlignedPointer<int>&& triangles, int vertexCount, int triangleCount);
+
 	IteratorFactory<ShapeVertexIter> iterVertices() const;
 	IteratorFactory<ShapeTriangleIter> iterTriangles() const;
 
@@ -52,3 +52,15 @@ void setInBuf(float* buf, size_t size, size_t index, const Vec3f& value) {
 	yValues[index] = value.y;
 	zValues[index] = value.z;
 }
+
+void setInBuf(int* buf, size_t size, size_t index, const Triangle& value) {
+	size_t offset = getOffset(size);
+
+	int* aValues = buf;
+	int* bValues = buf + offset;
+	int* cValues = buf + 2 * offset;
+
+	aValues[index] = value.firstIndex;
+	bValues[index] = value.secondIndex;
+	cValues[index] = value.thirdIndex;
+}
@@ -18,6 +18,7 @@ UniqueAlignedPointer<float> createAndFillParallelVecBuf(size_t size, const Vec3f
 UniqueAlignedPointer<int> createAndFillParallelTriangleBuf(size_t size, const Triangle* triangles);
 
 void setInBuf(float* buf, size_t size, size_t index, const Vec3f& value);
+void setInBuf(int* buf, size_t size, size_t index, const Triangle& value);
 
 template<typename T>
 UniqueAlignedPointer<T> copy(const UniqueAlignedPointer<T>& buf, size_t size) {
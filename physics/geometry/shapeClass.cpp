@@ -1,12 +1,19 @@
 #include "shapeClass.h"
 
 #include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 #include "basicShapes.h"
 #include "normalizedPolyhedron.h"
+#include "convexHull.h"
 #include "../misc/shapeLibrary.h"
 #include "../math/linalg/trigonometry.h"
 
@@ -109,15 +116,21 @@ struct SphereClass : public ShapeClass {
 	}
 
 	virtual Vec3f furthestInDirection(const Vec3f& direction) const {
-		double lenSq = lengthSquared(direction);
-		if(lenSq == 0.0) return Vec3f(1.0f, 0.0f, 0.0f);
-		return direction / sqrt(lenSq);
+		float lenSq = lengthSquared(direction);
+		if(lenSq == 0.0f) return Vec3f(1.0f, 0.0f, 0.0f);
+		return direction / std::sqrt(lenSq);
 	}
 
 	virtual Polyhedron asPolyhedron() const {
 		return Library::createSphere(1.0, 3);
 	}
 
+	virtual bool getCore(const DiagonalMat3& scale, ShapeCore& core) const override {
+		if(scale[0] != scale[1] || scale[0] != scale[2]) return false;
+		core = ShapeCore{0.0, scale[0]};
+		return true;
+	}
+
 	void setScaleX(double newX, DiagonalMat3& scale) const override {
 		scale[0] = newX;
 		scale[1] = newX;
@@ -235,6 +248,124 @@ struct CylinderClass : public ShapeClass {
 	}
 };
 
+double CapsuleClass::getVolume(double c) {
+	double L = 1.0 - c;
+	return 2.0 * M_PI * L + 4.0 / 3.0 * M_PI * c;
+}
+/*
+	Second moments of the cylinder between the cores and of both half ellipsoids shifted to the ends of the core
+*/
+ScalableInertialMatrix CapsuleClass::getInertia(double c) {
+	double L = 1.0 - c;
+	double xx = M_PI * L / 2.0 + 4.0 / 15.0 * M_PI * c;
+	double zz = 2.0 / 3.0 * M_PI * L * L * L + 4.0 / 3.0 * M_PI * c * L * L + M_PI * L * c * c + 4.0 / 15.0 * M_PI * c * c * c;
+	return ScalableInertialMatrix(Vec3(xx, xx, zz), Vec3(0, 0, 0));
+}
+
+CapsuleClass::CapsuleClass(double capRatio) : ShapeClass(getVolume(capRatio), Vec3(0, 0, 0), getInertia(capRatio), CAPSULE_CLASS_ID), capRatio(capRatio), coreHalfLength(1.0 - capRatio) {}
+
+bool CapsuleClass::containsPoint(Vec3 point) const {
+	double coreZ = std::max(-coreHalfLength, std::min(coreHalfLength, point.z));
+	double z = (point.z - coreZ) / capRatio;
+	return point.x * point.x + point.y * point.y + z * z <= 1.0;
+}
+
+double CapsuleClass::getIntersectionDistance(Vec3 origin, Vec3 direction) const {
+	// stretched along z so the caps become spheres of radius 1, distances along the ray do not change
+	origin.z /= capRatio;
+	direction.z /= capRatio;
+	double coreZ = coreHalfLength / capRatio;
+
+	// the entry into the capsule is the first entry into the round side or either sphere, pieces entirely behind the ray are skipped
+	double best = INFINITY;
+	double a = direction.x * direction.x + direction.y * direction.y;
+	if(a > 0.0) {
+		double b = origin.x * direction.x + origin.y * direction.y;
+		double c = origin.x * origin.x + origin.y * origin.y - 1.0;
+		double D = b * b - a * c;
+		if(D >= 0.0 && (-b + sqrt(D)) / a >= 0.0) {
+			double t = (-b - sqrt(D)) / a;
+			if(abs(origin.z + t * direction.z) <= coreZ) best = t;
+		}
+	}
+	for(double sphereZ : {-coreZ, coreZ}) {
+		Vec3 relativeOrigin(origin.x, origin.y, origin.z - sphereZ);
+		double a = direction * direction;
+		double b = relativeOrigin * direction;
+		double c = relativeOrigin * relativeOrigin - 1.0;
+		double D = b * b - a * c;
+		if(D >= 0.0 && (-b + sqrt(D)) / a >= 0.0) {
+			best = std::min(best, (-b - sqrt(D)) / a);
+		}
+	}
+	return best;
+}
+
+BoundingBox CapsuleClass::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	Mat3 rotationMatrix = rotation.asRotationMatrix();
+	Vec3 axes[3]{rotationMatrix.getCol(0) * scale[0], rotationMatrix.getCol(1) * scale[1], rotationMatrix.getCol(2) * (scale[2] * capRatio)};
+	Vec3 core = abs(rotationMatrix.getCol(2)) * (scale[2] * coreHalfLength);
+	Vec3 extent;
+	for(int i = 0; i < 3; i++) {
+		extent[i] = sqrt(axes[0][i] * axes[0][i] + axes[1][i] * axes[1][i] + axes[2][i] * axes[2][i]) + core[i];
+	}
+	return BoundingBox{-extent.x, -extent.y, -extent.z, extent.x, extent.y, extent.z};
+}
+
+double CapsuleClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
+	double radius = scale[2] * coreHalfLength + std::max(std::max(scale[0], scale[1]), scale[2] * capRatio);
+	return radius * radius;
+}
+
+Vec3f CapsuleClass::furthestInDirection(const Vec3f& direction) const {
+	float c = static_cast<float>(capRatio);
+	float coreZ = (direction.z >= 0.0f) ? static_cast<float>(coreHalfLength) : -static_cast<float>(coreHalfLength);
+	Vec3f stretched(direction.x, direction.y, direction.z * c);
+	float lenSq = lengthSquared(stretched);
+	if(lenSq == 0.0f) return Vec3f(1.0f, 0.0f, coreZ);
+	float inverseLength = 1.0f / std::sqrt(lenSq);
+	return Vec3f(stretched.x * inverseLength, stretched.y * inverseLength, stretched.z * c * inverseLength + coreZ);
+}
+
+Polyhedron CapsuleClass::asPolyhedron() const {
+	// rings of both half ellipsoids, the equators of both are included so the round side is a prism
+	const int sides = 32;
+	const int rings = 8;
+	std::vector<Vec3f> points;
+	for(int end = -1; end <= 1; end += 2) {
+		for(int ring = 0; ring <= rings; ring++) {
+			double angle = M_PI / 2 * ring / rings;
+			double z = end * (coreHalfLength + capRatio * sin(angle));
+			double radius = cos(angle);
+			if(ring == rings) {
+				points.push_back(Vec3f(0.0f, 0.0f, static_cast<float>(z)));
+				break;
+			}
+			for(int side = 0; side < sides; side++) {
+				double sideAngle = 2 * M_PI * side / sides;
+				points.push_back(Vec3f(static_cast<float>(radius * cos(sideAngle)), static_cast<float>(radius * sin(sideAngle)), static_cast<float>(z)));
+			}
+		}
+	}
+	return buildConvexHull(points.data(), points.size());
+}
+
+bool CapsuleClass::getCore(const DiagonalMat3& scale, ShapeCore& core) const {
+	double radius = scale[0];
+	if(scale[1] != radius || abs(scale[2] * capRatio - radius) > radius * 1e-9) return false;
+	core = ShapeCore{scale[2] * coreHalfLength, radius};
+	return true;
+}
+
+void CapsuleClass::setScaleX(double newX, DiagonalMat3& scale) const {
+	scale[0] = newX;
+	scale[1] = newX;
+}
+void CapsuleClass::setScaleY(double newY, DiagonalMat3& scale) const {
+	scale[0] = newY;
+	scale[1] = newY;
+}
+
 static const CubeClass box;
 static const SphereClass sphere;
 static const CylinderClass cylinder;
@@ -279,6 +410,18 @@ Shape Box(double width, double height, double depth) {
 	return Shape(&box, width, height, depth);
 }
 
+Shape Capsule(double radius, double height) {
+	assert(height >= 2 * radius);
+	double capRatio = 2 * radius / height;
+
+	static std::mutex capsuleClassesLock;
+	static std::map<double, std::unique_ptr<CapsuleClass>> capsuleClasses;
+	std::lock_guard<std::mutex> lock(capsuleClassesLock);
+	std::unique_ptr<CapsuleClass>& capsuleClass = capsuleClasses[capRatio];
+	if(!capsuleClass) capsuleClass = std::make_unique<CapsuleClass>(capRatio);
+	return Shape(capsuleClass.get(), radius * 2, radius * 2, height);
+}
+
 /*Shape Wedge(double width, double height, double depth) {
 
 }*/
@@ -10,9 +10,22 @@
 #define CUBE_CLASS_ID 0
 #define SPHERE_CLASS_ID 1
 #define CYLINDER_CLASS_ID 2
+#define CAPSULE_CLASS_ID 3
 #define CONVEX_POLYHEDRON_CLASS_ID 10
+#define HEIGHTFIELD_CLASS_ID 20
+#define TRIANGLE_MESH_CLASS_ID 21
 class Polyhedron;
 
+/*
+	Describes a shape that is a point or a segment along z, grown by radius, both in the scaled space of the shape
+	Intersections with such shapes run GJK on the core only and add the radius afterwards, see intersectsTransformed
+*/
+struct ShapeCore {
+	// half the length of the segment, 0 for a point
+	double halfLength;
+	double radius;
+};
+
 // a ShapeClass is defined as a shape with dimentions -1..1 in all axes. All functions work on scaled versions of the shape. 
 // examples include: 
 //    Sphere of radius=1
@@ -26,6 +39,11 @@ public:
 	const int intersectionClassID;
 
 	ShapeClass(double volume, Vec3 centerOfMass, ScalableInertialMatrix inertia, int intersectionClassID);
+	// ShapeClasses built while loading a world are deleted through ShapeClass* when loading fails
+	virtual ~ShapeClass() = default;
+
+	// triangle shapes are not convex, they derive from TriangleShapeClass and are tested per triangle
+	inline bool isTriangleShape() const { return intersectionClassID == HEIGHTFIELD_CLASS_ID || intersectionClassID == TRIANGLE_MESH_CLASS_ID; }
 
 	virtual bool containsPoint(Vec3 point) const = 0;
 	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const = 0;
@@ -43,6 +61,12 @@ public:
 
 	virtual Polyhedron asPolyhedron() const = 0;
 
+	/*
+		Returns true if the shape scaled by scale is exactly a ShapeCore, which is then written to core
+		Shapes that are not, or are no longer after a non uniform scale, return false
+	*/
+	virtual bool getCore(const DiagonalMat3& scale, ShapeCore& core) const { return false; }
+
 	// these functions determine the relations between the axes, for example, for Sphere, all axes must be equal
 	virtual void setScaleX(double newX, DiagonalMat3& scale) const;
 	virtual void setScaleY(double newY, DiagonalMat3& scale) const;
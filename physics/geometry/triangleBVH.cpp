@@ -0,0 +1,62 @@
+#include "triangleBVH.h"
+
+TriangleBVH::TriangleBVH(const Vec3f* vertices, const Triangle* triangles, int triangleCount) : triangleOrder(triangleCount) {
+	if(triangleCount == 0) return;
+
+	std::vector<Vec3f> centers(triangleCount);
+	std::vector<Vec3f> mins(triangleCount);
+	std::vector<Vec3f> maxs(triangleCount);
+	for(int i = 0; i < triangleCount; i++) {
+		const Vec3f& a = vertices[triangles[i][0]];
+		const Vec3f& b = vertices[triangles[i][1]];
+		const Vec3f& c = vertices[triangles[i][2]];
+		mins[i] = Vec3f(std::min(a.x, std::min(b.x, c.x)), std::min(a.y, std::min(b.y, c.y)), std::min(a.z, std::min(b.z, c.z)));
+		maxs[i] = Vec3f(std::max(a.x, std::max(b.x, c.x)), std::max(a.y, std::max(b.y, c.y)), std::max(a.z, std::max(b.z, c.z)));
+		centers[i] = (a + b + c) / 3.0f;
+		triangleOrder[i] = i;
+	}
+
+	nodes.reserve(2 * (triangleCount / TRIANGLE_BVH_LEAF_SIZE + 1));
+	nodes.push_back(Node());
+	build(0, 0, triangleCount, centers, mins, maxs);
+	nodes.shrink_to_fit();
+}
+
+void TriangleBVH::build(int nodeIndex, int begin, int end, const std::vector<Vec3f>& centers, const std::vector<Vec3f>& mins, const std::vector<Vec3f>& maxs) {
+	Vec3f min = mins[triangleOrder[begin]];
+	Vec3f max = maxs[triangleOrder[begin]];
+	Vec3f centerMin = centers[triangleOrder[begin]];
+	Vec3f centerMax = centerMin;
+	for(int i = begin + 1; i < end; i++) {
+		int triangle = triangleOrder[i];
+		for(int axis = 0; axis < 3; axis++) {
+			min[axis] = std::min(min[axis], mins[triangle][axis]);
+			max[axis] = std::max(max[axis], maxs[triangle][axis]);
+			centerMin[axis] = std::min(centerMin[axis], centers[triangle][axis]);
+			centerMax[axis] = std::max(centerMax[axis], centers[triangle][axis]);
+		}
+	}
+	nodes[nodeIndex].min = min;
+	nodes[nodeIndex].max = max;
+
+	if(end - begin <= TRIANGLE_BVH_LEAF_SIZE) {
+		nodes[nodeIndex].first = begin;
+		nodes[nodeIndex].count = end - begin;
+		return;
+	}
+
+	Vec3f centerSize = centerMax - centerMin;
+	int axis = (centerSize.x > centerSize.y) ? (centerSize.x > centerSize.z ? 0 : 2) : (centerSize.y > centerSize.z ? 1 : 2);
+	int middle = (begin + end) / 2;
+	std::nth_element(triangleOrder.begin() + begin, triangleOrder.begin() + middle, triangleOrder.begin() + end, [&centers, axis](int first, int second) {
+		return centers[first][axis] < centers[second][axis];
+	});
+
+	int firstChild = static_cast<int>(nodes.size());
+	nodes[nodeIndex].first = firstChild;
+	nodes[nodeIndex].count = 0;
+	nodes.push_back(Node());
+	nodes.push_back(Node());
+	build(firstChild, begin, middle, centers, mins, maxs);
+	build(firstChild + 1, middle, end, centers, mins, maxs);
+}
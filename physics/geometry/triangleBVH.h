@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+
+#include "../math/linalg/vec.h"
+#include "polyhedron.h"
+
+/*
+	Leaves of a TriangleBVH hold at most this many triangles
+*/
+#define TRIANGLE_BVH_LEAF_SIZE 4
+
+/*
+	Bounding volume hierarchy over the triangles of a static mesh, stored as a flat array of nodes
+	Nodes are split at the median along their longest axis, so the depth stays logarithmic in the triangle count
+	Every node covers a contiguous range of the reordered triangle indices
+*/
+class TriangleBVH {
+	struct Node {
+		Vec3f min;
+		Vec3f max;
+		// leaf: first index into triangleOrder, inner node: index of the first child, the second child directly follows it
+		int first;
+		// 0 for inner nodes
+		int count;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<int> triangleOrder;
+
+	void build(int nodeIndex, int begin, int end, const std::vector<Vec3f>& centers, const std::vector<Vec3f>& mins, const std::vector<Vec3f>& maxs);
+
+	static bool intersectsBox(const Node& node, const Vec3f& min, const Vec3f& max) {
+		return node.min.x <= max.x && node.max.x >= min.x &&
+			node.min.y <= max.y && node.max.y >= min.y &&
+			node.min.z <= max.z && node.max.z >= min.z;
+	}
+
+	// the distance along the ray at which it enters the node, or INFINITY if it misses it before maxDistance
+	static float rayEntryDistance(const Node& node, const Vec3f& origin, const Vec3f& inverseDirection, float maxDistance) {
+		float entry = 0.0f;
+		float exit = maxDistance;
+		for(int axis = 0; axis < 3; axis++) {
+			float t1 = (node.min[axis] - origin[axis]) * inverseDirection[axis];
+			float t2 = (node.max[axis] - origin[axis]) * inverseDirection[axis];
+			entry = std::max(entry, std::min(t1, t2));
+			exit = std::min(exit, std::max(t1, t2));
+		}
+		return (entry <= exit) ? entry : INFINITY;
+	}
+
+public:
+	TriangleBVH() = default;
+	TriangleBVH(const Vec3f* vertices, const Triangle* triangles, int triangleCount);
+
+	bool empty() const { return nodes.empty(); }
+	size_t getMemoryUsage() const { return nodes.capacity() * sizeof(Node) + triangleOrder.capacity() * sizeof(int); }
+
+	/*
+		Calls func(int triangleIndex) for every triangle whose bounds overlap the box from min to max
+	*/
+	template<typename Func>
+	void forEachTriangleInBounds(const Vec3f& min, const Vec3f& max, const Func& func) const {
+		if(nodes.empty()) return;
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while(stackSize > 0) {
+			const Node& node = nodes[stack[--stackSize]];
+			if(!intersectsBox(node, min, max)) continue;
+			if(node.count != 0) {
+				for(int i = node.first; i < node.first + node.count; i++) {
+					func(triangleOrder[i]);
+				}
+			} else {
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+	}
+
+	/*
+		Calls func(int triangleIndex) for every triangle whose bounds the ray origin + t * direction enters before maxDistance
+		func may lower maxDistance to skip everything further away, nearer nodes are visited first
+	*/
+	template<typename Func>
+	void forEachTriangleAlongRay(const Vec3f& origin, const Vec3f& direction, float& maxDistance, const Func& func) const {
+		if(nodes.empty()) return;
+		Vec3f inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+		struct Entry { int node; float distance; };
+		Entry stack[64];
+		int stackSize = 0;
+		float rootDistance = rayEntryDistance(nodes[0], origin, inverseDirection, maxDistance);
+		if(rootDistance == INFINITY) return;
+		stack[stackSize++] = Entry{0, rootDistance};
+		while(stackSize > 0) {
+			Entry entry = stack[--stackSize];
+			if(entry.distance > maxDistance) continue;
+			const Node& node = nodes[entry.node];
+			if(node.count != 0) {
+				for(int i = node.first; i < node.first + node.count; i++) {
+					func(triangleOrder[i]);
+				}
+			} else {
+				float firstDistance = rayEntryDistance(nodes[node.first], origin, inverseDirection, maxDistance);
+				float secondDistance = rayEntryDistance(nodes[node.first + 1], origin, inverseDirection, maxDistance);
+				Entry first{node.first, firstDistance};
+				Entry second{node.first + 1, secondDistance};
+				if(firstDistance < secondDistance) std::swap(first, second);
+				// the nearer child is pushed last so it is visited first
+				if(first.distance != INFINITY) stack[stackSize++] = first;
+				if(second.distance != INFINITY) stack[stackSize++] = second;
+			}
+		}
+	}
+};
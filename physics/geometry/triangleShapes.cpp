@@ -0,0 +1,333 @@
+#include "triangleShapes.h"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../math/utils.h"
+
+// flat shapes still get this fraction of their largest extent as thickness, the normalization must not divide by 0
+#define MIN_RELATIVE_THICKNESS 0.0001
+
+static double getHalfExtent(double extent, double largestExtent) {
+	return std::max(extent, largestExtent * MIN_RELATIVE_THICKNESS) / 2;
+}
+
+static bool rayHitsBox(const Vec3f& min, const Vec3f& max, const Vec3f& origin, const Vec3f& inverseDirection, float maxDistance) {
+	float entry = 0.0f;
+	float exit = maxDistance;
+	for(int axis = 0; axis < 3; axis++) {
+		float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+		float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+		entry = std::max(entry, std::min(t1, t2));
+		exit = std::min(exit, std::max(t1, t2));
+	}
+	return entry <= exit;
+}
+
+#pragma region TriangleShapeClass
+
+TriangleShapeClass::TriangleShapeClass(int intersectionClassID) :
+	ShapeClass(8, Vec3(0, 0, 0), ScalableInertialMatrix(Vec3(8.0 / 3.0, 8.0 / 3.0, 8.0 / 3.0), Vec3(0, 0, 0)), intersectionClassID) {}
+
+BoundingBox TriangleShapeClass::getBounds(const Rotation& rotation, const DiagonalMat3& scale) const {
+	Mat3 referenceFrame = rotation.asRotationMatrix() * scale;
+	double x = std::abs(referenceFrame[0][0]) + std::abs(referenceFrame[0][1]) + std::abs(referenceFrame[0][2]);
+	double y = std::abs(referenceFrame[1][0]) + std::abs(referenceFrame[1][1]) + std::abs(referenceFrame[1][2]);
+	double z = std::abs(referenceFrame[2][0]) + std::abs(referenceFrame[2][1]) + std::abs(referenceFrame[2][2]);
+	return BoundingBox{-x, -y, -z, x, y, z};
+}
+
+double TriangleShapeClass::getScaledMaxRadiusSq(DiagonalMat3 scale) const {
+	return scale[0] * scale[0] + scale[1] * scale[1] + scale[2] * scale[2];
+}
+
+Vec3f TriangleShapeClass::furthestInDirection(const Vec3f& direction) const {
+	return Vec3f(direction.x < 0 ? -1.0f : 1.0f, direction.y < 0 ? -1.0f : 1.0f, direction.z < 0 ? -1.0f : 1.0f);
+}
+
+#pragma endregion
+
+#pragma region HeightfieldShapeClass
+
+static Vec3 getHeightfieldCenter(const float* heights, int sampleCount) {
+	auto range = std::minmax_element(heights, heights + sampleCount);
+	return Vec3(0.0, (*range.first + *range.second) / 2.0, 0.0);
+}
+
+static DiagonalMat3 getHeightfieldScale(const float* heights, int sampleCount, double width, double depth) {
+	auto range = std::minmax_element(heights, heights + sampleCount);
+	double largest = std::max(width, depth);
+	return DiagonalMat3{getHalfExtent(width, largest), getHalfExtent(*range.second - *range.first, largest), getHalfExtent(depth, largest)};
+}
+
+HeightfieldShapeClass::HeightfieldShapeClass(const float* heights, int sampleCountX, int sampleCountZ, double width, double depth) :
+	TriangleShapeClass(HEIGHTFIELD_CLASS_ID),
+	sampleCountX(sampleCountX),
+	sampleCountZ(sampleCountZ),
+	originalCenter((sampleCountX >= 2 && sampleCountZ >= 2) ? getHeightfieldCenter(heights, sampleCountX * sampleCountZ) : Vec3()),
+	originalScale((sampleCountX >= 2 && sampleCountZ >= 2) ? getHeightfieldScale(heights, sampleCountX * sampleCountZ, width, depth) : DiagonalMat3{1, 1, 1}) {
+
+	if(sampleCountX < 2 || sampleCountZ < 2) {
+		throw std::invalid_argument("A heightfield needs at least 2 samples along both axes");
+	}
+
+	this->heights.resize(sampleCountX * sampleCountZ);
+	for(int i = 0; i < sampleCountX * sampleCountZ; i++) {
+		this->heights[i] = static_cast<float>((heights[i] - originalCenter.y) / originalScale[1]);
+	}
+
+	Level cells{sampleCountX - 1, sampleCountZ - 1, std::vector<HeightRange>((sampleCountX - 1) * (sampleCountZ - 1))};
+	for(int z = 0; z < cells.cellCountZ; z++) {
+		for(int x = 0; x < cells.cellCountX; x++) {
+			float corners[4]{getHeight(x, z), getHeight(x + 1, z), getHeight(x, z + 1), getHeight(x + 1, z + 1)};
+			cells.ranges[x + z * cells.cellCountX] = HeightRange{*std::min_element(corners, corners + 4), *std::max_element(corners, corners + 4)};
+		}
+	}
+	levels.push_back(std::move(cells));
+
+	while(levels.back().cellCountX > 1 || levels.back().cellCountZ > 1) {
+		const Level& previous = levels.back();
+		int nextCountX = (previous.cellCountX + 1) / 2;
+		int nextCountZ = (previous.cellCountZ + 1) / 2;
+		Level next{nextCountX, nextCountZ, std::vector<HeightRange>(nextCountX * nextCountZ, HeightRange{INFINITY, -INFINITY})};
+		for(int z = 0; z < previous.cellCountZ; z++) {
+			for(int x = 0; x < previous.cellCountX; x++) {
+				const HeightRange& child = previous.ranges[x + z * previous.cellCountX];
+				HeightRange& parent = next.ranges[x / 2 + z / 2 * next.cellCountX];
+				parent.min = std::min(parent.min, child.min);
+				parent.max = std::max(parent.max, child.max);
+			}
+		}
+		levels.push_back(std::move(next));
+	}
+}
+
+void HeightfieldShapeClass::getCellTriangles(int x, int z, TriangleCollidable& first, TriangleCollidable& second) const {
+	Vec3f p00 = getSample(x, z);
+	Vec3f p10 = getSample(x + 1, z);
+	Vec3f p01 = getSample(x, z + 1);
+	Vec3f p11 = getSample(x + 1, z + 1);
+	// both counterclockwise seen from above
+	first = TriangleCollidable(p00, p01, p10);
+	second = TriangleCollidable(p10, p01, p11);
+}
+
+void HeightfieldShapeClass::collectTriangles(int level, int blockX, int blockZ, const BoundingBox& bounds, int minCellX, int maxCellX, int minCellZ, int maxCellZ, std::vector<TriangleCollidable>& result) const {
+	if((blockX + 1) << level <= minCellX || blockX << level > maxCellX) return;
+	if((blockZ + 1) << level <= minCellZ || blockZ << level > maxCellZ) return;
+	const Level& current = levels[level];
+	const HeightRange& range = current.ranges[blockX + blockZ * current.cellCountX];
+	if(range.max < bounds.ymin || range.min > bounds.ymax) return;
+
+	if(level == 0) {
+		TriangleCollidable first;
+		TriangleCollidable second;
+		getCellTriangles(blockX, blockZ, first, second);
+		result.push_back(first);
+		result.push_back(second);
+		return;
+	}
+	const Level& children = levels[level - 1];
+	for(int z = blockZ * 2; z < std::min(blockZ * 2 + 2, children.cellCountZ); z++) {
+		for(int x = blockX * 2; x < std::min(blockX * 2 + 2, children.cellCountX); x++) {
+			collectTriangles(level - 1, x, z, bounds, minCellX, maxCellX, minCellZ, maxCellZ, result);
+		}
+	}
+}
+
+void HeightfieldShapeClass::getTrianglesInBounds(const BoundingBox& bounds, std::vector<TriangleCollidable>& result) const {
+	if(bounds.xmax < -1.0 || bounds.xmin > 1.0 || bounds.zmax < -1.0 || bounds.zmin > 1.0) return;
+	int cellCountX = sampleCountX - 1;
+	int cellCountZ = sampleCountZ - 1;
+	int minCellX = std::clamp(static_cast<int>(std::floor((bounds.xmin + 1.0) / 2.0 * cellCountX)), 0, cellCountX - 1);
+	int maxCellX = std::clamp(static_cast<int>(std::floor((bounds.xmax + 1.0) / 2.0 * cellCountX)), 0, cellCountX - 1);
+	int minCellZ = std::clamp(static_cast<int>(std::floor((bounds.zmin + 1.0) / 2.0 * cellCountZ)), 0, cellCountZ - 1);
+	int maxCellZ = std::clamp(static_cast<int>(std::floor((bounds.zmax + 1.0) / 2.0 * cellCountZ)), 0, cellCountZ - 1);
+	collectTriangles(static_cast<int>(levels.size() - 1), 0, 0, bounds, minCellX, maxCellX, minCellZ, maxCellZ, result);
+}
+
+void HeightfieldShapeClass::intersectRay(int level, int blockX, int blockZ, const Vec3f& origin, const Vec3f& direction, const Vec3f& inverseDirection, float& bestDistance) const {
+	const Level& current = levels[level];
+	const HeightRange& range = current.ranges[blockX + blockZ * current.cellCountX];
+	int firstCellX = blockX << level;
+	int firstCellZ = blockZ << level;
+	int endCellX = std::min((blockX + 1) << level, sampleCountX - 1);
+	int endCellZ = std::min((blockZ + 1) << level, sampleCountZ - 1);
+	Vec3f min(getSample(firstCellX, 0).x, range.min, getSample(0, firstCellZ).z);
+	Vec3f max(getSample(endCellX, 0).x, range.max, getSample(0, endCellZ).z);
+	if(!rayHitsBox(min, max, origin, inverseDirection, bestDistance)) return;
+
+	if(level == 0) {
+		TriangleCollidable triangles[2];
+		getCellTriangles(blockX, blockZ, triangles[0], triangles[1]);
+		for(const TriangleCollidable& triangle : triangles) {
+			RayIntersection<float> hit = rayTriangleIntersection(origin, direction, triangle.corners[0], triangle.corners[1], triangle.corners[2]);
+			if(hit.rayIntersectsTriangle() && hit.d < bestDistance) {
+				bestDistance = hit.d;
+			}
+		}
+		return;
+	}
+	const Level& children = levels[level - 1];
+	for(int z = blockZ * 2; z < std::min(blockZ * 2 + 2, children.cellCountZ); z++) {
+		for(int x = blockX * 2; x < std::min(blockX * 2 + 2, children.cellCountX); x++) {
+			intersectRay(level - 1, x, z, origin, direction, inverseDirection, bestDistance);
+		}
+	}
+}
+
+double HeightfieldShapeClass::getIntersectionDistance(Vec3 origin, Vec3 direction) const {
+	Vec3f originf(origin);
+	Vec3f directionf(direction);
+	Vec3f inverseDirection(1.0f / directionf.x, 1.0f / directionf.y, 1.0f / directionf.z);
+	float bestDistance = INFINITY;
+	intersectRay(static_cast<int>(levels.size() - 1), 0, 0, originf, directionf, inverseDirection, bestDistance);
+	return bestDistance;
+}
+
+bool HeightfieldShapeClass::containsPoint(Vec3 point) const {
+	if(std::abs(point.x) > 1.0 || std::abs(point.z) > 1.0 || point.y < -1.0) return false;
+	double cellX = (point.x + 1.0) / 2.0 * (sampleCountX - 1);
+	double cellZ = (point.z + 1.0) / 2.0 * (sampleCountZ - 1);
+	int x = std::min(static_cast<int>(cellX), sampleCountX - 2);
+	int z = std::min(static_cast<int>(cellZ), sampleCountZ - 2);
+	double u = cellX - x;
+	double v = cellZ - z;
+	double height;
+	if(u + v <= 1.0) {
+		height = getHeight(x, z) + u * (getHeight(x + 1, z) - getHeight(x, z)) + v * (getHeight(x, z + 1) - getHeight(x, z));
+	} else {
+		height = getHeight(x + 1, z + 1) + (1.0 - u) * (getHeight(x, z + 1) - getHeight(x + 1, z + 1)) + (1.0 - v) * (getHeight(x + 1, z) - getHeight(x + 1, z + 1));
+	}
+	return point.y <= height;
+}
+
+Polyhedron HeightfieldShapeClass::asPolyhedron() const {
+	std::vector<Vec3f> vertices;
+	vertices.reserve(sampleCountX * sampleCountZ);
+	for(int z = 0; z < sampleCountZ; z++) {
+		for(int x = 0; x < sampleCountX; x++) {
+			vertices.push_back(getSample(x, z));
+		}
+	}
+	std::vector<Triangle> triangles;
+	triangles.reserve(2 * (sampleCountX - 1) * (sampleCountZ - 1));
+	for(int z = 0; z < sampleCountZ - 1; z++) {
+		for(int x = 0; x < sampleCountX - 1; x++) {
+			int p00 = x + z * sampleCountX;
+			int p10 = p00 + 1;
+			int p01 = p00 + sampleCountX;
+			int p11 = p01 + 1;
+			triangles.push_back(Triangle{p00, p01, p10});
+			triangles.push_back(Triangle{p10, p01, p11});
+		}
+	}
+	return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+}
+
+size_t HeightfieldShapeClass::getMemoryUsage() const {
+	size_t total = heights.capacity() * sizeof(float) + levels.capacity() * sizeof(Level);
+	for(const Level& level : levels) {
+		total += level.ranges.capacity() * sizeof(HeightRange);
+	}
+	return total;
+}
+
+#pragma endregion
+
+#pragma region TriangleMeshShapeClass
+
+static BoundingBox getMeshBounds(const Vec3f* vertices, int vertexCount) {
+	BoundingBox result(vertices[0], vertices[0]);
+	for(int i = 1; i < vertexCount; i++) {
+		for(int axis = 0; axis < 3; axis++) {
+			result.min[axis] = std::min(result.min[axis], static_cast<double>(vertices[i][axis]));
+			result.max[axis] = std::max(result.max[axis], static_cast<double>(vertices[i][axis]));
+		}
+	}
+	return result;
+}
+
+static DiagonalMat3 getMeshScale(const BoundingBox& bounds) {
+	double largest = std::max(bounds.getWidth(), std::max(bounds.getHeight(), bounds.getDepth()));
+	return DiagonalMat3{getHalfExtent(bounds.getWidth(), largest), getHalfExtent(bounds.getHeight(), largest), getHalfExtent(bounds.getDepth(), largest)};
+}
+
+// the members are initialized before originalCenter and originalScale, so these are computed again
+static std::vector<Vec3f> getNormalizedVertices(const Vec3f* vertices, int vertexCount) {
+	if(vertexCount == 0) return std::vector<Vec3f>();
+	BoundingBox bounds = getMeshBounds(vertices, vertexCount);
+	Vec3 center = bounds.getCenter();
+	DiagonalMat3 scale = getMeshScale(bounds);
+	std::vector<Vec3f> result(vertexCount);
+	for(int i = 0; i < vertexCount; i++) {
+		result[i] = Vec3f(~scale * (Vec3(vertices[i]) - center));
+	}
+	return result;
+}
+
+TriangleMeshShapeClass::TriangleMeshShapeClass(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount) :
+	TriangleShapeClass(TRIANGLE_MESH_CLASS_ID),
+	vertices(getNormalizedVertices(vertices, vertexCount)),
+	triangles(triangles, triangles + triangleCount),
+	bvh(this->vertices.data(), triangles, triangleCount),
+	originalCenter((vertexCount > 0) ? getMeshBounds(vertices, vertexCount).getCenter() : Vec3()),
+	originalScale((vertexCount > 0) ? getMeshScale(getMeshBounds(vertices, vertexCount)) : DiagonalMat3{1, 1, 1}) {
+
+	if(vertexCount == 0 || triangleCount == 0) {
+		throw std::invalid_argument("A triangle mesh needs at least one triangle");
+	}
+}
+
+void TriangleMeshShapeClass::getTrianglesInBounds(const BoundingBox& bounds, std::vector<TriangleCollidable>& result) const {
+	bvh.forEachTriangleInBounds(Vec3f(bounds.min), Vec3f(bounds.max), [this, &result](int triangle) {
+		const Triangle& t = triangles[triangle];
+		result.push_back(TriangleCollidable(vertices[t[0]], vertices[t[1]], vertices[t[2]]));
+	});
+}
+
+float TriangleMeshShapeClass::getNearestHit(const Vec3f& origin, const Vec3f& direction, bool& isExiting) const {
+	float bestDistance = INFINITY;
+	isExiting = false;
+	bvh.forEachTriangleAlongRay(origin, direction, bestDistance, [&](int triangle) {
+		const Triangle& t = triangles[triangle];
+		RayIntersection<float> hit = rayTriangleIntersection(origin, direction, vertices[t[0]], vertices[t[1]], vertices[t[2]]);
+		if(hit.rayIntersectsTriangle() && hit.d < bestDistance) {
+			bestDistance = hit.d;
+			isExiting = ((vertices[t[1]] - vertices[t[0]]) % (vertices[t[2]] - vertices[t[0]])) * direction >= 0;
+		}
+	});
+	return bestDistance;
+}
+
+bool TriangleMeshShapeClass::containsPoint(Vec3 point) const {
+	bool isExiting;
+	getNearestHit(Vec3f(point), Vec3f(1.0f, 0.0f, 0.0f), isExiting);
+	return isExiting;
+}
+
+double TriangleMeshShapeClass::getIntersectionDistance(Vec3 origin, Vec3 direction) const {
+	bool isExiting;
+	return getNearestHit(Vec3f(origin), Vec3f(direction), isExiting);
+}
+
+Polyhedron TriangleMeshShapeClass::asPolyhedron() const {
+	return Polyhedron(vertices.data(), triangles.data(), static_cast<int>(vertices.size()), static_cast<int>(triangles.size()));
+}
+
+size_t TriangleMeshShapeClass::getMemoryUsage() const {
+	return vertices.capacity() * sizeof(Vec3f) + triangles.capacity() * sizeof(Triangle) + bvh.getMemoryUsage();
+}
+
+#pragma endregion
+
+Shape Heightfield(const float* heights, int sampleCountX, int sampleCountZ, double width, double depth) {
+	HeightfieldShapeClass* shapeClass = new HeightfieldShapeClass(heights, sampleCountX, sampleCountZ, width, depth);
+	return Shape(shapeClass, shapeClass->originalScale[0] * 2, shapeClass->originalScale[1] * 2, shapeClass->originalScale[2] * 2);
+}
+
+Shape TriangleMesh(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount) {
+	TriangleMeshShapeClass* shapeClass = new TriangleMeshShapeClass(vertices, triangles, vertexCount, triangleCount);
+	return Shape(shapeClass, shapeClass->originalScale[0] * 2, shapeClass->originalScale[1] * 2, shapeClass->originalScale[2] * 2);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "../math/linalg/vec.h"
+#include "shapeClass.h"
+#include "shape.h"
+#include "polyhedron.h"
+#include "triangleBVH.h"
+
+/*
+	A single triangle as a collidable, convex parts are tested against the triangles of a TriangleShapeClass one at a time
+*/
+struct TriangleCollidable : public GenericCollidable {
+	Vec3f corners[3];
+
+	TriangleCollidable() = default;
+	TriangleCollidable(const Vec3f& a, const Vec3f& b, const Vec3f& c) : corners{a, b, c} {}
+
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override {
+		float a = corners[0] * direction;
+		float b = corners[1] * direction;
+		float c = corners[2] * direction;
+		if(a >= b) return (a >= c) ? corners[0] : corners[2];
+		return (b >= c) ? corners[1] : corners[2];
+	}
+};
+
+/*
+	A static, non convex shape made of triangles, meant for terrain parts
+	Intersections with convex shapes are computed per triangle, see intersectsTrianglesTransformed
+	The triangles are one sided, parts are pushed out along the normal of the triangle they touch
+
+	The ShapeClass functions used by the convex pipeline treat the shape as its bounding box, this includes the mass properties
+*/
+class TriangleShapeClass : public ShapeClass {
+public:
+	TriangleShapeClass(int intersectionClassID);
+
+	/*
+		Appends every triangle whose bounds overlap bounds, in the normalized -1..1 space of the shape
+	*/
+	virtual void getTrianglesInBounds(const BoundingBox& bounds, std::vector<TriangleCollidable>& result) const = 0;
+
+	virtual BoundingBox getBounds(const Rotation& rotation, const DiagonalMat3& scale) const override;
+	virtual double getScaledMaxRadiusSq(DiagonalMat3 scale) const override;
+	virtual Vec3f furthestInDirection(const Vec3f& direction) const override;
+};
+
+/*
+	A regular grid of heights, seen from above along y
+	Every cell is split into two triangles, the height range of blocks of cells is kept in a pyramid that serves as the BVH
+*/
+class HeightfieldShapeClass : public TriangleShapeClass {
+	struct HeightRange {
+		float min;
+		float max;
+	};
+	struct Level {
+		int cellCountX;
+		int cellCountZ;
+		std::vector<HeightRange> ranges;
+	};
+
+	int sampleCountX;
+	int sampleCountZ;
+	// normalized to -1..1, x varies fastest
+	std::vector<float> heights;
+	// levels[0] holds the height range of every cell, every next level merges blocks of 2x2 of the previous one, up to a single block
+	std::vector<Level> levels;
+
+	inline float getHeight(int x, int z) const { return heights[x + z * sampleCountX]; }
+	inline Vec3f getSample(int x, int z) const {
+		return Vec3f(-1.0f + 2.0f * x / (sampleCountX - 1), getHeight(x, z), -1.0f + 2.0f * z / (sampleCountZ - 1));
+	}
+	void getCellTriangles(int x, int z, TriangleCollidable& first, TriangleCollidable& second) const;
+	void collectTriangles(int level, int blockX, int blockZ, const BoundingBox& bounds, int minCellX, int maxCellX, int minCellZ, int maxCellZ, std::vector<TriangleCollidable>& result) const;
+	void intersectRay(int level, int blockX, int blockZ, const Vec3f& origin, const Vec3f& direction, const Vec3f& inverseDirection, float& bestDistance) const;
+
+public:
+	const Vec3 originalCenter;
+	const DiagonalMat3 originalScale;
+
+	/*
+		heights holds sampleCountX * sampleCountZ heights, x varies fastest, the samples are spaced evenly across width and depth
+		At least 2 samples are needed along both axes
+	*/
+	HeightfieldShapeClass(const float* heights, int sampleCountX, int sampleCountZ, double width, double depth);
+
+	inline int getSampleCountX() const { return sampleCountX; }
+	inline int getSampleCountZ() const { return sampleCountZ; }
+	/*
+		The height of a sample as it was given to the constructor, up to rounding
+	*/
+	inline float getOriginalHeight(int x, int z) const { return static_cast<float>(getHeight(x, z) * originalScale[1] + originalCenter.y); }
+
+	virtual bool containsPoint(Vec3 point) const override;
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual void getTrianglesInBounds(const BoundingBox& bounds, std::vector<TriangleCollidable>& result) const override;
+	virtual Polyhedron asPolyhedron() const override;
+
+	size_t getMemoryUsage() const;
+};
+
+/*
+	An arbitrary static triangle mesh, the triangles are kept in a TriangleBVH
+	containsPoint expects the mesh to be closed, with counterclockwise triangles seen from outside
+*/
+class TriangleMeshShapeClass : public TriangleShapeClass {
+	std::vector<Vec3f> vertices;
+	std::vector<Triangle> triangles;
+	TriangleBVH bvh;
+
+	// the distance along the ray to the nearest triangle and whether the ray leaves the mesh there
+	float getNearestHit(const Vec3f& origin, const Vec3f& direction, bool& isExiting) const;
+
+public:
+	const Vec3 originalCenter;
+	const DiagonalMat3 originalScale;
+
+	TriangleMeshShapeClass(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount);
+
+	inline int getVertexCount() const { return static_cast<int>(vertices.size()); }
+	inline int getTriangleCount() const { return static_cast<int>(triangles.size()); }
+	/*
+		A vertex as it was given to the constructor, up to rounding
+	*/
+	inline Vec3f getOriginalVertex(int index) const { return Vec3f(originalScale * Vec3(vertices[index]) + originalCenter); }
+	inline const Triangle& getTriangle(int index) const { return triangles[index]; }
+
+	virtual bool containsPoint(Vec3 point) const override;
+	virtual double getIntersectionDistance(Vec3 origin, Vec3 direction) const override;
+	virtual void getTrianglesInBounds(const BoundingBox& bounds, std::vector<TriangleCollidable>& result) const override;
+	virtual Polyhedron asPolyhedron() const override;
+
+	size_t getMemoryUsage() const;
+};
+
+/*
+	The shapes are centered on the middle of their bounds, add originalCenter of the created class to the position of the part to keep the given coordinates
+*/
+Shape Heightfield(const float* heights, int sampleCountX, int sampleCountZ, double width, double depth);
+Shape TriangleMesh(const Vec3f* vertices, const Triangle* triangles, int vertexCount, int triangleCount);
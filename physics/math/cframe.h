@@ -1,8 +1,11 @@
 #pragma once
 
 #include "linalg/vec.h"
+#include "linalg/mat.h"
 #include "rotation.h"
 
+#include <cstddef>
+
 template<typename T>
 struct CFrameTemplate {
 public:
@@ -37,6 +40,38 @@ public:
 		return rotation.globalToLocal(rVec);
 	}
 
+	/*
+		Transform count vectors at once, the rotation is only converted to a matrix once for the whole array
+		The input and output arrays may be the same
+	*/
+	void localToGlobal(const Vector<T, 3>* lVecs, Vector<T, 3>* gVecs, std::size_t count) const {
+		Matrix<T, 3, 3> rotationMatrix = rotation.asRotationMatrix();
+		for(std::size_t i = 0; i < count; i++) {
+			gVecs[i] = rotationMatrix * lVecs[i] + position;
+		}
+	}
+
+	void globalToLocal(const Vector<T, 3>* gVecs, Vector<T, 3>* lVecs, std::size_t count) const {
+		Matrix<T, 3, 3> inverseRotationMatrix = rotation.asRotationMatrix().transpose();
+		for(std::size_t i = 0; i < count; i++) {
+			lVecs[i] = inverseRotationMatrix * (gVecs[i] - position);
+		}
+	}
+
+	void localToRelative(const Vector<T, 3>* lVecs, Vector<T, 3>* rVecs, std::size_t count) const {
+		Matrix<T, 3, 3> rotationMatrix = rotation.asRotationMatrix();
+		for(std::size_t i = 0; i < count; i++) {
+			rVecs[i] = rotationMatrix * lVecs[i];
+		}
+	}
+
+	void relativeToLocal(const Vector<T, 3>* rVecs, Vector<T, 3>* lVecs, std::size_t count) const {
+		Matrix<T, 3, 3> inverseRotationMatrix = rotation.asRotationMatrix().transpose();
+		for(std::size_t i = 0; i < count; i++) {
+			lVecs[i] = inverseRotationMatrix * rVecs[i];
+		}
+	}
+
 	inline CFrameTemplate<T> localToGlobal(const CFrameTemplate<T>& lFrame) const {
 		return CFrameTemplate<T>(position + rotation.localToGlobal(lFrame.position), rotation.localToGlobal(lFrame.rotation));
 	}
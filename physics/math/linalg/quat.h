@@ -0,0 +1,130 @@
+#pragma once
+
+#include "vec.h"
+#include "mat.h"
+#include "trigonometry.h"
+#include <cmath>
+
+/*
+	w + x*i + y*j + z*k, only unit quaternions are used, as rotations
+	Stored as plain scalars so the predefined rotations can be constexpr
+*/
+template<typename T>
+struct Quaternion {
+	T w;
+	T x;
+	T y;
+	T z;
+
+	constexpr Quaternion() : w(1), x(0), y(0), z(0) {}
+	constexpr Quaternion(T w, T x, T y, T z) : w(w), x(x), y(y), z(z) {}
+	Quaternion(T w, const Vector<T, 3>& v) : w(w), x(v.x), y(v.y), z(v.z) {}
+
+	template<typename OtherT>
+	constexpr explicit Quaternion(const Quaternion<OtherT>& other) :
+		w(static_cast<T>(other.w)), x(static_cast<T>(other.x)), y(static_cast<T>(other.y)), z(static_cast<T>(other.z)) {}
+
+	inline Vector<T, 3> getVector() const { return Vector<T, 3>(x, y, z); }
+};
+
+template<typename T>
+inline Quaternion<T> operator*(const Quaternion<T>& a, const Quaternion<T>& b) {
+	return Quaternion<T>(
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+	);
+}
+
+template<typename T>
+inline Quaternion<T> conjugate(const Quaternion<T>& q) {
+	return Quaternion<T>(q.w, -q.x, -q.y, -q.z);
+}
+
+template<typename T>
+inline T lengthSquared(const Quaternion<T>& q) {
+	return q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z;
+}
+
+/*
+	Rotates vec by the unit quaternion q, q * vec * conjugate(q) expanded
+*/
+template<typename T>
+inline Vector<T, 3> rotate(const Quaternion<T>& q, const Vector<T, 3>& vec) {
+	Vector<T, 3> u = q.getVector();
+	Vector<T, 3> t = (u % vec) * T(2);
+	return vec + t * q.w + u % t;
+}
+
+/*
+	Pulls a quaternion that drifted slightly away from unit length back, using the first order approximation of 1/sqrt(x) around 1
+	Products of unit quaternions only drift by rounding errors, for which this is as good as a real normalization
+*/
+template<typename T>
+inline Quaternion<T> renormalizeNearUnit(const Quaternion<T>& q) {
+	T factor = (T(3) - lengthSquared(q)) / T(2);
+	return Quaternion<T>(q.w * factor, q.x * factor, q.y * factor, q.z * factor);
+}
+
+template<typename T>
+inline Quaternion<T> quaternionFromAxisAngle(const Vector<T, 3>& normalizedAxis, T angle) {
+	return Quaternion<T>(std::cos(angle / 2), normalizedAxis * std::sin(angle / 2));
+}
+
+template<typename T>
+Quaternion<T> quaternionFromRotationVec(const Vector<T, 3>& rotationVec) {
+	T angleSq = lengthSquared(rotationVec);
+	T angle = std::sqrt(angleSq);
+	// sin(angle/2)/angle, the division loses precision for small angles, where its taylor expansion is used instead
+	T sinHalfOverAngle = (angle < T(1e-4)) ? T(0.5) - angleSq / T(48) : std::sin(angle / 2) / angle;
+	return Quaternion<T>(std::cos(angle / 2), rotationVec * sinHalfOverAngle);
+}
+
+/*
+	Returns the rotation vector of the shortest rotation q represents, its length is at most pi
+*/
+template<typename T>
+Vector<T, 3> quaternionToRotationVec(const Quaternion<T>& q) {
+	// q and -q are the same rotation, use the one that turns less than half a circle
+	T sign = (q.w < 0) ? T(-1) : T(1);
+	Vector<T, 3> v = q.getVector() * sign;
+	T sinHalf = length(v);
+	if(sinHalf == 0) return Vector<T, 3>(0, 0, 0);
+	T angle = 2 * std::atan2(sinHalf, q.w * sign);
+	return v * (angle / sinHalf);
+}
+
+template<typename T>
+Matrix<T, 3, 3> quaternionToMatrix(const Quaternion<T>& q) {
+	T w = q.w;
+	T x = q.x;
+	T y = q.y;
+	T z = q.z;
+	return Matrix<T, 3, 3>{
+		1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y),
+		2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x),
+		2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)
+	};
+}
+
+/*
+	Shepperd's method, divides by the largest of the four possible denominators so it stays precise for every rotation
+*/
+template<typename T>
+Quaternion<T> quaternionFromMatrix(const Matrix<T, 3, 3>& m) {
+	T trace = m[0][0] + m[1][1] + m[2][2];
+	if(trace > 0) {
+		T s = std::sqrt(trace + 1) * 2;
+		return Quaternion<T>(s / 4, (m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s);
+	} else if(m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+		T s = std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]) * 2;
+		return Quaternion<T>((m[2][1] - m[1][2]) / s, s / 4, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s);
+	} else if(m[1][1] > m[2][2]) {
+		T s = std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]) * 2;
+		return Quaternion<T>((m[0][2] - m[2][0]) / s, (m[0][1] + m[1][0]) / s, s / 4, (m[1][2] + m[2][1]) / s);
+	} else {
+		T s = std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]) * 2;
+		return Quaternion<T>((m[1][0] - m[0][1]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, s / 4);
+	}
+}
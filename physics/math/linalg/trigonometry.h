@@ -322,3 +322,44 @@ template<typename T>
 Matrix<T, 4, 4> translate(const Matrix<T, 4, 4> & mat, const Vector<T, 3> & dv) {
 	return translate(mat, dv.x, dv.y, dv.z);
 }
+
+template<typename T>
+bool isValidRotationMatrix(const Matrix<T, 3, 3>& mat) {
+	struct Comparator {
+		static bool equalsApproximately(double value, double comparedTo) {
+			auto delta = comparedTo - value;
+			return delta < 1E-8 && delta > -1E-8;
+		}
+		static bool equalsApproximately(float value, float comparedTo) {
+			auto delta = comparedTo - value;
+			return delta < 1E-4 && delta > -1E-4;
+		}
+	};
+	constexpr T zero = 0;
+	constexpr T one = 1;
+	for(int i = 0; i < 3; i++) {
+		T rowLengthSq = lengthSquared(mat.getRow(i));
+		T colLengthSq = lengthSquared(mat.getCol(i));
+		if(!Comparator::equalsApproximately(rowLengthSq, one)
+		|| !Comparator::equalsApproximately(colLengthSq, one)) {
+			return false;
+		}
+	}
+
+	for(int i = 0; i < 3; i++) {
+		for(int j = 0; j < 3; j++) {
+			if(i == j) continue;
+
+			if(!Comparator::equalsApproximately(mat.getRow(i) * mat.getRow(j), zero)
+			|| !Comparator::equalsApproximately(mat.getCol(i) * mat.getCol(j), zero)) {
+				return false;
+			}
+		}
+	}
+
+	T detMat = det(mat);
+	if(!Comparator::equalsApproximately(detMat, one)) {
+		return false;
+	}
+	return true;
+}
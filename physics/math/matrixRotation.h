@@ -0,0 +1,256 @@
+#pragma once
+
+#include "linalg/mat.h"
+#include "linalg/trigonometry.h"
+#include <assert.h>
+#include <cmath>
+
+/*
+	A rotation stored as its rotation matrix
+	Transforming vectors is a single matrix multiplication, composing rotations is a full matrix product
+*/
+template<typename T>
+class MatrixRotationTemplate {
+	Matrix<T, 3, 3> rotationMatrix;
+
+	constexpr explicit MatrixRotationTemplate(const Matrix<T, 3, 3>& rotationMatrix);
+public:
+
+	constexpr MatrixRotationTemplate();
+
+	Vector<T, 3> localToGlobal(const Vector<T, 3>& vec) const;
+	Vector<T, 3> globalToLocal(const Vector<T, 3>& vec) const;
+	MatrixRotationTemplate localToGlobal(const MatrixRotationTemplate<T>& rot) const;
+	MatrixRotationTemplate globalToLocal(const MatrixRotationTemplate<T>& rot) const;
+
+	/*
+		Transforms the given symmetric matrix into the basis of this rotation
+
+		effectively brings a local matrix into the global space
+
+		rot.localToGlobal(sm * v) == rot.localToGlobal(sm) * rot.localToGlobal(v)
+		== rot * sm * ~rot * rot * v
+	*/
+	SymmetricMatrix<T, 3> localToGlobal(const SymmetricMatrix<T, 3>& sm) const;
+
+	/*
+		Transforms the given symmetric matrix from the basis of this rotation
+
+		effectively brings a global matrix into the local space
+
+		rot.globalToLocal(sm * v) == rot.globalToLocal(sm) * rot.globalToLocal(v)
+		== ~rot * sm * rot * ~rot * v
+	*/
+	SymmetricMatrix<T, 3> globalToLocal(const SymmetricMatrix<T, 3>& sm) const;
+
+	MatrixRotationTemplate operator~() const;
+	MatrixRotationTemplate operator*(const MatrixRotationTemplate& rot2) const;
+	MatrixRotationTemplate& operator*=(const MatrixRotationTemplate& rot2);
+	Vec3 operator*(const Vector<T, 3>& vec) const;
+
+	static MatrixRotationTemplate rotX(double angle);
+	static MatrixRotationTemplate rotY(double angle);
+	static MatrixRotationTemplate rotZ(double angle);
+	static MatrixRotationTemplate fromEulerAngles(double alpha, double beta, double gamma);
+	static MatrixRotationTemplate fromRotationVec(const Vector<T, 3>& rotationVector);
+	static MatrixRotationTemplate fromRotationMatrix(const Matrix<T, 3, 3>& rotationMatrix);
+
+	static MatrixRotationTemplate faceX(Vector<T, 3> xDirection);
+	static MatrixRotationTemplate faceX(Vector<T, 3> xDirection, Vector<T, 3> yHint);
+	static MatrixRotationTemplate faceY(Vector<T, 3> yDirection);
+	static MatrixRotationTemplate faceY(Vector<T, 3> yDirection, Vector<T, 3> zHint);
+	static MatrixRotationTemplate faceZ(Vector<T, 3> zDirection);
+	static MatrixRotationTemplate faceZ(Vector<T, 3> zDirection, Vector<T, 3> xHint);
+
+	Matrix<T, 3, 3> asRotationMatrix() const;
+	Vector<T, 3> asRotationVector() const;
+
+	operator Matrix<T, 3, 3>() const {
+		return this->asRotationMatrix();
+	}
+
+	template<typename OtherT>
+	operator MatrixRotationTemplate<OtherT>() const;
+
+	struct Predefined;
+};
+
+template<typename T>
+struct MatrixRotationTemplate<T>::Predefined {
+	static constexpr MatrixRotationTemplate<T> IDENTITY{Matrix<T, 3, 3>{1,0,0,0,1,0,0,0,1}};
+
+	static constexpr MatrixRotationTemplate<T> X_90 {Matrix<T, 3, 3>{ 1, 0, 0, 0, 0,-1, 0, 1, 0}};
+	static constexpr MatrixRotationTemplate<T> Y_90 {Matrix<T, 3, 3>{ 0, 0, 1, 0, 1, 0,-1, 0, 0}};
+	static constexpr MatrixRotationTemplate<T> Z_90 {Matrix<T, 3, 3>{ 0,-1, 0, 1, 0, 0, 0, 0, 1}};
+
+	static constexpr MatrixRotationTemplate<T> X_180{Matrix<T, 3, 3>{ 1, 0, 0, 0,-1, 0, 0, 0,-1}};
+	static constexpr MatrixRotationTemplate<T> Y_180{Matrix<T, 3, 3>{-1, 0, 0, 0, 1, 0, 0, 0,-1}};
+	static constexpr MatrixRotationTemplate<T> Z_180{Matrix<T, 3, 3>{-1, 0, 0, 0,-1, 0, 0, 0, 1}};
+
+	static constexpr MatrixRotationTemplate<T> X_270{Matrix<T, 3, 3>{ 1, 0, 0, 0, 0, 1, 0,-1, 0}};
+	static constexpr MatrixRotationTemplate<T> Y_270{Matrix<T, 3, 3>{ 0, 0,-1, 0, 1, 0, 1, 0, 0}};
+	static constexpr MatrixRotationTemplate<T> Z_270{Matrix<T, 3, 3>{ 0, 1, 0,-1, 0, 0, 0, 0, 1}};
+};
+
+
+template<typename T>
+inline constexpr MatrixRotationTemplate<T>::MatrixRotationTemplate(const Matrix<T, 3, 3>& rotationMatrix) : rotationMatrix(rotationMatrix) {}
+
+template<typename T>
+inline constexpr MatrixRotationTemplate<T>::MatrixRotationTemplate() : rotationMatrix(Matrix<T, 3, 3>::IDENTITY()) {}
+
+template<typename T>
+inline Vector<T, 3> MatrixRotationTemplate<T>::localToGlobal(const Vector<T, 3>& vec) const {
+	return rotationMatrix * vec;
+}
+
+template<typename T>
+inline Vector<T, 3> MatrixRotationTemplate<T>::globalToLocal(const Vector<T, 3>& vec) const {
+	return rotationMatrix.transpose() * vec;
+}
+
+template<typename T>
+inline MatrixRotationTemplate<T> MatrixRotationTemplate<T>::localToGlobal(const MatrixRotationTemplate<T>& rot) const {
+	return (*this) * rot;
+}
+
+template<typename T>
+inline MatrixRotationTemplate<T> MatrixRotationTemplate<T>::globalToLocal(const MatrixRotationTemplate<T>& rot) const {
+	return (~*this) * rot;
+}
+
+/*
+Transforms the given symmetric matrix into the basis of this rotation
+
+effectively brings a local matrix into the global space
+
+rot.localToGlobal(sm * v) == rot.localToGlobal(sm) * rot.localToGlobal(v)
+== rot * sm * ~rot * rot * v
+*/
+template<typename T>
+inline SymmetricMatrix<T, 3> MatrixRotationTemplate<T>::localToGlobal(const SymmetricMatrix<T, 3>& sm) const {
+	Matrix<T, 3, 3> r = this->rotationMatrix * sm * this->rotationMatrix.transpose();
+	return SymmetricMatrix<T, 3>{
+		r[0][0],
+			r[1][0], r[1][1],
+			r[2][0], r[2][1], r[2][2]
+	};
+}
+
+/*
+Transforms the given symmetric matrix from the basis of this rotation
+
+effectively brings a global matrix into the local space
+
+rot.globalToLocal(sm * v) == rot.globalToLocal(sm) * rot.globalToLocal(v)
+== ~rot * sm * rot * ~rot * v
+*/
+template<typename T>
+inline SymmetricMatrix<T, 3> MatrixRotationTemplate<T>::globalToLocal(const SymmetricMatrix<T, 3>& sm) const {
+	Matrix<T, 3, 3> r = this->rotationMatrix.transpose() * sm * this->rotationMatrix;
+	return SymmetricMatrix<T, 3>{
+		r[0][0],
+			r[1][0], r[1][1],
+			r[2][0], r[2][1], r[2][2]
+	};
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::operator~() const {
+	return MatrixRotationTemplate(rotationMatrix.transpose());
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::operator*(const MatrixRotationTemplate<T>& rot2) const {
+	return MatrixRotationTemplate(this->rotationMatrix * rot2.rotationMatrix);
+}
+
+template<typename T>
+MatrixRotationTemplate<T>& MatrixRotationTemplate<T>::operator*=(const MatrixRotationTemplate<T>& rot2) {
+	this->rotationMatrix = this->rotationMatrix * rot2.rotationMatrix;
+	return *this;
+}
+
+template<typename T>
+Vec3 MatrixRotationTemplate<T>::operator*(const Vector<T, 3>& vec) const {
+	return rotationMatrix * vec;
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::rotX(double angle) {
+	return MatrixRotationTemplate<T>(::rotMatX(angle));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::rotY(double angle) {
+	return MatrixRotationTemplate<T>(::rotMatY(angle));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::rotZ(double angle) {
+	return MatrixRotationTemplate<T>(::rotMatZ(angle));
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::fromEulerAngles(double alpha, double beta, double gamma) {
+	return MatrixRotationTemplate<T>::rotZ(gamma) * MatrixRotationTemplate<T>::rotX(alpha) * MatrixRotationTemplate<T>::rotY(beta);
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::fromRotationMatrix(const Matrix<T, 3, 3>& rotationMatrix) {
+	assert(isValidRotationMatrix(rotationMatrix));
+	return MatrixRotationTemplate<T>(rotationMatrix);
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::fromRotationVec(const Vector<T, 3>& rotationVector) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::rotationMatrixfromRotationVec(rotationVector));
+}
+
+template<typename T>
+Matrix<T, 3, 3> MatrixRotationTemplate<T>::asRotationMatrix() const {
+	return this->rotationMatrix;
+}
+template<typename T>
+Vector<T, 3> MatrixRotationTemplate<T>::asRotationVector() const {
+	return ::rotationVectorfromRotationMatrix(this->rotationMatrix);
+}
+
+template<typename T>
+template<typename OtherT>
+MatrixRotationTemplate<T>::operator MatrixRotationTemplate<OtherT>() const {
+	return MatrixRotationTemplate<OtherT>::fromRotationMatrix(static_cast<Matrix<OtherT, 3, 3>>(this->rotationMatrix));
+}
+
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceX(Vector<T, 3> xDirection) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatX(xDirection));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceX(Vector<T, 3> xDirection, Vector<T, 3> yHint) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatX(xDirection, yHint));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceY(Vector<T, 3> yDirection) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatY(yDirection));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceY(Vector<T, 3> yDirection, Vector<T, 3> zHint) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatY(yDirection, zHint));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceZ(Vector<T, 3> zDirection) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatZ(zDirection));
+}
+template<typename T>
+MatrixRotationTemplate<T> MatrixRotationTemplate<T>::faceZ(Vector<T, 3> zDirection, Vector<T, 3> xHint) {
+	return MatrixRotationTemplate<T>::fromRotationMatrix(::faceMatZ(zDirection, xHint));
+}
+
+template<typename T>
+Matrix<T, 3, 3> operator*(const Matrix<T, 3, 3>& matrix, const MatrixRotationTemplate<T>& rotation) {
+	return matrix * rotation.asRotationMatrix();
+}
+
+template<typename T>
+Matrix<T, 3, 3> operator*(const MatrixRotationTemplate<T>& rotation, const Matrix<T, 3, 3>& matrix) {
+	return rotation.asRotationMatrix() * matrix;
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "linalg/mat.h"
+#include "linalg/quat.h"
+#include "linalg/trigonometry.h"
+#include <assert.h>
+#include <cmath>
+
+/*
+	A rotation stored as a unit quaternion, the same interface as MatrixRotationTemplate in less than half the memory
+	Composing rotations is cheaper than a matrix product, transforming a vector a little more expensive than a matrix multiplication
+	Matrices are only built at the boundaries, for asRotationMatrix and for transforming inertia matrices
+
+	Every product is renormalized with renormalizeNearUnit, so rounding errors do not accumulate over many ticks
+*/
+template<typename T>
+class QuaternionRotationTemplate {
+	Quaternion<T> quaternion;
+
+	constexpr explicit QuaternionRotationTemplate(const Quaternion<T>& quaternion);
+public:
+
+	constexpr QuaternionRotationTemplate();
+
+	Vector<T, 3> localToGlobal(const Vector<T, 3>& vec) const;
+	Vector<T, 3> globalToLocal(const Vector<T, 3>& vec) const;
+	QuaternionRotationTemplate localToGlobal(const QuaternionRotationTemplate<T>& rot) const;
+	QuaternionRotationTemplate globalToLocal(const QuaternionRotationTemplate<T>& rot) const;
+
+	/*
+		Transforms the given symmetric matrix into the basis of this rotation
+
+		effectively brings a local matrix into the global space
+
+		rot.localToGlobal(sm * v) == rot.localToGlobal(sm) * rot.localToGlobal(v)
+		== rot * sm * ~rot * rot * v
+	*/
+	SymmetricMatrix<T, 3> localToGlobal(const SymmetricMatrix<T, 3>& sm) const;
+
+	/*
+		Transforms the given symmetric matrix from the basis of this rotation
+
+		effectively brings a global matrix into the local space
+
+		rot.globalToLocal(sm * v) == rot.globalToLocal(sm) * rot.globalToLocal(v)
+		== ~rot * sm * rot * ~rot * v
+	*/
+	SymmetricMatrix<T, 3> globalToLocal(const SymmetricMatrix<T, 3>& sm) const;
+
+	QuaternionRotationTemplate operator~() const;
+	QuaternionRotationTemplate operator*(const QuaternionRotationTemplate& rot2) const;
+	QuaternionRotationTemplate& operator*=(const QuaternionRotationTemplate& rot2);
+	Vector<T, 3> operator*(const Vector<T, 3>& vec) const;
+
+	static QuaternionRotationTemplate rotX(double angle);
+	static QuaternionRotationTemplate rotY(double angle);
+	static QuaternionRotationTemplate rotZ(double angle);
+	static QuaternionRotationTemplate fromEulerAngles(double alpha, double beta, double gamma);
+	static QuaternionRotationTemplate fromRotationVec(const Vector<T, 3>& rotationVector);
+	static QuaternionRotationTemplate fromRotationMatrix(const Matrix<T, 3, 3>& rotationMatrix);
+	static QuaternionRotationTemplate fromQuaternion(const Quaternion<T>& unitQuaternion);
+
+	static QuaternionRotationTemplate faceX(Vector<T, 3> xDirection);
+	static QuaternionRotationTemplate faceX(Vector<T, 3> xDirection, Vector<T, 3> yHint);
+	static QuaternionRotationTemplate faceY(Vector<T, 3> yDirection);
+	static QuaternionRotationTemplate faceY(Vector<T, 3> yDirection, Vector<T, 3> zHint);
+	static QuaternionRotationTemplate faceZ(Vector<T, 3> zDirection);
+	static QuaternionRotationTemplate faceZ(Vector<T, 3> zDirection, Vector<T, 3> xHint);
+
+	Matrix<T, 3, 3> asRotationMatrix() const;
+	Vector<T, 3> asRotationVector() const;
+	Quaternion<T> asQuaternion() const;
+
+	operator Matrix<T, 3, 3>() const {
+		return this->asRotationMatrix();
+	}
+
+	template<typename OtherT>
+	operator QuaternionRotationTemplate<OtherT>() const;
+
+	struct Predefined;
+};
+
+// cos(pi/4) == sin(pi/4)
+#define QUATERNION_HALF_SQRT_2 0.70710678118654752440
+
+template<typename T>
+struct QuaternionRotationTemplate<T>::Predefined {
+	static constexpr QuaternionRotationTemplate<T> IDENTITY{Quaternion<T>(1, 0, 0, 0)};
+
+	static constexpr QuaternionRotationTemplate<T> X_90 {Quaternion<T>(QUATERNION_HALF_SQRT_2, QUATERNION_HALF_SQRT_2, 0, 0)};
+	static constexpr QuaternionRotationTemplate<T> Y_90 {Quaternion<T>(QUATERNION_HALF_SQRT_2, 0, QUATERNION_HALF_SQRT_2, 0)};
+	static constexpr QuaternionRotationTemplate<T> Z_90 {Quaternion<T>(QUATERNION_HALF_SQRT_2, 0, 0, QUATERNION_HALF_SQRT_2)};
+
+	static constexpr QuaternionRotationTemplate<T> X_180{Quaternion<T>(0, 1, 0, 0)};
+	static constexpr QuaternionRotationTemplate<T> Y_180{Quaternion<T>(0, 0, 1, 0)};
+	static constexpr QuaternionRotationTemplate<T> Z_180{Quaternion<T>(0, 0, 0, 1)};
+
+	static constexpr QuaternionRotationTemplate<T> X_270{Quaternion<T>(QUATERNION_HALF_SQRT_2, -QUATERNION_HALF_SQRT_2, 0, 0)};
+	static constexpr QuaternionRotationTemplate<T> Y_270{Quaternion<T>(QUATERNION_HALF_SQRT_2, 0, -QUATERNION_HALF_SQRT_2, 0)};
+	static constexpr QuaternionRotationTemplate<T> Z_270{Quaternion<T>(QUATERNION_HALF_SQRT_2, 0, 0, -QUATERNION_HALF_SQRT_2)};
+};
+
+
+template<typename T>
+inline constexpr QuaternionRotationTemplate<T>::QuaternionRotationTemplate(const Quaternion<T>& quaternion) : quaternion(quaternion) {}
+
+template<typename T>
+inline constexpr QuaternionRotationTemplate<T>::QuaternionRotationTemplate() : quaternion(1, 0, 0, 0) {}
+
+template<typename T>
+inline Vector<T, 3> QuaternionRotationTemplate<T>::localToGlobal(const Vector<T, 3>& vec) const {
+	return rotate(quaternion, vec);
+}
+
+template<typename T>
+inline Vector<T, 3> QuaternionRotationTemplate<T>::globalToLocal(const Vector<T, 3>& vec) const {
+	return rotate(conjugate(quaternion), vec);
+}
+
+template<typename T>
+inline QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::localToGlobal(const QuaternionRotationTemplate<T>& rot) const {
+	return (*this) * rot;
+}
+
+template<typename T>
+inline QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::globalToLocal(const QuaternionRotationTemplate<T>& rot) const {
+	return (~*this) * rot;
+}
+
+template<typename T>
+inline SymmetricMatrix<T, 3> QuaternionRotationTemplate<T>::localToGlobal(const SymmetricMatrix<T, 3>& sm) const {
+	Matrix<T, 3, 3> rotationMatrix = this->asRotationMatrix();
+	Matrix<T, 3, 3> r = rotationMatrix * sm * rotationMatrix.transpose();
+	return SymmetricMatrix<T, 3>{
+		r[0][0],
+			r[1][0], r[1][1],
+			r[2][0], r[2][1], r[2][2]
+	};
+}
+
+template<typename T>
+inline SymmetricMatrix<T, 3> QuaternionRotationTemplate<T>::globalToLocal(const SymmetricMatrix<T, 3>& sm) const {
+	Matrix<T, 3, 3> rotationMatrix = this->asRotationMatrix();
+	Matrix<T, 3, 3> r = rotationMatrix.transpose() * sm * rotationMatrix;
+	return SymmetricMatrix<T, 3>{
+		r[0][0],
+			r[1][0], r[1][1],
+			r[2][0], r[2][1], r[2][2]
+	};
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::operator~() const {
+	return QuaternionRotationTemplate(conjugate(quaternion));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::operator*(const QuaternionRotationTemplate<T>& rot2) const {
+	return QuaternionRotationTemplate(renormalizeNearUnit(this->quaternion * rot2.quaternion));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T>& QuaternionRotationTemplate<T>::operator*=(const QuaternionRotationTemplate<T>& rot2) {
+	this->quaternion = renormalizeNearUnit(this->quaternion * rot2.quaternion);
+	return *this;
+}
+
+template<typename T>
+Vector<T, 3> QuaternionRotationTemplate<T>::operator*(const Vector<T, 3>& vec) const {
+	return rotate(quaternion, vec);
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::rotX(double angle) {
+	return QuaternionRotationTemplate<T>(Quaternion<T>(static_cast<T>(std::cos(angle / 2)), static_cast<T>(std::sin(angle / 2)), 0, 0));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::rotY(double angle) {
+	return QuaternionRotationTemplate<T>(Quaternion<T>(static_cast<T>(std::cos(angle / 2)), 0, static_cast<T>(std::sin(angle / 2)), 0));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::rotZ(double angle) {
+	return QuaternionRotationTemplate<T>(Quaternion<T>(static_cast<T>(std::cos(angle / 2)), 0, 0, static_cast<T>(std::sin(angle / 2))));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::fromEulerAngles(double alpha, double beta, double gamma) {
+	return QuaternionRotationTemplate<T>::rotZ(gamma) * QuaternionRotationTemplate<T>::rotX(alpha) * QuaternionRotationTemplate<T>::rotY(beta);
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::fromRotationMatrix(const Matrix<T, 3, 3>& rotationMatrix) {
+	assert(isValidRotationMatrix(rotationMatrix));
+	return QuaternionRotationTemplate<T>(quaternionFromMatrix(rotationMatrix));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::fromRotationVec(const Vector<T, 3>& rotationVector) {
+	return QuaternionRotationTemplate<T>(quaternionFromRotationVec(rotationVector));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::fromQuaternion(const Quaternion<T>& unitQuaternion) {
+	assert(std::abs(lengthSquared(unitQuaternion) - 1) < 1E-4);
+	return QuaternionRotationTemplate<T>(unitQuaternion);
+}
+
+template<typename T>
+Matrix<T, 3, 3> QuaternionRotationTemplate<T>::asRotationMatrix() const {
+	return quaternionToMatrix(this->quaternion);
+}
+template<typename T>
+Vector<T, 3> QuaternionRotationTemplate<T>::asRotationVector() const {
+	return quaternionToRotationVec(this->quaternion);
+}
+template<typename T>
+Quaternion<T> QuaternionRotationTemplate<T>::asQuaternion() const {
+	return this->quaternion;
+}
+
+template<typename T>
+template<typename OtherT>
+QuaternionRotationTemplate<T>::operator QuaternionRotationTemplate<OtherT>() const {
+	return QuaternionRotationTemplate<OtherT>::fromQuaternion(static_cast<Quaternion<OtherT>>(this->quaternion));
+}
+
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceX(Vector<T, 3> xDirection) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatX(xDirection));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceX(Vector<T, 3> xDirection, Vector<T, 3> yHint) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatX(xDirection, yHint));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceY(Vector<T, 3> yDirection) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatY(yDirection));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceY(Vector<T, 3> yDirection, Vector<T, 3> zHint) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatY(yDirection, zHint));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceZ(Vector<T, 3> zDirection) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatZ(zDirection));
+}
+template<typename T>
+QuaternionRotationTemplate<T> QuaternionRotationTemplate<T>::faceZ(Vector<T, 3> zDirection, Vector<T, 3> xHint) {
+	return QuaternionRotationTemplate<T>::fromRotationMatrix(::faceMatZ(zDirection, xHint));
+}
+
+template<typename T>
+Matrix<T, 3, 3> operator*(const Matrix<T, 3, 3>& matrix, const QuaternionRotationTemplate<T>& rotation) {
+	return matrix * rotation.asRotationMatrix();
+}
+
+template<typename T>
+Matrix<T, 3, 3> operator*(const QuaternionRotationTemplate<T>& rotation, const Matrix<T, 3, 3>& matrix) {
+	return rotation.asRotationMatrix() * matrix;
+}
@@ -0,0 +1,193 @@
+#include "memoryProfiler.h"
+
+#include <atomic>
+#include <new>
+#include <set>
+#include <stdlib.h>
+
+#include "world.h"
+#include "physical.h"
+#include "datastructures/boundsTree.h"
+#include "geometry/shapeClass.h"
+#include "geometry/normalizedPolyhedron.h"
+#include "geometry/polyhedronInternals.h"
+#include "geometry/computationBuffer.h"
+#include "geometry/genericIntersection.h"
+
+extern thread_local ComputationBuffers buffers;
+
+const char* memoryCategoryLabels[]{
+	"Parts",
+	"Physicals",
+	"Tree Nodes",
+	"Polyhedra",
+	"Computation Buffers"
+};
+
+extern const char* physicsLabels[];
+
+HistoricTally<long long, PhysicsProcess> allocationStatistics(physicsLabels, 100);
+HistoricTally<long long, PhysicsProcess> allocatedBytesStatistics(physicsLabels, 100);
+
+#pragma region memoryUsage
+
+size_t WorldMemoryUsage::getTotalBytes() const {
+	size_t total = 0;
+	for(size_t i = 0; i < static_cast<size_t>(MemoryCategory::COUNT); i++) {
+		total += bytes[i];
+	}
+	return total;
+}
+
+double WorldMemoryUsage::getBytesPerPart() const {
+	if(partCount == 0) return 0.0;
+	return double(getTotalBytes()) / partCount;
+}
+
+static void addPhysicalMemoryUsage(const Physical& phys, WorldMemoryUsage& result) {
+	result.bytes[static_cast<size_t>(MemoryCategory::PHYSICALS)] += phys.rigidBody.parts.capacity() * sizeof(AttachedPart);
+	result.bytes[static_cast<size_t>(MemoryCategory::PHYSICALS)] += phys.childPhysicals.capacity() * sizeof(ConnectedPhysical);
+	result.physicalCount++;
+	for(const ConnectedPhysical& child : phys.childPhysicals) {
+		addPhysicalMemoryUsage(child, result);
+	}
+}
+
+static void addTreeMemoryUsage(const TreeNode& node, WorldMemoryUsage& result) {
+	if(node.isLeafNode() || node.subTrees == nullptr) return;
+
+	result.bytes[static_cast<size_t>(MemoryCategory::TREE_NODES)] += MAX_BRANCHES * sizeof(TreeNode);
+	result.treeNodeCount += MAX_BRANCHES;
+	for(const TreeNode& subNode : node) {
+		addTreeMemoryUsage(subNode, result);
+	}
+}
+
+static size_t getPolyhedronMemoryUsage(const Polyhedron& poly) {
+	return getOffset(poly.vertexCount) * 3 * sizeof(float) + getOffset(poly.triangleCount) * 3 * sizeof(int);
+}
+
+size_t getMemoryUsage(const ComputationBuffers& buffers) {
+	return sizeof(ComputationBuffers) +
+		buffers.vertexCapacity * (sizeof(Vec3f) + sizeof(MinkowskiPointIndices)) +
+		buffers.triangleCapacity * (sizeof(Triangle) + sizeof(TriangleNeighbors) + sizeof(EdgePiece) + sizeof(int));
+}
+
+WorldMemoryUsage getWorldMemoryUsage(const WorldPrototype& world, size_t partSize) {
+	WorldMemoryUsage result;
+
+	std::set<const ShapeClass*> seenShapeClasses;
+	for(const Part& part : world.iterParts()) {
+		result.partCount++;
+		result.bytes[static_cast<size_t>(MemoryCategory::PARTS)] += partSize;
+
+		const ShapeClass* shapeClass = part.hitbox.baseShape;
+		if(shapeClass->intersectionClassID == CONVEX_POLYHEDRON_CLASS_ID && seenShapeClasses.insert(shapeClass).second) {
+			const NormalizedPolyhedron* poly = static_cast<const NormalizedPolyhedron*>(shapeClass);
+			result.bytes[static_cast<size_t>(MemoryCategory::POLYHEDRA)] += sizeof(NormalizedPolyhedron) + getPolyhedronMemoryUsage(*poly);
+			result.polyhedronCount++;
+		}
+	}
+
+	for(const MotorizedPhysical* phys : world.physicals) {
+		result.bytes[static_cast<size_t>(MemoryCategory::PHYSICALS)] += sizeof(MotorizedPhysical);
+		addPhysicalMemoryUsage(*phys, result);
+	}
+	result.bytes[static_cast<size_t>(MemoryCategory::PHYSICALS)] += world.physicals.capacity() * sizeof(MotorizedPhysical*);
+
+	addTreeMemoryUsage(world.objectTree.rootNode, result);
+	addTreeMemoryUsage(world.terrainTree.rootNode, result);
+
+	result.bytes[static_cast<size_t>(MemoryCategory::COMPUTATION_BUFFERS)] += getMemoryUsage(buffers);
+
+	return result;
+}
+
+#pragma endregion
+
+#pragma region allocationTracking
+
+static std::atomic<long long> allocationCounts[static_cast<size_t>(PhysicsProcess::COUNT)];
+static std::atomic<long long> allocatedBytes[static_cast<size_t>(PhysicsProcess::COUNT)];
+
+void recordAllocation(size_t size) {
+	PhysicsProcess process = physicsMeasure.getCurrentProcess();
+	size_t index = static_cast<size_t>(process);
+	if(index >= static_cast<size_t>(PhysicsProcess::COUNT)) {
+		index = static_cast<size_t>(PhysicsProcess::OTHER);
+	}
+	allocationCounts[index].fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes[index].fetch_add(size, std::memory_order_relaxed);
+}
+
+void nextAllocationTally() {
+	for(size_t i = 0; i < static_cast<size_t>(PhysicsProcess::COUNT); i++) {
+		allocationStatistics.addToTally(static_cast<PhysicsProcess>(i), allocationCounts[i].exchange(0, std::memory_order_relaxed));
+		allocatedBytesStatistics.addToTally(static_cast<PhysicsProcess>(i), allocatedBytes[i].exchange(0, std::memory_order_relaxed));
+	}
+	allocationStatistics.nextTally();
+	allocatedBytesStatistics.nextTally();
+}
+
+void resetAllocationTally() {
+	for(size_t i = 0; i < static_cast<size_t>(PhysicsProcess::COUNT); i++) {
+		allocationCounts[i].store(0, std::memory_order_relaxed);
+		allocatedBytes[i].store(0, std::memory_order_relaxed);
+	}
+	allocationStatistics.clearCurrentTally();
+	allocatedBytesStatistics.clearCurrentTally();
+}
+
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+
+static void* countedAlloc(size_t size) {
+	recordAllocation(size);
+	void* result = malloc(size == 0 ? 1 : size);
+	if(!result) throw std::bad_alloc();
+	return result;
+}
+
+static void* countedAlignedAlloc(size_t size, size_t align) {
+	recordAllocation(size);
+#ifdef _MSC_VER
+	void* result = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+	void* result = aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+	if(!result) throw std::bad_alloc();
+	return result;
+}
+
+static void countedAlignedFree(void* ptr) {
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try { return countedAlloc(size); } catch(...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try { return countedAlloc(size); } catch(...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+
+void* operator new(size_t size, std::align_val_t align) { return countedAlignedAlloc(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return countedAlignedAlloc(size, static_cast<size_t>(align)); }
+void operator delete(void* ptr, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+
+#endif
+
+#pragma endregion
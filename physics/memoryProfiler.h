@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+#include "profiling.h"
+#include "physicsProfiler.h"
+
+class WorldPrototype;
+template<typename T>
+class World;
+struct ComputationBuffers;
+
+enum class MemoryCategory {
+	PARTS,
+	PHYSICALS,
+	TREE_NODES,
+	POLYHEDRA,
+	COMPUTATION_BUFFERS,
+	COUNT
+};
+
+/*
+	A snapshot of the heap memory owned by a world, split per MemoryCategory
+
+	Shared shape data (polyhedra) is counted once per distinct ShapeClass
+*/
+struct WorldMemoryUsage {
+	size_t bytes[static_cast<size_t>(MemoryCategory::COUNT)]{};
+	size_t partCount = 0;
+	size_t physicalCount = 0;
+	size_t treeNodeCount = 0;
+	size_t polyhedronCount = 0;
+
+	size_t getTotalBytes() const;
+	double getBytesPerPart() const;
+};
+
+extern const char* memoryCategoryLabels[];
+
+/*
+	partSize is the sizeof the actual part type stored in the world, usually sizeof(Part)
+	The computation buffers counted are those of the calling thread, call it from the thread that ticks the world
+*/
+WorldMemoryUsage getWorldMemoryUsage(const WorldPrototype& world, size_t partSize);
+
+template<typename T>
+WorldMemoryUsage getWorldMemoryUsage(const World<T>& world) {
+	return getWorldMemoryUsage(world, sizeof(T));
+}
+
+size_t getMemoryUsage(const ComputationBuffers& buffers);
+
+/*
+	Allocation tracking is opt-in. When the physics library is built with PHYSICS_TRACK_ALLOCATIONS defined
+	(cmake -DPHYSICS_TRACK_ALLOCATIONS=ON) a counting global operator new / delete is installed, as well as counting in createAligned.
+
+	Every allocation is attributed to the PhysicsProcess physicsMeasure is currently in, allocations outside of a marked process go to OTHER.
+	Call nextAllocationTally() once per tick, next to physicsMeasure.end()
+*/
+extern HistoricTally<long long, PhysicsProcess> allocationStatistics;
+extern HistoricTally<long long, PhysicsProcess> allocatedBytesStatistics;
+
+constexpr bool isAllocationTrackingEnabled() {
+#ifdef PHYSICS_TRACK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void recordAllocation(size_t size);
+
+/*
+	Moves the allocations counted since the last call into allocationStatistics and allocatedBytesStatistics
+*/
+void nextAllocationTally();
+/*
+	Discards the allocations counted since the last call to nextAllocationTally, for example the ones made while building a world
+*/
+void resetAllocationTally();
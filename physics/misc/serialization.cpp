@@ -9,8 +9,10 @@
 #include "../geometry/polyhedron.h"
 #include "../geometry/normalizedPolyhedron.h"
 #include "../geometry/polyhedronInternals.h"
+#include "../geometry/triangleShapes.h"
 #include "../geometry/shape.h"
 #include "../geometry/shapeClass.h"
+#include "../geometry/basicShapes.h"
 #include "../part.h"
 #include "../world.h"
 #include "../constraints/hardConstraint.h"
@@ -39,20 +41,20 @@ Polyhedron deserializePolyhedron(std::istream& istream) {
 	uint32_t vertexCount = ::deserialize<uint32_t>(istream);
 	uint32_t triangleCount = ::deserialize<uint32_t>(istream);
 
-	Vec3f* vertices = new Vec3f[vertexCount];
-	Triangle* triangles = new Triangle[triangleCount];
+	// read straight into the parallel buffers, avoiding a temporary copy
+	UniqueAlignedPointer<float> vertices = createParallelVecBuf(vertexCount);
+	UniqueAlignedPointer<int> triangles = createParallelTriangleBuf(triangleCount);
 
 	for(uint32_t i = 0; i < vertexCount; i++) {
-		vertices[i] = ::deserialize<Vec3f>(istream);
+		setInBuf(vertices, vertexCount, i, ::deserialize<Vec3f>(istream));
 	}
 	for(uint32_t i = 0; i < triangleCount; i++) {
-		triangles[i] = ::deserialize<Triangle>(istream);
+		setInBuf(triangles, triangleCount, i, ::deserialize<Triangle>(istream));
 	}
+	fixFinalBlock(vertices.get(), vertexCount);
+	fixFinalBlock(triangles.get(), triangleCount);
 
-	Polyhedron result(vertices, triangles, vertexCount, triangleCount);
-	delete[] vertices;
-	delete[] triangles;
-	return result;
+	return Polyhedron::fromParallelBuffers(std::move(vertices), std::move(triangles), vertexCount, triangleCount);
 }
 
 void ShapeSerializer::include(const Shape& shape) {
@@ -115,6 +117,75 @@ NormalizedPolyhedron* deserializeNormalizedPolyhedron(std::istream& istream) {
 	return result;
 }
 
+void serializeCapsule(const CapsuleClass& capsule, std::ostream& ostream) {
+	::serialize<double>(capsule.capRatio, ostream);
+}
+CapsuleClass* deserializeCapsule(std::istream& istream) {
+	double capRatio = ::deserialize<double>(istream);
+	if(!(capRatio > 0.0 && capRatio <= 1.0)) {
+		throw SerializationException("Invalid capsule cap ratio!");
+	}
+	return new CapsuleClass(capRatio);
+}
+
+void serializeHeightfield(const HeightfieldShapeClass& heightfield, std::ostream& ostream) {
+	int sampleCountX = heightfield.getSampleCountX();
+	int sampleCountZ = heightfield.getSampleCountZ();
+	::serialize<int>(sampleCountX, ostream);
+	::serialize<int>(sampleCountZ, ostream);
+	::serialize<double>(heightfield.originalScale[0] * 2, ostream);
+	::serialize<double>(heightfield.originalScale[2] * 2, ostream);
+	std::vector<float> heights(static_cast<size_t>(sampleCountX) * sampleCountZ);
+	for(int z = 0; z < sampleCountZ; z++) {
+		for(int x = 0; x < sampleCountX; x++) {
+			heights[x + z * sampleCountX] = heightfield.getOriginalHeight(x, z);
+		}
+	}
+	::serializeArray<float>(heights.data(), heights.size(), ostream);
+}
+HeightfieldShapeClass* deserializeHeightfield(std::istream& istream) {
+	int sampleCountX = ::deserialize<int>(istream);
+	int sampleCountZ = ::deserialize<int>(istream);
+	double width = ::deserialize<double>(istream);
+	double depth = ::deserialize<double>(istream);
+	if(sampleCountX < 2 || sampleCountZ < 2 || sampleCountX > INT_MAX / sampleCountZ) {
+		throw SerializationException("Invalid heightfield size!");
+	}
+	std::vector<float> heights(static_cast<size_t>(sampleCountX) * sampleCountZ);
+	::deserializeArray<float>(heights.data(), heights.size(), istream);
+	return new HeightfieldShapeClass(heights.data(), sampleCountX, sampleCountZ, width, depth);
+}
+
+void serializeTriangleMesh(const TriangleMeshShapeClass& mesh, std::ostream& ostream) {
+	::serialize<int>(mesh.getVertexCount(), ostream);
+	::serialize<int>(mesh.getTriangleCount(), ostream);
+	for(int i = 0; i < mesh.getVertexCount(); i++) {
+		::serialize<Vec3f>(mesh.getOriginalVertex(i), ostream);
+	}
+	for(int i = 0; i < mesh.getTriangleCount(); i++) {
+		::serialize<Triangle>(mesh.getTriangle(i), ostream);
+	}
+}
+TriangleMeshShapeClass* deserializeTriangleMesh(std::istream& istream) {
+	int vertexCount = ::deserialize<int>(istream);
+	int triangleCount = ::deserialize<int>(istream);
+	if(vertexCount <= 0 || triangleCount <= 0) {
+		throw SerializationException("Invalid triangle mesh size!");
+	}
+	std::vector<Vec3f> vertices(vertexCount);
+	std::vector<Triangle> triangles(triangleCount);
+	::deserializeArray<Vec3f>(vertices.data(), vertices.size(), istream);
+	::deserializeArray<Triangle>(triangles.data(), triangles.size(), istream);
+	for(const Triangle& triangle : triangles) {
+		for(int k = 0; k < 3; k++) {
+			if(triangle[k] < 0 || triangle[k] >= vertexCount) {
+				throw SerializationException("Triangle mesh refers to a vertex that does not exist!");
+			}
+		}
+	}
+	return new TriangleMeshShapeClass(vertices.data(), triangles.data(), vertexCount, triangleCount);
+}
+
 void serializeDirectionalGravity(const DirectionalGravity& gravity, std::ostream& ostream) {
 	::serialize<Vec3>(gravity.gravity, ostream);
 }
@@ -173,6 +244,7 @@ RigidBody DeSerializationSessionPrototype::deserializeRigidBodyWithContext(std::
 		Part* newPart = virtualDeserializePart(deserializeRawPart(GlobalCFrame(), istream), istream);
 		result.parts.push_back(AttachedPart{attach, newPart});
 	}
+	result.refreshWithNewParts();
 	return result;
 }
 
@@ -318,17 +390,23 @@ void DeSerializationSessionPrototype::deserializeWorld(WorldPrototype& world, st
 	uint64_t numberOfTerrainParts = ::deserialize<uint64_t>(istream);
 	world.physicals.reserve(numberOfPhysicals);
 
+	// the stream has to be read in order, but the parts are added to the world in one bulk step
+	std::vector<Part*> mainParts(numberOfPhysicals);
 	for(uint64_t i = 0; i < numberOfPhysicals; i++) {
 		MotorizedPhysical* p = deserializeMotorizedPhysicalWithContext(istream);
-		world.addPart(p->getMainPart());
+		mainParts[i] = p->getMainPart();
 	}
 
+	std::vector<Part*> terrainParts(numberOfTerrainParts);
 	for(uint64_t i = 0; i < numberOfTerrainParts; i++) {
 		GlobalCFrame cf = ::deserialize<GlobalCFrame>(istream);
 		Part* p = virtualDeserializePart(deserializeRawPart(GlobalCFrame(), istream), istream);
 		p->setCFrame(cf);
-		world.addTerrainPart(p);
+		terrainParts[i] = p;
 	}
+
+	world.addParts(mainParts.data(), mainParts.size());
+	world.addTerrainParts(terrainParts.data(), terrainParts.size());
 }
 
 void SerializationSessionPrototype::serializeParts(const Part* const parts[], size_t partCount, std::ostream& ostream) {
@@ -400,6 +478,12 @@ static DynamicSerializerRegistry<HardConstraint>::ConcreteDynamicSerializer<Sinu
 
 static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<NormalizedPolyhedron> polyhedronSerializer
 (serializeNormalizedPolyhedron, deserializeNormalizedPolyhedron, 0);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<HeightfieldShapeClass> heightfieldSerializer
+(serializeHeightfield, deserializeHeightfield, 1);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<TriangleMeshShapeClass> triangleMeshSerializer
+(serializeTriangleMesh, deserializeTriangleMesh, 2);
+static DynamicSerializerRegistry<ShapeClass>::ConcreteDynamicSerializer<CapsuleClass> capsuleSerializer
+(serializeCapsule, deserializeCapsule, 3);
 
 static DynamicSerializerRegistry<ExternalForce>::ConcreteDynamicSerializer<DirectionalGravity> gravitySerializer
 (serializeDirectionalGravity, deserializeDirectionalGravity, 0);
@@ -413,6 +497,9 @@ DynamicSerializerRegistry<HardConstraint> dynamicHardConstraintSerializer{
 };
 DynamicSerializerRegistry<ShapeClass> dynamicShapeClassSerializer{
 	{typeid(NormalizedPolyhedron), &polyhedronSerializer},
+	{typeid(HeightfieldShapeClass), &heightfieldSerializer},
+	{typeid(TriangleMeshShapeClass), &triangleMeshSerializer},
+	{typeid(CapsuleClass), &capsuleSerializer},
 };
 DynamicSerializerRegistry<ExternalForce> dynamicExternalForceSerializer{
 	{typeid(DirectionalGravity), &gravitySerializer},
@@ -116,11 +116,19 @@ inline std::ostream& operator<<(std::ostream& os, const EigenValues<N, Size>& v)
 	return os;
 }
 
-inline std::ostream& operator<<(std::ostream& os, const Rotation& rotation) {
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const MatrixRotationTemplate<T>& rotation) {
 	os << rotation.asRotationMatrix();
 	return os;
 }
 
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const QuaternionRotationTemplate<T>& rotation) {
+	Quaternion<T> q = rotation.asQuaternion();
+	os << "Quaternion(" << q.w << ", " << q.x << ", " << q.y << ", " << q.z << ")";
+	return os;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const CFrame& cframe) {
 	os << "CFrame(" << cframe.position << ", " << cframe.rotation << ")";
 	return os;
@@ -0,0 +1,590 @@
+#include "worldCheckpoint.h"
+
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+
+#include "serialization.h"
+#include "../world.h"
+#include "../physical.h"
+#include "../rigidBody.h"
+#include "../math/rotation.h"
+
+#include "../../util/serializeBasicTypes.h"
+#include "../../util/parallelFor.h"
+
+#define CHECKPOINT_CFRAME_CHANGED 0x1
+#define CHECKPOINT_MOTION_CHANGED 0x2
+#define CHECKPOINT_CONNECTIONS_CHANGED 0x4
+
+#pragma region encoding
+
+static void writeVarInt(std::string& out, uint64_t value) {
+	while(value >= 0x80) {
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+static uint64_t zigZagEncode(int64_t value) {
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t zigZagDecode(uint64_t value) {
+	return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+template<typename T>
+static void writeRaw(std::string& out, const T& value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class DeltaReader {
+	const char* cur;
+	const char* end;
+
+public:
+	DeltaReader(const std::string& data) : cur(data.data()), end(data.data() + data.size()) {}
+
+	const char* readBytes(size_t count) {
+		if(count > static_cast<size_t>(end - cur)) {
+			throw SerializationException("Checkpoint delta is truncated!");
+		}
+		const char* result = cur;
+		cur += count;
+		return result;
+	}
+
+	uint64_t readVarInt() {
+		uint64_t result = 0;
+		for(int shift = 0; shift < 64; shift += 7) {
+			uint8_t byte = static_cast<uint8_t>(*readBytes(1));
+			result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if((byte & 0x80) == 0) return result;
+		}
+		throw SerializationException("Invalid varint in checkpoint delta!");
+	}
+
+	template<typename T>
+	T readRaw() {
+		T result;
+		std::memcpy(&result, readBytes(sizeof(T)), sizeof(T));
+		return result;
+	}
+};
+
+#pragma endregion
+
+#pragma region tracking
+
+// exact comparisons, the math types contain only doubles and Fix values so they have no padding
+template<typename T>
+static bool bitwiseEqual(const T& a, const T& b) {
+	return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+bool WorldCheckpointRecorder::isSamePart(const Part& part, const CFrame& attachment, const TrackedPart& tracked) {
+	return tracked.part == &part &&
+		tracked.shapeClass == part.hitbox.baseShape &&
+		bitwiseEqual(tracked.scale, part.hitbox.scale) &&
+		bitwiseEqual(tracked.properties, part.properties) &&
+		bitwiseEqual(tracked.attachment, attachment);
+}
+
+void WorldCheckpointRecorder::collectStructure(const Physical& phys, std::vector<TrackedPart>& parts, std::vector<uint32_t>& childCounts) {
+	const Part& mainPart = *phys.rigidBody.mainPart;
+	parts.push_back(TrackedPart{&mainPart, mainPart.hitbox.baseShape, mainPart.hitbox.scale, mainPart.properties, CFrame()});
+	for(const AttachedPart& atPart : phys.rigidBody.parts) {
+		const Part& part = *atPart.part;
+		parts.push_back(TrackedPart{&part, part.hitbox.baseShape, part.hitbox.scale, part.properties, atPart.attachment});
+	}
+	childCounts.push_back(static_cast<uint32_t>(phys.childPhysicals.size()));
+	for(const ConnectedPhysical& child : phys.childPhysicals) {
+		collectStructure(child, parts, childCounts);
+	}
+}
+
+bool WorldCheckpointRecorder::matchesStructure(const Physical& phys, const std::vector<TrackedPart>& parts, const std::vector<uint32_t>& childCounts, size_t& partIndex, size_t& physicalIndex) {
+	if(partIndex + 1 + phys.rigidBody.parts.size() > parts.size() || physicalIndex >= childCounts.size()) return false;
+
+	if(!isSamePart(*phys.rigidBody.mainPart, CFrame(), parts[partIndex++])) return false;
+	for(const AttachedPart& atPart : phys.rigidBody.parts) {
+		if(!isSamePart(*atPart.part, atPart.attachment, parts[partIndex++])) return false;
+	}
+	if(childCounts[physicalIndex++] != phys.childPhysicals.size()) return false;
+	for(const ConnectedPhysical& child : phys.childPhysicals) {
+		if(!matchesStructure(child, parts, childCounts, partIndex, physicalIndex)) return false;
+	}
+	return true;
+}
+
+/*
+	Attachments and constraint state of all connections of the physical, in depth first order
+*/
+static std::string serializeConnections(const MotorizedPhysical& phys) {
+	if(phys.childPhysicals.empty()) return std::string();
+
+	std::ostringstream ostream;
+	phys.forEachHardConstraint([&ostream](const Physical& parent, const ConnectedPhysical& child) {
+		const HardPhysicalConnection& connection = child.connectionToParent;
+		::serialize<CFrame>(connection.attachOnChild, ostream);
+		::serialize<CFrame>(connection.attachOnParent, ostream);
+		dynamicHardConstraintSerializer.serialize(*connection.constraintWithParent, ostream);
+	});
+	return ostream.str();
+}
+
+static void deserializeConnections(MotorizedPhysical& phys, const char* data, size_t size) {
+	std::istringstream istream(std::string(data, size));
+	phys.forEachHardConstraint([&istream](Physical& parent, ConnectedPhysical& child) {
+		HardPhysicalConnection& connection = child.connectionToParent;
+		connection.attachOnChild = ::deserialize<CFrame>(istream);
+		connection.attachOnParent = ::deserialize<CFrame>(istream);
+		connection.constraintWithParent.reset(dynamicHardConstraintSerializer.deserialize(istream));
+	});
+}
+
+void WorldCheckpointRecorder::trackPhysical(const MotorizedPhysical& phys, TrackedPhysical& tracked) const {
+	tracked.lastCapture = captureCount;
+	tracked.cframe = phys.getCFrame();
+	tracked.motion = phys.motionOfCenterOfMass;
+	tracked.parts.clear();
+	tracked.childCounts.clear();
+	collectStructure(phys, tracked.parts, tracked.childCounts);
+	tracked.connectionData = serializeConnections(phys);
+}
+
+#pragma endregion
+
+#pragma region capture
+
+WorldCheckpointRecorder::WorldCheckpointRecorder(size_t snapshotInterval, size_t maxSnapshotCount, const std::vector<const ShapeClass*>& knownShapeClasses) :
+	snapshotInterval(std::max<size_t>(snapshotInterval, 1)),
+	maxSnapshotCount(std::max<size_t>(maxSnapshotCount, 1)),
+	knownShapeClasses(knownShapeClasses) {}
+
+std::unique_ptr<WorldFileWriter> WorldCheckpointRecorder::createWriter() const {
+	return std::make_unique<WorldFileWriter>(knownShapeClasses);
+}
+
+std::unique_ptr<WorldFileReader> WorldCheckpointRecorder::createReader(const char* data, size_t size) const {
+	return std::make_unique<WorldFileReader>(data, size, knownShapeClasses);
+}
+
+void WorldCheckpointRecorder::captureSnapshot(const WorldPrototype& world) {
+	uint64_t age = world.age;
+	if(!snapshots.empty() && age <= getNewestTick()) {
+		truncateAfter(age);
+	}
+
+	std::ostringstream ostream;
+	createWriter()->writeWorld(world, ostream);
+	std::string fileData = ostream.str();
+
+	// the world file reader requires aligned data
+	Snapshot snapshot{age, UniqueAlignedPointer<char>(fileData.size(), WORLD_FILE_ALIGNMENT), fileData.size(), std::vector<Delta>()};
+	std::memcpy(snapshot.data.get(), fileData.data(), fileData.size());
+
+	// ids follow the order of the snapshot, physicals first, then the terrain parts
+	captureCount++;
+	trackedPhysicals.clear();
+	trackedTerrainParts.clear();
+	trackedPhysicals.reserve(world.physicals.size());
+	nextID = 0;
+	for(const MotorizedPhysical* phys : world.physicals) {
+		TrackedPhysical& tracked = trackedPhysicals[phys];
+		tracked.id = nextID++;
+		trackPhysical(*phys, tracked);
+	}
+	for(const Part& part : world.iterParts(TERRAIN_PARTS)) {
+		trackedTerrainParts.emplace(&part, TrackedTerrainPart{nextID++, captureCount});
+	}
+
+	lastCaptureSize = snapshot.size;
+	snapshots.push_back(std::move(snapshot));
+	if(snapshots.size() > maxSnapshotCount) {
+		snapshots.erase(snapshots.begin());
+	}
+}
+
+/*
+	The physicals of the world are compared to their tracked state in parallel chunks, the chunks are concatenated in order
+	The first state of a chunk is written on concatenation, as its id is stored relative to the last state of the previous chunk
+*/
+struct CaptureChunk {
+	std::vector<uint32_t> removedIDs;
+	std::vector<const MotorizedPhysical*> addedPhysicals;
+	std::vector<const MotorizedPhysical*> restructuredPhysicals;
+	std::string stateData;
+	size_t stateCount = 0;
+	uint32_t firstStateID = 0;
+	uint32_t lastStateID = 0;
+};
+
+void WorldCheckpointRecorder::capture(const WorldPrototype& world) {
+	uint64_t age = world.age;
+	if(snapshots.empty() || age <= getNewestTick() || snapshots.back().deltas.size() + 1 >= snapshotInterval) {
+		captureSnapshot(world);
+		return;
+	}
+
+	captureCount++;
+
+	std::vector<CaptureChunk> chunks(Util::getChunkCount(world.physicals.size(), 1024));
+	Util::parallelForChunks(world.physicals.size(), chunks.size(), [&](size_t chunkIndex, size_t begin, size_t end) {
+		CaptureChunk& chunk = chunks[chunkIndex];
+		for(size_t i = begin; i < end; i++) {
+			const MotorizedPhysical* phys = world.physicals[i];
+			auto found = trackedPhysicals.find(phys);
+			if(found == trackedPhysicals.end()) {
+				chunk.addedPhysicals.push_back(phys);
+				continue;
+			}
+			TrackedPhysical& tracked = found->second;
+
+			size_t partIndex = 0;
+			size_t physicalIndex = 0;
+			if(!matchesStructure(*phys, tracked.parts, tracked.childCounts, partIndex, physicalIndex) || partIndex != tracked.parts.size() || physicalIndex != tracked.childCounts.size()) {
+				chunk.removedIDs.push_back(tracked.id);
+				chunk.addedPhysicals.push_back(phys);
+				chunk.restructuredPhysicals.push_back(phys);
+				continue;
+			}
+			tracked.lastCapture = captureCount;
+
+			uint8_t flags = 0;
+			const GlobalCFrame& cframe = phys->getCFrame();
+			if(!bitwiseEqual(cframe, tracked.cframe)) flags |= CHECKPOINT_CFRAME_CHANGED;
+			if(!bitwiseEqual(phys->motionOfCenterOfMass, tracked.motion)) flags |= CHECKPOINT_MOTION_CHANGED;
+			std::string connectionData = serializeConnections(*phys);
+			if(connectionData != tracked.connectionData) flags |= CHECKPOINT_CONNECTIONS_CHANGED;
+			if(flags == 0) continue;
+
+			std::string& out = chunk.stateData;
+			if(chunk.stateCount == 0) {
+				chunk.firstStateID = tracked.id;
+			} else {
+				writeVarInt(out, zigZagEncode(static_cast<int64_t>(tracked.id) - chunk.lastStateID));
+			}
+			chunk.lastStateID = tracked.id;
+			chunk.stateCount++;
+
+			out.push_back(static_cast<char>(flags));
+			if(flags & CHECKPOINT_CFRAME_CHANGED) {
+				// exact, and small for parts that only moved a little
+				Position position = cframe.getPosition();
+				writeVarInt(out, zigZagEncode(position.x.value - tracked.cframe.getPosition().x.value));
+				writeVarInt(out, zigZagEncode(position.y.value - tracked.cframe.getPosition().y.value));
+				writeVarInt(out, zigZagEncode(position.z.value - tracked.cframe.getPosition().z.value));
+				writeRaw<Rotationf>(out, static_cast<Rotationf>(cframe.getRotation()));
+				tracked.cframe = cframe;
+			}
+			if(flags & CHECKPOINT_MOTION_CHANGED) {
+				const Motion& motion = phys->motionOfCenterOfMass;
+				writeRaw<Vec3f>(out, motion.getVelocity());
+				writeRaw<Vec3f>(out, motion.getAngularVelocity());
+				writeRaw<Vec3f>(out, motion.getAcceleration());
+				writeRaw<Vec3f>(out, motion.getAngularAcceleration());
+				tracked.motion = motion;
+			}
+			if(flags & CHECKPOINT_CONNECTIONS_CHANGED) {
+				writeVarInt(out, connectionData.size());
+				out.append(connectionData);
+				tracked.connectionData = std::move(connectionData);
+			}
+		}
+	});
+
+	std::vector<uint32_t> removedIDs;
+	std::vector<const MotorizedPhysical*> addedPhysicals;
+	std::vector<const Part*> addedTerrainParts;
+	for(const CaptureChunk& chunk : chunks) {
+		removedIDs.insert(removedIDs.end(), chunk.removedIDs.begin(), chunk.removedIDs.end());
+		addedPhysicals.insert(addedPhysicals.end(), chunk.addedPhysicals.begin(), chunk.addedPhysicals.end());
+		for(const MotorizedPhysical* phys : chunk.restructuredPhysicals) {
+			trackedPhysicals.erase(phys);
+		}
+	}
+	size_t seenPhysicalCount = world.physicals.size() - addedPhysicals.size();
+
+	size_t seenTerrainPartCount = 0;
+	for(const Part& part : world.iterParts(TERRAIN_PARTS)) {
+		auto found = trackedTerrainParts.find(&part);
+		if(found == trackedTerrainParts.end()) {
+			addedTerrainParts.push_back(&part);
+		} else {
+			found->second.lastCapture = captureCount;
+			seenTerrainPartCount++;
+		}
+	}
+
+	// everything that was not encountered in the world has been removed, only look for it when something is missing
+	if(seenPhysicalCount != trackedPhysicals.size()) {
+		for(auto iter = trackedPhysicals.begin(); iter != trackedPhysicals.end();) {
+			if(iter->second.lastCapture != captureCount) {
+				removedIDs.push_back(iter->second.id);
+				iter = trackedPhysicals.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+	}
+	if(seenTerrainPartCount != trackedTerrainParts.size()) {
+		for(auto iter = trackedTerrainParts.begin(); iter != trackedTerrainParts.end();) {
+			if(iter->second.lastCapture != captureCount) {
+				removedIDs.push_back(iter->second.id);
+				iter = trackedTerrainParts.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+	}
+
+	Delta delta{age, std::string()};
+	std::string& out = delta.data;
+
+	std::sort(removedIDs.begin(), removedIDs.end());
+	writeVarInt(out, removedIDs.size());
+	uint32_t previousRemovedID = 0;
+	for(uint32_t id : removedIDs) {
+		writeVarInt(out, id - previousRemovedID);
+		previousRemovedID = id;
+	}
+
+	writeVarInt(out, addedPhysicals.size());
+	writeVarInt(out, addedTerrainParts.size());
+	if(!addedPhysicals.empty() || !addedTerrainParts.empty()) {
+		std::ostringstream addedStream;
+		createWriter()->writeParts(addedPhysicals.data(), addedPhysicals.size(), addedTerrainParts.data(), addedTerrainParts.size(), addedStream);
+		std::string addedData = addedStream.str();
+
+		writeVarInt(out, nextID);
+		writeVarInt(out, addedData.size());
+		out.append(addedData);
+
+		for(const MotorizedPhysical* phys : addedPhysicals) {
+			TrackedPhysical& tracked = trackedPhysicals[phys];
+			tracked.id = nextID++;
+			trackPhysical(*phys, tracked);
+		}
+		for(const Part* part : addedTerrainParts) {
+			trackedTerrainParts.emplace(part, TrackedTerrainPart{nextID++, captureCount});
+		}
+	}
+
+	size_t stateCount = 0;
+	for(const CaptureChunk& chunk : chunks) {
+		stateCount += chunk.stateCount;
+	}
+	writeVarInt(out, stateCount);
+	int64_t previousStateID = 0;
+	for(const CaptureChunk& chunk : chunks) {
+		if(chunk.stateCount == 0) continue;
+		writeVarInt(out, zigZagEncode(static_cast<int64_t>(chunk.firstStateID) - previousStateID));
+		out.append(chunk.stateData);
+		previousStateID = chunk.lastStateID;
+	}
+
+	lastCaptureSize = out.size();
+	snapshots.back().deltas.push_back(std::move(delta));
+}
+
+void WorldCheckpointRecorder::truncateAfter(uint64_t age) {
+	while(!snapshots.empty() && snapshots.back().age >= age) {
+		snapshots.pop_back();
+	}
+	if(!snapshots.empty()) {
+		std::vector<Delta>& deltas = snapshots.back().deltas;
+		deltas.erase(std::find_if(deltas.begin(), deltas.end(), [age](const Delta& d) { return d.age >= age; }), deltas.end());
+	}
+}
+
+void WorldCheckpointRecorder::clear() {
+	snapshots.clear();
+	trackedPhysicals.clear();
+	trackedTerrainParts.clear();
+	nextID = 0;
+	lastCaptureSize = 0;
+}
+
+#pragma endregion
+
+#pragma region restore
+
+void WorldCheckpointRecorder::restore(uint64_t age, WorldPrototype& world) const {
+	if(!hasTick(age)) {
+		throw SerializationException("Tick " + std::to_string(age) + " was not recorded!");
+	}
+	auto snapshot = std::find_if(snapshots.rbegin(), snapshots.rend(), [age](const Snapshot& s) { return s.age <= age; });
+
+	// indexed by id, at most one of both is set
+	std::vector<MotorizedPhysical*> physicalsByID;
+	std::vector<Part*> terrainPartsByID;
+	std::vector<bool> touched;
+
+	std::unique_ptr<WorldFileReader> snapshotReader = createReader(snapshot->data.get(), snapshot->size);
+	snapshotReader->readParts(physicalsByID, terrainPartsByID);
+	snapshotReader->readExternalForces(world);
+	terrainPartsByID.insert(terrainPartsByID.begin(), physicalsByID.size(), nullptr);
+	physicalsByID.resize(terrainPartsByID.size(), nullptr);
+	touched.resize(physicalsByID.size(), false);
+
+	for(const Delta& delta : snapshot->deltas) {
+		if(delta.age > age) break;
+		DeltaReader reader(delta.data);
+
+		size_t removedCount = reader.readVarInt();
+		uint64_t removedID = 0;
+		for(size_t i = 0; i < removedCount; i++) {
+			removedID += reader.readVarInt();
+			if(removedID >= physicalsByID.size()) {
+				throw SerializationException("Checkpoint removes an unknown part!");
+			}
+			if(physicalsByID[removedID] != nullptr) {
+				std::vector<Part*> parts;
+				physicalsByID[removedID]->forEachPart([&parts](Part& part) {
+					parts.push_back(&part);
+				});
+				// deleting the last part of a physical deletes the physical
+				for(Part* part : parts) {
+					deletePart(part);
+				}
+				physicalsByID[removedID] = nullptr;
+			} else if(terrainPartsByID[removedID] != nullptr) {
+				deletePart(terrainPartsByID[removedID]);
+				terrainPartsByID[removedID] = nullptr;
+			} else {
+				throw SerializationException("Checkpoint removes a part twice!");
+			}
+		}
+
+		size_t addedPhysicalCount = reader.readVarInt();
+		size_t addedTerrainPartCount = reader.readVarInt();
+		if(addedPhysicalCount != 0 || addedTerrainPartCount != 0) {
+			size_t firstID = reader.readVarInt();
+			size_t addedSize = reader.readVarInt();
+			const char* addedData = reader.readBytes(addedSize);
+			if(firstID != physicalsByID.size()) {
+				throw SerializationException("Checkpoint deltas are out of order!");
+			}
+
+			UniqueAlignedPointer<char> alignedData(addedSize, WORLD_FILE_ALIGNMENT);
+			std::memcpy(alignedData.get(), addedData, addedSize);
+			std::vector<MotorizedPhysical*> addedPhysicals;
+			std::vector<Part*> addedTerrainParts;
+			createReader(alignedData.get(), addedSize)->readParts(addedPhysicals, addedTerrainParts);
+			if(addedPhysicals.size() != addedPhysicalCount || addedTerrainParts.size() != addedTerrainPartCount) {
+				throw SerializationException("Checkpoint added parts do not match!");
+			}
+
+			physicalsByID.insert(physicalsByID.end(), addedPhysicals.begin(), addedPhysicals.end());
+			physicalsByID.resize(physicalsByID.size() + addedTerrainPartCount, nullptr);
+			terrainPartsByID.resize(terrainPartsByID.size() + addedPhysicalCount, nullptr);
+			terrainPartsByID.insert(terrainPartsByID.end(), addedTerrainParts.begin(), addedTerrainParts.end());
+			touched.resize(physicalsByID.size(), false);
+		}
+
+		size_t stateCount = reader.readVarInt();
+		int64_t id = 0;
+		for(size_t i = 0; i < stateCount; i++) {
+			id += zigZagDecode(reader.readVarInt());
+			if(id < 0 || static_cast<size_t>(id) >= physicalsByID.size() || physicalsByID[id] == nullptr) {
+				throw SerializationException("Checkpoint changes an unknown physical!");
+			}
+			MotorizedPhysical* phys = physicalsByID[id];
+			touched[id] = true;
+
+			uint8_t flags = reader.readRaw<uint8_t>();
+			if(flags & CHECKPOINT_CFRAME_CHANGED) {
+				Position position = phys->getCFrame().getPosition();
+				position.x.value += zigZagDecode(reader.readVarInt());
+				position.y.value += zigZagDecode(reader.readVarInt());
+				position.z.value += zigZagDecode(reader.readVarInt());
+				Rotation rotation = static_cast<Rotation>(reader.readRaw<Rotationf>());
+				phys->rigidBody.setCFrame(GlobalCFrame(position, rotation));
+			}
+			if(flags & CHECKPOINT_MOTION_CHANGED) {
+				Vec3 velocity = reader.readRaw<Vec3f>();
+				Vec3 angularVelocity = reader.readRaw<Vec3f>();
+				Vec3 acceleration = reader.readRaw<Vec3f>();
+				Vec3 angularAcceleration = reader.readRaw<Vec3f>();
+				phys->motionOfCenterOfMass = Motion(velocity, angularVelocity, acceleration, angularAcceleration);
+			}
+			if(flags & CHECKPOINT_CONNECTIONS_CHANGED) {
+				size_t connectionSize = reader.readVarInt();
+				deserializeConnections(*phys, reader.readBytes(connectionSize), connectionSize);
+			}
+		}
+	}
+
+	std::vector<Part*> mainParts;
+	std::vector<Part*> terrainParts;
+	for(size_t i = 0; i < physicalsByID.size(); i++) {
+		if(physicalsByID[i] != nullptr) {
+			if(touched[i]) {
+				physicalsByID[i]->fullRefreshOfConnectedPhysicals();
+				physicalsByID[i]->refreshPhysicalProperties();
+			}
+			mainParts.push_back(physicalsByID[i]->getMainPart());
+		} else if(terrainPartsByID[i] != nullptr) {
+			terrainParts.push_back(terrainPartsByID[i]);
+		}
+	}
+
+	world.addParts(mainParts.data(), mainParts.size());
+	world.addTerrainParts(terrainParts.data(), terrainParts.size());
+	world.age = age;
+}
+
+#pragma endregion
+
+#pragma region statistics
+
+bool WorldCheckpointRecorder::hasTick(uint64_t age) const {
+	for(const Snapshot& snapshot : snapshots) {
+		if(snapshot.age == age) return true;
+		for(const Delta& delta : snapshot.deltas) {
+			if(delta.age == age) return true;
+		}
+	}
+	return false;
+}
+
+uint64_t WorldCheckpointRecorder::getOldestTick() const {
+	return snapshots.empty() ? 0 : snapshots.front().age;
+}
+
+uint64_t WorldCheckpointRecorder::getNewestTick() const {
+	if(snapshots.empty()) return 0;
+	const Snapshot& newest = snapshots.back();
+	return newest.deltas.empty() ? newest.age : newest.deltas.back().age;
+}
+
+size_t WorldCheckpointRecorder::getTickCount() const {
+	size_t count = 0;
+	for(const Snapshot& snapshot : snapshots) {
+		count += 1 + snapshot.deltas.size();
+	}
+	return count;
+}
+
+size_t WorldCheckpointRecorder::getSnapshotBytes() const {
+	size_t total = 0;
+	for(const Snapshot& snapshot : snapshots) {
+		total += snapshot.size;
+	}
+	return total;
+}
+
+size_t WorldCheckpointRecorder::getDeltaBytes() const {
+	size_t total = 0;
+	for(const Snapshot& snapshot : snapshots) {
+		for(const Delta& delta : snapshot.deltas) {
+			total += delta.data.size();
+		}
+	}
+	return total;
+}
+
+#pragma endregion
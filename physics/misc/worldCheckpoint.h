@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "../math/globalCFrame.h"
+#include "../math/cframe.h"
+#include "../math/linalg/mat.h"
+#include "../motion.h"
+#include "../part.h"
+#include "../datastructures/alignedPtr.h"
+
+#include "worldFile.h"
+
+class WorldPrototype;
+class ShapeClass;
+class Physical;
+class MotorizedPhysical;
+
+/*
+	Records the state of a world at every captured tick, for crash recovery and replay
+
+	Every snapshotInterval ticks a full world file is stored, the ticks in between only store what changed since the previous capture:
+		the CFrames and motions of motorized physicals,
+		the attachments and constraint state of their connections,
+		added and removed physicals and terrain parts
+	A physical whose parts, shapes, properties or attachments changed is stored as removed and added again.
+
+	Positions are stored exactly, as differences in Fix units to the previous capture.
+	Rotations and motions are quantized to floats, so a restored tick between two snapshots matches the recorded world within float precision.
+	Data stored by WorldFileWriter::serializePartExtension is only recorded when a part is added, changes to it are not tracked.
+*/
+class WorldCheckpointRecorder {
+	struct TrackedPart {
+		const Part* part;
+		const ShapeClass* shapeClass;
+		DiagonalMat3 scale;
+		PartProperties properties;
+		CFrame attachment;
+	};
+
+	struct TrackedPhysical {
+		uint32_t id;
+		uint64_t lastCapture;
+		GlobalCFrame cframe;
+		Motion motion;
+		// parts and the child count of every physical, both in depth first order
+		std::vector<TrackedPart> parts;
+		std::vector<uint32_t> childCounts;
+		std::string connectionData;
+	};
+
+	struct TrackedTerrainPart {
+		uint32_t id;
+		uint64_t lastCapture;
+	};
+
+	struct Delta {
+		uint64_t age;
+		std::string data;
+	};
+
+	struct Snapshot {
+		uint64_t age;
+		UniqueAlignedPointer<char> data;
+		size_t size;
+		std::vector<Delta> deltas;
+	};
+
+	size_t snapshotInterval;
+	size_t maxSnapshotCount;
+	std::vector<const ShapeClass*> knownShapeClasses;
+
+	std::vector<Snapshot> snapshots;
+	std::unordered_map<const MotorizedPhysical*, TrackedPhysical> trackedPhysicals;
+	std::unordered_map<const Part*, TrackedTerrainPart> trackedTerrainParts;
+	uint32_t nextID = 0;
+	uint64_t captureCount = 0;
+	size_t lastCaptureSize = 0;
+
+	static bool isSamePart(const Part& part, const CFrame& attachment, const TrackedPart& tracked);
+	static void collectStructure(const Physical& phys, std::vector<TrackedPart>& parts, std::vector<uint32_t>& childCounts);
+	static bool matchesStructure(const Physical& phys, const std::vector<TrackedPart>& parts, const std::vector<uint32_t>& childCounts, size_t& partIndex, size_t& physicalIndex);
+	void trackPhysical(const MotorizedPhysical& phys, TrackedPhysical& tracked) const;
+	void truncateAfter(uint64_t age);
+
+protected:
+	/*
+		Override to record extended parts, the writer and reader must match like for a regular world file
+	*/
+	virtual std::unique_ptr<WorldFileWriter> createWriter() const;
+	virtual std::unique_ptr<WorldFileReader> createReader(const char* data, size_t size) const;
+	/*
+		Deletes a restored part that is removed again by a later tick, override when createReader creates extended parts
+	*/
+	virtual void deletePart(Part* part) const { delete part; }
+
+public:
+	/*
+		A full snapshot is stored every snapshotInterval captures, only the last maxSnapshotCount snapshots and their deltas are kept
+	*/
+	WorldCheckpointRecorder(size_t snapshotInterval = 256, size_t maxSnapshotCount = 4, const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
+	virtual ~WorldCheckpointRecorder() = default;
+
+	WorldCheckpointRecorder(const WorldCheckpointRecorder&) = delete;
+	WorldCheckpointRecorder& operator=(const WorldCheckpointRecorder&) = delete;
+
+	/*
+		Records the world at its current age, as a full snapshot or as a delta to the previous capture
+		Capturing an age that is not newer than the last captured one discards the recorded ticks from that age onwards
+	*/
+	void capture(const WorldPrototype& world);
+	/*
+		Always records a full snapshot, required after the world was replaced, for example by restore
+	*/
+	void captureSnapshot(const WorldPrototype& world);
+
+	/*
+		Adds the parts of the given tick to world, which is expected to be empty, and sets its age
+		Throws SerializationException if the tick was not recorded
+	*/
+	void restore(uint64_t age, WorldPrototype& world) const;
+
+	bool hasTick(uint64_t age) const;
+	uint64_t getOldestTick() const;
+	uint64_t getNewestTick() const;
+	size_t getTickCount() const;
+
+	size_t getSnapshotBytes() const;
+	size_t getDeltaBytes() const;
+	/*
+		Size in bytes of the snapshot or delta recorded by the last capture
+	*/
+	size_t getLastCaptureSize() const { return lastCaptureSize; }
+
+	void clear();
+};
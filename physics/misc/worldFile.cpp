@@ -0,0 +1,742 @@
+#include "worldFile.h"
+
+#include <cstring>
+#include <sstream>
+#include <fstream>
+#include <map>
+
+#include "serialization.h"
+#include "../world.h"
+#include "../physical.h"
+#include "../geometry/shapeClass.h"
+#include "../geometry/polyhedron.h"
+#include "../geometry/normalizedPolyhedron.h"
+#include "../geometry/polyhedronInternals.h"
+
+#include "../../util/parallelFor.h"
+
+static const char worldFileMagic[8]{'P', '3', 'D', 'W', 'O', 'R', 'L', 'D'};
+
+static const ShapeClass* builtinShapeClasses[]{boxClass, sphereClass, cylinderClass};
+
+static size_t alignToWorldFile(size_t offset) {
+	return (offset + WORLD_FILE_ALIGNMENT - 1) & ~static_cast<size_t>(WORLD_FILE_ALIGNMENT - 1);
+}
+
+/*
+	Element sizes of every section, 1 for sections containing arbitrary byte data
+*/
+static const uint32_t sectionElementSizes[]{
+	sizeof(WorldFileInfo),
+	1,
+	sizeof(WorldFilePolyhedron),
+	1,
+	sizeof(WorldFilePhysical),
+	sizeof(Motion),
+	sizeof(WorldFileConnection),
+	1,
+	sizeof(Position),
+	sizeof(Rotation),
+	sizeof(CFrame),
+	sizeof(uint32_t),
+	sizeof(DiagonalMat3),
+	sizeof(PartProperties),
+	sizeof(uint64_t),
+	1,
+	sizeof(uint64_t),
+	1
+};
+
+/*
+	Allows std::istream based deserializers to read from the mapped file
+*/
+class MemoryInputBuffer : public std::streambuf {
+public:
+	MemoryInputBuffer(const char* begin, const char* end) {
+		char* b = const_cast<char*>(begin);
+		char* e = const_cast<char*>(end);
+		this->setg(b, b, e);
+	}
+};
+
+#pragma region WorldFileWriter
+
+WorldFileWriter::WorldFileWriter(const std::vector<const ShapeClass*>& knownShapeClasses) {
+	// ids are assigned by position, the reader rebuilds the same list
+	uint32_t id = 0;
+	for(const ShapeClass* sc : builtinShapeClasses) {
+		shapeClassIDs.emplace(sc, id++);
+	}
+	for(const ShapeClass* sc : knownShapeClasses) {
+		shapeClassIDs.emplace(sc, id++);
+	}
+	knownShapeClassCount = id;
+}
+
+void WorldFileWriter::collectShapeClass(const ShapeClass* shapeClass) {
+	if(shapeClassIDs.find(shapeClass) != shapeClassIDs.end()) return;
+
+	// the id is assigned once all shape classes are collected, polyhedra are numbered before the others
+	shapeClassIDs.emplace(shapeClass, 0);
+	if(shapeClass->intersectionClassID == CONVEX_POLYHEDRON_CLASS_ID) {
+		polyhedronShapeClasses.push_back(shapeClass);
+	} else {
+		serializedShapeClasses.push_back(shapeClass);
+	}
+}
+
+uint32_t WorldFileWriter::getShapeClassID(const ShapeClass* shapeClass) const {
+	return shapeClassIDs.at(shapeClass);
+}
+
+void WorldFileWriter::addPart(Chunk& chunk, const Part& part, const CFrame& attachment) {
+	const GlobalCFrame& cframe = part.getCFrame();
+	chunk.partPositions.push_back(cframe.getPosition());
+	chunk.partRotations.push_back(cframe.getRotation());
+	chunk.partAttachments.push_back(attachment);
+	chunk.partShapeClasses.push_back(getShapeClassID(part.hitbox.baseShape));
+	chunk.partShapeScales.push_back(part.hitbox.scale);
+	chunk.partProperties.push_back(part.properties);
+
+	chunk.partExtensionOffsets.push_back(chunk.partExtensionData.size());
+	std::ostringstream extension;
+	serializePartExtension(part, extension);
+	chunk.partExtensionData.append(extension.str());
+}
+
+void WorldFileWriter::addPhysical(Chunk& chunk, const Physical& phys, uint32_t parent, uint32_t motionOrConnectionIndex) {
+	uint32_t index = static_cast<uint32_t>(chunk.physicals.size());
+	chunk.physicals.push_back(WorldFilePhysical{
+		parent,
+		static_cast<uint32_t>(chunk.partPositions.size()),
+		static_cast<uint32_t>(phys.rigidBody.getPartCount()),
+		static_cast<uint32_t>(phys.childPhysicals.size()),
+		motionOrConnectionIndex
+	});
+
+	addPart(chunk, *phys.rigidBody.mainPart, CFrame());
+	for(const AttachedPart& atPart : phys.rigidBody.parts) {
+		addPart(chunk, *atPart.part, atPart.attachment);
+	}
+
+	for(const ConnectedPhysical& child : phys.childPhysicals) {
+		const HardPhysicalConnection& connection = child.connectionToParent;
+		uint32_t connectionIndex = static_cast<uint32_t>(chunk.connections.size());
+
+		std::ostringstream constraint;
+		dynamicHardConstraintSerializer.serialize(*connection.constraintWithParent, constraint);
+		chunk.connections.push_back(WorldFileConnection{connection.attachOnChild, connection.attachOnParent, chunk.constraintData.size()});
+		chunk.constraintData.append(constraint.str());
+
+		addPhysical(chunk, child, index, connectionIndex);
+	}
+}
+
+template<typename T>
+static void appendVector(std::vector<T>& to, const std::vector<T>& from) {
+	to.insert(to.end(), from.begin(), from.end());
+}
+
+void WorldFileWriter::appendChunk(const Chunk& chunk) {
+	uint32_t partBase = static_cast<uint32_t>(partPositions.size());
+	uint32_t physicalBase = static_cast<uint32_t>(physicals.size());
+	uint32_t motionBase = static_cast<uint32_t>(motions.size());
+	uint32_t connectionBase = static_cast<uint32_t>(connections.size());
+	uint64_t constraintBase = constraintData.size();
+	uint64_t extensionBase = partExtensionData.size();
+
+	for(WorldFilePhysical record : chunk.physicals) {
+		record.firstPart += partBase;
+		if(record.parent != WORLD_FILE_NO_PARENT) {
+			record.parent += physicalBase;
+			record.motionOrConnectionIndex += connectionBase;
+		} else {
+			record.motionOrConnectionIndex += motionBase;
+		}
+		physicals.push_back(record);
+	}
+	for(WorldFileConnection connection : chunk.connections) {
+		connection.constraintOffset += constraintBase;
+		connections.push_back(connection);
+	}
+	for(uint64_t offset : chunk.partExtensionOffsets) {
+		partExtensionOffsets.push_back(offset + extensionBase);
+	}
+
+	appendVector(motions, chunk.motions);
+	constraintData.append(chunk.constraintData);
+	appendVector(partPositions, chunk.partPositions);
+	appendVector(partRotations, chunk.partRotations);
+	appendVector(partAttachments, chunk.partAttachments);
+	appendVector(partShapeClasses, chunk.partShapeClasses);
+	appendVector(partShapeScales, chunk.partShapeScales);
+	appendVector(partProperties, chunk.partProperties);
+	partExtensionData.append(chunk.partExtensionData);
+}
+
+void WorldFileWriter::writeWorld(const WorldPrototype& world, std::ostream& ostream) {
+	std::vector<const Part*> terrainParts;
+	for(const Part& p : world.iterParts(TERRAIN_PARTS)) {
+		terrainParts.push_back(&p);
+	}
+
+	std::ostringstream externalForces;
+	for(ExternalForce* force : world.externalForces) {
+		dynamicExternalForceSerializer.serialize(*force, externalForces);
+	}
+
+	write(world.physicals.data(), world.physicals.size(), terrainParts.data(), terrainParts.size(), externalForces.str(), world.age, ostream);
+}
+
+void WorldFileWriter::writeParts(const MotorizedPhysical* const physicals[], size_t physicalCount, const Part* const terrainParts[], size_t terrainPartCount, std::ostream& ostream) {
+	write(physicals, physicalCount, terrainParts, terrainPartCount, std::string(), 0, ostream);
+}
+
+void WorldFileWriter::write(const MotorizedPhysical* const motorizedPhysicals[], size_t physicalCount, const Part* const terrainParts[], size_t terrainPartCount, const std::string& externalForceData, uint64_t age, std::ostream& ostream) {
+	info = WorldFileInfo{};
+	for(const ShapeClass* sc : polyhedronShapeClasses) {
+		shapeClassIDs.erase(sc);
+	}
+	for(const ShapeClass* sc : serializedShapeClasses) {
+		shapeClassIDs.erase(sc);
+	}
+	polyhedronShapeClasses.clear();
+	serializedShapeClasses.clear();
+	physicals.clear();
+	motions.clear();
+	connections.clear();
+	constraintData.clear();
+	partPositions.clear();
+	partRotations.clear();
+	partAttachments.clear();
+	partShapeClasses.clear();
+	partShapeScales.clear();
+	partProperties.clear();
+	partExtensionOffsets.clear();
+	partExtensionData.clear();
+
+	// shape classes are collected up front, so that the chunks only read shapeClassIDs
+	for(size_t i = 0; i < physicalCount; i++) {
+		motorizedPhysicals[i]->forEachPart([this](const Part& p) {
+			collectShapeClass(p.hitbox.baseShape);
+		});
+	}
+	for(size_t i = 0; i < terrainPartCount; i++) {
+		collectShapeClass(terrainParts[i]->hitbox.baseShape);
+	}
+	uint32_t nextShapeClassID = static_cast<uint32_t>(knownShapeClassCount);
+	for(const ShapeClass* sc : polyhedronShapeClasses) {
+		shapeClassIDs[sc] = nextShapeClassID++;
+	}
+	for(const ShapeClass* sc : serializedShapeClasses) {
+		shapeClassIDs[sc] = nextShapeClassID++;
+	}
+
+	// physicals come first, followed by the terrain parts, every chunk covers a contiguous range of both
+	size_t itemCount = physicalCount + terrainPartCount;
+	std::vector<Chunk> chunks(Util::getChunkCount(itemCount, 256));
+	Util::parallelForChunks(itemCount, chunks.size(), [&](size_t chunkIndex, size_t begin, size_t end) {
+		Chunk& chunk = chunks[chunkIndex];
+		for(size_t i = begin; i < end; i++) {
+			if(i < physicalCount) {
+				const MotorizedPhysical* phys = motorizedPhysicals[i];
+				chunk.motions.push_back(phys->motionOfCenterOfMass);
+				addPhysical(chunk, *phys, WORLD_FILE_NO_PARENT, static_cast<uint32_t>(chunk.motions.size() - 1));
+			} else {
+				addPart(chunk, *terrainParts[i - physicalCount], CFrame());
+			}
+		}
+	});
+
+	size_t totalPartCount = 0;
+	for(const Chunk& chunk : chunks) {
+		totalPartCount += chunk.partPositions.size();
+	}
+	partPositions.reserve(totalPartCount);
+	partRotations.reserve(totalPartCount);
+	partAttachments.reserve(totalPartCount);
+	partShapeClasses.reserve(totalPartCount);
+	partShapeScales.reserve(totalPartCount);
+	partProperties.reserve(totalPartCount);
+	partExtensionOffsets.reserve(totalPartCount + 1);
+
+	for(const Chunk& chunk : chunks) {
+		appendChunk(chunk);
+	}
+	partExtensionOffsets.push_back(partExtensionData.size());
+	info.terrainPartCount = terrainPartCount;
+
+	std::vector<WorldFilePolyhedron> polyhedra;
+	std::string polyhedronData;
+	polyhedra.reserve(polyhedronShapeClasses.size());
+	for(const ShapeClass* sc : polyhedronShapeClasses) {
+		const NormalizedPolyhedron* poly = static_cast<const NormalizedPolyhedron*>(sc);
+		size_t vertexBytes = getOffset(poly->vertexCount) * 3 * sizeof(float);
+		size_t triangleBytes = getOffset(poly->triangleCount) * 3 * sizeof(int);
+
+		WorldFilePolyhedron record{static_cast<uint32_t>(poly->vertexCount), static_cast<uint32_t>(poly->triangleCount), polyhedronData.size(), polyhedronData.size() + vertexBytes};
+		polyhedronData.append(reinterpret_cast<const char*>(poly->getVertexBuffer()), vertexBytes);
+		polyhedronData.append(reinterpret_cast<const char*>(poly->getTriangleBuffer()), triangleBytes);
+		polyhedra.push_back(record);
+	}
+
+	// throws for ShapeClasses that have no registered serializer
+	std::vector<uint64_t> shapeClassOffsets;
+	std::ostringstream shapeClassData;
+	shapeClassOffsets.reserve(serializedShapeClasses.size() + 1);
+	for(const ShapeClass* sc : serializedShapeClasses) {
+		shapeClassOffsets.push_back(static_cast<uint64_t>(shapeClassData.tellp()));
+		dynamicShapeClassSerializer.serialize(*sc, shapeClassData);
+	}
+	shapeClassOffsets.push_back(static_cast<uint64_t>(shapeClassData.tellp()));
+	std::string shapeClassDataString = shapeClassData.str();
+
+	info.age = age;
+	info.partCount = partPositions.size();
+	info.physicalCount = physicals.size();
+	info.motorizedPhysicalCount = motions.size();
+	info.polyhedronCount = polyhedra.size();
+
+	struct SectionData {
+		WorldFileSection type;
+		const void* data;
+		size_t count;
+	};
+
+	std::vector<SectionData> sectionData{
+		{WorldFileSection::INFO, &info, 1},
+		{WorldFileSection::EXTERNAL_FORCES, externalForceData.data(), externalForceData.size()},
+		{WorldFileSection::POLYHEDRA, polyhedra.data(), polyhedra.size()},
+		{WorldFileSection::POLYHEDRON_DATA, polyhedronData.data(), polyhedronData.size()},
+		{WorldFileSection::PHYSICALS, physicals.data(), physicals.size()},
+		{WorldFileSection::MOTIONS, motions.data(), motions.size()},
+		{WorldFileSection::CONNECTIONS, connections.data(), connections.size()},
+		{WorldFileSection::CONSTRAINT_DATA, constraintData.data(), constraintData.size()},
+		{WorldFileSection::PART_POSITIONS, partPositions.data(), partPositions.size()},
+		{WorldFileSection::PART_ROTATIONS, partRotations.data(), partRotations.size()},
+		{WorldFileSection::PART_ATTACHMENTS, partAttachments.data(), partAttachments.size()},
+		{WorldFileSection::PART_SHAPE_CLASSES, partShapeClasses.data(), partShapeClasses.size()},
+		{WorldFileSection::PART_SHAPE_SCALES, partShapeScales.data(), partShapeScales.size()},
+		{WorldFileSection::PART_PROPERTIES, partProperties.data(), partProperties.size()},
+	};
+	if(!partExtensionData.empty()) {
+		sectionData.push_back({WorldFileSection::PART_EXTENSION_OFFSETS, partExtensionOffsets.data(), partExtensionOffsets.size()});
+		sectionData.push_back({WorldFileSection::PART_EXTENSION_DATA, partExtensionData.data(), partExtensionData.size()});
+	}
+	if(!serializedShapeClasses.empty()) {
+		sectionData.push_back({WorldFileSection::SHAPE_CLASS_OFFSETS, shapeClassOffsets.data(), shapeClassOffsets.size()});
+		sectionData.push_back({WorldFileSection::SHAPE_CLASS_DATA, shapeClassDataString.data(), shapeClassDataString.size()});
+	}
+
+	std::vector<WorldFileSectionHeader> sectionHeaders;
+	sectionHeaders.reserve(sectionData.size());
+	size_t curOffset = alignToWorldFile(sizeof(WorldFileHeader) + sizeof(WorldFileSectionHeader) * sectionData.size());
+	for(const SectionData& section : sectionData) {
+		uint32_t elementSize = sectionElementSizes[static_cast<size_t>(section.type)];
+		size_t sectionSize = elementSize * section.count;
+		sectionHeaders.push_back(WorldFileSectionHeader{section.type, elementSize, curOffset, sectionSize, section.count});
+		curOffset = alignToWorldFile(curOffset + sectionSize);
+	}
+
+	WorldFileHeader header;
+	std::memcpy(header.magic, worldFileMagic, sizeof(worldFileMagic));
+	header.version = WORLD_FILE_VERSION_ID;
+	header.sectionCount = static_cast<uint32_t>(sectionHeaders.size());
+	header.totalSize = curOffset;
+
+	static const char padding[WORLD_FILE_ALIGNMENT]{};
+
+	::serialize<WorldFileHeader>(header, ostream);
+	::serializeArray<WorldFileSectionHeader>(sectionHeaders.data(), sectionHeaders.size(), ostream);
+	size_t written = sizeof(WorldFileHeader) + sizeof(WorldFileSectionHeader) * sectionHeaders.size();
+	for(size_t i = 0; i < sectionData.size(); i++) {
+		const WorldFileSectionHeader& section = sectionHeaders[i];
+		::serialize(padding, section.offset - written, ostream);
+		::serialize(static_cast<const char*>(sectionData[i].data), section.size, ostream);
+		written = section.offset + section.size;
+	}
+	::serialize(padding, header.totalSize - written, ostream);
+}
+
+void WorldFileWriter::writeWorld(const WorldPrototype& world, const std::string& path) {
+	std::ofstream file(path, std::ios::binary);
+	if(!file.is_open()) {
+		throw SerializationException("Could not open " + path + " for writing!");
+	}
+	writeWorld(world, file);
+}
+
+#pragma endregion
+
+#pragma region WorldFileReader
+
+WorldFileReader::WorldFileReader(const std::string& path, const std::vector<const ShapeClass*>& knownShapeClasses) : file(path) {
+	if(!file.isOpen()) {
+		throw SerializationException("Could not open world file " + path);
+	}
+	this->data = file.data();
+	this->size = file.size();
+
+	shapeClasses.assign(std::begin(builtinShapeClasses), std::end(builtinShapeClasses));
+	shapeClasses.insert(shapeClasses.end(), knownShapeClasses.begin(), knownShapeClasses.end());
+	readHeader();
+}
+
+WorldFileReader::WorldFileReader(const char* data, size_t size, const std::vector<const ShapeClass*>& knownShapeClasses) : data(data), size(size) {
+	if(reinterpret_cast<uintptr_t>(data) % WORLD_FILE_ALIGNMENT != 0) {
+		throw SerializationException("World file data must be aligned to " + std::to_string(WORLD_FILE_ALIGNMENT) + " bytes!");
+	}
+
+	shapeClasses.assign(std::begin(builtinShapeClasses), std::end(builtinShapeClasses));
+	shapeClasses.insert(shapeClasses.end(), knownShapeClasses.begin(), knownShapeClasses.end());
+	readHeader();
+}
+
+void WorldFileReader::readHeader() {
+	if(size < sizeof(WorldFileHeader)) {
+		throw SerializationException("File is too small to be a world file!");
+	}
+	const WorldFileHeader* header = reinterpret_cast<const WorldFileHeader*>(data);
+	if(std::memcmp(header->magic, worldFileMagic, sizeof(worldFileMagic)) != 0) {
+		throw SerializationException("Not a world file!");
+	}
+	if(header->version != WORLD_FILE_VERSION_ID) {
+		throw SerializationException(
+			"This world file version cannot be read! Current " +
+			std::to_string(WORLD_FILE_VERSION_ID) +
+			" version from file: " +
+			std::to_string(header->version)
+		);
+	}
+	if(header->totalSize > size || sizeof(WorldFileHeader) + sizeof(WorldFileSectionHeader) * static_cast<size_t>(header->sectionCount) > size) {
+		throw SerializationException("World file is truncated!");
+	}
+
+	const WorldFileSectionHeader* sectionHeaders = reinterpret_cast<const WorldFileSectionHeader*>(data + sizeof(WorldFileHeader));
+	for(uint32_t i = 0; i < header->sectionCount; i++) {
+		const WorldFileSectionHeader& section = sectionHeaders[i];
+		size_t type = static_cast<size_t>(section.type);
+
+		// sections of unknown types may be added by later versions, skip them
+		if(type >= static_cast<size_t>(WorldFileSection::COUNT)) continue;
+
+		if(section.elementSize != sectionElementSizes[type] || section.size != section.count * section.elementSize) {
+			throw SerializationException("Invalid element size for world file section " + std::to_string(type));
+		}
+		if(section.offset % WORLD_FILE_ALIGNMENT != 0 || section.offset > size || section.size > size - section.offset) {
+			throw SerializationException("World file section " + std::to_string(type) + " lies outside of the file!");
+		}
+		sections[type] = &section;
+	}
+
+	if(getSectionCount(WorldFileSection::INFO) != 1) {
+		throw SerializationException("World file is missing its INFO section!");
+	}
+	info = getSection<WorldFileInfo>(WorldFileSection::INFO);
+
+	static const WorldFileSection partSections[]{
+		WorldFileSection::PART_POSITIONS,
+		WorldFileSection::PART_ROTATIONS,
+		WorldFileSection::PART_ATTACHMENTS,
+		WorldFileSection::PART_SHAPE_CLASSES,
+		WorldFileSection::PART_SHAPE_SCALES,
+		WorldFileSection::PART_PROPERTIES
+	};
+	for(WorldFileSection section : partSections) {
+		if(getSectionCount(section) != info->partCount) {
+			throw SerializationException("World file part section " + std::to_string(static_cast<size_t>(section)) + " does not match the part count!");
+		}
+	}
+	if(sections[static_cast<size_t>(WorldFileSection::PART_EXTENSION_OFFSETS)] != nullptr && getSectionCount(WorldFileSection::PART_EXTENSION_OFFSETS) != info->partCount + 1) {
+		throw SerializationException("World file part extensions do not match the part count!");
+	}
+	if(getSectionCount(WorldFileSection::PHYSICALS) != info->physicalCount ||
+	   getSectionCount(WorldFileSection::MOTIONS) != info->motorizedPhysicalCount ||
+	   getSectionCount(WorldFileSection::POLYHEDRA) != info->polyhedronCount ||
+	   info->terrainPartCount > info->partCount) {
+		throw SerializationException("World file sections do not match the world info!");
+	}
+
+	serializedShapeClassCount = (getSectionCount(WorldFileSection::SHAPE_CLASS_OFFSETS) != 0) ? getSectionCount(WorldFileSection::SHAPE_CLASS_OFFSETS) - 1 : 0;
+
+	knownShapeClassCount = shapeClasses.size();
+	shapeClasses.resize(knownShapeClassCount + info->polyhedronCount + serializedShapeClassCount, nullptr);
+	loadedShapeClasses.resize(info->polyhedronCount + serializedShapeClassCount);
+}
+
+WorldFileReader::~WorldFileReader() = default;
+
+void WorldFileReader::LoadedPartDeleter::operator()(Part* part) const {
+	reader->deletePart(part);
+}
+
+void WorldFileReader::LoadedPhysicalDeleter::operator()(MotorizedPhysical* phys) const {
+	std::vector<Part*> parts;
+	phys->forEachPart([&parts](Part& part) {
+		parts.push_back(&part);
+	});
+	// deleting the last part of a physical deletes the physical
+	for(Part* part : parts) {
+		reader->deletePart(part);
+	}
+}
+
+void WorldFileReader::releaseShapeClasses() {
+	for(std::unique_ptr<const ShapeClass>& shapeClass : loadedShapeClasses) {
+		shapeClass.release();
+	}
+}
+
+size_t WorldFileReader::getSectionCount(WorldFileSection type) const {
+	const WorldFileSectionHeader* section = sections[static_cast<size_t>(type)];
+	return (section != nullptr) ? section->count : 0;
+}
+
+GlobalCFrame WorldFileReader::getPartCFrame(size_t partIndex) const {
+	return GlobalCFrame(getSection<Position>(WorldFileSection::PART_POSITIONS)[partIndex], getSection<Rotation>(WorldFileSection::PART_ROTATIONS)[partIndex]);
+}
+
+const PartProperties& WorldFileReader::getPartProperties(size_t partIndex) const {
+	return getSection<PartProperties>(WorldFileSection::PART_PROPERTIES)[partIndex];
+}
+
+const ShapeClass* WorldFileReader::getShapeClass(uint32_t shapeClassID) const {
+	if(shapeClassID >= shapeClasses.size()) {
+		throw SerializationException("There is no ShapeClass with id " + std::to_string(shapeClassID));
+	}
+
+	const ShapeClass*& shapeClass = shapeClasses[shapeClassID];
+	if(shapeClass == nullptr) {
+		size_t index = shapeClassID - knownShapeClassCount;
+		shapeClass = (index < info->polyhedronCount) ? loadPolyhedron(index) : loadSerializedShapeClass(index - info->polyhedronCount);
+	}
+	return shapeClass;
+}
+
+const ShapeClass* WorldFileReader::loadPolyhedron(size_t polyhedronIndex) const {
+	const WorldFilePolyhedron& record = getSection<WorldFilePolyhedron>(WorldFileSection::POLYHEDRA)[polyhedronIndex];
+	size_t vertexBytes = getOffset(record.vertexCount) * 3 * sizeof(float);
+	size_t triangleBytes = getOffset(record.triangleCount) * 3 * sizeof(int);
+	size_t dataSize = getSectionCount(WorldFileSection::POLYHEDRON_DATA);
+	if(record.vertexDataOffset > dataSize || vertexBytes > dataSize - record.vertexDataOffset ||
+	   record.triangleDataOffset > dataSize || triangleBytes > dataSize - record.triangleDataOffset) {
+		throw SerializationException("Polyhedron data lies outside of the world file!");
+	}
+	const char* polyhedronData = getSection<char>(WorldFileSection::POLYHEDRON_DATA);
+
+	// the stored buffers are already in the parallel layout, a single copy into aligned storage is enough
+	UniqueAlignedPointer<float> vertices = createParallelVecBuf(record.vertexCount);
+	UniqueAlignedPointer<int> triangles = createParallelTriangleBuf(record.triangleCount);
+	std::memcpy(vertices.get(), polyhedronData + record.vertexDataOffset, vertexBytes);
+	std::memcpy(triangles.get(), polyhedronData + record.triangleDataOffset, triangleBytes);
+
+	Polyhedron poly = Polyhedron::fromParallelBuffers(std::move(vertices), std::move(triangles), record.vertexCount, record.triangleCount);
+	std::unique_ptr<const ShapeClass>& loaded = loadedShapeClasses[polyhedronIndex];
+	loaded.reset(new NormalizedPolyhedron(poly.normalized()));
+	return loaded.get();
+}
+
+const ShapeClass* WorldFileReader::loadSerializedShapeClass(size_t index) const {
+	const uint64_t* offsets = getSection<uint64_t>(WorldFileSection::SHAPE_CLASS_OFFSETS);
+	const char* shapeClassData = getSection<char>(WorldFileSection::SHAPE_CLASS_DATA);
+	size_t dataSize = getSectionCount(WorldFileSection::SHAPE_CLASS_DATA);
+	if(offsets[index] > offsets[index + 1] || offsets[index + 1] > dataSize) {
+		throw SerializationException("ShapeClass data lies outside of the world file!");
+	}
+	MemoryInputBuffer buffer(shapeClassData + offsets[index], shapeClassData + offsets[index + 1]);
+	std::istream stream(&buffer);
+
+	std::unique_ptr<const ShapeClass>& loaded = loadedShapeClasses[info->polyhedronCount + index];
+	loaded.reset(dynamicShapeClassSerializer.deserialize(stream));
+	return loaded.get();
+}
+
+Shape WorldFileReader::getPartShape(size_t partIndex) const {
+	const ShapeClass* shapeClass = getShapeClass(getSection<uint32_t>(WorldFileSection::PART_SHAPE_CLASSES)[partIndex]);
+	const DiagonalMat3& scale = getSection<DiagonalMat3>(WorldFileSection::PART_SHAPE_SCALES)[partIndex];
+	return Shape(shapeClass, scale[0] * 2, scale[1] * 2, scale[2] * 2);
+}
+
+Part* WorldFileReader::createPart(Part&& partPhysicalData, std::istream& extensionData) {
+	return new Part(std::move(partPhysicalData));
+}
+
+WorldFileReader::LoadedPart WorldFileReader::loadPart(size_t partIndex) {
+	if(partIndex >= info->partCount) {
+		throw SerializationException("Part index " + std::to_string(partIndex) + " out of range!");
+	}
+
+	Part part(getPartShape(partIndex), getPartCFrame(partIndex), getPartProperties(partIndex));
+
+	const char* extensionBegin = nullptr;
+	const char* extensionEnd = nullptr;
+	if(sections[static_cast<size_t>(WorldFileSection::PART_EXTENSION_OFFSETS)] != nullptr) {
+		const uint64_t* offsets = getSection<uint64_t>(WorldFileSection::PART_EXTENSION_OFFSETS);
+		const char* extensionData = getSection<char>(WorldFileSection::PART_EXTENSION_DATA);
+		size_t extensionSize = getSectionCount(WorldFileSection::PART_EXTENSION_DATA);
+		if(offsets[partIndex] > offsets[partIndex + 1] || offsets[partIndex + 1] > extensionSize) {
+			throw SerializationException("Part extension data lies outside of the world file!");
+		}
+		extensionBegin = extensionData + offsets[partIndex];
+		extensionEnd = extensionData + offsets[partIndex + 1];
+	}
+	MemoryInputBuffer extensionBuffer(extensionBegin, extensionEnd);
+	std::istream extensionStream(&extensionBuffer);
+
+	return LoadedPart(createPart(std::move(part), extensionStream), LoadedPartDeleter{this});
+}
+
+Part* WorldFileReader::materializePart(size_t partIndex) {
+	LoadedPart part = loadPart(partIndex);
+	releaseShapeClasses();
+	return part.release();
+}
+
+RigidBody WorldFileReader::loadRigidBody(const WorldFilePhysical& record) {
+	if(record.partCount == 0 || record.firstPart > getFirstTerrainPart() || record.partCount > getFirstTerrainPart() - record.firstPart) {
+		throw SerializationException("Physical refers to parts outside of the world file!");
+	}
+
+	const CFrame* attachments = getSection<CFrame>(WorldFileSection::PART_ATTACHMENTS);
+
+	std::vector<LoadedPart> parts;
+	parts.reserve(record.partCount);
+	for(uint32_t i = 0; i < record.partCount; i++) {
+		parts.push_back(loadPart(record.firstPart + i));
+	}
+
+	RigidBody result(parts[0].release());
+	result.parts.reserve(record.partCount - 1);
+	for(uint32_t i = 1; i < record.partCount; i++) {
+		result.parts.push_back(AttachedPart{attachments[record.firstPart + i], parts[i].release()});
+	}
+	result.refreshWithNewParts();
+	return result;
+}
+
+void WorldFileReader::loadPhysicalChildren(Physical& parent, const WorldFilePhysical& parentRecord, size_t& physicalIndex) {
+	const WorldFilePhysical* physicals = getSection<WorldFilePhysical>(WorldFileSection::PHYSICALS);
+	const WorldFileConnection* connections = getSection<WorldFileConnection>(WorldFileSection::CONNECTIONS);
+	size_t connectionCount = getSectionCount(WorldFileSection::CONNECTIONS);
+	const char* constraintData = getSection<char>(WorldFileSection::CONSTRAINT_DATA);
+	size_t constraintDataSize = getSectionCount(WorldFileSection::CONSTRAINT_DATA);
+
+	// children must not move once they are created, grandchildren point to them
+	parent.childPhysicals.reserve(parentRecord.childCount);
+	for(uint32_t i = 0; i < parentRecord.childCount; i++) {
+		if(physicalIndex >= info->physicalCount) {
+			throw SerializationException("World file physical tree is truncated!");
+		}
+		const WorldFilePhysical& record = physicals[physicalIndex++];
+		if(record.motionOrConnectionIndex >= connectionCount) {
+			throw SerializationException("Invalid connection index in world file!");
+		}
+		const WorldFileConnection& connectionRecord = connections[record.motionOrConnectionIndex];
+		if(connectionRecord.constraintOffset > constraintDataSize) {
+			throw SerializationException("Constraint data lies outside of the world file!");
+		}
+
+		MemoryInputBuffer constraintBuffer(constraintData + connectionRecord.constraintOffset, constraintData + constraintDataSize);
+		std::istream constraintStream(&constraintBuffer);
+		HardConstraint* constraint = dynamicHardConstraintSerializer.deserialize(constraintStream);
+		HardPhysicalConnection connection(std::unique_ptr<HardConstraint>(constraint), connectionRecord.attachOnChild, connectionRecord.attachOnParent);
+
+		parent.childPhysicals.push_back(ConnectedPhysical(loadRigidBody(record), &parent, std::move(connection)));
+		loadPhysicalChildren(parent.childPhysicals.back(), record, physicalIndex);
+	}
+}
+
+WorldFileReader::LoadedPhysical WorldFileReader::loadMotorizedPhysical(size_t physicalIndex) {
+	const WorldFilePhysical& record = getSection<WorldFilePhysical>(WorldFileSection::PHYSICALS)[physicalIndex++];
+	if(record.parent != WORLD_FILE_NO_PARENT || record.motionOrConnectionIndex >= info->motorizedPhysicalCount) {
+		throw SerializationException("Expected a motorized physical in the world file!");
+	}
+
+	RigidBody rigidBody = loadRigidBody(record);
+	rigidBody.setCFrame(getPartCFrame(record.firstPart));
+	LoadedPhysical phys(new MotorizedPhysical(std::move(rigidBody)), LoadedPhysicalDeleter{this});
+	phys->motionOfCenterOfMass = getSection<Motion>(WorldFileSection::MOTIONS)[record.motionOrConnectionIndex];
+
+	loadPhysicalChildren(*phys, record, physicalIndex);
+
+	phys->fullRefreshOfConnectedPhysicals();
+	phys->refreshPhysicalProperties();
+	return phys;
+}
+
+void WorldFileReader::materializeShapeClasses() {
+	Util::parallelFor(info->polyhedronCount + serializedShapeClassCount, 16, [this](size_t i) {
+		getShapeClass(static_cast<uint32_t>(knownShapeClassCount + i));
+	});
+}
+
+void WorldFileReader::readParts(std::vector<MotorizedPhysical*>& motorizedPhysicals, std::vector<Part*>& terrainParts) {
+	// the shape class cache is not synchronized, fill it before the parts are built concurrently
+	materializeShapeClasses();
+
+	// find where every motorized physical starts, its connected physicals directly follow it
+	const WorldFilePhysical* physicals = getSection<WorldFilePhysical>(WorldFileSection::PHYSICALS);
+	std::vector<size_t> motorizedPhysicalIndices;
+	motorizedPhysicalIndices.reserve(info->motorizedPhysicalCount);
+	size_t physicalIndex = 0;
+	while(physicalIndex < info->physicalCount) {
+		motorizedPhysicalIndices.push_back(physicalIndex);
+		size_t remainingInTree = 1;
+		while(remainingInTree > 0) {
+			if(physicalIndex >= info->physicalCount) {
+				throw SerializationException("World file physical tree is truncated!");
+			}
+			remainingInTree += physicals[physicalIndex++].childCount;
+			remainingInTree--;
+		}
+	}
+
+	std::vector<LoadedPhysical> loadedPhysicals(motorizedPhysicalIndices.size());
+	Util::parallelFor(motorizedPhysicalIndices.size(), 64, [&](size_t i) {
+		loadedPhysicals[i] = loadMotorizedPhysical(motorizedPhysicalIndices[i]);
+	});
+
+	size_t firstTerrainPart = getFirstTerrainPart();
+	std::vector<LoadedPart> loadedTerrainParts(info->terrainPartCount);
+	Util::parallelFor(info->terrainPartCount, 256, [&](size_t i) {
+		loadedTerrainParts[i] = loadPart(firstTerrainPart + i);
+	});
+
+	// the whole file has been read, nothing can fail anymore
+	motorizedPhysicals.reserve(motorizedPhysicals.size() + loadedPhysicals.size());
+	for(LoadedPhysical& phys : loadedPhysicals) {
+		motorizedPhysicals.push_back(phys.release());
+	}
+	terrainParts.reserve(terrainParts.size() + loadedTerrainParts.size());
+	for(LoadedPart& part : loadedTerrainParts) {
+		terrainParts.push_back(part.release());
+	}
+	releaseShapeClasses();
+}
+
+void WorldFileReader::readExternalForces(WorldPrototype& world) {
+	const char* forceData = getSection<char>(WorldFileSection::EXTERNAL_FORCES);
+	MemoryInputBuffer forceBuffer(forceData, forceData + getSectionCount(WorldFileSection::EXTERNAL_FORCES));
+	std::istream forceStream(&forceBuffer);
+	while(forceStream.peek() != std::char_traits<char>::eof()) {
+		world.externalForces.push_back(dynamicExternalForceSerializer.deserialize(forceStream));
+	}
+}
+
+void WorldFileReader::readWorld(WorldPrototype& world) {
+	readExternalForces(world);
+	world.age = info->age;
+
+	std::vector<MotorizedPhysical*> motorizedPhysicals;
+	std::vector<Part*> terrainParts;
+	readParts(motorizedPhysicals, terrainParts);
+
+	std::vector<Part*> mainParts(motorizedPhysicals.size());
+	for(size_t i = 0; i < motorizedPhysicals.size(); i++) {
+		mainParts[i] = motorizedPhysicals[i]->getMainPart();
+	}
+	world.addParts(mainParts.data(), mainParts.size());
+	world.addTerrainParts(terrainParts.data(), terrainParts.size());
+}
+
+#pragma endregion
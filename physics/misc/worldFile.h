@@ -0,0 +1,311 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "../math/position.h"
+#include "../math/rotation.h"
+#include "../math/cframe.h"
+#include "../math/globalCFrame.h"
+#include "../math/linalg/mat.h"
+#include "../geometry/shape.h"
+#include "../motion.h"
+#include "../part.h"
+
+#include "../../util/mappedFile.h"
+
+class WorldPrototype;
+class ShapeClass;
+class Physical;
+class MotorizedPhysical;
+
+/*
+	Binary world file
+
+	Unlike the stream based SerializationSession, a world file stores every per part field as one contiguous array (a section),
+	so that it can be written with a handful of large writes and read straight from a memory mapping without parsing.
+
+	Layout:
+		WorldFileHeader
+		WorldFileSectionHeader[sectionCount]
+		sections, each starting at a multiple of WORLD_FILE_ALIGNMENT
+
+	Parts are stored in the order: parts of each physical in depth first order (main part first), followed by the terrain parts.
+	Polyhedra are stored in the parallel SIMD layout used by Polyhedron, see polyhedronInternals.h
+	Other ShapeClasses, such as heightfields and triangle meshes, are stored with dynamicShapeClassSerializer in the SHAPE_CLASS sections,
+	their ids follow those of the polyhedra
+*/
+
+#define WORLD_FILE_VERSION_ID 1
+#define WORLD_FILE_ALIGNMENT 32
+#define WORLD_FILE_NO_PARENT 0xFFFFFFFF
+
+enum class WorldFileSection : uint32_t {
+	INFO,
+	EXTERNAL_FORCES,
+	POLYHEDRA,
+	POLYHEDRON_DATA,
+	PHYSICALS,
+	MOTIONS,
+	CONNECTIONS,
+	CONSTRAINT_DATA,
+	PART_POSITIONS,
+	PART_ROTATIONS,
+	PART_ATTACHMENTS,
+	PART_SHAPE_CLASSES,
+	PART_SHAPE_SCALES,
+	PART_PROPERTIES,
+	PART_EXTENSION_OFFSETS,
+	PART_EXTENSION_DATA,
+	SHAPE_CLASS_OFFSETS,
+	SHAPE_CLASS_DATA,
+	COUNT
+};
+
+struct WorldFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t sectionCount;
+	uint64_t totalSize;
+};
+
+struct WorldFileSectionHeader {
+	WorldFileSection type;
+	uint32_t elementSize;
+	uint64_t offset;
+	uint64_t size;
+	uint64_t count;
+};
+
+struct WorldFileInfo {
+	uint64_t age;
+	uint64_t partCount;
+	uint64_t terrainPartCount;
+	uint64_t physicalCount;
+	uint64_t motorizedPhysicalCount;
+	uint64_t polyhedronCount;
+};
+
+struct WorldFilePolyhedron {
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	// offsets relative to the start of the POLYHEDRON_DATA section
+	uint64_t vertexDataOffset;
+	uint64_t triangleDataOffset;
+};
+
+/*
+	Physicals are stored in depth first order, children directly follow their parent
+	Motorized physicals have parent == WORLD_FILE_NO_PARENT and index the MOTIONS section with motionIndex,
+	connected physicals index the CONNECTIONS section with connectionIndex
+*/
+struct WorldFilePhysical {
+	uint32_t parent;
+	uint32_t firstPart;
+	uint32_t partCount;
+	uint32_t childCount;
+	uint32_t motionOrConnectionIndex;
+};
+
+struct WorldFileConnection {
+	CFrame attachOnChild;
+	CFrame attachOnParent;
+	// offset of the dynamically serialized HardConstraint in the CONSTRAINT_DATA section
+	uint64_t constraintOffset;
+};
+
+class WorldFileWriter {
+	/*
+		Parts and physicals are written into independent chunks in parallel, the chunks are concatenated at the end
+		All indices and offsets within a chunk are relative to the start of the chunk
+	*/
+	struct Chunk {
+		std::vector<WorldFilePhysical> physicals;
+		std::vector<Motion> motions;
+		std::vector<WorldFileConnection> connections;
+		std::string constraintData;
+
+		std::vector<Position> partPositions;
+		std::vector<Rotation> partRotations;
+		std::vector<CFrame> partAttachments;
+		std::vector<uint32_t> partShapeClasses;
+		std::vector<DiagonalMat3> partShapeScales;
+		std::vector<PartProperties> partProperties;
+		std::vector<uint64_t> partExtensionOffsets;
+		std::string partExtensionData;
+	};
+
+	std::map<const ShapeClass*, uint32_t> shapeClassIDs;
+	size_t knownShapeClassCount;
+
+	void collectShapeClass(const ShapeClass* shapeClass);
+	uint32_t getShapeClassID(const ShapeClass* shapeClass) const;
+
+	void addPhysical(Chunk& chunk, const Physical& phys, uint32_t parent, uint32_t motionOrConnectionIndex);
+	void addPart(Chunk& chunk, const Part& part, const CFrame& attachment);
+	void appendChunk(const Chunk& chunk);
+
+	void write(const MotorizedPhysical* const motorizedPhysicals[], size_t physicalCount, const Part* const terrainParts[], size_t terrainPartCount, const std::string& externalForceData, uint64_t age, std::ostream& ostream);
+
+protected:
+	WorldFileInfo info{};
+	std::vector<const ShapeClass*> polyhedronShapeClasses;
+	std::vector<const ShapeClass*> serializedShapeClasses;
+
+	std::vector<WorldFilePhysical> physicals;
+	std::vector<Motion> motions;
+	std::vector<WorldFileConnection> connections;
+	std::string constraintData;
+
+	std::vector<Position> partPositions;
+	std::vector<Rotation> partRotations;
+	std::vector<CFrame> partAttachments;
+	std::vector<uint32_t> partShapeClasses;
+	std::vector<DiagonalMat3> partShapeScales;
+	std::vector<PartProperties> partProperties;
+	std::vector<uint64_t> partExtensionOffsets;
+	std::string partExtensionData;
+
+	/*
+		Override to store extra data with every part, such as the data of an ExtendedPart
+		It is given back to WorldFileReader::createPart when reading
+		Called concurrently for different parts, it must not modify shared state
+	*/
+	virtual void serializePartExtension(const Part& part, std::ostream& ostream) const {}
+
+public:
+	/*
+		knownShapeClasses are ShapeClasses which are available when reading, they are not stored in the file.
+		The builtin ShapeClasses are always known
+	*/
+	WorldFileWriter(const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
+	virtual ~WorldFileWriter() = default;
+
+	void writeWorld(const WorldPrototype& world, std::ostream& ostream);
+	void writeWorld(const WorldPrototype& world, const std::string& path);
+	/*
+		Stores only the given physicals and terrain parts, without the external forces and age of a world
+	*/
+	void writeParts(const MotorizedPhysical* const physicals[], size_t physicalCount, const Part* const terrainParts[], size_t terrainPartCount, std::ostream& ostream);
+};
+
+class WorldFileReader {
+	Util::MappedFile file;
+	const char* data;
+	size_t size;
+
+	const WorldFileSectionHeader* sections[static_cast<size_t>(WorldFileSection::COUNT)]{};
+	const WorldFileInfo* info;
+
+	size_t knownShapeClassCount;
+	size_t serializedShapeClassCount;
+	mutable std::vector<const ShapeClass*> shapeClasses;
+	/*
+		The ShapeClasses built from this file, owned by the reader until parts using them are handed out
+		Freed with the reader when loading fails before that
+	*/
+	mutable std::vector<std::unique_ptr<const ShapeClass>> loadedShapeClasses;
+
+	/*
+		Own what has been loaded so far, so a file that turns out to be invalid partway through does not leak the parts and physicals before it
+	*/
+	struct LoadedPartDeleter {
+		const WorldFileReader* reader = nullptr;
+		void operator()(Part* part) const;
+	};
+	struct LoadedPhysicalDeleter {
+		const WorldFileReader* reader = nullptr;
+		void operator()(MotorizedPhysical* phys) const;
+	};
+	using LoadedPart = std::unique_ptr<Part, LoadedPartDeleter>;
+	using LoadedPhysical = std::unique_ptr<MotorizedPhysical, LoadedPhysicalDeleter>;
+
+	void readHeader();
+	LoadedPart loadPart(size_t partIndex);
+	void loadPhysicalChildren(Physical& parent, const WorldFilePhysical& parentRecord, size_t& physicalIndex);
+	RigidBody loadRigidBody(const WorldFilePhysical& record);
+	LoadedPhysical loadMotorizedPhysical(size_t physicalIndex);
+	const ShapeClass* loadPolyhedron(size_t polyhedronIndex) const;
+	const ShapeClass* loadSerializedShapeClass(size_t index) const;
+	/*
+		Called once loaded parts are handed out, from then on the ShapeClasses belong to the parts using them
+	*/
+	void releaseShapeClasses();
+
+protected:
+	/*
+		Override to create an extended part from the physical part data and what was stored by WorldFileWriter::serializePartExtension
+		Called concurrently from readWorld, it must not modify shared state
+	*/
+	virtual Part* createPart(Part&& partPhysicalData, std::istream& extensionData);
+	/*
+		Deletes a part made by createPart when the file turns out to be invalid before it is handed out, override along with createPart
+	*/
+	virtual void deletePart(Part* part) const { delete part; }
+
+public:
+	/*
+		Maps the given file, throws SerializationException if it is not a valid world file
+	*/
+	WorldFileReader(const std::string& path, const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
+	/*
+		Reads a world file from memory, data must be aligned to WORLD_FILE_ALIGNMENT and stay valid for the lifetime of this reader
+	*/
+	WorldFileReader(const char* data, size_t size, const std::vector<const ShapeClass*>& knownShapeClasses = std::vector<const ShapeClass*>());
+	virtual ~WorldFileReader();
+
+	WorldFileReader(const WorldFileReader&) = delete;
+	WorldFileReader& operator=(const WorldFileReader&) = delete;
+
+	template<typename T>
+	const T* getSection(WorldFileSection type) const {
+		const WorldFileSectionHeader* section = sections[static_cast<size_t>(type)];
+		return (section != nullptr) ? reinterpret_cast<const T*>(data + section->offset) : nullptr;
+	}
+	size_t getSectionCount(WorldFileSection type) const;
+
+	const WorldFileInfo& getInfo() const { return *info; }
+	size_t getPartCount() const { return info->partCount; }
+	size_t getTerrainPartCount() const { return info->terrainPartCount; }
+	size_t getFirstTerrainPart() const { return info->partCount - info->terrainPartCount; }
+
+	/*
+		Accessors that read straight from the file, without creating any Part
+	*/
+	GlobalCFrame getPartCFrame(size_t partIndex) const;
+	const PartProperties& getPartProperties(size_t partIndex) const;
+	/*
+		ShapeClasses are only built the first time a shape refers to them
+		Building them is not synchronized, call materializeShapeClasses first when accessing parts from multiple threads
+	*/
+	Shape getPartShape(size_t partIndex) const;
+	const ShapeClass* getShapeClass(uint32_t shapeClassID) const;
+
+	/*
+		Creates the given part on its own, not attached to any physical or world
+	*/
+	Part* materializePart(size_t partIndex);
+
+	/*
+		Builds all ShapeClasses stored in the file, in parallel
+	*/
+	void materializeShapeClasses();
+
+	void readExternalForces(WorldPrototype& world);
+
+	/*
+		Builds the physicals and terrain parts in parallel chunks, and appends them to the given lists without adding them to a world
+		Physicals are returned in the order they were written
+	*/
+	void readParts(std::vector<MotorizedPhysical*>& physicals, std::vector<Part*>& terrainParts);
+
+	/*
+		Builds the physicals and terrain parts in parallel chunks, and adds them to the world in one bulk step
+	*/
+	void readWorld(WorldPrototype& world);
+};
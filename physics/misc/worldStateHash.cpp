@@ -0,0 +1,220 @@
+#include "worldStateHash.h"
+
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../world.h"
+#include "../physical.h"
+#include "../rigidBody.h"
+#include "../constraintGroup.h"
+#include "../constraints/hardConstraint.h"
+#include "../constraints/hardPhysicalConnection.h"
+
+#include "../../util/parallelFor.h"
+
+/*
+	Worlds with fewer physicals than this are hashed on the calling thread
+*/
+#define WORLD_STATE_HASH_MIN_CHUNK_SIZE 8192
+
+uint64_t WorldStateHash::combine(uint64_t hash, uint64_t value) {
+	hash ^= value * 0x9E3779B97F4A7C15ULL;
+	return ((hash << 31) | (hash >> 33)) * 0xC2B2AE3D27D4EB4FULL;
+}
+
+static uint64_t finalizeHash(uint64_t hash) {
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/*
+	Multiplies to 128 bits and folds the halves together, every bit of either input affects the result
+*/
+static inline uint64_t multiplyFold(uint64_t a, uint64_t b) {
+#ifdef _MSC_VER
+	uint64_t high;
+	uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#else
+	unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#endif
+}
+
+/*
+	Hashes a sequence of values two words at a time, every pair is salted with its position and multiplied on its own,
+	so the multiplies do not wait on each other while the result still depends on the order of the words
+	The salts are position times a constant, kept as running sums so a pair costs a single multiply
+*/
+struct StateHasher {
+	uint64_t accumulator = 0;
+	uint64_t position = 0;
+	uint64_t firstSalt = 0;
+	uint64_t secondSalt = 0;
+
+	inline void addPair(uint64_t first, uint64_t second) {
+		position++;
+		firstSalt += 0x9E3779B97F4A7C15ULL;
+		secondSalt += 0xC2B2AE3D27D4EB4FULL;
+		accumulator += multiplyFold(first ^ firstSalt, second ^ secondSalt);
+	}
+
+	/*
+		Adds the bytes of value, a word at a time
+		Only for types made of 8 byte numbers, so there is no padding whose contents would change the hash
+	*/
+	template<typename T>
+	inline void addValue(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "hashed values are read bitwise");
+		static_assert(sizeof(T) % sizeof(uint64_t) == 0, "hashed values must consist of 8 byte numbers");
+
+		constexpr size_t wordCount = sizeof(T) / sizeof(uint64_t);
+		uint64_t words[wordCount];
+		std::memcpy(words, &value, sizeof(T));
+		for(size_t i = 0; i + 1 < wordCount; i += 2) {
+			addPair(words[i], words[i + 1]);
+		}
+		if(wordCount % 2 == 1) {
+			addPair(words[wordCount - 1], 0x165667B19E3779F9ULL);
+		}
+	}
+
+	inline uint64_t get() const {
+		return finalizeHash(WorldStateHash::combine(accumulator, position));
+	}
+};
+
+uint64_t WorldStateHash::hashPart(const Part& part) {
+	StateHasher hash;
+	hash.addValue(part.getCFrame());
+	return hash.get();
+}
+
+uint64_t WorldStateHash::hashPhysical(const MotorizedPhysical& phys) {
+	StateHasher hash;
+	hash.addValue(phys.motionOfCenterOfMass);
+	phys.forEachPart([&hash](const Part& part) {
+		hash.addValue(part.getCFrame());
+	});
+	phys.forEachHardConstraint([&hash](const Physical& parent, const ConnectedPhysical& child) {
+		const HardConstraint& constraint = *child.connectionToParent.constraintWithParent;
+		hash.addValue(constraint.getRelativeCFrame());
+		hash.addValue(constraint.getRelativeMotion());
+	});
+	return hash.get();
+}
+
+static uint64_t hashConstraintGroups(uint64_t hash, const std::vector<ConstraintGroup>& constraints) {
+	for(const ConstraintGroup& group : constraints) {
+		StateHasher groupHash;
+		for(const BallConstraint& ball : group.ballConstraints) {
+			groupHash.addValue(ball.attachA);
+			groupHash.addValue(ball.attachB);
+		}
+		hash = WorldStateHash::combine(hash, groupHash.get());
+	}
+	return hash;
+}
+
+uint64_t WorldStateHash::hashWorld(const WorldPrototype& world) {
+	size_t physicalCount = world.physicals.size();
+
+	// salted with their index and summed, so chunks can be hashed on separate threads without the result depending on the chunk count
+	std::vector<uint64_t> chunkSums(Util::getChunkCount(physicalCount, WORLD_STATE_HASH_MIN_CHUNK_SIZE));
+	Util::parallelForChunks(physicalCount, chunkSums.size(), [&world, &chunkSums](size_t chunkIndex, size_t begin, size_t end) {
+		uint64_t sum = 0;
+		for(size_t i = begin; i < end; i++) {
+			sum += hashPhysicalAt(*world.physicals[i], i);
+		}
+		chunkSums[chunkIndex] = sum;
+	});
+
+	uint64_t physicalsHash = 0;
+	for(uint64_t sum : chunkSums) {
+		physicalsHash += sum;
+	}
+	return hashWorldFromPhysicals(world, physicalsHash);
+}
+
+uint64_t WorldStateHash::hashPhysicalAt(const MotorizedPhysical& phys, size_t index) {
+	return finalizeHash(hashPhysical(phys) ^ (index * 0x9E3779B97F4A7C15ULL));
+}
+
+uint64_t WorldStateHash::hashWorldFromPhysicals(const WorldPrototype& world, uint64_t physicalsHash) {
+	uint64_t hash = combine(world.age, world.physicals.size());
+	hash = combine(hash, physicalsHash);
+	return finalizeHash(hashConstraintGroups(hash, world.constraints));
+}
+
+static std::vector<const Part*> collectParts(const MotorizedPhysical& phys) {
+	std::vector<const Part*> parts;
+	phys.forEachPart([&parts](const Part& part) {
+		parts.push_back(&part);
+	});
+	return parts;
+}
+
+WorldDivergence compareWorldStates(const WorldPrototype& reference, const WorldPrototype& tested) {
+	WorldDivergence result;
+	result.tick = reference.age;
+
+	if(reference.age != tested.age) {
+		result.diverged = true;
+		result.physicalIndex = std::min(reference.physicals.size(), tested.physicals.size());
+		return result;
+	}
+
+	size_t commonCount = std::min(reference.physicals.size(), tested.physicals.size());
+	for(size_t i = 0; i < commonCount; i++) {
+		const MotorizedPhysical& referencePhys = *reference.physicals[i];
+		const MotorizedPhysical& testedPhys = *tested.physicals[i];
+		if(WorldStateHash::hashPhysical(referencePhys) == WorldStateHash::hashPhysical(testedPhys)) continue;
+
+		result.diverged = true;
+		result.physicalIndex = i;
+
+		std::vector<const Part*> referenceParts = collectParts(referencePhys);
+		std::vector<const Part*> testedParts = collectParts(testedPhys);
+		size_t partCount = std::min(referenceParts.size(), testedParts.size());
+		size_t partIndex = 0;
+		while(partIndex < partCount && WorldStateHash::hashPart(*referenceParts[partIndex]) == WorldStateHash::hashPart(*testedParts[partIndex])) {
+			partIndex++;
+		}
+		if(partIndex == partCount && referenceParts.size() == testedParts.size()) {
+			partIndex = 0;
+		}
+
+		result.partIndex = partIndex;
+		result.referencePart = partIndex < referenceParts.size() ? referenceParts[partIndex] : nullptr;
+		result.testedPart = partIndex < testedParts.size() ? testedParts[partIndex] : nullptr;
+		return result;
+	}
+
+	if(reference.physicals.size() != tested.physicals.size() || hashConstraintGroups(0, reference.constraints) != hashConstraintGroups(0, tested.constraints)) {
+		result.diverged = true;
+		result.physicalIndex = commonCount;
+	}
+	return result;
+}
+
+WorldDivergence findFirstDivergence(WorldPrototype& reference, WorldPrototype& tested, size_t tickCount) {
+	WorldDivergence result = compareWorldStates(reference, tested);
+
+	for(size_t tick = 0; tick < tickCount && !result.diverged; tick++) {
+		reference.tick();
+		tested.tick();
+
+		if(WorldStateHash::hashWorld(reference) != WorldStateHash::hashWorld(tested)) {
+			result = compareWorldStates(reference, tested);
+		}
+	}
+	return result;
+}
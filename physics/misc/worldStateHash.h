@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+class WorldPrototype;
+class MotorizedPhysical;
+class Part;
+
+/*
+	Hashes of the simulated state of a world, to check that two ways of running a tick give bit identical results
+
+	The state of a world is, in this order:
+		its age,
+		for every physical in world.physicals:
+			the motion of its center of mass,
+			the CFrame of every part, depth first like forEachPart,
+			the relative CFrame and motion of every hard constraint, depth first like forEachHardConstraint
+		for every group in world.constraints: the attachments of its ball constraints
+	Values are hashed bitwise, so runs that only differ in rounding have different hashes. Terrain parts do not move and are not hashed.
+
+	Nothing is serialized, the values are read in place, hashing a world costs one pass over its physicals and parts.
+	The order of world.physicals is part of the state, two worlds only compare equal if they were built in the same order.
+*/
+namespace WorldStateHash {
+	/*
+		Folds value into hash, the result depends on the order of the values
+	*/
+	uint64_t combine(uint64_t hash, uint64_t value);
+
+	uint64_t hashPart(const Part& part);
+	uint64_t hashPhysical(const MotorizedPhysical& phys);
+	uint64_t hashWorld(const WorldPrototype& world);
+
+	/*
+		The contribution of the physical at the given index of world.physicals, hashWorld sums these over all physicals
+		Lets a loop that already visits every physical, like WorldPrototype::update, hash them while they are in the cache
+	*/
+	uint64_t hashPhysicalAt(const MotorizedPhysical& phys, size_t index);
+	/*
+		The hash of the world, given the sum of hashPhysicalAt over all of its physicals
+	*/
+	uint64_t hashWorldFromPhysicals(const WorldPrototype& world, uint64_t physicalsHash);
+};
+
+struct WorldDivergence {
+	bool diverged = false;
+
+	// the age of the worlds after the first tick at which their states differed
+	size_t tick = 0;
+
+	/*
+		The first differing physical in world.physicals and the first differing part of it, in depth first order
+		If only the motion or the constraints of the physical differ the part is its main part
+		If the worlds have a different number of physicals, or differ outside of their physicals, physicalIndex is the smaller
+		physical count and both parts are nullptr
+	*/
+	size_t physicalIndex = 0;
+	size_t partIndex = 0;
+	const Part* referencePart = nullptr;
+	const Part* testedPart = nullptr;
+};
+
+/*
+	Compares the state of two worlds of the same age, see WorldDivergence
+*/
+WorldDivergence compareWorldStates(const WorldPrototype& reference, const WorldPrototype& tested);
+
+/*
+	Ticks both worlds tickCount times side by side and compares their state after every tick
+	Stops at the first tick after which they differ
+*/
+WorldDivergence findFirstDivergence(WorldPrototype& reference, WorldPrototype& tested, size_t tickCount);
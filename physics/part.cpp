@@ -22,12 +22,12 @@ namespace {
 }
 
 Part::Part(const Shape& shape, const GlobalCFrame& position, const PartProperties& properties)
-	: hitbox(shape), cframe(position), properties(properties) {
+	: cframe(position), hitbox(shape), properties(properties) {
 	recalculate(*this);
 }
 
 Part::Part(const Shape& shape, Part& attachTo, const CFrame& attach, const PartProperties& properties)
-	: hitbox(shape), cframe(attachTo.cframe.localToGlobal(attach)), properties(properties) {
+	: cframe(attachTo.cframe.localToGlobal(attach)), hitbox(shape), properties(properties) {
 	attachTo.attach(this, attach);
 	recalculate(*this);
 }
@@ -39,12 +39,13 @@ Part::~Part() {
 }
 
 Part::Part(Part&& other) :
-	cframe(other.cframe),
 	isTerrainPart(other.isTerrainPart),
-	parent(other.parent), 
-	hitbox(std::move(other.hitbox)), 
-	maxRadius(other.maxRadius), 
-	properties(std::move(other.properties)) {
+	maxRadius(other.maxRadius),
+	cframe(other.cframe),
+	hitbox(std::move(other.hitbox)),
+	parent(other.parent),
+	properties(std::move(other.properties)),
+	handle(other.handle) {
 
 	if(parent != nullptr) parent->notifyPartStdMoved(&other, this);
 
@@ -57,6 +58,7 @@ Part& Part::operator=(Part&& other) {
 	this->hitbox = std::move(other.hitbox);
 	this->maxRadius = other.maxRadius;
 	this->properties = std::move(other.properties);
+	this->handle = other.handle;
 
 	if(parent != nullptr) parent->notifyPartStdMoved(&other, this);
 
@@ -66,8 +68,13 @@ Part& Part::operator=(Part&& other) {
 }
 
 PartIntersection Part::intersects(const Part& other) const {
+	SupportHint hint;
+	return this->intersects(other, hint);
+}
+
+PartIntersection Part::intersects(const Part& other, SupportHint& hint) const {
 	CFrame relativeTransform = this->cframe.globalToLocal(other.cframe);
-	std::optional<Intersection> result = intersectsTransformed(this->hitbox, other.hitbox, relativeTransform);
+	std::optional<Intersection> result = intersectsTransformed(this->hitbox, other.hitbox, relativeTransform, hint);
 	if(result) {
 		Position intersection = this->cframe.localToGlobal(result.value().intersection);
 		Vec3 exitVector = this->cframe.localToRelative(result.value().exitVector);
@@ -81,6 +88,16 @@ PartIntersection Part::intersects(const Part& other) const {
 	return PartIntersection();
 }
 
+void Part::intersectsTriangles(const Part& other, std::vector<PartIntersection>& result) const {
+	CFrame relativeTransform = this->cframe.globalToLocal(other.cframe);
+	thread_local std::vector<Intersection> intersections;
+	intersections.clear();
+	intersectsTrianglesTransformed(this->hitbox, other.hitbox, relativeTransform, intersections);
+	for(const Intersection& intersection : intersections) {
+		result.push_back(PartIntersection(this->cframe.localToGlobal(intersection.intersection), this->cframe.localToRelative(intersection.exitVector)));
+	}
+}
+
 BoundingBox Part::getLocalBounds() const {
 	Vec3 v = Vec3(this->hitbox.scale[0], this->hitbox.scale[1], this->hitbox.scale[2]);
 	return BoundingBox(-v, v);
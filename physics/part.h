@@ -7,12 +7,17 @@ class Physical;
 class ConnectedPhysical;
 class MotorizedPhysical;
 class WorldPrototype;
+
+#include <vector>
+
 #include "geometry/shape.h"
+#include "geometry/genericCollidable.h"
 #include "math/linalg/mat.h"
 #include "math/position.h"
 #include "math/globalCFrame.h"
 #include "math/bounds.h"
 #include "motion.h"
+#include "datastructures/handleTable.h"
 
 struct PartProperties {
 	double density;
@@ -48,15 +53,27 @@ class Part {
 	friend class MotorizedPhysical;
 	friend class WorldPrototype;
 
-	GlobalCFrame cframe;
-
+	/*
+		The fields colission detection reads for every pair of parts it considers come first, in the order it reads them
+	*/
 public:
 	bool isTerrainPart = false;
-	Physical* parent = nullptr;
-	Shape hitbox;
 	double maxRadius;
+private:
+	GlobalCFrame cframe;
+public:
+	Shape hitbox;
+
+	// only needed once two parts are found to touch
+	Physical* parent = nullptr;
 	PartProperties properties;
 
+	/*
+		Identifies this part within the world it is in, stays the same when the part is moved in memory, see WorldPrototype::getPart
+		Null while the part is not in a world
+	*/
+	Handle<Part> handle;
+
 	Part() = default;
 	Part(const Shape& shape, const GlobalCFrame& position, const PartProperties& properties);
 	Part(const Shape& shape, Part& attachTo, const CFrame& attach, const PartProperties& properties);
@@ -69,6 +86,14 @@ public:
 
 
 	PartIntersection intersects(const Part& other) const;
+	/*
+		hint is kept between ticks per pair of parts, see SupportHint
+	*/
+	PartIntersection intersects(const Part& other, SupportHint& hint) const;
+	/*
+		other must have a TriangleShapeClass, appends an intersection for every triangle of other that this part intersects
+	*/
+	void intersectsTriangles(const Part& other, std::vector<PartIntersection>& result) const;
 	void scale(double scaleX, double scaleY, double scaleZ);
 
 	Bounds getStrictBounds() const;
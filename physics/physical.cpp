@@ -38,6 +38,10 @@ Physical::Physical(RigidBody&& rigidBody, MotorizedPhysical* mainPhysical) : rig
 }
 
 Physical::Physical(Physical&& other) noexcept :
+	subtreeMass(other.subtreeMass),
+	subtreeCenterOfMass(other.subtreeCenterOfMass),
+	subtreeInertia(other.subtreeInertia),
+	massPropertiesValid(other.massPropertiesValid),
 	rigidBody(std::move(other.rigidBody)), 
 	mainPhysical(other.mainPhysical),
 	childPhysicals(std::move(other.childPhysicals)) {
@@ -54,6 +58,10 @@ Physical& Physical::operator=(Physical&& other) noexcept {
 	this->rigidBody = std::move(other.rigidBody);
 	this->mainPhysical = other.mainPhysical;
 	this->childPhysicals = std::move(other.childPhysicals);
+	this->subtreeMass = other.subtreeMass;
+	this->subtreeCenterOfMass = other.subtreeCenterOfMass;
+	this->subtreeInertia = other.subtreeInertia;
+	this->massPropertiesValid = other.massPropertiesValid;
 	this->rigidBody.mainPart->parent = this;
 	for(AttachedPart& p : this->rigidBody.parts) {
 		p.part->parent = this;
@@ -86,6 +94,7 @@ void Physical::makeMainPart(AttachedPart& newMainPart) {
 		ConnectedPhysical* self = (ConnectedPhysical*) this;
 		self->connectionToParent.attachOnChild = newCenterCFrame.globalToLocal(self->connectionToParent.attachOnChild);
 	}
+	invalidateMassProperties();
 }
 
 template<typename T>
@@ -217,7 +226,7 @@ void Physical::attachPhysical(Physical* phys, HardConstraint* constraint, const
 void Physical::attachPhysical(MotorizedPhysical* phys, HardConstraint* constraint, const CFrame& attachToThis, const CFrame& attachToThat) {
 	WorldPrototype* world = this->mainPhysical->world;
 	if(world != nullptr) {
-		world->notifyPhysicalsMerged(this->mainPhysical, mainPhysical);
+		world->notifyPhysicalsMerged(this->mainPhysical, phys);
 	}
 
 	ConnectedPhysical childToAdd(std::move(*phys), this, constraint, attachToThat, attachToThis);
@@ -330,6 +339,8 @@ void Physical::detachAllChildPhysicals() {
 	}
 
 	childPhysicals.clear(); // calls the destructors on all (now invalid) children, deleting the constraints in the process
+	// the cached subtree still counts the children that were just split off
+	invalidateMassProperties();
 }
 
 void Physical::detachFromRigidBody(Part* part) {
@@ -395,8 +406,9 @@ void Physical::detachPart(Part* part) {
 				world->notifyPhysicalHasBeenSplit(mainPhys, newPhys);
 			}
 			self.parent->childPhysicals.remove(std::move(self)); // double move, but okay, since remove really only needs the address of self
-			mainPhys->refreshPhysicalProperties();
 		}
+		// either this lost its children or mainPhys lost this
+		mainPhys->refreshPhysicalProperties();
 
 		// After this, self, and hence also *this* is no longer valid!
 		// It has been removed
@@ -449,9 +461,10 @@ void Physical::removePart(Part* part) {
 	}
 }
 
-// TODO: this seems to need to update the encompassing MotorizedPhysical as well
 void Physical::notifyPartPropertiesChanged(Part* part) {
 	rigidBody.refreshWithNewParts();
+	invalidateMassProperties();
+	mainPhysical->updateMassProperties();
 }
 void Physical::notifyPartPropertiesAndBoundsChanged(Part* part, const Bounds& oldBounds) {
 	notifyPartPropertiesChanged(part);
@@ -471,6 +484,10 @@ void Physical::notifyPartStdMoved(Part* oldPartPtr, Part* newPartPtr) {
 void Physical::updateConstraints(double deltaT) {
 	for(ConnectedPhysical& p : childPhysicals) {
 		p.connectionToParent.update(deltaT);
+		if(!p.connectionToParent.constraintWithParent->isConstant()) {
+			// the subtree of p itself is unchanged, only its placement in this physical moved
+			invalidateMassProperties();
+		}
 		p.updateConstraints(deltaT);
 	}
 }
@@ -557,18 +574,6 @@ void MotorizedPhysical::translate(const Vec3& translation) {
 	mainPhysical->world->notifyPartGroupBoundsUpdated(this->rigidBody.mainPart, oldBounds);
 }
 
-static std::pair<Vec3, double> getRecursiveCenterOfMass(const Physical& phys) {
-	Vec3 totalCOM = phys.rigidBody.mass * phys.rigidBody.localCenterOfMass;
-	double totalMass = phys.rigidBody.mass;
-	for(const ConnectedPhysical& conPhys : phys.childPhysicals) {
-		CFrame relFrame = conPhys.getRelativeCFrameToParent();
-		std::pair<Vec3, double> localCOM = getRecursiveCenterOfMass(conPhys);
-		totalCOM += localCOM.second * relFrame.localToGlobal(localCOM.first);
-		totalMass += localCOM.second;
-	}
-	return std::pair<Vec3, double>(totalCOM / totalMass, totalMass);
-}
-
 static SymmetricMat3 getRecursiveInertia(const Physical& phys, const CFrame& offsetCFrame, const Vec3& localCOMOfMain) {
 	SymmetricMat3 totalInertia = getTransformedInertiaAroundCenterOfMass(phys.rigidBody.inertia, phys.rigidBody.localCenterOfMass, offsetCFrame, localCOMOfMain, phys.rigidBody.mass);
 
@@ -582,15 +587,65 @@ static SymmetricMat3 getRecursiveInertia(const Physical& phys, const CFrame& off
 	return totalInertia;
 }
 
+void Physical::invalidateMassProperties() {
+	Physical* cur = this;
+	while(true) {
+		cur->massPropertiesValid = false;
+		if(cur->isMainPhysical()) break;
+		cur = static_cast<ConnectedPhysical*>(cur)->parent;
+	}
+}
+
+void Physical::invalidateMassPropertiesRecursive() {
+	massPropertiesValid = false;
+	for(ConnectedPhysical& conPhys : childPhysicals) {
+		conPhys.invalidateMassPropertiesRecursive();
+	}
+}
+
+bool Physical::refreshMassProperties() {
+	if(massPropertiesValid) return false;
+
+	for(ConnectedPhysical& conPhys : childPhysicals) {
+		conPhys.refreshMassProperties();
+	}
+
+	Vec3 totalCOM = rigidBody.mass * rigidBody.localCenterOfMass;
+	double totalMass = rigidBody.mass;
+	for(const ConnectedPhysical& conPhys : childPhysicals) {
+		totalCOM += conPhys.subtreeMass * conPhys.getRelativeCFrameToParent().localToGlobal(conPhys.subtreeCenterOfMass);
+		totalMass += conPhys.subtreeMass;
+	}
+	totalCOM = totalCOM / totalMass;
+
+	SymmetricMat3 totalInertia = getTransformedInertiaAroundCenterOfMass(rigidBody.inertia, rigidBody.localCenterOfMass, CFrame(0, 0, 0), totalCOM, rigidBody.mass);
+	for(const ConnectedPhysical& conPhys : childPhysicals) {
+		totalInertia += getTransformedInertiaAroundCenterOfMass(conPhys.subtreeInertia, conPhys.subtreeCenterOfMass, conPhys.getRelativeCFrameToParent(), totalCOM, conPhys.subtreeMass);
+	}
+
+	subtreeMass = totalMass;
+	subtreeCenterOfMass = totalCOM;
+	subtreeInertia = totalInertia;
+	massPropertiesValid = true;
+	return true;
+}
+
 void MotorizedPhysical::refreshPhysicalProperties() {
-	std::pair<Vec3, double> result = getRecursiveCenterOfMass(*this);
-	totalCenterOfMass = result.first;
-	totalMass = result.second;
+	invalidateMassPropertiesRecursive();
+	updateMassProperties();
+}
+
+void MotorizedPhysical::updateMassProperties() {
+	if(!refreshMassProperties()) return;
+
+	// the parts or their attachments changed
+	cachedStateHash.isReusable = false;
 
-	SymmetricMat3 totalInertia = getRecursiveInertia(*this, CFrame(0, 0, 0), totalCenterOfMass);
+	totalCenterOfMass = subtreeCenterOfMass;
+	totalMass = subtreeMass;
 
 	forceResponse = SymmetricMat3::IDENTITY() * (1 / totalMass);
-	momentResponse = ~totalInertia;
+	momentResponse = ~subtreeInertia;
 }
 
 void ConnectedPhysical::refreshCFrame() {
@@ -646,7 +701,7 @@ void MotorizedPhysical::update(double deltaT) {
 	this->motionOfCenterOfMass.rotation.rotation[0] -= deltaAngularVelocity;
 
 	Vec3 oldCenterOfMass = this->totalCenterOfMass;
-	refreshPhysicalProperties();
+	updateMassProperties();
 	Vec3 deltaCOM = this->totalCenterOfMass - oldCenterOfMass;
 
 	
@@ -659,6 +714,12 @@ void MotorizedPhysical::update(double deltaT) {
 	updateAttachedPhysicals();
 }
 
+bool MotorizedPhysical::isAtRest() const {
+	Vec3 zero(0.0, 0.0, 0.0);
+	return motionOfCenterOfMass.getVelocity() == zero && motionOfCenterOfMass.getAngularVelocity() == zero &&
+		totalForce == zero && totalMoment == zero && childPhysicals.size() == 0 && massPropertiesValid;
+}
+
 #pragma endregion
 
 /*
@@ -791,12 +852,14 @@ Mat3 MotorizedPhysical::getResponseMatrix(const Vec3Local& actionPoint, const Ve
 
 	return Mat3(forceResponse) - rotationFactor;
 }
+/*
+	Same as (getResponseMatrix(localPoint) * localDirection) * localDirection, without building the response matrix
+	With C = createCrossProductEquivalent(localPoint): d * (C * M * ~C * d) == (~C * d) * (M * (~C * d)) and ~C * d == localPoint % d
+*/
 double MotorizedPhysical::getInertiaOfPointInDirectionLocal(const Vec3Local& localPoint, const Vec3Local& localDirection) const {
-	SymmetricMat3 accMat = getResponseMatrix(localPoint);
-
-	Vec3 force = localDirection;
-	Vec3 accel = accMat * force;
-	double accelInForceDir = accel * localDirection / lengthSquared(localDirection);
+	Vec3 momentArm = localPoint % localDirection;
+	double accelAlongDirection = (forceResponse * localDirection) * localDirection + (momentResponse * momentArm) * momentArm;
+	double accelInForceDir = accelAlongDirection / lengthSquared(localDirection);
 
 	return 1 / accelInForceDir;
 
@@ -826,7 +889,8 @@ Vec3 MotorizedPhysical::getTotalImpulse() const {
 	return this->motionOfCenterOfMass.getVelocity() * this->totalMass;
 }
 Vec3 MotorizedPhysical::getTotalAngularMomentum() const {
-	SymmetricMat3 totalInertia = getRecursiveInertia(*this, CFrame(0, 0, 0), totalCenterOfMass);
+	// while the cache is valid totalCenterOfMass is the center of the cached inertia
+	SymmetricMat3 totalInertia = massPropertiesValid ? subtreeInertia : getRecursiveInertia(*this, CFrame(0, 0, 0), totalCenterOfMass);
 	return totalInertia * this->motionOfCenterOfMass.getAngularVelocity();
 }
 
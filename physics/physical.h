@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "math/linalg/vec.h"
 #include "math/linalg/mat.h"
 #include "math/cframe.h"
@@ -9,6 +11,7 @@
 
 #include "datastructures/unorderedVector.h"
 #include "datastructures/iteratorEnd.h"
+#include "datastructures/handleTable.h"
 
 #include "part.h"
 #include "rigidBody.h"
@@ -48,7 +51,26 @@ protected:
 	void detachFromRigidBody(AttachedPart&& part);
 
 	void detachPartAssumingMultipleParts(Part* part);
-	
+
+	/*
+		Mass properties of this physical and all its children, in the local frame of this physical
+		The inertia is around subtreeCenterOfMass. Only recomputed when invalidated, so an unchanged subtree costs nothing per tick
+	*/
+	double subtreeMass = 0.0;
+	Vec3 subtreeCenterOfMass;
+	SymmetricMat3 subtreeInertia;
+	bool massPropertiesValid = false;
+
+	/*
+		Marks this physical and every physical above it as changed, the children keep their cached properties
+	*/
+	void invalidateMassProperties();
+	void invalidateMassPropertiesRecursive();
+	/*
+		Recomputes the subtree properties of every invalidated physical, returns true if anything changed
+	*/
+	bool refreshMassProperties();
+
 	/*
 		Returns a representation for the motion of the center of mass within this physical
 
@@ -209,7 +231,14 @@ class MotorizedPhysical : public Physical {
 	friend class ConnectedPhysical;
 	void rotateAroundCenterOfMassUnsafe(const Rotation& rotation);
 public:
+	/*
+		Recomputes the mass properties of the whole structure, call after changing attachments or parts directly
+	*/
 	void refreshPhysicalProperties();
+	/*
+		Only recomputes the subtrees that changed since the last refresh, moving constraints invalidate their parents every tick
+	*/
+	void updateMassProperties();
 	Vec3 totalForce = Vec3(0.0, 0.0, 0.0);
 	Vec3 totalMoment = Vec3(0.0, 0.0, 0.0);
 
@@ -217,11 +246,25 @@ public:
 	Vec3 totalCenterOfMass;
 
 	WorldPrototype* world = nullptr;
+	/*
+		Identifies this physical within world, see WorldPrototype::getPhysical
+	*/
+	Handle<MotorizedPhysical> handle;
 	
 	SymmetricMat3 forceResponse;
 	SymmetricMat3 momentResponse;
 
 	Motion motionOfCenterOfMass;
+
+	/*
+		The contribution of this physical to the state hash of its world and its index in world.physicals at the time, see WorldPrototype::hashStateEveryTick
+		Reused while the physical stays at rest, moving it or changing its parts outside of update clears isReusable
+	*/
+	struct CachedStateHash {
+		uint64_t hash = 0;
+		size_t index = 0;
+		bool isReusable = false;
+	} cachedStateHash;
 	
 	explicit MotorizedPhysical(Part* mainPart);
 	explicit MotorizedPhysical(RigidBody&& rigidBody);
@@ -251,6 +294,11 @@ public:
 	void ensureWorld(WorldPrototype* world);
 
 	void update(double deltaT);
+	/*
+		True if update leaves this physical where it is: it has no velocity, no pending force or moment, no child physicals and up to date mass properties
+		Only the signs of zeros in its state can still change, and only on the first update at rest
+	*/
+	bool isAtRest() const;
 
 	void setCFrame(const GlobalCFrame& newCFrame);
 	void rotateAroundCenterOfMass(const Rotation& rotation);
@@ -26,6 +26,15 @@ public:
 	}
 };
 
+/*
+	Whether profilers record on the current thread, enabled by default
+	The global profilers are not synchronized, threads that run physics next to the one that records into them, like the workers of the batch runner, turn it off
+*/
+inline bool& isProfilingEnabled() {
+	thread_local bool enabled = true;
+	return enabled;
+}
+
 template<typename Unit, typename Category>
 class HistoricTally {
 	ParallelArray<Unit, static_cast<size_t>(Category::COUNT)> currentTally;
@@ -41,6 +50,7 @@ public:
 	}
 
 	inline void addToTally(Category category, Unit amount) {
+		if(!isProfilingEnabled()) return;
 		currentTally[static_cast<size_t>(category)] += amount;
 	}
 
@@ -51,6 +61,7 @@ public:
 	}
 
 	inline void nextTally() {
+		if(!isProfilingEnabled()) return;
 		history.add(currentTally);
 		clearCurrentTally();
 	}
@@ -71,16 +82,23 @@ public:
 
 	inline BreakdownAverageProfiler(char const * const labels[static_cast<size_t>(ProcessType::COUNT)], size_t capacity) : HistoricTally<std::chrono::nanoseconds, ProcessType>(labels, capacity), tickHistory(capacity) {}
 
+	/*
+		Worlds ticking on separate threads share the global profilers, currentProcess is read once so an unsynchronized
+		end() on another thread can only skew the times, never make addToTally index with -1
+	*/
 	inline void mark(ProcessType process) {
+		if(!isProfilingEnabled()) return;
 		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
-		if(currentProcess != static_cast<ProcessType>(-1)) {
-			HistoricTally<std::chrono::nanoseconds, ProcessType>::addToTally(currentProcess, curTime - startTime);
+		ProcessType previousProcess = currentProcess;
+		if(previousProcess != static_cast<ProcessType>(-1)) {
+			HistoricTally<std::chrono::nanoseconds, ProcessType>::addToTally(previousProcess, curTime - startTime);
 		}
 		startTime = curTime;
 		currentProcess = process;
 	}
 
 	inline void mark(ProcessType process, ProcessType overrideOldProcess) {
+		if(!isProfilingEnabled()) return;
 		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
 		if (currentProcess != static_cast<ProcessType>(-1)) {
 			HistoricTally<std::chrono::nanoseconds, ProcessType>::addToTally(overrideOldProcess, curTime - startTime);
@@ -90,14 +108,25 @@ public:
 	}
 
 	inline void end() {
+		if(!isProfilingEnabled()) return;
 		std::chrono::high_resolution_clock::time_point curTime = std::chrono::high_resolution_clock::now();
-		this->addToTally(currentProcess, curTime - startTime);
+		ProcessType previousProcess = currentProcess;
+		if(previousProcess != static_cast<ProcessType>(-1)) {
+			this->addToTally(previousProcess, curTime - startTime);
+		}
 		tickHistory.add(curTime);
 
 		currentProcess = static_cast<ProcessType>(-1);
 		this->nextTally();
 	}
 
+	/*
+		Returns the process currently being measured, or static_cast<ProcessType>(-1) if no process is marked
+	*/
+	inline ProcessType getCurrentProcess() const {
+		return currentProcess;
+	}
+
 	inline double getAvgTPS() {
 		size_t numTicks = tickHistory.size();
 		if(numTicks != 0) {
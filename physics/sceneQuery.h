@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cmath>
+
+#include "math/ray.h"
+#include "math/globalCFrame.h"
+#include "geometry/shape.h"
+#include "geometry/basicShapes.h"
+
+class Part;
+
+/*
+	Batches of queries are answered by the query functions of WorldPrototype, see raycastClosest, overlapAll and sweepClosest
+	They only read the world, a batch may run on several threads while no other thread modifies the world
+*/
+
+/*
+	A ray from ray.start along ray.direction, only hits closer than maxDistance are reported
+	Distances are measured in multiples of ray.direction, just like Shape::getIntersectionDistance
+*/
+struct RayQuery {
+	Ray ray;
+	double maxDistance = INFINITY;
+
+	RayQuery() = default;
+	RayQuery(const Ray& ray, double maxDistance = INFINITY) : ray(ray), maxDistance(maxDistance) {}
+};
+
+/*
+	The result of a single ray or sweep query, part is nullptr if nothing was hit
+*/
+struct QueryHit {
+	Part* part = nullptr;
+	double distance = INFINITY;
+
+	inline bool hasHit() const { return part != nullptr; }
+};
+
+/*
+	A convex shape placed in the world, every part that intersects it is reported
+*/
+struct OverlapQuery {
+	Shape shape;
+	GlobalCFrame cframe;
+
+	OverlapQuery() = default;
+	OverlapQuery(const Shape& shape, const GlobalCFrame& cframe) : shape(shape), cframe(cframe) {}
+
+	static inline OverlapQuery sphere(const Position& center, double radius) {
+		return OverlapQuery(Sphere(radius), GlobalCFrame(center));
+	}
+	static inline OverlapQuery box(const GlobalCFrame& cframe, double width, double height, double depth) {
+		return OverlapQuery(Box(width, height, depth), cframe);
+	}
+};
+
+/*
+	A convex shape moved from start by translation, without rotating
+	The distance of the hit is the fraction of translation at which the shape first touches a part, from 0 to 1
+	Moving the shape by less than that fraction does not intersect the hit part, a distance of 0 means it already intersects at start
+
+	The movement is sampled in steps of the smallest half extent of the shape, parts thinner than that may be missed when they are hit at a glancing angle
+*/
+struct SweepQuery {
+	Shape shape;
+	GlobalCFrame start;
+	Vec3 translation;
+
+	SweepQuery() = default;
+	SweepQuery(const Shape& shape, const GlobalCFrame& start, const Vec3& translation) : shape(shape), start(start), translation(translation) {}
+};
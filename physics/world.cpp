@@ -84,6 +84,12 @@ bool WorldPrototype::isValid() const {
 			DEBUGBREAK;
 			return false;
 		}
+
+		if(getPhysical(phys->handle) != phys) {
+			Log::error("Physical handle does not resolve to the physical!");
+			DEBUGBREAK;
+			return false;
+		}
 	}
 
 	treeValidCheck(objectTree);
@@ -139,7 +145,7 @@ void WorldPrototype::addPart(Part* part) {
 	}
 	
 	objectTree.add(createNodeFor(part->parent->mainPhysical));
-	physicals.push_back(part->parent->mainPhysical);
+	registerPhysical(part->parent->mainPhysical);
 
 	objectCount += part->parent->mainPhysical->getNumberOfPartsInThisAndChildren();
 	
@@ -148,9 +154,42 @@ void WorldPrototype::addPart(Part* part) {
 	ASSERT_VALID;
 
 	part->parent->mainPhysical->forEachPart([this](Part& part) {
-		this->onPartAdded(&part);
+		this->registerPart(&part);
 	});
 }
+void WorldPrototype::addParts(Part* const parts[], size_t partCount) {
+	ASSERT_VALID;
+	std::vector<TreeNode> newNodes;
+	newNodes.reserve(partCount);
+	physicals.reserve(physicals.size() + partCount);
+	for(size_t i = 0; i < partCount; i++) {
+		Part* part = parts[i];
+		part->ensureHasParent();
+		MotorizedPhysical* phys = part->parent->mainPhysical;
+		if(phys->world == this) {
+			Log::warn("Attempting to readd part to world");
+			continue;
+		}
+
+		newNodes.push_back(createNodeFor(phys));
+		registerPhysical(phys);
+		objectCount += phys->getNumberOfPartsInThisAndChildren();
+		phys->world = this;
+	}
+
+	objectTree.addAll(newNodes.data(), newNodes.size());
+
+	ASSERT_VALID;
+
+	for(size_t i = 0; i < newNodes.size(); i++) {
+		// the nodes were moved into the tree, the physicals were appended in the same order
+		MotorizedPhysical* phys = physicals[physicals.size() - newNodes.size() + i];
+		phys->forEachPart([this](Part& part) {
+			this->registerPart(&part);
+		});
+	}
+}
+
 void WorldPrototype::removePart(Part* part) {
 	ASSERT_VALID;
 	
@@ -160,7 +199,7 @@ void WorldPrototype::removePart(Part* part) {
 }
 
 void WorldPrototype::notifyMainPhysicalObsolete(MotorizedPhysical* motorPhys) {
-	physicals.erase(std::remove(physicals.begin(), physicals.end(), motorPhys));
+	unregisterPhysical(motorPhys);
 
 	ASSERT_VALID;
 }
@@ -172,8 +211,26 @@ void WorldPrototype::addTerrainPart(Part* part) {
 
 	ASSERT_VALID;
 
-	this->onPartAdded(part);
+	this->registerPart(part);
 }
+void WorldPrototype::addTerrainParts(Part* const parts[], size_t partCount) {
+	std::vector<TreeNode> newNodes;
+	newNodes.reserve(partCount);
+	for(size_t i = 0; i < partCount; i++) {
+		parts[i]->isTerrainPart = true;
+		newNodes.push_back(TreeNode(parts[i], parts[i]->getStrictBounds(), true));
+	}
+	objectCount += partCount;
+
+	terrainTree.addAll(newNodes.data(), newNodes.size());
+
+	ASSERT_VALID;
+
+	for(size_t i = 0; i < partCount; i++) {
+		this->registerPart(parts[i]);
+	}
+}
+
 void WorldPrototype::optimizeTerrain() {
 	for(int i = 0; i < 5; i++) {
 		terrainTree.improveStructure();
@@ -183,17 +240,19 @@ void WorldPrototype::optimizeTerrain() {
 
 void WorldPrototype::notifyPartBoundsUpdated(const Part* updatedPart, const Bounds& oldBounds) {
 	objectTree.updateObjectBounds(updatedPart, oldBounds);
+	updatedPart->parent->mainPhysical->cachedStateHash.isReusable = false;
 	ASSERT_VALID;
 }
 
 void WorldPrototype::notifyPartGroupBoundsUpdated(const Part* mainPart, const Bounds& oldMainPartBounds) {
 	objectTree.updateObjectGroupBounds(mainPart, oldMainPartBounds);
+	mainPart->parent->mainPhysical->cachedStateHash.isReusable = false;
 	ASSERT_VALID;
 }
 
 
 void WorldPrototype::notifyNewPhysicalCreatedWhenSplitting(MotorizedPhysical* newPhysical) {
-	physicals.push_back(newPhysical);
+	registerPhysical(newPhysical);
 	newPhysical->world = this;
 }
 
@@ -242,6 +301,8 @@ void WorldPrototype::mergePhysicalGroups(const MotorizedPhysical* firstPhysical,
 			if(item == secondPhysical) {
 				item = std::move(physicals.back());
 				physicals.pop_back();
+				physicalHandles.remove(secondPhysical->handle);
+				secondPhysical->handle = Handle<MotorizedPhysical>();
 
 				goto physicalFound;
 			}
@@ -259,7 +320,7 @@ void WorldPrototype::mergePhysicalGroups(const MotorizedPhysical* firstPhysical,
 		stack.expandBoundsAllTheWayToTop();
 	} else {
 		secondPhysical->forEachPart([this](Part& part) {
-			this->onPartAdded(&part);
+			this->registerPart(&part);
 		});
 
 		const Part* main = firstPhysical->getMainPart();
@@ -284,11 +345,12 @@ void WorldPrototype::notifyNewPartAddedToPhysical(const MotorizedPhysical* physi
 	objectCount++;
 	ASSERT_TREE_VALID(objectTree);
 
-	onPartAdded(newPart);
+	registerPart(newPart);
 }
 
 void WorldPrototype::notifyPartStdMoved(Part* oldPartPtr, Part* newPartPtr) {
 	(*getTreeForPart(oldPartPtr).find(oldPartPtr, newPartPtr->getStrictBounds()))->object = newPartPtr;
+	partHandles.relocate(newPartPtr->handle, newPartPtr);
 	ASSERT_TREE_VALID(objectTree);
 }
 
@@ -309,13 +371,34 @@ void WorldPrototype::notifyPartRemovedFromPhysical(Part* part) {
 	objectCount--;
 	ASSERT_TREE_VALID(objectTree);
 
-	this->onPartRemoved(part);
+	this->unregisterPart(part);
 }
 
 
 void WorldPrototype::onPartAdded(Part* newPart) {}
 void WorldPrototype::onPartRemoved(Part* removedPart) {}
 
+void WorldPrototype::registerPart(Part* part) {
+	part->handle = partHandles.add(part);
+	this->onPartAdded(part);
+}
+void WorldPrototype::unregisterPart(Part* part) {
+	this->onPartRemoved(part);
+	partHandles.remove(part->handle);
+	part->handle = Handle<Part>();
+}
+
+void WorldPrototype::registerPhysical(MotorizedPhysical* physical) {
+	physicals.push_back(physical);
+	physical->handle = physicalHandles.add(physical);
+	physical->cachedStateHash.isReusable = false;
+}
+void WorldPrototype::unregisterPhysical(MotorizedPhysical* physical) {
+	physicals.erase(std::remove(physicals.begin(), physicals.end(), physical));
+	physicalHandles.remove(physical->handle);
+	physical->handle = Handle<MotorizedPhysical>();
+}
+
 void WorldPrototype::addExternalForce(ExternalForce* force) {
 	externalForces.push_back(force);
 }
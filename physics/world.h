@@ -1,13 +1,19 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
 
 #include "part.h"
 #include "physical.h"
 #include "constraintGroup.h"
+#include "sceneQuery.h"
 #include "datastructures/iterators.h"
 #include "datastructures/iteratorEnd.h"
 #include "datastructures/boundsTree.h"
+#include "datastructures/quantizedBoundsTree.h"
+#include "datastructures/handleTable.h"
 #include "math/linalg/largeMatrix.h"
 
 #define FREE_PARTS 0x1
@@ -43,6 +49,31 @@ private:
 	std::vector<Colission> currentObjectColissions;
 	std::vector<Colission> currentTerrainColissions;
 
+	struct SupportHintEntry {
+		SupportHint hint;
+		size_t lastUsedAge;
+	};
+	struct PartPairHash {
+		static uint64_t getKey(Handle<Part> handle) {
+			return (static_cast<uint64_t>(handle.generation) << 32) | handle.index;
+		}
+		size_t operator()(const std::pair<Handle<Part>, Handle<Part>>& pair) const {
+			return std::hash<uint64_t>()(getKey(pair.first)) * 31 + std::hash<uint64_t>()(getKey(pair.second));
+		}
+	};
+	/*
+		Support vertices of the last intersection test of every pair of parts of which one uses support hints
+		Keyed by the handles of the parts, so the hints stay with parts that compactParts moves
+		Pairs that were not tested for a while are removed by findColissions, the handles of removed parts are never looked up again until then
+	*/
+	std::unordered_map<std::pair<Handle<Part>, Handle<Part>>, SupportHintEntry, PartPairHash> supportHints;
+
+	/*
+		Copies of objectTree and terrainTree used by findColissions, rebuilt at the start of every search
+	*/
+	QuantizedBoundsTree quantizedObjectTree;
+	QuantizedBoundsTree quantizedTerrainTree;
+
 	/*
 		Called when then bounds of a part are updated
 	*/
@@ -98,6 +129,23 @@ private:
 private: // actually private fields and methods, not to be used by any friends
 	void mergePhysicalGroups(const MotorizedPhysical* first, MotorizedPhysical* second);
 
+	/*
+		The current address of every part and physical in this world, by handle
+	*/
+	HandleTable<Part> partHandles;
+	HandleTable<MotorizedPhysical> physicalHandles;
+
+	/*
+		Give a part entering or leaving the world its handle and call onPartAdded or onPartRemoved
+	*/
+	void registerPart(Part* part);
+	void unregisterPart(Part* part);
+	/*
+		Add a physical to or remove it from physicals and give it its handle
+	*/
+	void registerPhysical(MotorizedPhysical* physical);
+	void unregisterPhysical(MotorizedPhysical* physical);
+
 	BoundsTree<Part>& getTreeForPart(const Part* part);
 	const BoundsTree<Part>& getTreeForPart(const Part* part) const;
 
@@ -132,6 +180,16 @@ public:
 	size_t objectCount = 0;
 	double deltaT;
 
+	/*
+		If enabled, every tick folds the hash of the state of the world after it into stateHash, see misc/worldStateHash.h
+		Two worlds that ran the same ticks have the same stateHash only if their states matched after every tick
+
+		Off by default, it is meant for tracking down divergences. Physicals are hashed as update visits them, a physical that stays
+		at rest keeps the hash of the previous tick, see MotorizedPhysical::cachedStateHash. Only moving physicals cost a pass over their parts and constraints
+	*/
+	bool hashStateEveryTick = false;
+	uint64_t stateHash = 0;
+
 
 	WorldPrototype(double deltaT);
 	~WorldPrototype();
@@ -150,6 +208,52 @@ public:
 	void addTerrainPart(Part* part);
 	void optimizeTerrain();
 
+	/*
+		Adds many parts in one step, the object tree is extended with a single balanced subtree instead of inserting every physical separately
+		Parts of the same physical should only be passed once, through any one of its parts
+	*/
+	void addParts(Part* const parts[], size_t partCount);
+	void addTerrainParts(Part* const parts[], size_t partCount);
+
+	/*
+		Scene queries, answer queryCount queries at once, spread over the available hardware threads
+		Only parts selected by partsMask are considered, the world must not be modified while a batch runs
+		The threads running the queries do not record into the global profilers, so GJK iterations of queries are not counted in its statistics
+	*/
+	/*
+		results[i] is the nearest part hit by queries[i]
+	*/
+	void raycastClosest(const RayQuery* queries, size_t queryCount, QueryHit* results, int partsMask = ALL_PARTS) const;
+	/*
+		results[i] is some part hit by queries[i], not necessarily the nearest, the search stops at the first hit
+		Meant for line of sight tests
+	*/
+	void raycastAny(const RayQuery* queries, size_t queryCount, QueryHit* results, int partsMask = ALL_PARTS) const;
+	/*
+		results[i] receives every part hit by queries[i], sorted by distance
+	*/
+	void raycastAll(const RayQuery* queries, size_t queryCount, std::vector<QueryHit>* results, int partsMask = ALL_PARTS) const;
+	/*
+		results[i] receives every part intersecting queries[i], in no particular order
+	*/
+	void overlapAll(const OverlapQuery* queries, size_t queryCount, std::vector<Part*>* results, int partsMask = ALL_PARTS) const;
+	/*
+		results[i] is the first part hit by the shape of queries[i] along its translation
+	*/
+	void sweepClosest(const SweepQuery* queries, size_t queryCount, QueryHit* results, int partsMask = ALL_PARTS) const;
+
+	/*
+		The hint for intersection tests between first and second, kept between ticks
+	*/
+	SupportHint& getSupportHint(const Part* first, const Part* second);
+
+	/*
+		Handles refer to parts and physicals without depending on where they are in memory, compactParts moves parts but keeps their handles
+		A handle of a part or physical that has left the world resolves to nullptr, the handle of a part is part->handle
+	*/
+	inline Part* getPart(Handle<Part> handle) const { return partHandles.get(handle); }
+	inline MotorizedPhysical* getPhysical(Handle<MotorizedPhysical> handle) const { return physicalHandles.get(handle); }
+
 	inline size_t getPartCount(int partsMask = ALL_PARTS) const {
 		return objectCount;
 	}
@@ -211,6 +315,8 @@ public:
 
 class ExternalForce {
 public:
+	virtual ~ExternalForce() {}
+
 	virtual void apply(WorldPrototype* world) = 0;
 	virtual double getPotentialEnergyForObject(const WorldPrototype* world, const Part&) const = 0;
 	virtual double getPotentialEnergyForObject(const WorldPrototype* world, const MotorizedPhysical& phys) const {
@@ -267,4 +373,28 @@ public:
 			)
 		);
 	}
+
+	inline T* getPart(Handle<Part> handle) const { return static_cast<T*>(WorldPrototype::getPart(handle)); }
+
+	/*
+		Moves every free part to a newly allocated T, in the order of the leaves of objectTree, and deletes the old parts
+		Parts that are near each other in the tree, and thus in space, end up near each other in memory, undoing the scattering left by adding and removing parts
+		Handles stay valid, but raw pointers to free parts held outside of the world and its physicals do not. Only call between ticks
+	*/
+	void compactParts() {
+		std::vector<T*> oldParts;
+		oldParts.reserve(objectCount);
+		for(T& part : iterParts(FREE_PARTS)) {
+			oldParts.push_back(&part);
+		}
+
+		// all new parts are allocated before any old part is freed, so they don't fill the holes the old parts leave behind in arbitrary order
+		for(T* part : oldParts) {
+			// the moved part takes the place of the old one in its physical, objectTree and the handle table
+			new T(std::move(*part));
+		}
+		for(T* part : oldParts) {
+			delete part;
+		}
+	}
 };
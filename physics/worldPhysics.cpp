@@ -14,9 +14,16 @@
 #include "debug.h"
 #include "constants.h"
 #include "physicsProfiler.h"
+#include "geometry/shapeClass.h"
+#include "misc/worldStateHash.h"
 
 #include <vector>
 
+/*
+	Support hints of pairs that were not tested for this many ticks are removed
+*/
+#define SUPPORT_HINT_MAX_UNUSED_TICKS 64
+
 /*
 	exitVector is the distance p2 must travel so that the shapes are no longer colliding
 */
@@ -184,6 +191,50 @@ bool boundsSphereEarlyEnd(const DiagonalMat3& scale, const Vec3& sphereCenter, d
 	return std::abs(sphereCenter.x) > scale[0] + sphereRadius || std::abs(sphereCenter.y) > scale[1] + sphereRadius || std::abs(sphereCenter.z) > scale[2] + sphereRadius;
 }
 
+/*
+	Triangle shapes are tested per triangle, the hits are merged into one colission so the response does not depend on how the terrain is tessellated
+	The colission takes the deepest exitVector and the depth weighted average of the intersection points
+	Two triangle shapes never collide
+*/
+inline void runTriangleColissionTests(Part& p1, Part& p2, std::vector<Colission>& colissions) {
+	bool firstHasTriangles = p1.hitbox.baseShape->isTriangleShape();
+	if (firstHasTriangles && p2.hitbox.baseShape->isTriangleShape()) return;
+
+	thread_local std::vector<PartIntersection> results;
+	results.clear();
+	if (firstHasTriangles) {
+		p2.intersectsTriangles(p1, results);
+	} else {
+		p1.intersectsTriangles(p2, results);
+	}
+
+	if (results.empty()) {
+		intersectionStatistics.addToTally(IntersectionResult::GJK_REJECT, 1);
+		return;
+	}
+	intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
+
+	Position origin = results[0].intersection;
+	Vec3 deepestExitVector = results[0].exitVector;
+	double deepestDepthSq = 0.0;
+	Vec3 weightedOffset(0.0, 0.0, 0.0);
+	double totalDepth = 0.0;
+	for (const PartIntersection& result : results) {
+		double depthSq = lengthSquared(result.exitVector);
+		if (depthSq > deepestDepthSq) {
+			deepestDepthSq = depthSq;
+			deepestExitVector = result.exitVector;
+		}
+		double depth = std::sqrt(depthSq);
+		weightedOffset += Vec3(result.intersection - origin) * depth;
+		totalDepth += depth;
+	}
+	Position intersection = (totalDepth > 0.0) ? origin + weightedOffset / totalDepth : origin;
+
+	// the exitVector is for the triangle part, moving p1 the other way separates them just as well
+	colissions.push_back(Colission{ &p1, &p2, intersection, firstHasTriangles ? -deepestExitVector : deepestExitVector });
+}
+
 inline void runColissionTests(Part& p1, Part& p2, WorldPrototype& world, std::vector<Colission>& colissions) {
 	if (p1.isTerrainPart && p2.isTerrainPart) return; // TODO Unneccecary test?
 
@@ -206,7 +257,13 @@ inline void runColissionTests(Part& p1, Part& p2, WorldPrototype& world, std::ve
 		return;
 	}
 
-	PartIntersection result = p1.intersects(p2);
+	if (p1.hitbox.baseShape->isTriangleShape() || p2.hitbox.baseShape->isTriangleShape()) {
+		runTriangleColissionTests(p1, p2, colissions);
+		physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
+		return;
+	}
+
+	PartIntersection result = (p1.hitbox.baseShape->usesSupportHints() || p2.hitbox.baseShape->usesSupportHints()) ? p1.intersects(p2, world.getSupportHint(&p1, &p2)) : p1.intersects(p2);
 	if (result.intersects) {
 		intersectionStatistics.addToTally(IntersectionResult::COLISSION, 1);
 
@@ -217,65 +274,34 @@ inline void runColissionTests(Part& p1, Part& p2, WorldPrototype& world, std::ve
 	physicsMeasure.mark(PhysicsProcess::COLISSION_OTHER);
 }
 
-void recursiveFindColissionsInternal(WorldPrototype& world, std::vector<Colission>& colissions, TreeNode& trunkNode);
-void recursiveFindColissionsBetween(WorldPrototype& world, std::vector<Colission>& colissions, TreeNode& first, TreeNode& second);
-
-void recursiveFindColissionsInternal(WorldPrototype& world, std::vector<Colission>& colissions, TreeNode& trunkNode) {
-	// within the same node
-	if (trunkNode.isLeafNode() || trunkNode.isGroupHead)
-		return;
-
-	for (int i = 0; i < trunkNode.nodeCount; i++) {
-		TreeNode& A = trunkNode[i];
-		recursiveFindColissionsInternal(world, colissions, A);
-		for (int j = i + 1; j < trunkNode.nodeCount; j++) {
-			TreeNode& B = trunkNode[j];
-			recursiveFindColissionsBetween(world, colissions, A, B);
-		}
-	}
+SupportHint& WorldPrototype::getSupportHint(const Part* first, const Part* second) {
+	SupportHintEntry& entry = supportHints[std::make_pair(first->handle, second->handle)];
+	entry.lastUsedAge = age;
+	return entry.hint;
 }
 
-void recursiveFindColissionsBetween(WorldPrototype& world, std::vector<Colission>& colissions, TreeNode& first, TreeNode& second) {
-	if (!intersects(first.bounds, second.bounds)) return;
-	
-	if (first.isLeafNode() && second.isLeafNode()) {
-		Part* firstObj = static_cast<Part*>(first.object);
-		Part* secondObj = static_cast<Part*>(second.object);
+static void runColissionTestsBetweenLeaves(TreeNode& first, TreeNode& second, WorldPrototype& world, std::vector<Colission>& colissions) {
+	Part* firstObj = static_cast<Part*>(first.object);
+	Part* secondObj = static_cast<Part*>(second.object);
 #ifdef CATCH_INTERSECTION_ERRORS
-		try {
-			runColissionTests(*firstObj, *secondObj, world, colissions);
-		} catch(const std::exception& err) {
-			Log::fatal("Error occurred during intersection: %s", err.what());
+	try {
+		runColissionTests(*firstObj, *secondObj, world, colissions);
+	} catch(const std::exception& err) {
+		Log::fatal("Error occurred during intersection: %s", err.what());
 
-			Debug::saveIntersectionError(firstObj, secondObj, "colError");
+		Debug::saveIntersectionError(firstObj, secondObj, "colError");
 
-			throw err;
-		} catch(...) {
-			Log::fatal("Unknown error occured during intersection");
+		throw err;
+	} catch(...) {
+		Log::fatal("Unknown error occured during intersection");
 
-			Debug::saveIntersectionError(firstObj, secondObj, "colError");
+		Debug::saveIntersectionError(firstObj, secondObj, "colError");
 
-			throw "exit";
-		}
+		throw "exit";
+	}
 #else
-		runColissionTests(*firstObj, *secondObj, world, colissions);
+	runColissionTests(*firstObj, *secondObj, world, colissions);
 #endif
-	} else {
-		bool preferFirst = computeCost(first.bounds) <= computeCost(second.bounds);
-		if (preferFirst && !first.isLeafNode() || second.isLeafNode()) {
-			// split first
-
-			for (TreeNode& node : first) {
-				recursiveFindColissionsBetween(world, colissions, node, second);
-			}
-		} else {
-			// split second
-
-			for (TreeNode& node : second) {
-				recursiveFindColissionsBetween(world, colissions, first, node);
-			}
-		}
-	}
 }
 
 /*
@@ -310,8 +336,27 @@ void WorldPrototype::findColissions() {
 	currentObjectColissions.clear();
 	currentTerrainColissions.clear();
 
-	recursiveFindColissionsInternal(*this, currentObjectColissions, objectTree.rootNode);
-	recursiveFindColissionsBetween(*this, currentTerrainColissions, objectTree.rootNode, terrainTree.rootNode);
+	if(age % SUPPORT_HINT_MAX_UNUSED_TICKS == 0) {
+		for(auto iter = supportHints.begin(); iter != supportHints.end();) {
+			if(age - iter->second.lastUsedAge > SUPPORT_HINT_MAX_UNUSED_TICKS) {
+				iter = supportHints.erase(iter);
+			} else {
+				++iter;
+			}
+		}
+	}
+
+	// both trees share an origin, so their bounds can be compared directly
+	Position origin = objectTree.isEmpty() ? Position() : objectTree.rootNode.bounds.min;
+	quantizedObjectTree.rebuild(objectTree.rootNode, origin);
+	quantizedTerrainTree.rebuild(terrainTree.rootNode, origin);
+
+	quantizedObjectTree.forEachOverlappingPair([this](TreeNode& first, TreeNode& second) {
+		runColissionTestsBetweenLeaves(first, second, *this, currentObjectColissions);
+	});
+	quantizedObjectTree.forEachOverlappingPair(quantizedTerrainTree, [this](TreeNode& first, TreeNode& second) {
+		runColissionTestsBetweenLeaves(first, second, *this, currentTerrainColissions);
+	});
 }
 void WorldPrototype::handleColissions() {
 	physicsMeasure.mark(PhysicsProcess::COLISSION_HANDLING);
@@ -330,8 +375,24 @@ void WorldPrototype::handleConstraints() {
 }
 void WorldPrototype::update() {
 	physicsMeasure.mark(PhysicsProcess::UPDATING);
-	for (MotorizedPhysical* physical : iterPhysicals()) {
-		physical->update(this->deltaT);
+	// physicals are hashed right after their update, while they are still in the cache
+	uint64_t physicalsHash = 0;
+	for (size_t i = 0; i < physicals.size(); i++) {
+		MotorizedPhysical& phys = *physicals[i];
+		MotorizedPhysical::CachedStateHash& cachedHash = phys.cachedStateHash;
+		bool startsAtRest = phys.isAtRest();
+		phys.update(this->deltaT);
+
+		// once a physical has spent a whole update at rest its state stops changing, so the hash of that state stays valid
+		if (!startsAtRest) cachedHash.isReusable = false;
+		if (hashStateEveryTick) {
+			if (!cachedHash.isReusable || cachedHash.index != i) {
+				cachedHash.hash = WorldStateHash::hashPhysicalAt(phys, i);
+				cachedHash.index = i;
+				cachedHash.isReusable = startsAtRest;
+			}
+			physicalsHash += cachedHash.hash;
+		}
 	}
 
 	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_BOUNDS);
@@ -339,6 +400,8 @@ void WorldPrototype::update() {
 	physicsMeasure.mark(PhysicsProcess::UPDATE_TREE_STRUCTURE);
 	objectTree.improveStructure();
 	age++;
+
+	if (hashStateEveryTick) stateHash = WorldStateHash::combine(stateHash, WorldStateHash::hashWorldFromPhysicals(*this, physicalsHash));
 }
 
 
@@ -0,0 +1,267 @@
+#include "world.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "../util/parallelFor.h"
+
+#include "profiling.h"
+#include "geometry/intersection.h"
+
+/*
+	Batches smaller than this many queries per thread are not worth the cost of starting a thread
+*/
+#define MIN_RAY_QUERIES_PER_THREAD 64
+#define MIN_SHAPE_QUERIES_PER_THREAD 16
+
+/*
+	Sweeps are refined by bisection between the last free sample and the first intersecting one, this many times
+*/
+#define SWEEP_BISECTION_STEPS 20
+
+/*
+	The distance along the ray at which it enters bounds, or INFINITY if it misses them before maxDistance
+	Computed relative to the start of the ray, so it stays precise far away from the origin
+*/
+static double rayEntryDistance(const Bounds& bounds, const Ray& ray, const Vec3& inverseDirection, double maxDistance) {
+	Vec3 min = bounds.min - ray.start;
+	Vec3 max = bounds.max - ray.start;
+	double entry = 0.0;
+	double exit = maxDistance;
+	for(int axis = 0; axis < 3; axis++) {
+		double t1 = min[axis] * inverseDirection[axis];
+		double t2 = max[axis] * inverseDirection[axis];
+		entry = std::max(entry, std::min(t1, t2));
+		exit = std::min(exit, std::max(t1, t2));
+	}
+	return (entry <= exit) ? entry : INFINITY;
+}
+
+/*
+	The distance along the ray at which it enters the part, or INFINITY if it misses it
+*/
+static double rayPartDistance(const Ray& ray, const Part& part) {
+	const GlobalCFrame& cframe = part.getCFrame();
+	double distance = part.hitbox.getIntersectionDistance(cframe.globalToLocal(ray.start), cframe.relativeToLocal(ray.direction));
+	return (distance > 0.0) ? distance : INFINITY;
+}
+
+/*
+	Calls func(Part& part) for every part whose bounds the ray enters before maxDistance, nearer nodes are visited first
+	func may lower maxDistance to skip everything further away, and returns false to stop the search
+	Returns false if the search was stopped
+*/
+template<typename Func>
+static bool forEachPartAlongRay(const TreeNode& rootNode, const Ray& ray, const Vec3& inverseDirection, double& maxDistance, const Func& func) {
+	if(!rootNode.isLeafNode() && rootNode.nodeCount == 0) return true;
+	struct Entry { const TreeNode* node; double distance; };
+	Entry stack[MAX_HEIGHT * MAX_BRANCHES];
+	int stackSize = 0;
+	double rootDistance = rayEntryDistance(rootNode.bounds, ray, inverseDirection, maxDistance);
+	if(rootDistance == INFINITY) return true;
+	stack[stackSize++] = Entry{&rootNode, rootDistance};
+	while(stackSize > 0) {
+		Entry entry = stack[--stackSize];
+		if(entry.distance > maxDistance) continue;
+		if(entry.node->isLeafNode()) {
+			if(!func(*static_cast<Part*>(entry.node->object))) return false;
+			continue;
+		}
+		Entry children[MAX_BRANCHES];
+		int childCount = 0;
+		for(const TreeNode& child : *entry.node) {
+			double distance = rayEntryDistance(child.bounds, ray, inverseDirection, maxDistance);
+			if(distance != INFINITY) children[childCount++] = Entry{&child, distance};
+		}
+		// the nearest child is pushed last so it is visited first, an insertion sort as there are at most MAX_BRANCHES children
+		for(int i = 1; i < childCount; i++) {
+			Entry child = children[i];
+			int j = i;
+			for(; j > 0 && children[j - 1].distance < child.distance; j--) {
+				children[j] = children[j - 1];
+			}
+			children[j] = child;
+		}
+		for(int i = 0; i < childCount; i++) {
+			stack[stackSize++] = children[i];
+		}
+	}
+	return true;
+}
+
+/*
+	Calls func(Part& part) for every part whose bounds intersect bounds
+*/
+template<typename Func>
+static void forEachPartInBounds(const TreeNode& node, const Bounds& bounds, const Func& func) {
+	if(!node.isLeafNode() && node.nodeCount == 0) return;
+	if(!intersects(node.bounds, bounds)) return;
+	if(node.isLeafNode()) {
+		func(*static_cast<Part*>(node.object));
+	} else {
+		for(const TreeNode& child : node) {
+			forEachPartInBounds(child, bounds, func);
+		}
+	}
+}
+
+/*
+	Calls func(i) for every i in [0, count) like Util::parallelFor, with the global profilers turned off on every thread that runs queries
+	GJK records its iteration statistics into them, which is only safe on the physics thread
+*/
+template<typename Func>
+static void parallelForQueries(size_t count, size_t minChunkSize, const Func& func) {
+	Util::parallelForChunks(count, Util::getChunkCount(count, minChunkSize), [&func](size_t, size_t begin, size_t end) {
+		struct ProfilingDisabled {
+			bool previous = isProfilingEnabled();
+			ProfilingDisabled() { isProfilingEnabled() = false; }
+			~ProfilingDisabled() { isProfilingEnabled() = previous; }
+		} profilingDisabled;
+		for(size_t i = begin; i < end; i++) {
+			func(i);
+		}
+	});
+}
+
+static Vec3 getInverseDirection(const Ray& ray) {
+	return Vec3(1.0 / ray.direction.x, 1.0 / ray.direction.y, 1.0 / ray.direction.z);
+}
+
+void WorldPrototype::raycastClosest(const RayQuery* queries, size_t queryCount, QueryHit* results, int partsMask) const {
+	parallelForQueries(queryCount, MIN_RAY_QUERIES_PER_THREAD, [&](size_t i) {
+		const Ray& ray = queries[i].ray;
+		Vec3 inverseDirection = getInverseDirection(ray);
+		QueryHit best;
+		double maxDistance = queries[i].maxDistance;
+		auto testPart = [&](Part& part) {
+			double distance = rayPartDistance(ray, part);
+			if(distance < maxDistance) {
+				maxDistance = distance;
+				best = QueryHit{&part, distance};
+			}
+			return true;
+		};
+		if(partsMask & FREE_PARTS) forEachPartAlongRay(objectTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		if(partsMask & TERRAIN_PARTS) forEachPartAlongRay(terrainTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		results[i] = best;
+	});
+}
+
+void WorldPrototype::raycastAny(const RayQuery* queries, size_t queryCount, QueryHit* results, int partsMask) const {
+	parallelForQueries(queryCount, MIN_RAY_QUERIES_PER_THREAD, [&](size_t i) {
+		const Ray& ray = queries[i].ray;
+		Vec3 inverseDirection = getInverseDirection(ray);
+		QueryHit hit;
+		double maxDistance = queries[i].maxDistance;
+		auto testPart = [&](Part& part) {
+			double distance = rayPartDistance(ray, part);
+			if(distance < maxDistance) {
+				hit = QueryHit{&part, distance};
+				return false;
+			}
+			return true;
+		};
+		if(partsMask & FREE_PARTS) forEachPartAlongRay(objectTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		if(!hit.hasHit() && (partsMask & TERRAIN_PARTS)) forEachPartAlongRay(terrainTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		results[i] = hit;
+	});
+}
+
+void WorldPrototype::raycastAll(const RayQuery* queries, size_t queryCount, std::vector<QueryHit>* results, int partsMask) const {
+	parallelForQueries(queryCount, MIN_RAY_QUERIES_PER_THREAD, [&](size_t i) {
+		const Ray& ray = queries[i].ray;
+		Vec3 inverseDirection = getInverseDirection(ray);
+		std::vector<QueryHit>& hits = results[i];
+		hits.clear();
+		double maxDistance = queries[i].maxDistance;
+		auto testPart = [&](Part& part) {
+			double distance = rayPartDistance(ray, part);
+			if(distance < maxDistance) {
+				hits.push_back(QueryHit{&part, distance});
+			}
+			return true;
+		};
+		if(partsMask & FREE_PARTS) forEachPartAlongRay(objectTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		if(partsMask & TERRAIN_PARTS) forEachPartAlongRay(terrainTree.rootNode, ray, inverseDirection, maxDistance, testPart);
+		std::sort(hits.begin(), hits.end(), [](const QueryHit& a, const QueryHit& b) { return a.distance < b.distance; });
+	});
+}
+
+static bool overlapsPart(const Shape& shape, const GlobalCFrame& cframe, const Part& part) {
+	return overlapsTransformed(shape, part.hitbox, cframe.globalToLocal(part.getCFrame()));
+}
+
+void WorldPrototype::overlapAll(const OverlapQuery* queries, size_t queryCount, std::vector<Part*>* results, int partsMask) const {
+	parallelForQueries(queryCount, MIN_SHAPE_QUERIES_PER_THREAD, [&](size_t i) {
+		const OverlapQuery& query = queries[i];
+		std::vector<Part*>& parts = results[i];
+		parts.clear();
+		Bounds bounds = query.shape.getBounds(query.cframe.getRotation()) + query.cframe.getPosition();
+		auto testPart = [&](Part& part) {
+			if(overlapsPart(query.shape, query.cframe, part)) {
+				parts.push_back(&part);
+			}
+		};
+		if(partsMask & FREE_PARTS) forEachPartInBounds(objectTree.rootNode, bounds, testPart);
+		if(partsMask & TERRAIN_PARTS) forEachPartInBounds(terrainTree.rootNode, bounds, testPart);
+	});
+}
+
+void WorldPrototype::sweepClosest(const SweepQuery* queries, size_t queryCount, QueryHit* results, int partsMask) const {
+	parallelForQueries(queryCount, MIN_SHAPE_QUERIES_PER_THREAD, [&](size_t i) {
+		const SweepQuery& query = queries[i];
+		const Rotation& rotation = query.start.getRotation();
+		BoundingBox localBounds = query.shape.getBounds(rotation);
+		auto cframeAt = [&](double fraction) {
+			return GlobalCFrame(query.start.getPosition() + query.translation * fraction, rotation);
+		};
+
+		thread_local std::vector<Part*> candidates;
+		candidates.clear();
+		Bounds sweptBounds = unionOfBounds(localBounds + query.start.getPosition(), localBounds + (query.start.getPosition() + query.translation));
+		auto addCandidate = [](Part& part) { candidates.push_back(&part); };
+		if(partsMask & FREE_PARTS) forEachPartInBounds(objectTree.rootNode, sweptBounds, addCandidate);
+		if(partsMask & TERRAIN_PARTS) forEachPartInBounds(terrainTree.rootNode, sweptBounds, addCandidate);
+
+		QueryHit best;
+		if(candidates.empty()) {
+			results[i] = best;
+			return;
+		}
+
+		// a convex shape cannot pass through anything while moving less than its own thickness per sample
+		double stepLength = std::min(query.shape.scale[0], std::min(query.shape.scale[1], query.shape.scale[2]));
+		double sweepLength = length(query.translation);
+		int stepCount = (stepLength > 0.0) ? static_cast<int>(std::ceil(sweepLength / stepLength)) : 1;
+		stepCount = std::max(stepCount, 1);
+
+		for(int step = 0; step <= stepCount && !best.hasHit(); step++) {
+			double fraction = static_cast<double>(step) / stepCount;
+			GlobalCFrame cframe = cframeAt(fraction);
+			Bounds bounds = localBounds + cframe.getPosition();
+			for(Part* part : candidates) {
+				if(!intersects(part->getStrictBounds(), bounds) || !overlapsPart(query.shape, cframe, *part)) continue;
+				if(step == 0) {
+					best = QueryHit{part, 0.0};
+					break;
+				}
+				// the previous sample did not intersect, narrow down where the shape first touches this part
+				double free = static_cast<double>(step - 1) / stepCount;
+				double touching = fraction;
+				for(int j = 0; j < SWEEP_BISECTION_STEPS; j++) {
+					double middle = (free + touching) / 2;
+					if(overlapsPart(query.shape, cframeAt(middle), *part)) {
+						touching = middle;
+					} else {
+						free = middle;
+					}
+				}
+				if(free < best.distance) {
+					best = QueryHit{part, free};
+				}
+			}
+		}
+		results[i] = best;
+	});
+}
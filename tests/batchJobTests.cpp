@@ -0,0 +1,91 @@
+#include "testsMain.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "../batchRunner/batchJob.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+static std::vector<BatchJob> parseJobs(const std::string& text) {
+	std::istringstream input(text);
+	return parseBatchJobs(input);
+}
+
+/*
+	Returns whether parsing the given text throws std::invalid_argument mentioning the given line
+*/
+static bool rejectsLine(const std::string& text, size_t lineNumber) {
+	try {
+		parseJobs(text);
+	} catch(const std::invalid_argument& error) {
+		return std::string(error.what()).find("Line " + std::to_string(lineNumber) + ":") == 0;
+	}
+	return false;
+}
+
+TEST_CASE(batchJobsParseValidLines) {
+	std::vector<BatchJob> jobs = parseJobs(
+		"# comment\n"
+		"\n"
+		"builder boxStack 100 height=5 name=stack\r\n"
+		"   \n"
+		"file worlds/test.world 20 deltaT=0.005\n"
+	);
+
+	ASSERT(jobs.size() == 2);
+
+	ASSERT(jobs[0].index == 0);
+	ASSERT_TRUE(jobs[0].sourceType == BatchSource::BUILDER);
+	ASSERT(jobs[0].source == "boxStack");
+	ASSERT(jobs[0].tickCount == 100);
+	ASSERT(jobs[0].deltaT == 1.0 / 100.0);
+	ASSERT(jobs[0].parameters.getInt("height", 0) == 5);
+	ASSERT(jobs[0].parameters.getString("name", "") == "stack");
+	ASSERT(jobs[0].parameters.toString() == "height=5 name=stack");
+
+	ASSERT(jobs[1].index == 1);
+	ASSERT_TRUE(jobs[1].sourceType == BatchSource::WORLD_FILE);
+	ASSERT(jobs[1].source == "worlds/test.world");
+	ASSERT(jobs[1].tickCount == 20);
+	ASSERT(jobs[1].deltaT == 0.005);
+	ASSERT_FALSE(jobs[1].parameters.has("height"));
+}
+
+TEST_CASE(batchJobsExpandRanges) {
+	std::vector<BatchJob> jobs = parseJobs("builder grid 10 x=1..3 y=-1..0 seed=7\nbuilder grid 5 x=4..4\n");
+
+	ASSERT(jobs.size() == 7);
+	size_t jobIndex = 0;
+	for(long long x = 1; x <= 3; x++) {
+		for(long long y = -1; y <= 0; y++) {
+			const BatchJob& job = jobs[jobIndex];
+			ASSERT(job.index == jobIndex);
+			ASSERT(job.tickCount == 10);
+			ASSERT(job.parameters.getInt("x", 0) == x);
+			ASSERT(job.parameters.getInt("y", 0) == y);
+			ASSERT(job.parameters.getInt("seed", 0) == 7);
+			jobIndex++;
+		}
+	}
+	ASSERT(jobs[6].tickCount == 5);
+	ASSERT(jobs[6].parameters.getInt("x", 0) == 4);
+
+	// values that only look like ranges are kept as text
+	std::vector<BatchJob> textJobs = parseJobs("builder grid 10 path=a..b x=1.5..2\n");
+	ASSERT(textJobs.size() == 1);
+	ASSERT(textJobs[0].parameters.getString("path", "") == "a..b");
+	ASSERT(textJobs[0].parameters.getString("x", "") == "1.5..2");
+}
+
+TEST_CASE(batchJobsRejectMalformedLines) {
+	ASSERT_TRUE(rejectsLine("builder grid 10\nsimulate grid 10\n", 2));
+	ASSERT_TRUE(rejectsLine("builder grid\n", 1));
+	ASSERT_TRUE(rejectsLine("builder grid ten\n", 1));
+	ASSERT_TRUE(rejectsLine("# comment\nbuilder grid -5\n", 2));
+	ASSERT_TRUE(rejectsLine("builder grid 10 height\n", 1));
+	ASSERT_TRUE(rejectsLine("builder grid 10 =5\n", 1));
+	ASSERT_TRUE(rejectsLine("\n\nfile test.world 10 deltaT=fast\n", 3));
+}
@@ -126,7 +126,12 @@ bool tolerantEquals(const Position& a, const Position& b, Tol tolerance) {
 }
 
 template<typename T, typename Tol>
-bool tolerantEquals(const RotationTemplate<T>& a, const RotationTemplate<T>& b, Tol tolerance) {
+bool tolerantEquals(const MatrixRotationTemplate<T>& a, const MatrixRotationTemplate<T>& b, Tol tolerance) {
+	return tolerantEquals(a.asRotationMatrix(), b.asRotationMatrix(), tolerance);
+}
+
+template<typename T, typename Tol>
+bool tolerantEquals(const QuaternionRotationTemplate<T>& a, const QuaternionRotationTemplate<T>& b, Tol tolerance) {
 	return tolerantEquals(a.asRotationMatrix(), b.asRotationMatrix(), tolerance);
 }
 
@@ -426,3 +426,65 @@ TEST_CASE(testPlainAttachAndFixedConstraintIndistinguishable) {
 	ASSERT(main1->motionOfCenterOfMass == main2->motionOfCenterOfMass);
 	ASSERT(main1->getCFrame() == main2->getCFrame());
 }
+
+TEST_CASE(cachedMassPropertiesMatchFullRefresh) {
+	Part p1(Box(1.0, 2.0, 3.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 1.0, 1.0});
+	Part p2(Box(1.5, 0.7, 1.2), GlobalCFrame(), {2.0, 1.0, 1.0});
+	Part p3(Box(0.5, 0.5, 2.5), GlobalCFrame(), {0.7, 1.0, 1.0});
+
+	p1.attach(&p2, new ConstantSpeedMotorConstraint(1.3), CFrame(Vec3(1.0, 0.3, 0.0), Rotation::fromEulerAngles(0.3, -0.2, 0.1)), CFrame(-0.5, 0.0, 0.2));
+	p2.attach(&p3, new FixedConstraint(), CFrame(0.0, 0.8, 0.4), CFrame(0.2, -0.3, 0.0));
+
+	MotorizedPhysical* main = p1.parent->mainPhysical;
+
+	for(int i = 0; i < 20; i++) {
+		main->update(0.05);
+	}
+
+	double cachedMass = main->totalMass;
+	Vec3 cachedCenterOfMass = main->totalCenterOfMass;
+	SymmetricMat3 cachedMomentResponse = main->momentResponse;
+
+	main->refreshPhysicalProperties();
+
+	ASSERT(cachedMass == main->totalMass);
+	ASSERT(cachedCenterOfMass == main->totalCenterOfMass);
+	ASSERT(cachedMomentResponse == main->momentResponse);
+
+	p3.setWidth(2.0);
+	cachedMass = main->totalMass;
+	cachedCenterOfMass = main->totalCenterOfMass;
+	cachedMomentResponse = main->momentResponse;
+
+	main->refreshPhysicalProperties();
+
+	ASSERT(cachedMass == main->totalMass);
+	ASSERT(cachedCenterOfMass == main->totalCenterOfMass);
+	ASSERT(cachedMomentResponse == main->momentResponse);
+}
+
+TEST_CASE(detachingLastPartDropsChildrenFromCachedMass) {
+	Part a(Box(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 1.0, 1.0});
+	Part b(Box(1.0, 1.0, 1.0), GlobalCFrame(), {1.0, 1.0, 1.0});
+
+	a.attach(&b, new FixedConstraint(), CFrame(1.0, 0.0, 0.0), CFrame(-1.0, 0.0, 0.0));
+	ASSERT(a.parent->mainPhysical->totalMass == 2.0);
+
+	// a is the only part of the main physical, b is split off into its own physical
+	a.parent->detachPart(&a);
+	MotorizedPhysical* mainOfA = a.parent->mainPhysical;
+	MotorizedPhysical* mainOfB = b.parent->mainPhysical;
+	ASSERT_TRUE(mainOfA != mainOfB);
+	ASSERT_TRUE(mainOfA->childPhysicals.size() == 0);
+
+	mainOfA->update(DELTA_T);
+	mainOfB->update(DELTA_T);
+
+	ASSERT(mainOfA->totalMass == 1.0);
+	ASSERT(mainOfB->totalMass == 1.0);
+	ASSERT(mainOfA->forceResponse == SymmetricMat3::IDENTITY());
+
+	SymmetricMat3 cachedMomentResponse = mainOfA->momentResponse;
+	mainOfA->refreshPhysicalProperties();
+	ASSERT(cachedMomentResponse == mainOfA->momentResponse);
+}
@@ -6,7 +6,11 @@
 #include "../util/log.h"
 #include "../physics/math/cframe.h"
 #include "../physics/datastructures/buffers.h"
+#include "../physics/datastructures/boundsTree.h"
+#include "../physics/datastructures/quantizedBoundsTree.h"
 #include <vector>
+#include <utility>
+#include <algorithm>
 
 volatile double t;
 
@@ -149,3 +153,106 @@ TEST_CASE(profileSmallVectorOfVectorsJustRight) {
 
 	Log::debug("Total %d", sum);
 }*/
+
+static std::vector<Bounds> createTestBounds(size_t count, double offset) {
+	std::vector<Bounds> result;
+	for(size_t i = 0; i < count; i++) {
+		Position min(offset + std::sin(i * 0.37) * 10.0, offset + std::sin(i * 0.71) * 10.0, offset + std::sin(i * 0.13) * 10.0);
+		Vec3 size(1.0 + std::sin(i * 0.29), 1.0 + std::cos(i * 0.53), 1.0 + std::sin(i * 0.91));
+		result.push_back(Bounds(min, min + size));
+		// exactly touching bounds must still be found
+		if(i % 7 == 0) result.push_back(Bounds(Position(min.x, min.y, min.z + size.z), min + size * 2.0));
+	}
+	return result;
+}
+
+static void fillTree(BoundsTree<int>& tree, std::vector<int>& objects, const std::vector<Bounds>& bounds) {
+	for(size_t i = 0; i < bounds.size(); i++) {
+		tree.add(&objects[i], bounds[i]);
+	}
+	tree.improveStructure();
+}
+
+static std::pair<int, int> makeOrderedPair(const TreeNode& first, const TreeNode& second) {
+	int a = *static_cast<int*>(first.object);
+	int b = *static_cast<int*>(second.object);
+	return (a < b) ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
+TEST_CASE(quantizedTreeFindsAllOverlappingPairs) {
+	for(double offset : {0.0, 1000000.0}) {
+		std::vector<Bounds> bounds = createTestBounds(300, offset);
+		std::vector<int> objects(bounds.size());
+		for(size_t i = 0; i < objects.size(); i++) objects[i] = static_cast<int>(i);
+
+		BoundsTree<int> tree;
+		fillTree(tree, objects, bounds);
+		QuantizedBoundsTree quantizedTree;
+		quantizedTree.rebuild(tree.rootNode);
+
+		std::vector<std::pair<int, int>> found;
+		quantizedTree.forEachOverlappingPair([&](TreeNode& first, TreeNode& second) {
+			found.push_back(makeOrderedPair(first, second));
+		});
+		std::sort(found.begin(), found.end());
+
+		std::vector<std::pair<int, int>> expected;
+		for(int i = 0; i < static_cast<int>(bounds.size()); i++) {
+			for(int j = i + 1; j < static_cast<int>(bounds.size()); j++) {
+				if(intersects(bounds[i], bounds[j])) expected.push_back(std::make_pair(i, j));
+			}
+		}
+		ASSERT_TRUE(expected.size() > 0);
+		ASSERT_TRUE(found == expected);
+	}
+}
+
+TEST_CASE(quantizedTreeFindsAllPairsBetweenTrees) {
+	std::vector<Bounds> firstBounds = createTestBounds(200, 0.0);
+	std::vector<Bounds> secondBounds = createTestBounds(150, 3.5);
+	std::vector<int> firstObjects(firstBounds.size());
+	std::vector<int> secondObjects(secondBounds.size());
+	for(size_t i = 0; i < firstObjects.size(); i++) firstObjects[i] = static_cast<int>(i);
+	for(size_t i = 0; i < secondObjects.size(); i++) secondObjects[i] = static_cast<int>(i);
+
+	BoundsTree<int> firstTree;
+	BoundsTree<int> secondTree;
+	fillTree(firstTree, firstObjects, firstBounds);
+	fillTree(secondTree, secondObjects, secondBounds);
+	QuantizedBoundsTree quantizedFirst;
+	QuantizedBoundsTree quantizedSecond;
+	quantizedFirst.rebuild(firstTree.rootNode);
+	quantizedSecond.rebuild(secondTree.rootNode, quantizedFirst.getOrigin());
+
+	std::vector<std::pair<int, int>> found;
+	quantizedFirst.forEachOverlappingPair(quantizedSecond, [&](TreeNode& first, TreeNode& second) {
+		found.push_back(std::make_pair(*static_cast<int*>(first.object), *static_cast<int*>(second.object)));
+	});
+	std::sort(found.begin(), found.end());
+
+	std::vector<std::pair<int, int>> expected;
+	for(int i = 0; i < static_cast<int>(firstBounds.size()); i++) {
+		for(int j = 0; j < static_cast<int>(secondBounds.size()); j++) {
+			if(intersects(firstBounds[i], secondBounds[j])) expected.push_back(std::make_pair(i, j));
+		}
+	}
+	ASSERT_TRUE(expected.size() > 0);
+	ASSERT_TRUE(found == expected);
+
+	for(size_t q = 0; q < 20; q++) {
+		Position center(std::sin(q * 1.3) * 8.0, std::sin(q * 0.7) * 8.0, std::cos(q * 0.4) * 8.0);
+		Bounds query(center - Vec3(2.0, 1.0, 3.0), center + Vec3(2.0, 1.0, 3.0));
+		std::vector<int> inBounds;
+		quantizedFirst.forEachLeafInBounds(query, [&](TreeNode& leaf) {
+			inBounds.push_back(*static_cast<int*>(leaf.object));
+		});
+		std::sort(inBounds.begin(), inBounds.end());
+
+		std::vector<int> expectedInBounds;
+		for(int i = 0; i < static_cast<int>(firstBounds.size()); i++) {
+			if(intersects(firstBounds[i], query)) expectedInBounds.push_back(i);
+		}
+		ASSERT_TRUE(inBounds == expectedInBounds);
+	}
+}
+
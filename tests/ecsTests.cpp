@@ -0,0 +1,172 @@
+#include "testsMain.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "core.h"
+#include "../engine/ecs/tree.h"
+#include "../engine/ecs/entity.h"
+#include "../engine/ecs/componentStorage.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+/*
+	Components without any data, the application components depend on the renderer
+*/
+struct TestTransform : public Engine::Component {
+	DEFINE_COMPONENT(Transform, true);
+};
+
+struct TestMaterial : public Engine::Component {
+	DEFINE_COMPONENT(Material, true);
+};
+
+struct TestLight : public Engine::Component {
+	DEFINE_COMPONENT(Light, false);
+};
+
+TEST_CASE(componentStorageInsertAndGet) {
+	Engine::ComponentStorage storage;
+	TestTransform components[3];
+
+	storage.insert(4, nullptr, &components[0]);
+	storage.insert(0, nullptr, &components[1]);
+	ASSERT(storage.size() == 2);
+	ASSERT(storage.contains(4));
+	ASSERT(storage.contains(0));
+	ASSERT_FALSE(storage.contains(2));
+	ASSERT_FALSE(storage.contains(100));
+	ASSERT(storage.get(4) == &components[0]);
+	ASSERT(storage.get(2) == nullptr);
+
+	// inserting for an entity that already has a component replaces it
+	storage.insert(4, nullptr, &components[2]);
+	ASSERT(storage.size() == 2);
+	ASSERT(storage.get(4) == &components[2]);
+}
+
+TEST_CASE(componentStorageRemoveSwapsBack) {
+	Engine::ComponentStorage storage;
+	TestTransform components[5];
+	for(std::size_t i = 0; i < 5; i++) {
+		storage.insert(i, nullptr, &components[i]);
+	}
+
+	storage.remove(1);
+	ASSERT(storage.size() == 4);
+	ASSERT_FALSE(storage.contains(1));
+	// the last component takes the place of the removed one
+	ASSERT(storage.entityIdAt(1) == 4);
+	ASSERT(storage.componentAt(1) == &components[4]);
+	ASSERT(storage.get(4) == &components[4]);
+	for(std::size_t i : {0, 2, 3}) {
+		ASSERT(storage.get(i) == &components[i]);
+	}
+
+	// removing the last component or one that is not there leaves the others in place
+	storage.remove(3);
+	storage.remove(1);
+	storage.remove(100);
+	ASSERT(storage.size() == 3);
+	for(std::size_t i : {0, 2, 4}) {
+		ASSERT(storage.get(i) == &components[i]);
+	}
+
+	storage.remove(0);
+	storage.remove(2);
+	storage.remove(4);
+	ASSERT(storage.size() == 0);
+}
+
+TEST_CASE(componentViewVisitsIntersection) {
+	Engine::ECSTree tree;
+	std::vector<TestTransform> transforms(12);
+	std::vector<TestMaterial> materials(12);
+	std::vector<Engine::Entity*> expected;
+	for(int i = 0; i < 12; i++) {
+		Engine::Entity* entity = tree.createEntity(tree.getRoot());
+		// every third entity has only a material, every fourth only a transform
+		if(i % 3 != 0) entity->addComponent(&transforms[i]);
+		if(i % 4 != 0) entity->addComponent(&materials[i]);
+		if(i % 3 != 0 && i % 4 != 0) expected.push_back(entity);
+	}
+
+	std::vector<Engine::Entity*> visited;
+	for(auto [entity, transform, material] : tree.view<TestTransform, TestMaterial>()) {
+		ASSERT(transform == entity->getComponent<TestTransform>());
+		ASSERT(material == entity->getComponent<TestMaterial>());
+		visited.push_back(entity);
+	}
+	std::sort(visited.begin(), visited.end());
+	std::sort(expected.begin(), expected.end());
+	ASSERT_TRUE(visited == expected);
+
+	std::size_t transformCount = 0;
+	for(auto [entity, transform] : tree.view<TestTransform>()) {
+		ASSERT(transform == entity->getComponent<TestTransform>());
+		transformCount++;
+	}
+	ASSERT(transformCount == 8);
+
+	// no entity has a light, the view is empty instead of visiting the entities with the other types
+	std::size_t lightCount = 0;
+	for(auto [entity, transform, light] : tree.view<TestTransform, TestLight>()) {
+		ASSERT(light == entity->getComponent<TestLight>());
+		lightCount++;
+	}
+	ASSERT(lightCount == 0);
+}
+
+TEST_CASE(componentRemovalUpdatesStorage) {
+	Engine::ECSTree tree;
+	TestTransform transform;
+	TestLight lights[2];
+	Engine::Entity* entity = tree.createEntity(tree.getRoot());
+	entity->addComponent(&transform);
+	entity->addComponent(&lights[0]);
+	entity->addComponent(&lights[1]);
+
+	const Engine::ComponentStorage& lightStorage = tree.getStorage(Engine::ComponentType::Light);
+	ASSERT(lightStorage.get(entity->getId()) == &lights[0]);
+
+	// the storage falls back to the remaining component of the same type
+	entity->removeComponent(&lights[0]);
+	ASSERT(lightStorage.get(entity->getId()) == &lights[1]);
+	entity->removeComponent(&lights[1]);
+	ASSERT_FALSE(lightStorage.contains(entity->getId()));
+
+	entity->removeComponent(&transform);
+	ASSERT(tree.getStorage(Engine::ComponentType::Transform).size() == 0);
+}
+
+TEST_CASE(entityRemovalFreesComponentsAndId) {
+	Engine::ECSTree tree;
+	TestTransform transforms[3];
+	TestMaterial material;
+	Engine::Entity* entities[3];
+	for(int i = 0; i < 3; i++) {
+		entities[i] = tree.createEntity(tree.getRoot());
+		entities[i]->addComponent(&transforms[i]);
+	}
+	entities[1]->addComponent(&material);
+
+	std::size_t removedId = entities[1]->getId();
+	tree.removeNode(entities[1], false);
+	ASSERT(entities[1]->getId() == ECS_NULL_INDEX);
+	ASSERT_FALSE(tree.getRoot()->containsChild(entities[1]));
+
+	const Engine::ComponentStorage& transformStorage = tree.getStorage(Engine::ComponentType::Transform);
+	ASSERT(transformStorage.size() == 2);
+	ASSERT_FALSE(transformStorage.contains(removedId));
+	ASSERT(transformStorage.get(entities[0]->getId()) == &transforms[0]);
+	ASSERT(transformStorage.get(entities[2]->getId()) == &transforms[2]);
+	ASSERT(tree.getStorage(Engine::ComponentType::Material).size() == 0);
+	ASSERT(tree.getEntitiesWithComponent(Engine::ComponentType::Transform).size() == 2);
+
+	// the freed id is handed out again, without the components of the removed entity
+	Engine::Entity* reused = tree.createEntity(tree.getRoot());
+	ASSERT(reused->getId() == removedId);
+	ASSERT_FALSE(transformStorage.contains(reused->getId()));
+
+	delete entities[1];
+}
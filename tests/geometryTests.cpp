@@ -11,11 +11,20 @@
 
 #include "../physics/geometry/shape.h"
 #include "../physics/geometry/boundingBox.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/geometry/normalizedPolyhedron.h"
+#include "../physics/geometry/intersection.h"
+#include "../physics/geometry/convexHull.h"
+#include "../physics/geometry/triangleShapes.h"
 
 #include "../physics/misc/shapeLibrary.h"
 
 #include "testValues.h"
 
+#include <vector>
+#include <thread>
+#include <atomic>
+
 #define ASSERT(condition) ASSERT_TOLERANT(condition, 0.00001)
 
 template<typename T, typename Tol, size_t Size>
@@ -155,3 +164,385 @@ TEST_CASE(testGetFurthestPointInDirection) {
 		ASSERT(Library::icosahedron.furthestInDirection(vertex) == vertex);
 	}
 }
+
+TEST_CASE(hillClimbingMatchesFullScan) {
+	Polyhedron sphere = Library::createSphere(1.0, 4);
+	VertexAdjacency adjacency = sphere.computeVertexAdjacency();
+
+	int hint = 0;
+	for(int i = 0; i < 1000; i++) {
+		Vec3f direction(std::cos(i * 0.37f), std::sin(i * 0.23f), std::cos(i * 1.9f));
+		hint = sphere.furthestIndexInDirectionFrom(direction, hint, adjacency);
+		ASSERT(sphere[hint] * direction == sphere.furthestInDirection(direction) * direction);
+	}
+	// out of range hints start from a valid vertex
+	Vec3f direction(0.3f, -0.5f, 0.8f);
+	ASSERT(sphere[sphere.furthestIndexInDirectionFrom(direction, -5, adjacency)] * direction == sphere.furthestInDirection(direction) * direction);
+	ASSERT(sphere[sphere.furthestIndexInDirectionFrom(direction, 1000000, adjacency)] * direction == sphere.furthestInDirection(direction) * direction);
+}
+
+TEST_CASE(hillClimbingFromIsolatedVertex) {
+	// a tetrahedron with an extra vertex inside it that is on no triangle
+	Vec3f vertices[]{Vec3f(1.0f, 1.0f, 1.0f), Vec3f(1.0f, -1.0f, -1.0f), Vec3f(-1.0f, 1.0f, -1.0f), Vec3f(-1.0f, -1.0f, 1.0f), Vec3f(0.0f, 0.0f, 0.0f)};
+	Triangle triangles[]{{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+	Polyhedron tetrahedron(vertices, triangles, 5, 4);
+	VertexAdjacency adjacency = tetrahedron.computeVertexAdjacency();
+
+	for(int i = 0; i < 100; i++) {
+		Vec3f direction(std::cos(i * 0.37f), std::sin(i * 0.23f), std::cos(i * 1.9f));
+		int furthest = tetrahedron.furthestIndexInDirectionFrom(direction, 4, adjacency);
+		ASSERT(tetrahedron[furthest] * direction == tetrahedron.furthestInDirection(direction) * direction);
+	}
+}
+
+TEST_CASE(polyhedronTransformsMatchCFrame) {
+	// 42 vertices, the final block of 8 is only partially filled
+	Polyhedron sphere = Library::createSphere(1.0, 1);
+	CFramef frame(Vec3f(0.3f, -2.0f, 5.0f), Rotationf::fromEulerAngles(0.3, 0.7, -0.4));
+
+	Polyhedron global = sphere.localToGlobal(frame);
+	Polyhedron local = sphere.globalToLocal(frame);
+	Polyhedron rotated = sphere.rotated(frame.getRotation());
+	for(int i = 0; i < sphere.vertexCount; i++) {
+		ASSERT(global[i] == frame.localToGlobal(sphere[i]));
+		ASSERT(local[i] == frame.globalToLocal(sphere[i]));
+		ASSERT(rotated[i] == frame.localToRelative(sphere[i]));
+	}
+	BoundingBox rotatedBounds = sphere.getBounds(frame.getRotation().asRotationMatrix());
+	ASSERT(global.getBounds().min == rotatedBounds.min + Vec3(frame.getPosition()));
+	ASSERT(global.getBounds().max == rotatedBounds.max + Vec3(frame.getPosition()));
+
+	Vec3 points[3]{Vec3(1.0, 2.0, 3.0), Vec3(-0.5, 0.0, 0.7), Vec3(0.0, -4.0, 0.1)};
+	CFrame doubleFrame = frame;
+	Vec3 transformed[3];
+	doubleFrame.localToGlobal(points, transformed, 3);
+	for(int i = 0; i < 3; i++) {
+		ASSERT(transformed[i] == doubleFrame.localToGlobal(points[i]));
+	}
+	doubleFrame.globalToLocal(transformed, transformed, 3);
+	for(int i = 0; i < 3; i++) {
+		ASSERT(transformed[i] == points[i]);
+	}
+}
+
+TEST_CASE(supportHintsDoNotChangeIntersections) {
+	Shape sphere = Library::createSphere(1.0, 4);
+	ASSERT_TRUE(sphere.baseShape->usesSupportHints());
+
+	SupportHint hint;
+	for(int i = 0; i < 100; i++) {
+		CFrame relativeTransform(Vec3(std::cos(i * 0.7), std::sin(i * 0.3), std::cos(i * 0.11)) * 1.5, Rotation::fromEulerAngles(i * 0.4, i * 0.9, i * 0.15));
+		std::optional<Intersection> withoutHint = intersectsTransformed(sphere, sphere, relativeTransform);
+		std::optional<Intersection> withHint = intersectsTransformed(sphere, sphere, relativeTransform, hint);
+		ASSERT_STRICT(withoutHint.has_value() == withHint.has_value());
+		if(withoutHint) {
+			ASSERT_TOLERANT(withoutHint.value().exitVector == withHint.value().exitVector, 0.001);
+		}
+	}
+}
+
+TEST_CASE(convexHullOfPointCloud) {
+	// points spread through a cube, by a fixed linear congruential sequence
+	std::vector<Vec3f> points;
+	unsigned int state = 12345;
+	auto nextCoordinate = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) / float(1 << 24) * 1.98f - 0.99f;
+	};
+	for(int i = 0; i < 20000; i++) {
+		float x = nextCoordinate();
+		float y = nextCoordinate();
+		float z = nextCoordinate();
+		points.push_back(Vec3f(x, y, z));
+	}
+	Polyhedron cube = Library::createCube(2.0f);
+	for(Vec3f corner : cube.iterVertices()) {
+		points.push_back(corner);
+	}
+
+	float maxError;
+	Polyhedron hull = buildConvexHull(points.data(), points.size(), INT_MAX, &maxError);
+
+	ASSERT_TRUE(hull.isValid());
+	ASSERT_STRICT(hull.vertexCount == 8);
+	ASSERT(hull.getVolume() == 8.0);
+	ASSERT_STRICT(maxError == 0.0f);
+}
+
+TEST_CASE(convexHullVertexLimit) {
+	Polyhedron sphere = Library::createSphere(1.0, 3);
+	std::vector<Vec3f> points(sphere.vertexCount);
+	sphere.getVertices(points.data());
+
+	Polyhedron exactHull = buildConvexHull(points.data(), points.size());
+	ASSERT_TRUE(exactHull.isValid());
+	ASSERT_STRICT(exactHull.vertexCount == sphere.vertexCount);
+
+	float maxError;
+	Polyhedron reducedHull = buildConvexHull(points.data(), points.size(), 32, &maxError);
+	ASSERT_TRUE(reducedHull.isValid());
+	ASSERT_TRUE(reducedHull.vertexCount <= 32);
+	ASSERT_TRUE(maxError > 0.0f && maxError < 0.2f);
+	// the vertices that stick out furthest are kept first, so little volume is lost
+	ASSERT_TRUE(reducedHull.getVolume() > 0.8 * exactHull.getVolume());
+}
+
+TEST_CASE(deepSphereBoxPenetration) {
+	Shape box = Box(2.0, 2.0, 2.0);
+	Shape sphere = Sphere(1.0);
+
+	for(int i = 0; i < 10; i++) {
+		double offset = i * 0.08;
+		std::optional<Intersection> result = intersectsTransformed(box, sphere, CFrame(Vec3(0.0, 0.0, offset), Rotation::fromEulerAngles(0.3 * i, 0.1, 0.2)));
+		ASSERT_TRUE(result.has_value());
+		// pushed out through the nearest side, which is the one facing the sphere
+		ASSERT_TOLERANT(length(result.value().exitVector) == 2.0 - offset, 0.02);
+	}
+}
+
+TEST_CASE(boxOnFlatHeightfield) {
+	std::vector<float> heights(21 * 21, 2.0f);
+	Shape heightfield = Heightfield(heights.data(), 21, 21, 20.0, 20.0);
+	const HeightfieldShapeClass* heightfieldClass = static_cast<const HeightfieldShapeClass*>(heightfield.baseShape);
+	CFrame heightfieldFrame(heightfieldClass->originalCenter);
+	Shape box = Box(1.0, 1.0, 1.0);
+
+	std::vector<Intersection> result;
+	intersectsTrianglesTransformed(box, heightfield, CFrame(Vec3(3.3, 2.4, 1.7)).globalToLocal(heightfieldFrame), result);
+	// the box overlaps the corner of 4 cells
+	ASSERT_TRUE(result.size() >= 2);
+	for(const Intersection& intersection : result) {
+		ASSERT(intersection.exitVector == Vec3(0.0, -0.1, 0.0));
+	}
+
+	result.clear();
+	intersectsTrianglesTransformed(box, heightfield, CFrame(Vec3(3.3, 2.6, 1.7)).globalToLocal(heightfieldFrame), result);
+	ASSERT_STRICT(result.size() == 0);
+
+	// tipped onto its edge, the deepest point is the lowest edge
+	result.clear();
+	intersectsTrianglesTransformed(box, heightfield, CFrame(Vec3(-4.5, 2.6, 6.2), Rotation::rotZ(M_PI / 4)).globalToLocal(heightfieldFrame), result);
+	ASSERT_TRUE(result.size() > 0);
+	for(const Intersection& intersection : result) {
+		ASSERT(Rotation::rotZ(M_PI / 4).localToGlobal(intersection.exitVector) == Vec3(0.0, -(std::sqrt(0.5) - 0.6), 0.0));
+	}
+}
+
+TEST_CASE(heightfieldFindsAllNearbyTriangles) {
+	std::vector<float> heights(33 * 17);
+	for(int z = 0; z < 17; z++) {
+		for(int x = 0; x < 33; x++) {
+			heights[x + z * 33] = static_cast<float>(std::sin(x * 0.4) + std::cos(z * 0.7));
+		}
+	}
+	Shape heightfield = Heightfield(heights.data(), 33, 17, 32.0, 16.0);
+	const TriangleShapeClass* triangleShape = static_cast<const TriangleShapeClass*>(heightfield.baseShape);
+	Polyhedron allTriangles = heightfield.baseShape->asPolyhedron();
+
+	for(int i = 0; i < 50; i++) {
+		Vec3 center(std::sin(i * 0.37) * 1.1, std::sin(i * 0.71), std::sin(i * 0.13) * 1.1);
+		BoundingBox bounds(center - Vec3(0.1, 0.2, 0.15), center + Vec3(0.1, 0.2, 0.15));
+
+		std::vector<TriangleCollidable> found;
+		triangleShape->getTrianglesInBounds(bounds, found);
+
+		for(Triangle triangle : allTriangles.iterTriangles()) {
+			Vec3f corners[3]{allTriangles[triangle[0]], allTriangles[triangle[1]], allTriangles[triangle[2]]};
+			BoundingBox triangleBounds(corners[0], corners[0]);
+			for(const Vec3f& corner : corners) {
+				for(int axis = 0; axis < 3; axis++) {
+					triangleBounds.min[axis] = std::min(triangleBounds.min[axis], static_cast<double>(corner[axis]));
+					triangleBounds.max[axis] = std::max(triangleBounds.max[axis], static_cast<double>(corner[axis]));
+				}
+			}
+			if(!triangleBounds.intersects(bounds)) continue;
+
+			bool wasFound = false;
+			for(const TriangleCollidable& candidate : found) {
+				if(candidate.corners[0] == corners[0] && candidate.corners[1] == corners[1] && candidate.corners[2] == corners[2]) wasFound = true;
+			}
+			ASSERT_TRUE(wasFound);
+		}
+	}
+}
+
+TEST_CASE(triangleMeshMatchesPolyhedron) {
+	Polyhedron sphere = Library::createSphere(1.0, 2);
+	std::vector<Vec3f> vertices(sphere.vertexCount);
+	sphere.getVertices(vertices.data());
+	std::vector<Triangle> triangles;
+	for(Triangle triangle : sphere.iterTriangles()) {
+		triangles.push_back(triangle);
+	}
+	TriangleMeshShapeClass mesh(vertices.data(), triangles.data(), sphere.vertexCount, static_cast<int>(triangles.size()));
+	DiagonalMat3 toMesh = ~mesh.originalScale;
+
+	for(int i = 0; i < 200; i++) {
+		Vec3 point = Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13)) * 1.2;
+		ASSERT_STRICT(mesh.containsPoint(toMesh * (point - mesh.originalCenter)) == sphere.containsPoint(point));
+
+		Vec3 origin = Vec3(std::cos(i * 0.5), std::sin(i * 0.5), std::sin(i * 0.9)) * 3.0;
+		Vec3 direction = point - origin;
+		double meshDistance = mesh.getIntersectionDistance(toMesh * (origin - mesh.originalCenter), toMesh * direction);
+		double sphereDistance = sphere.getIntersectionDistance(origin, direction);
+		if(std::isinf(sphereDistance)) {
+			ASSERT_TRUE(std::isinf(meshDistance));
+		} else {
+			ASSERT_TOLERANT(meshDistance == sphereDistance, 0.0001);
+		}
+	}
+}
+
+
+// the nearest hit over all triangles, computed without the AVX kernel or a bvh
+static RayIntersection<float> bruteForceNearestHit(const Polyhedron& poly, Vec3f origin, Vec3f direction, bool& isExiting) {
+	RayIntersection<float> best{INFINITY, 0.0f, 0.0f};
+	for(Triangle triangle : poly.iterTriangles()) {
+		RayIntersection<float> r = rayTriangleIntersection(origin, direction, poly[triangle.firstIndex], poly[triangle.secondIndex], poly[triangle.thirdIndex]);
+		if(r.rayIntersectsTriangle() && r.d < best.d) {
+			best = r;
+			isExiting = poly.getNormalVecOfTriangle(triangle) * direction >= 0;
+		}
+	}
+	return best;
+}
+
+TEST_CASE(polyhedronRayQueriesMatchBruteForce) {
+	// the first is tested 8 triangles at a time, the second has enough triangles for a bvh
+	for(int steps : {1, 3}) {
+		Polyhedron sphere = Library::createSphere(1.0f, steps);
+		for(int i = 0; i < 300; i++) {
+			Vec3f origin = Vec3f(std::cos(i * 0.5f), std::sin(i * 0.5f), std::sin(i * 0.9f)) * 3.0f;
+			Vec3f target = Vec3f(std::sin(i * 0.37f), std::sin(i * 0.71f), std::sin(i * 0.13f)) * 1.2f;
+
+			bool isExiting = false;
+			RayIntersection<float> expected = bruteForceNearestHit(sphere, origin, target - origin, isExiting);
+			float distance = sphere.getIntersectionDistance(origin, target - origin);
+			if(expected.d == INFINITY) {
+				ASSERT_TRUE(distance == INFINITY);
+			} else {
+				ASSERT_TOLERANT(distance == expected.d, 0.0001);
+			}
+
+			bool pointIsExiting = false;
+			bruteForceNearestHit(sphere, target, Vec3f(1, 0, 0), pointIsExiting);
+			ASSERT_STRICT(sphere.containsPoint(target) == pointIsExiting);
+		}
+
+		// copies share the bvh of the original
+		Polyhedron copy = sphere;
+		ASSERT_STRICT(copy.containsPoint(Vec3f(0.1f, 0.2f, 0.3f)));
+		ASSERT_FALSE(copy.containsPoint(Vec3f(1.1f, 0.2f, 0.3f)));
+	}
+}
+
+TEST_CASE(concurrentFirstRayQueries) {
+	const int rayCount = 200;
+	std::vector<Vec3f> origins(rayCount);
+	std::vector<Vec3f> directions(rayCount);
+	std::vector<float> expected(rayCount);
+	Polyhedron reference = Library::createSphere(1.0f, 3);
+	ASSERT_TRUE(reference.triangleCount >= POLYHEDRON_BVH_MIN_TRIANGLES);
+	for(int i = 0; i < rayCount; i++) {
+		origins[i] = Vec3f(std::cos(i * 0.5f), std::sin(i * 0.5f), std::sin(i * 0.9f)) * 3.0f;
+		directions[i] = Vec3f(std::sin(i * 0.37f), std::sin(i * 0.71f), std::sin(i * 0.13f)) * 1.2f - origins[i];
+		bool isExiting = false;
+		expected[i] = bruteForceNearestHit(reference, origins[i], directions[i], isExiting).d;
+	}
+
+	// every round starts all threads on a polyhedron that has no bvh yet, so that they race to build it
+	const int threadCount = 8;
+	for(int round = 0; round < 10; round++) {
+		Polyhedron sphere = Library::createSphere(1.0f, 3);
+		std::vector<std::vector<float>> distances(threadCount, std::vector<float>(rayCount));
+		std::atomic<bool> start(false);
+		std::vector<std::thread> threads;
+		for(int t = 0; t < threadCount; t++) {
+			threads.emplace_back([&, t]() {
+				while(!start.load()) std::this_thread::yield();
+				for(int i = 0; i < rayCount; i++) {
+					distances[t][i] = sphere.getIntersectionDistance(origins[i], directions[i]);
+				}
+			});
+		}
+		start.store(true);
+		for(std::thread& thread : threads) thread.join();
+
+		for(int t = 0; t < threadCount; t++) {
+			for(int i = 0; i < rayCount; i++) {
+				if(expected[i] == INFINITY) {
+					ASSERT_TRUE(distances[t][i] == INFINITY);
+				} else {
+					ASSERT_TOLERANT(distances[t][i] == expected[i], 0.0001);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(capsuleMatchesItsPolyhedron) {
+	Shape capsule = Capsule(0.5, 3.0);
+	const ShapeClass& capsuleClass = *capsule.baseShape;
+	Polyhedron poly = capsuleClass.asPolyhedron();
+	Polyhedron scaledPoly = poly.scaled(0.5, 0.5, 1.5);
+
+	ASSERT_TOLERANT(scaledPoly.getVolume() == capsule.getVolume(), 0.03);
+	ASSERT_TOLERANT(scaledPoly.getInertiaAroundCenterOfMass() == capsule.getInertia(), 0.03);
+
+	for(int i = 0; i < 200; i++) {
+		Vec3 point = Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13)) * 1.2;
+		// points near the surface may land on either side of the approximating polyhedron
+		if(capsuleClass.containsPoint(point * 1.02) == capsuleClass.containsPoint(point * 0.98)) {
+			ASSERT_STRICT(capsuleClass.containsPoint(point) == poly.containsPoint(point));
+		}
+
+		Vec3 origin = Vec3(std::cos(i * 0.5), std::sin(i * 0.5), std::sin(i * 0.9)) * 3.0;
+		Vec3 direction = point - origin;
+		double capsuleDistance = capsuleClass.getIntersectionDistance(origin, direction);
+		double polyDistance = poly.getIntersectionDistance(origin, direction);
+		if(std::isinf(capsuleDistance) || std::isinf(polyDistance)) {
+			// grazing rays may only hit one of both
+			continue;
+		}
+		ASSERT_TOLERANT(capsuleDistance == polyDistance, 0.02);
+	}
+
+	// the bounds of a capsule are those of its end spheres
+	Rotation rotation = Rotation::fromEulerAngles(0.3, 0.7, 0.9);
+	BoundingBox bounds = capsule.getBounds(rotation);
+	Vec3 end = abs(rotation.localToGlobal(Vec3(0.0, 0.0, 1.0)));
+	ASSERT(bounds.max == end + Vec3(0.5, 0.5, 0.5));
+	ASSERT(bounds.min == -(end + Vec3(0.5, 0.5, 0.5)));
+}
+
+TEST_CASE(coreIntersectionsMatchFullGJK) {
+	Shape shapes[]{Sphere(0.7), Box(1.0, 0.6, 1.4), Capsule(0.4, 2.0), Shape(Library::icosahedron).scaled(0.8, 0.8, 0.8)};
+	int pairs[][2]{{0, 0}, {0, 1}, {1, 0}, {2, 1}, {1, 2}, {2, 2}, {0, 2}, {2, 3}, {0, 3}};
+	int comparedCount = 0;
+	for(const int* pair : pairs) {
+		const Shape& first = shapes[pair[0]];
+		const Shape& second = shapes[pair[1]];
+		for(int i = 0; i < 200; i++) {
+			CFrame relativeTransform(Vec3(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13)) * 1.8, Rotation::fromEulerAngles(i * 0.3, i * 0.7, i * 0.11));
+			std::optional<Intersection> fast = intersectsTransformed(first, second, relativeTransform);
+			std::optional<Intersection> full = intersectsTransformed(*first.baseShape, *second.baseShape, relativeTransform, first.scale, second.scale);
+			if(fast.has_value() != full.has_value()) {
+				// only barely touching shapes may disagree
+				const Intersection& found = fast.has_value() ? fast.value() : full.value();
+				ASSERT_TRUE(length(found.exitVector) < 0.01);
+				continue;
+			}
+			if(!fast) continue;
+			comparedCount++;
+			// EPA stops within a tolerance of the exact exit vector, which grows with the depth
+			ASSERT_TOLERANT(fast.value().exitVector == full.value().exitVector, 0.06);
+			if(pair[0] == 0 && pair[1] == 0) {
+				// spheres are pushed apart along the line between their centers
+				Vec3 center = relativeTransform.getPosition();
+				ASSERT(fast.value().exitVector == normalize(center) * (1.4 - length(center)));
+			}
+			ASSERT_TRUE(overlapsTransformed(first, second, relativeTransform));
+		}
+	}
+	ASSERT_TRUE(comparedCount > 100);
+}
@@ -8,6 +8,8 @@
 #include "../physics/geometry/convexShapeBuilder.h"
 #include "../physics/misc/shapeLibrary.h"
 
+#include <vector>
+
 TEST_CASE(testIndexedShape) {
 	Vec3f verts[]{Vec3f(0.0, 0.0, 0.0), Vec3f(1.0, 0.0, 0.0), Vec3f(0.0, 0.0, 1.0), Vec3f(0.0, 1.0, 0.0)};
 	Triangle triangles[]{{0,1,2},{0,3,1},{0,2,3},{1,3,2}};
@@ -88,3 +90,48 @@ TEST_CASE(buildConvexShape) {
 
 	ASSERT_TRUE(icosaBuilder.toIndexedShape().isValid());
 }
+
+TEST_CASE(largeMeshNeighbors) {
+	Polyhedron sphere = Library::createSphere(1.0, 3);
+	ASSERT_TRUE(sphere.triangleCount >= LINEAR_NEIGHBOR_SEARCH_MIN_TRIANGLES);
+
+	std::vector<Vec3f> verts(sphere.vertexCount);
+	std::vector<Triangle> triangles(sphere.triangleCount);
+	std::vector<TriangleNeighbors> neighBuf(sphere.triangleCount);
+	sphere.getVertices(verts.data());
+	sphere.getTriangles(triangles.data());
+
+	fillNeighborBuf(triangles.data(), sphere.triangleCount, neighBuf.data());
+
+	IndexedShape s(verts.data(), triangles.data(), sphere.vertexCount, sphere.triangleCount, neighBuf.data());
+
+	ASSERT_TRUE(s.isValid());
+}
+
+TEST_CASE(linearNeighborsMatchQuadratic) {
+	Polyhedron sphere = Library::createSphere(1.0, 3);
+	std::vector<Triangle> triangles(sphere.triangleCount);
+	sphere.getTriangles(triangles.data());
+	// an open mesh as well, its border edges have no neighbor and must be left untouched by both
+	int openTriangleCount = sphere.triangleCount - 7;
+
+	for(int triangleCount : {sphere.triangleCount, openTriangleCount}) {
+		std::vector<TriangleNeighbors> quadratic(triangleCount);
+		std::vector<TriangleNeighbors> linear(triangleCount);
+		for(int i = 0; i < triangleCount; i++) {
+			for(int j = 0; j < 3; j++) {
+				quadratic[i][j] = -1;
+				linear[i][j] = -1;
+			}
+		}
+
+		fillNeighborBufQuadratic(triangles.data(), triangleCount, quadratic.data());
+		fillNeighborBufLinear(triangles.data(), triangleCount, linear.data());
+
+		for(int i = 0; i < triangleCount; i++) {
+			for(int j = 0; j < 3; j++) {
+				ASSERT_STRICT(linear[i][j] == quadratic[i][j]);
+			}
+		}
+	}
+}
@@ -315,3 +315,72 @@ TEST_CASE(testSinTaylorExpansion) {
 	ASSERT(testTaylor.derivatives[2] == thirdDerivative);
 	ASSERT(testTaylor.derivatives[3] == fourthDerivative);
 }
+
+/*
+	Both rotation representations are compiled into every build, these check the one that is not selected by PHYSICS_QUATERNION_ROTATIONS as well
+*/
+TEST_CASE(quaternionRotationMatchesMatrixRotation) {
+	typedef MatrixRotationTemplate<double> MatRot;
+	typedef QuaternionRotationTemplate<double> QuatRot;
+
+	Vec3 v(0.7, -1.3, 2.9);
+	SymmetricMat3 sm{2.0, 0.3, 1.5, -0.4, 0.2, 3.1};
+	for(int i = 0; i < 40; i++) {
+		double alpha = std::sin(i * 0.37) * 3.0;
+		double beta = std::sin(i * 0.71) * 3.0;
+		double gamma = std::sin(i * 0.13) * 3.0;
+
+		MatRot m1 = MatRot::fromEulerAngles(alpha, beta, gamma);
+		MatRot m2 = MatRot::fromEulerAngles(gamma, alpha, beta);
+		QuatRot q1 = QuatRot::fromEulerAngles(alpha, beta, gamma);
+		QuatRot q2 = QuatRot::fromEulerAngles(gamma, alpha, beta);
+
+		ASSERT(q1.asRotationMatrix() == m1.asRotationMatrix());
+		ASSERT(q1.localToGlobal(v) == m1.localToGlobal(v));
+		ASSERT(q1.globalToLocal(v) == m1.globalToLocal(v));
+		ASSERT(q1 * v == m1 * v);
+		ASSERT((q1 * q2).asRotationMatrix() == (m1 * m2).asRotationMatrix());
+		ASSERT(q1.globalToLocal(q2).asRotationMatrix() == m1.globalToLocal(m2).asRotationMatrix());
+		ASSERT((~q1).asRotationMatrix() == (~m1).asRotationMatrix());
+		ASSERT(q1.localToGlobal(sm) == m1.localToGlobal(sm));
+		ASSERT(q1.globalToLocal(sm) == m1.globalToLocal(sm));
+
+		ASSERT(QuatRot::fromRotationMatrix(m1.asRotationMatrix()) == q1);
+		ASSERT(QuatRot::fromRotationVec(m1.asRotationVector()) == q1);
+		ASSERT(MatRot::fromRotationVec(q1.asRotationVector()) == m1);
+	}
+}
+
+TEST_CASE(quaternionRotationPredefined) {
+	typedef MatrixRotationTemplate<double> MatRot;
+	typedef QuaternionRotationTemplate<double> QuatRot;
+
+	ASSERT(QuatRot::Predefined::IDENTITY.asRotationMatrix() == MatRot::Predefined::IDENTITY.asRotationMatrix());
+	ASSERT(QuatRot().asRotationMatrix() == MatRot().asRotationMatrix());
+
+	ASSERT(QuatRot::Predefined::X_90.asRotationMatrix() == MatRot::Predefined::X_90.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Y_90.asRotationMatrix() == MatRot::Predefined::Y_90.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Z_90.asRotationMatrix() == MatRot::Predefined::Z_90.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::X_180.asRotationMatrix() == MatRot::Predefined::X_180.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Y_180.asRotationMatrix() == MatRot::Predefined::Y_180.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Z_180.asRotationMatrix() == MatRot::Predefined::Z_180.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::X_270.asRotationMatrix() == MatRot::Predefined::X_270.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Y_270.asRotationMatrix() == MatRot::Predefined::Y_270.asRotationMatrix());
+	ASSERT(QuatRot::Predefined::Z_270.asRotationMatrix() == MatRot::Predefined::Z_270.asRotationMatrix());
+}
+
+TEST_CASE(quaternionRotationStaysNormalized) {
+	typedef QuaternionRotationTemplate<double> QuatRot;
+
+	QuatRot step = QuatRot::fromEulerAngles(0.0013, 0.0021, 0.0007);
+	QuatRot total;
+	for(int i = 0; i < 100000; i++) {
+		total *= step;
+	}
+	ASSERT(lengthSquared(total.asQuaternion()) == 1.0);
+	ASSERT_TRUE(isValidRotationMatrix(total.asRotationMatrix()));
+
+	// the single precision version is the one stored in checkpoints
+	QuaternionRotationTemplate<float> totalf = static_cast<QuaternionRotationTemplate<float>>(total);
+	ASSERT_TOLERANT(totalf.asRotationMatrix() == static_cast<Mat3f>(total.asRotationMatrix()), 0.00001f);
+}
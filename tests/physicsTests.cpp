@@ -5,10 +5,16 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 #include "../physics/world.h"
 #include "../physics/inertia.h"
 #include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/gravityForce.h"
+#include "../physics/misc/worldStateHash.h"
+#include "../physics/profiling.h"
+#include "../physics/constraints/fixedConstraint.h"
 #include "../physics/math/linalg/trigonometry.h"
 #include "../physics/math/linalg/misc.h"
 #include "../physics/math/linalg/commonMatrices.h"
@@ -16,6 +22,7 @@
 #include "../physics/geometry/basicShapes.h"
 #include "../physics/geometry/shape.h"
 #include "../physics/geometry/polyhedron.h"
+#include "../physics/geometry/triangleShapes.h"
 #include "../physics/geometry/normalizedPolyhedron.h"
 #include "../util/log.h"
 
@@ -381,3 +388,365 @@ TEST_CASE(testShapeNativeScaling) {
 
 	ASSERT(shape2.getInertia() == scaledTestPoly.getInertiaAroundCenterOfMass());
 }
+
+static void fillSceneQueryWorld(World<Part>& world) {
+	std::vector<Part*> parts;
+	for(int i = 0; i < 200; i++) {
+		GlobalCFrame cframe(std::sin(i * 0.37) * 10.0, std::sin(i * 0.71) * 10.0, std::sin(i * 0.13) * 10.0);
+		if(i % 2 == 0) {
+			parts.push_back(new Part(Box(0.5 + 0.3 * (i % 3), 0.7, 0.5 + 0.2 * (i % 5)), cframe, {1.0, 0.5, 0.5}));
+		} else {
+			parts.push_back(new Part(Sphere(0.3 + 0.1 * (i % 4)), cframe, {1.0, 0.5, 0.5}));
+		}
+	}
+	world.addParts(parts.data(), parts.size());
+	world.addTerrainPart(new Part(Box(40.0, 1.0, 40.0), GlobalCFrame(0.0, -12.0, 0.0), {1.0, 0.5, 0.5}));
+}
+
+static double bruteForceRayDistance(const Ray& ray, const Part& part) {
+	double distance = part.hitbox.getIntersectionDistance(part.getCFrame().globalToLocal(ray.start), part.getCFrame().relativeToLocal(ray.direction));
+	return (distance > 0.0) ? distance : INFINITY;
+}
+
+TEST_CASE(worldRaycastsMatchBruteForce) {
+	World<Part> world(DELTA_T);
+	fillSceneQueryWorld(world);
+
+	std::vector<RayQuery> queries;
+	for(int i = 0; i < 300; i++) {
+		Position start(std::sin(i * 0.53) * 15.0, std::sin(i * 0.29) * 15.0, std::sin(i * 0.91) * 15.0);
+		Vec3 direction(std::sin(i * 1.7), std::sin(i * 2.3) - 0.3, std::cos(i * 1.1));
+		queries.push_back(RayQuery(Ray{start, direction}, (i % 4 == 0) ? 10.0 : INFINITY));
+	}
+	std::vector<QueryHit> closest(queries.size());
+	std::vector<QueryHit> any(queries.size());
+	std::vector<std::vector<QueryHit>> all(queries.size());
+	world.raycastClosest(queries.data(), queries.size(), closest.data());
+	world.raycastAny(queries.data(), queries.size(), any.data());
+	world.raycastAll(queries.data(), queries.size(), all.data());
+
+	for(size_t i = 0; i < queries.size(); i++) {
+		double bestDistance = queries[i].maxDistance;
+		int hitCount = 0;
+		for(const Part& part : world.iterParts()) {
+			double distance = bruteForceRayDistance(queries[i].ray, part);
+			if(distance < queries[i].maxDistance) {
+				hitCount++;
+				bestDistance = std::min(bestDistance, distance);
+			}
+		}
+		ASSERT_STRICT(closest[i].hasHit() == (hitCount != 0));
+		ASSERT_STRICT(any[i].hasHit() == (hitCount != 0));
+		ASSERT_STRICT(all[i].size() == hitCount);
+		if(hitCount != 0) {
+			ASSERT_TOLERANT(closest[i].distance == bestDistance, 0.000001);
+			ASSERT_TRUE(any[i].distance < queries[i].maxDistance);
+			ASSERT_TOLERANT(all[i][0].distance == bestDistance, 0.000001);
+			for(size_t j = 1; j < all[i].size(); j++) {
+				ASSERT_TRUE(all[i][j - 1].distance <= all[i][j].distance);
+			}
+		}
+	}
+}
+
+TEST_CASE(worldOverlapsMatchBruteForce) {
+	World<Part> world(DELTA_T);
+	std::vector<Part*> boxes;
+	for(int i = 0; i < 100; i++) {
+		boxes.push_back(new Part(Box(1.0, 0.6, 0.8), GlobalCFrame(std::sin(i * 0.37) * 6.0, std::sin(i * 0.71) * 6.0, std::sin(i * 0.13) * 6.0), {1.0, 0.5, 0.5}));
+	}
+	world.addParts(boxes.data(), boxes.size());
+
+	std::vector<OverlapQuery> queries;
+	for(int i = 0; i < 100; i++) {
+		queries.push_back(OverlapQuery::sphere(Position(std::sin(i * 0.53) * 6.0, std::sin(i * 0.29) * 6.0, std::sin(i * 0.91) * 6.0), 0.5 + 0.2 * (i % 5)));
+	}
+	std::vector<std::vector<Part*>> results(queries.size());
+	world.overlapAll(queries.data(), queries.size(), results.data());
+	// the query threads turn profiling off, the calling thread gets it back afterwards
+	ASSERT_TRUE(isProfilingEnabled());
+
+	for(size_t i = 0; i < queries.size(); i++) {
+		double radius = queries[i].shape.scale[0];
+		for(Part& part : world.iterParts()) {
+			// distance from the center of the sphere to the nearest point of the unrotated box
+			Vec3 relative = queries[i].cframe.getPosition() - part.getPosition();
+			Vec3 outside;
+			for(int axis = 0; axis < 3; axis++) {
+				outside[axis] = std::max(std::abs(relative[axis]) - part.hitbox.scale[axis], 0.0);
+			}
+			double distance = length(outside);
+			// touching pairs may go either way
+			if(std::abs(distance - radius) < 0.001) continue;
+			bool found = std::find(results[i].begin(), results[i].end(), &part) != results[i].end();
+			ASSERT_STRICT(found == (distance < radius));
+		}
+	}
+}
+
+/*
+	Returns the velocity of a box resting slightly inside a flat heightfield with the given number of samples per side, after one tick
+*/
+static Vec3 velocityOfBoxOnHeightfield(int samplesPerSide) {
+	World<Part> world(DELTA_T);
+	std::vector<float> heights(samplesPerSide * samplesPerSide, 0.0f);
+	world.addTerrainPart(new Part(Heightfield(heights.data(), samplesPerSide, samplesPerSide, 20.0, 20.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.5, 0.5}));
+	Part* box = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(0.3, 0.4, 0.2), {1.0, 0.5, 0.5});
+	world.addPart(box);
+	world.tick();
+	return box->getMotion().getVelocity();
+}
+
+TEST_CASE(heightfieldResponseIndependentOfTessellation) {
+	// the box overlaps 2 triangles of the coarse heightfield and about 18 of the fine one
+	Vec3 coarseVelocity = velocityOfBoxOnHeightfield(3);
+	Vec3 fineVelocity = velocityOfBoxOnHeightfield(41);
+	ASSERT_TRUE(coarseVelocity.y > 0.0);
+	ASSERT_TOLERANT(coarseVelocity == fineVelocity, 0.0001);
+}
+
+TEST_CASE(worldSweepFindsFirstContact) {
+	World<Part> world(DELTA_T);
+	Part* nearBox = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(5.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	Part* farBox = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(8.0, 0.2, 0.0), {1.0, 0.5, 0.5});
+	world.addPart(nearBox);
+	world.addPart(farBox);
+	world.addTerrainPart(new Part(Box(20.0, 1.0, 20.0), GlobalCFrame(0.0, -3.0, 0.0), {1.0, 0.5, 0.5}));
+
+	SweepQuery queries[]{
+		// hits the near box when its center reaches x = 4
+		SweepQuery(Sphere(0.5), GlobalCFrame(0.0, 0.0, 0.0), Vec3(10.0, 0.0, 0.0)),
+		// passes above both boxes
+		SweepQuery(Sphere(0.5), GlobalCFrame(0.0, 2.0, 0.0), Vec3(10.0, 0.0, 0.0)),
+		// already inside the near box
+		SweepQuery(Box(0.4, 0.4, 0.4), GlobalCFrame(5.2, 0.0, 0.0), Vec3(0.0, 5.0, 0.0)),
+		// falls onto the terrain, whose top is at y = -2.5
+		SweepQuery(Box(1.0, 1.0, 1.0), GlobalCFrame(-3.0, 0.0, 0.0), Vec3(0.0, -4.0, 0.0)),
+	};
+	QueryHit results[4];
+	world.sweepClosest(queries, 4, results);
+
+	ASSERT_TRUE(results[0].part == nearBox);
+	ASSERT_TOLERANT(results[0].distance == 0.4, 0.001);
+	ASSERT_FALSE(results[1].hasHit());
+	ASSERT_TRUE(results[2].part == nearBox);
+	ASSERT_STRICT(results[2].distance == 0.0);
+	ASSERT_TRUE(results[3].hasHit());
+	ASSERT_TRUE(results[3].part->isTerrainPart);
+	ASSERT_TOLERANT(results[3].distance == 0.5, 0.001);
+
+	std::vector<Part*> overlapping;
+	OverlapQuery atContact(queries[0].shape, GlobalCFrame(queries[0].start.getPosition() + queries[0].translation * results[0].distance));
+	world.overlapAll(&atContact, 1, &overlapping);
+	ASSERT_TRUE(overlapping.empty());
+}
+
+TEST_CASE(inertiaOfPointMatchesResponseMatrix) {
+	Part part(Box(1.0, 0.5, 0.7), GlobalCFrame(1.0, 2.0, 3.0, Rotation::fromEulerAngles(0.3, 0.7, -0.4)), {1.0, 0.2, 0.5});
+	part.ensureHasParent();
+	const MotorizedPhysical& phys = *part.parent->mainPhysical;
+
+	for(int i = 0; i < 20; i++) {
+		Vec3 point(std::sin(i * 0.37), std::sin(i * 0.71), std::sin(i * 0.13));
+		Vec3 direction(std::sin(i * 0.53) + 1.5, std::sin(i * 0.29), std::sin(i * 0.83));
+
+		double accel = (phys.getResponseMatrix(point) * direction) * direction / lengthSquared(direction);
+		ASSERT(phys.getInertiaOfPointInDirectionLocal(point, direction) == 1 / accel);
+	}
+}
+
+static void fillFallingBoxesWorld(World<Part>& world) {
+	std::vector<Part*> parts;
+	for(int i = 0; i < 40; i++) {
+		GlobalCFrame cframe(std::sin(i * 0.37) * 3.0, 1.0 + i * 0.6, std::sin(i * 0.13) * 3.0, Rotation::fromEulerAngles(i * 0.1, i * 0.2, 0.0));
+		parts.push_back(new Part(Box(0.5 + 0.3 * (i % 3), 0.7, 0.5 + 0.2 * (i % 5)), cframe, {1.0, 0.5, 0.5}));
+	}
+	world.addParts(parts.data(), parts.size());
+	world.addTerrainPart(new Part(Box(40.0, 1.0, 40.0), GlobalCFrame(0.0, -0.5, 0.0), {1.0, 0.5, 0.5}));
+	world.addExternalForce(new DirectionalGravity(Vec3(0.0, -10.0, 0.0)));
+}
+
+/*
+	Pushes one physical at one tick, a stand in for a code path that does not match the reference
+*/
+class PerturbedWorld : public World<Part> {
+public:
+	size_t perturbedAge;
+	size_t perturbedPhysical;
+
+	PerturbedWorld(double deltaT, size_t perturbedAge, size_t perturbedPhysical) : World<Part>(deltaT), perturbedAge(perturbedAge), perturbedPhysical(perturbedPhysical) {}
+
+	virtual void applyExternalForces() override {
+		World<Part>::applyExternalForces();
+		if(age == perturbedAge) {
+			physicals[perturbedPhysical]->applyForceAtCenterOfMass(Vec3(0.0, 0.0, 1E-6));
+		}
+	}
+};
+
+TEST_CASE(identicalWorldsHaveEqualStateHashes) {
+	World<Part> reference(DELTA_T);
+	World<Part> tested(DELTA_T);
+	fillFallingBoxesWorld(reference);
+	fillFallingBoxesWorld(tested);
+	reference.hashStateEveryTick = true;
+	tested.hashStateEveryTick = true;
+
+	WorldDivergence divergence = findFirstDivergence(reference, tested, 100);
+
+	ASSERT_FALSE(divergence.diverged);
+	ASSERT_STRICT(reference.age == 100);
+	ASSERT_TRUE(reference.stateHash == tested.stateHash);
+	ASSERT_TRUE(WorldStateHash::hashWorld(reference) == WorldStateHash::hashWorld(tested));
+}
+
+TEST_CASE(firstDivergingTickAndPartAreFound) {
+	World<Part> reference(DELTA_T);
+	PerturbedWorld tested(DELTA_T, 30, 7);
+	fillFallingBoxesWorld(reference);
+	fillFallingBoxesWorld(tested);
+	reference.hashStateEveryTick = true;
+	tested.hashStateEveryTick = true;
+
+	WorldDivergence divergence = findFirstDivergence(reference, tested, 100);
+
+	ASSERT_TRUE(divergence.diverged);
+	ASSERT_STRICT(divergence.tick == 31);
+	ASSERT_STRICT(reference.age == 31);
+	ASSERT_STRICT(divergence.physicalIndex == 7);
+	ASSERT_STRICT(divergence.partIndex == 0);
+	ASSERT_TRUE(divergence.referencePart == reference.physicals[7]->getMainPart());
+	ASSERT_TRUE(divergence.testedPart == tested.physicals[7]->getMainPart());
+	ASSERT_TRUE(reference.stateHash != tested.stateHash);
+}
+
+TEST_CASE(cachedStateHashesOfRestingPhysicalsMatchAFullHash) {
+	World<Part> world(DELTA_T);
+	std::vector<Part*> parts;
+	for(int i = 0; i < 8; i++) {
+		parts.push_back(new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(i * 3.0, 0.0, 0.0, Rotation::fromEulerAngles(0.0, i * 0.3, 0.0)), {1.0, 0.5, 0.5}));
+	}
+	parts[1]->attach(new Part(Box(0.5, 0.5, 0.5), GlobalCFrame(), {1.0, 0.5, 0.5}), CFrame(0.0, 1.0, 0.0));
+	world.addParts(parts.data(), parts.size());
+	parts[2]->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.0, 0.1, 0.0), Vec3(0.0, 0.0, 0.2));
+	world.hashStateEveryTick = true;
+
+	uint64_t expectedHash = 0;
+	bool allTicksMatched = true;
+	for(int tick = 0; tick < 60; tick++) {
+		// things that change resting physicals outside of update
+		if(tick == 10) parts[3]->parent->mainPhysical->setCFrame(GlobalCFrame(9.0, 2.0, 0.0));
+		if(tick == 20) parts[4]->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.2, 0.0, 0.0), Vec3(0.0, 0.0, 0.0));
+		if(tick == 25) parts[4]->parent->mainPhysical->motionOfCenterOfMass = Motion();
+		if(tick == 30) parts[5]->attach(parts[6], parts[5]->getCFrame().globalToLocal(parts[6]->getCFrame()));
+		if(tick == 40) parts[7]->setCFrame(GlobalCFrame(0.0, 5.0, 5.0));
+		world.hashStateEveryTick = tick < 12 || tick > 16;
+
+		world.tick();
+		if(world.hashStateEveryTick) {
+			expectedHash = WorldStateHash::combine(expectedHash, WorldStateHash::hashWorld(world));
+			allTicksMatched = allTicksMatched && world.stateHash == expectedHash;
+		}
+	}
+	ASSERT_TRUE(allTicksMatched);
+	ASSERT_TRUE(parts[0]->parent->mainPhysical->isAtRest());
+	ASSERT_FALSE(parts[2]->parent->mainPhysical->isAtRest());
+}
+
+TEST_CASE(handlesStopResolvingOnceRemoved) {
+	World<Part> world(DELTA_T);
+	Part* a = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	Part* b = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(3.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	world.addPart(a);
+	world.addPart(b);
+
+	Handle<Part> handleOfA = a->handle;
+	Handle<Part> handleOfB = b->handle;
+	Handle<MotorizedPhysical> physicalOfB = b->parent->mainPhysical->handle;
+	ASSERT_TRUE(world.getPart(handleOfA) == a);
+	ASSERT_TRUE(world.getPart(handleOfB) == b);
+	ASSERT_TRUE(world.getPhysical(physicalOfB) == b->parent->mainPhysical);
+
+	// the physical of b is merged into that of a and deleted, b itself stays in the world
+	a->attach(b, CFrame(3.0, 0.0, 0.0));
+	ASSERT_TRUE(world.getPhysical(physicalOfB) == nullptr);
+	ASSERT_TRUE(world.getPhysical(a->parent->mainPhysical->handle) == a->parent->mainPhysical);
+	ASSERT_TRUE(world.getPart(handleOfB) == b);
+
+	delete a;
+	ASSERT_TRUE(world.getPart(handleOfA) == nullptr);
+	ASSERT_TRUE(world.getPart(handleOfB) == b);
+
+	// c reuses the slot of a, the handle of a must not resolve to it
+	Part* c = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(0.0, 3.0, 0.0), {1.0, 0.5, 0.5});
+	world.addPart(c);
+	ASSERT_STRICT(c->handle.index == handleOfA.index);
+	ASSERT_TRUE(world.getPart(c->handle) == c);
+	ASSERT_TRUE(world.getPart(handleOfA) == nullptr);
+	ASSERT_TRUE(world.isValid());
+}
+
+TEST_CASE(hardConstraintAttachMergesPhysicalsInWorld) {
+	World<Part> world(DELTA_T);
+	Part* a = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(0.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	Part* b = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(3.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	world.addPart(a);
+	world.addPart(b);
+	ASSERT_STRICT(world.physicals.size() == 2);
+
+	Handle<MotorizedPhysical> physicalOfA = a->parent->mainPhysical->handle;
+	Handle<MotorizedPhysical> physicalOfB = b->parent->mainPhysical->handle;
+	Handle<Part> handleOfB = b->handle;
+
+	// both physicals are in the world, the one of b is absorbed as a ConnectedPhysical of the one of a
+	a->attach(b, new FixedConstraint(), CFrame(1.5, 0.0, 0.0), CFrame(-1.5, 0.0, 0.0));
+	ASSERT_TRUE(world.isValid());
+	ASSERT_STRICT(world.physicals.size() == 1);
+	ASSERT_TRUE(world.getPhysical(physicalOfB) == nullptr);
+	ASSERT_TRUE(world.getPhysical(physicalOfA) == a->parent->mainPhysical);
+	ASSERT_TRUE(b->parent->mainPhysical == a->parent->mainPhysical);
+	ASSERT_FALSE(b->parent->isMainPhysical());
+	ASSERT_TRUE(world.getPart(handleOfB) == b);
+
+	for(int i = 0; i < 10; i++) {
+		world.tick();
+	}
+	ASSERT_TRUE(world.isValid());
+}
+
+TEST_CASE(compactedPartsKeepTheirHandles) {
+	World<Part> world(DELTA_T);
+	fillFallingBoxesWorld(world);
+	Part* mainPart = world.physicals[3]->getMainPart();
+	// attached to a physical already in the world, a multi part physical
+	new Part(Box(0.3, 0.3, 0.3), *mainPart, CFrame(0.0, 0.6, 0.0), {1.0, 0.5, 0.5});
+	for(int i = 0; i < 20; i++) {
+		world.tick();
+	}
+
+	std::vector<Handle<Part>> handles;
+	std::vector<const Part*> oldAddresses;
+	std::vector<Position> positions;
+	for(const Part& part : world.iterParts()) {
+		handles.push_back(part.handle);
+		oldAddresses.push_back(&part);
+		positions.push_back(part.getPosition());
+	}
+
+	world.compactParts();
+	ASSERT_TRUE(world.isValid());
+
+	for(size_t i = 0; i < handles.size(); i++) {
+		Part* moved = world.getPart(handles[i]);
+		ASSERT_TRUE(moved != nullptr);
+		ASSERT_TRUE(moved->handle == handles[i]);
+		ASSERT_TRUE(moved->getPosition() == positions[i]);
+		// terrain parts are left where they are
+		ASSERT_TRUE((moved == oldAddresses[i]) == moved->isTerrainPart);
+	}
+
+	for(int i = 0; i < 20; i++) {
+		world.tick();
+	}
+	ASSERT_TRUE(world.isValid());
+}
@@ -0,0 +1,185 @@
+#include "testsMain.h"
+
+#include "../physics/misc/toString.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "core.h"
+#include "../engine/io/import.h"
+#include "../engine/io/meshCache.h"
+#include "../graphics/visualShape.h"
+#include "../physics/geometry/normalizedPolyhedron.h"
+#include "../util/resource/resourceManager.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+/*
+	A mesh resource without the graphics card, decoded the same way as MeshResource
+*/
+class ShapeResource;
+
+class ShapeAllocator : public ResourceAllocator<ShapeResource> {
+public:
+	virtual ShapeResource* load(const std::string& name, const std::string& path) override;
+	virtual std::function<ShapeResource*()> decode(const std::string& name, const std::string& path) override;
+};
+
+class ShapeResource : public Resource {
+public:
+	DEFINE_RESOURCE(OBJ, "");
+
+	Graphics::VisualShape shape;
+	std::thread::id finalizeThread;
+
+	ShapeResource(const std::string& name, const std::string& path, const Graphics::VisualShape& shape) : Resource(name, path), shape(shape), finalizeThread(std::this_thread::get_id()) {}
+
+	virtual void close() override {}
+
+	virtual std::size_t getSize() const override {
+		return shape.vertexCount * sizeof(Vec3f);
+	}
+
+	static ShapeAllocator getAllocator() {
+		return ShapeAllocator();
+	}
+};
+
+ShapeResource* ShapeAllocator::load(const std::string& name, const std::string& path) {
+	std::function<ShapeResource*()> finalize = decode(name, path);
+	return finalize ? finalize() : nullptr;
+}
+
+std::function<ShapeResource*()> ShapeAllocator::decode(const std::string& name, const std::string& path) {
+	Graphics::VisualShape shape = OBJImport::load(path);
+
+	if (shape.vertexCount == 0)
+		return nullptr;
+
+	return [name, path, shape]() { return new ShapeResource(name, path, shape); };
+}
+
+static std::string writeTestCube(const std::string& path) {
+	std::ofstream file(path);
+	file << "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\nv -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n";
+	file << "f 1 3 2\nf 1 4 3\nf 5 6 7\nf 5 7 8\nf 1 2 6\nf 1 6 5\nf 2 3 7\nf 2 7 6\nf 3 4 8\nf 3 8 7\nf 4 1 5\nf 4 5 8\n";
+	return path;
+}
+
+TEST_CASE(asyncResourceLoadPublishesOnUpdate) {
+	std::string path = writeTestCube("resourceTestsCube.obj");
+
+	ShapeResource* published = nullptr;
+	ResourceHandle<ShapeResource> handle = ResourceManager::addAsync<ShapeResource>("cube", path, [&published](ShapeResource* resource) { published = resource; });
+	ResourceHandle<ShapeResource> second = ResourceManager::addAsync<ShapeResource>("cube", path);
+
+	ASSERT_FALSE(handle.isReady());
+	ResourceManager::finish();
+	std::remove(path.c_str());
+
+	ASSERT_TRUE(handle.isReady());
+	ASSERT_TRUE(second.isReady());
+	ASSERT_TRUE(published != nullptr);
+	ASSERT_TRUE(handle.get() == published);
+	ASSERT_TRUE(second.get() == published);
+	ASSERT(published->shape.vertexCount == 8);
+	ASSERT(published->shape.triangleCount == 12);
+	ASSERT_TRUE(published->finalizeThread == std::this_thread::get_id());
+	ASSERT(ResourceManager::getReferenceCount("cube") == 2);
+
+	// an already loaded resource is still published by update, never inside addAsync
+	ShapeResource* publishedAgain = nullptr;
+	ResourceHandle<ShapeResource> loaded = ResourceManager::addAsync<ShapeResource>("cube", path, [&publishedAgain](ShapeResource* resource) { publishedAgain = resource; });
+	ASSERT(ResourceManager::getReferenceCount("cube") == 3);
+	ASSERT_FALSE(loaded.isReady());
+	ASSERT_TRUE(publishedAgain == nullptr);
+	ResourceManager::update();
+	ASSERT_TRUE(loaded.get() == published);
+	ASSERT_TRUE(publishedAgain == published);
+
+	ResourceManager::close();
+}
+
+TEST_CASE(asyncResourceLoadFailure) {
+	bool called = false;
+	ResourceHandle<ShapeResource> handle = ResourceManager::addAsync<ShapeResource>("missing", "resourceTestsMissing.obj", [&called](ShapeResource* resource) { called = resource == nullptr; });
+	ResourceManager::finish();
+
+	ASSERT_TRUE(handle.isReady());
+	ASSERT_TRUE(handle.get() == nullptr);
+	ASSERT_TRUE(called);
+	ASSERT_FALSE(ResourceManager::exists("missing"));
+
+	ResourceManager::close();
+}
+
+TEST_CASE(unusedResourcesEvictedOverBudget) {
+	std::string path = writeTestCube("resourceTestsCube.obj");
+	ResourceManager::addAsync<ShapeResource>("first", path);
+	ResourceManager::addAsync<ShapeResource>("second", path);
+	ResourceManager::finish();
+	std::remove(path.c_str());
+
+	std::size_t size = 8 * sizeof(Vec3f);
+	ASSERT(ResourceManager::getMemoryUsed() == 2 * size);
+
+	ResourceManager::setMemoryBudget(size);
+	ASSERT_TRUE(ResourceManager::exists("first"));
+	ASSERT_TRUE(ResourceManager::exists("second"));
+
+	ResourceManager::release("second");
+	ResourceManager::release("first");
+	ASSERT_TRUE(ResourceManager::exists("first"));
+	ASSERT_FALSE(ResourceManager::exists("second"));
+	ASSERT(ResourceManager::getMemoryUsed() == size);
+
+	ResourceManager::setMemoryBudget(static_cast<std::size_t>(-1));
+	ResourceManager::close();
+}
+
+static const char* meshCacheTestDirectory = "resourceTestsMeshCache";
+
+TEST_CASE(meshCacheReusedOnSecondLoad) {
+	std::string path = writeTestCube("resourceTestsCachedCube.obj");
+
+	CachedMesh parsed = MeshCache::load(path, meshCacheTestDirectory);
+	CachedMesh cached = MeshCache::load(path, meshCacheTestDirectory);
+	std::remove(path.c_str());
+	std::filesystem::remove_all(meshCacheTestDirectory);
+
+	ASSERT_FALSE(parsed.fromCache);
+	ASSERT_TRUE(cached.fromCache);
+	ASSERT(cached.shape.vertexCount == parsed.shape.vertexCount);
+	ASSERT(cached.shape.triangleCount == parsed.shape.triangleCount);
+	ASSERT_TRUE((cached.shape.normals.get() == nullptr) == (parsed.shape.normals.get() == nullptr));
+	for (int i = 0; i < parsed.shape.vertexCount; i++) {
+		ASSERT(cached.shape[i] == parsed.shape[i]);
+	}
+	for (int i = 0; i < parsed.shape.triangleCount; i++) {
+		ASSERT_TRUE(cached.shape.getTriangle(i) == parsed.shape.getTriangle(i));
+	}
+}
+
+TEST_CASE(meshCacheRebuiltWhenSourceChanges) {
+	std::string path = writeTestCube("resourceTestsCachedCube.obj");
+	MeshCache::load(path, meshCacheTestDirectory);
+
+	{
+		std::ofstream file(path);
+		file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nf 1 3 2\nf 1 2 4\nf 1 4 3\nf 2 3 4\n";
+	}
+
+	CachedMesh changed = MeshCache::load(path, meshCacheTestDirectory);
+	CachedMesh cached = MeshCache::load(path, meshCacheTestDirectory);
+	std::remove(path.c_str());
+	std::filesystem::remove_all(meshCacheTestDirectory);
+
+	ASSERT_FALSE(changed.fromCache);
+	ASSERT(changed.shape.vertexCount == 4);
+	ASSERT_TRUE(cached.fromCache);
+	ASSERT(cached.shape.vertexCount == 4);
+	ASSERT(cached.shape.triangleCount == 4);
+}
@@ -0,0 +1,427 @@
+#include "testsMain.h"
+
+#include "compare.h"
+#include "../physics/misc/toString.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "randomValues.h"
+
+#include "../physics/world.h"
+#include "../physics/part.h"
+#include "../physics/physical.h"
+#include "../physics/geometry/basicShapes.h"
+#include "../physics/geometry/normalizedPolyhedron.h"
+#include "../physics/geometry/triangleShapes.h"
+#include "../physics/misc/shapeLibrary.h"
+#include "../physics/misc/gravityForce.h"
+#include "../physics/misc/worldFile.h"
+#include "../physics/misc/worldCheckpoint.h"
+#include "../physics/misc/serialization.h"
+#include "../physics/constraints/fixedConstraint.h"
+#include "../physics/constraints/motorConstraint.h"
+#include "../util/serializeBasicTypes.h"
+
+#define ASSERT(x) ASSERT_STRICT(x)
+
+static void fillTestWorld(World<Part>& world, const ShapeClass* polyhedronClass) {
+	world.externalForces.push_back(new DirectionalGravity(Vec3(0.0, -10.0, 0.0)));
+	world.age = 37;
+
+	Part* a = new Part(Box(1.0, 2.0, 3.0), GlobalCFrame(1.0, 2.0, 3.0), {1.0, 0.7, 0.3});
+	Part* b = new Part(Sphere(0.5), GlobalCFrame(), {2.0, 0.5, 0.1});
+	Part* c = new Part(Shape(polyhedronClass, 1.0, 1.0, 1.0), GlobalCFrame(), {1.5, 0.2, 0.2});
+	Part* d = new Part(Cylinder(0.3, 1.0), GlobalCFrame(), {1.0, 1.0, 1.0});
+	a->attach(b, CFrame(Vec3(0.0, 1.5, 0.0)));
+	a->attach(c, new FixedConstraint(), CFrame(Vec3(1.0, 0.0, 0.0)), CFrame(Vec3(-1.0, 0.0, 0.0)));
+	c->attach(d, new FixedConstraint(), CFrame(Vec3(0.0, 0.0, 1.0)), CFrame(Vec3(0.0, 0.0, -1.0)));
+	world.addPart(a);
+	a->parent->mainPhysical->motionOfCenterOfMass = Motion(Vec3(0.5, 0.0, 0.0), Vec3(0.0, 0.1, 0.0));
+
+	world.addPart(new Part(Box(0.5, 0.5, 0.5), GlobalCFrame(-3.0, 0.0, 0.0), {1.0, 1.0, 1.0}));
+	world.addTerrainPart(new Part(Box(20.0, 1.0, 20.0), GlobalCFrame(0.0, -5.0, 0.0), {1.0, 1.0, 1.0}));
+	world.addTerrainPart(new Part(Shape(polyhedronClass, 2.0, 2.0, 2.0), GlobalCFrame(4.0, -4.0, 0.0), {1.0, 0.5, 0.5}));
+}
+
+static size_t countParts(const World<Part>& world, int partsMask) {
+	size_t count = 0;
+	for(const Part& p : world.iterParts(partsMask)) count++;
+	return count;
+}
+
+TEST_CASE(worldFileRoundTrip) {
+	NormalizedPolyhedron* icosaClass = new NormalizedPolyhedron(Library::icosahedron.normalized());
+
+	World<Part> world(0.01);
+	fillTestWorld(world, icosaClass);
+
+	std::ostringstream output;
+	WorldFileWriter().writeWorld(world, output);
+	std::string fileData = output.str();
+
+	// the reader requires aligned data
+	UniqueAlignedPointer<char> alignedData(fileData.size(), WORLD_FILE_ALIGNMENT);
+	std::copy(fileData.begin(), fileData.end(), alignedData.get());
+
+	WorldFileReader reader(alignedData.get(), fileData.size());
+	ASSERT_STRICT(reader.getPartCount() == world.getPartCount());
+	ASSERT_STRICT(reader.getTerrainPartCount() == countParts(world, TERRAIN_PARTS));
+
+	World<Part> loadedWorld(0.01);
+	reader.readWorld(loadedWorld);
+
+	ASSERT_STRICT(loadedWorld.age == world.age);
+	ASSERT_STRICT(loadedWorld.externalForces.size() == world.externalForces.size());
+	ASSERT_STRICT(countParts(loadedWorld, FREE_PARTS) == countParts(world, FREE_PARTS));
+	ASSERT_STRICT(countParts(loadedWorld, TERRAIN_PARTS) == countParts(world, TERRAIN_PARTS));
+	ASSERT_STRICT(loadedWorld.physicals.size() == world.physicals.size());
+	ASSERT_TRUE(loadedWorld.isValid());
+
+	for(size_t i = 0; i < world.physicals.size(); i++) {
+		const MotorizedPhysical& original = *world.physicals[i];
+		const MotorizedPhysical& loaded = *loadedWorld.physicals[i];
+
+		ASSERT_STRICT(loaded.childPhysicals.size() == original.childPhysicals.size());
+		ASSERT_TOLERANT(loaded.totalMass == original.totalMass, 0.000001);
+		ASSERT_TOLERANT(loaded.getMainPart()->getCFrame() == original.getMainPart()->getCFrame(), 0.000001);
+		ASSERT_TOLERANT(loaded.motionOfCenterOfMass.getVelocity() == original.motionOfCenterOfMass.getVelocity(), 0.000001);
+		ASSERT_TOLERANT(loaded.motionOfCenterOfMass.getAngularVelocity() == original.motionOfCenterOfMass.getAngularVelocity(), 0.000001);
+	}
+
+	double originalVolume = 0.0;
+	double loadedVolume = 0.0;
+	for(const Part& p : world.iterParts()) originalVolume += p.hitbox.getVolume();
+	for(const Part& p : loadedWorld.iterParts()) loadedVolume += p.hitbox.getVolume();
+	ASSERT_TOLERANT(loadedVolume == originalVolume, 0.000001);
+}
+
+TEST_CASE(worldFileRejectsGarbage) {
+	UniqueAlignedPointer<char> garbage(256, WORLD_FILE_ALIGNMENT);
+	for(int i = 0; i < 256; i++) garbage[i] = static_cast<char>(i);
+
+	bool threw = false;
+	try {
+		WorldFileReader reader(garbage.get(), 256);
+	} catch(SerializationException&) {
+		threw = true;
+	}
+	ASSERT_TRUE(threw);
+}
+
+TEST_CASE(worldFileFreesPartialLoads) {
+	NormalizedPolyhedron* icosaClass = new NormalizedPolyhedron(Library::icosahedron.normalized());
+
+	World<Part> world(0.01);
+	fillTestWorld(world, icosaClass);
+
+	std::ostringstream output;
+	WorldFileWriter().writeWorld(world, output);
+	std::string fileData = output.str();
+
+	// part 3 lies in a connected physical of a connected physical, the last part is the last terrain part to be loaded
+	size_t corruptedParts[]{3, world.getPartCount() - 1};
+	for(size_t corruptedPart : corruptedParts) {
+		UniqueAlignedPointer<char> alignedData(fileData.size(), WORLD_FILE_ALIGNMENT);
+		std::copy(fileData.begin(), fileData.end(), alignedData.get());
+
+		WorldFileReader reader(alignedData.get(), fileData.size());
+		const_cast<uint32_t*>(reader.getSection<uint32_t>(WorldFileSection::PART_SHAPE_CLASSES))[corruptedPart] = 1000000;
+
+		std::vector<MotorizedPhysical*> physicals;
+		std::vector<Part*> terrainParts;
+		bool threw = false;
+		try {
+			reader.readParts(physicals, terrainParts);
+		} catch(SerializationException&) {
+			threw = true;
+		}
+		ASSERT_TRUE(threw);
+		ASSERT_TRUE(physicals.empty());
+		ASSERT_TRUE(terrainParts.empty());
+	}
+}
+
+static Shape createTestHeightfield() {
+	std::vector<float> heights(9 * 5);
+	for(int z = 0; z < 5; z++) {
+		for(int x = 0; x < 9; x++) {
+			heights[x + z * 9] = static_cast<float>(std::sin(x * 0.4) + std::cos(z * 0.7));
+		}
+	}
+	return Heightfield(heights.data(), 9, 5, 16.0, 8.0);
+}
+
+static Shape createTestTriangleMesh() {
+	Polyhedron sphere = Library::createSphere(1.0, 1);
+	std::vector<Vec3f> vertices(sphere.vertexCount);
+	sphere.getVertices(vertices.data());
+	for(Vec3f& vertex : vertices) vertex += Vec3f(2.0f, 0.0f, 0.0f);
+	std::vector<Triangle> triangles;
+	for(Triangle triangle : sphere.iterTriangles()) {
+		triangles.push_back(triangle);
+	}
+	return TriangleMesh(vertices.data(), triangles.data(), sphere.vertexCount, static_cast<int>(triangles.size()));
+}
+
+// compares the shapes by volume and by a set of rays cast down onto them
+static bool isSameTriangleShapeClass(const ShapeClass* original, const ShapeClass* loaded) {
+	if(loaded->intersectionClassID != original->intersectionClassID) return false;
+	if(std::abs(loaded->volume - original->volume) > 0.000001) return false;
+	for(int i = 0; i < 20; i++) {
+		Vec3 origin = Vec3(std::cos(i * 0.5), 3.0, std::sin(i * 0.9));
+		Vec3 direction = Vec3(std::sin(i * 0.37), -1.0, std::sin(i * 0.13) * 0.5);
+		double originalDistance = original->getIntersectionDistance(origin, direction);
+		double loadedDistance = loaded->getIntersectionDistance(origin, direction);
+		if(std::isinf(originalDistance) != std::isinf(loadedDistance)) return false;
+		if(!std::isinf(originalDistance) && std::abs(loadedDistance - originalDistance) > 0.0001) return false;
+	}
+	return true;
+}
+
+TEST_CASE(triangleShapeClassSerialization) {
+	Shape heightfield = createTestHeightfield();
+	Shape mesh = createTestTriangleMesh();
+
+	for(const ShapeClass* original : {heightfield.baseShape, mesh.baseShape}) {
+		std::stringstream stream;
+		dynamicShapeClassSerializer.serialize(*original, stream);
+		std::unique_ptr<ShapeClass> loaded(dynamicShapeClassSerializer.deserialize(stream));
+		ASSERT_TRUE(isSameTriangleShapeClass(original, loaded.get()));
+	}
+
+	const HeightfieldShapeClass* heightfieldClass = static_cast<const HeightfieldShapeClass*>(heightfield.baseShape);
+	std::stringstream heightfieldStream;
+	dynamicShapeClassSerializer.serialize(*heightfieldClass, heightfieldStream);
+	std::unique_ptr<ShapeClass> loadedHeightfield(dynamicShapeClassSerializer.deserialize(heightfieldStream));
+	const HeightfieldShapeClass* loadedHeightfieldClass = static_cast<const HeightfieldShapeClass*>(loadedHeightfield.get());
+	ASSERT_STRICT(loadedHeightfieldClass->getSampleCountX() == 9);
+	ASSERT_STRICT(loadedHeightfieldClass->getSampleCountZ() == 5);
+	ASSERT_TOLERANT(loadedHeightfieldClass->originalCenter == heightfieldClass->originalCenter, 0.00001);
+	ASSERT_TOLERANT(loadedHeightfieldClass->originalScale == heightfieldClass->originalScale, 0.00001);
+}
+
+TEST_CASE(worldFileStoresTriangleShapes) {
+	Shape heightfield = createTestHeightfield();
+	Shape mesh = createTestTriangleMesh();
+	NormalizedPolyhedron* icosaClass = new NormalizedPolyhedron(Library::icosahedron.normalized());
+
+	World<Part> world(0.01);
+	world.addTerrainPart(new Part(heightfield, GlobalCFrame(0.0, -5.0, 0.0), {1.0, 1.0, 1.0}));
+	world.addTerrainPart(new Part(Shape(icosaClass, 1.0, 1.0, 1.0), GlobalCFrame(4.0, -4.0, 0.0), {1.0, 0.5, 0.5}));
+	world.addTerrainPart(new Part(mesh, GlobalCFrame(-4.0, -4.0, 0.0), {1.0, 0.5, 0.5}));
+	world.addTerrainPart(new Part(heightfield.scaled(0.5, 1.0, 0.5), GlobalCFrame(10.0, -5.0, 0.0), {1.0, 1.0, 1.0}));
+
+	std::ostringstream output;
+	WorldFileWriter().writeWorld(world, output);
+	std::string fileData = output.str();
+
+	UniqueAlignedPointer<char> alignedData(fileData.size(), WORLD_FILE_ALIGNMENT);
+	std::copy(fileData.begin(), fileData.end(), alignedData.get());
+
+	WorldFileReader reader(alignedData.get(), fileData.size());
+	ASSERT_STRICT(reader.getSectionCount(WorldFileSection::SHAPE_CLASS_OFFSETS) == 3);
+
+	World<Part> loadedWorld(0.01);
+	reader.readWorld(loadedWorld);
+	ASSERT_STRICT(countParts(loadedWorld, TERRAIN_PARTS) == 4);
+	ASSERT_TRUE(loadedWorld.isValid());
+
+	std::vector<const Part*> originalParts;
+	std::vector<const Part*> loadedParts;
+	for(const Part& p : world.iterParts(TERRAIN_PARTS)) originalParts.push_back(&p);
+	for(const Part& p : loadedWorld.iterParts(TERRAIN_PARTS)) loadedParts.push_back(&p);
+	// parts are matched by position, the iteration order of the terrain tree is not kept
+	for(const Part* original : originalParts) {
+		const Part* loaded = nullptr;
+		for(const Part* candidate : loadedParts) {
+			if(candidate->getPosition() == original->getPosition()) loaded = candidate;
+		}
+		ASSERT_TRUE(loaded != nullptr);
+		ASSERT_TOLERANT(loaded->hitbox.scale == original->hitbox.scale, 0.000001);
+		ASSERT_TRUE(isSameTriangleShapeClass(original->hitbox.baseShape, loaded->hitbox.baseShape));
+	}
+	// both heightfield parts share a single loaded ShapeClass
+	const ShapeClass* firstHeightfield = nullptr;
+	for(const Part* loaded : loadedParts) {
+		if(loaded->hitbox.baseShape->intersectionClassID != HEIGHTFIELD_CLASS_ID) continue;
+		if(firstHeightfield == nullptr) firstHeightfield = loaded->hitbox.baseShape;
+		ASSERT_TRUE(loaded->hitbox.baseShape == firstHeightfield);
+	}
+}
+
+TEST_CASE(worldFileStoresCapsules) {
+	Shape capsule = Capsule(0.3, 1.5);
+	const CapsuleClass* capsuleClass = static_cast<const CapsuleClass*>(capsule.baseShape);
+
+	std::stringstream stream;
+	dynamicShapeClassSerializer.serialize(*capsuleClass, stream);
+	std::unique_ptr<ShapeClass> loadedClass(dynamicShapeClassSerializer.deserialize(stream));
+	ASSERT_STRICT(loadedClass->intersectionClassID == CAPSULE_CLASS_ID);
+	ASSERT_STRICT(static_cast<const CapsuleClass*>(loadedClass.get())->capRatio == capsuleClass->capRatio);
+
+	World<Part> world(0.01);
+	world.addPart(new Part(capsule, GlobalCFrame(0.0, 1.0, 0.0), {1.0, 0.5, 0.5}));
+	// same ratio of radius to height, so the same ShapeClass
+	world.addPart(new Part(Capsule(0.6, 3.0), GlobalCFrame(3.0, 1.0, 0.0), {1.0, 0.5, 0.5}));
+	world.addPart(new Part(Capsule(0.5, 1.0), GlobalCFrame(-3.0, 1.0, 0.0), {1.0, 0.5, 0.5}));
+
+	std::ostringstream output;
+	WorldFileWriter().writeWorld(world, output);
+	std::string fileData = output.str();
+
+	UniqueAlignedPointer<char> alignedData(fileData.size(), WORLD_FILE_ALIGNMENT);
+	std::copy(fileData.begin(), fileData.end(), alignedData.get());
+
+	WorldFileReader reader(alignedData.get(), fileData.size());
+	ASSERT_STRICT(reader.getSectionCount(WorldFileSection::SHAPE_CLASS_OFFSETS) == 3);
+
+	World<Part> loadedWorld(0.01);
+	reader.readWorld(loadedWorld);
+	ASSERT_STRICT(countParts(loadedWorld, FREE_PARTS) == 3);
+	ASSERT_TRUE(loadedWorld.isValid());
+
+	for(const Part& original : world.iterParts()) {
+		const Part* loaded = nullptr;
+		for(const Part& candidate : loadedWorld.iterParts()) {
+			if(candidate.getPosition() == original.getPosition()) loaded = &candidate;
+		}
+		ASSERT_TRUE(loaded != nullptr);
+		ASSERT_STRICT(loaded->hitbox.baseShape->intersectionClassID == CAPSULE_CLASS_ID);
+		ASSERT_STRICT(static_cast<const CapsuleClass*>(loaded->hitbox.baseShape)->capRatio == static_cast<const CapsuleClass*>(original.hitbox.baseShape)->capRatio);
+		ASSERT_TOLERANT(loaded->hitbox.scale == original.hitbox.scale, 0.000001);
+		ASSERT_TOLERANT(loaded->getMass() == original.getMass(), 0.000001);
+	}
+}
+
+TEST_CASE(worldFileParallelLoad) {
+	// enough physicals and terrain parts to be split over several chunks
+	// parts added one by one in a line make the object tree degenerate past MAX_HEIGHT, so the original world is built in bulk as well
+	std::vector<Part*> parts;
+	std::vector<Part*> terrainParts;
+	for(int i = 0; i < 3000; i++) {
+		Part* main = new Part(Box(0.5, 0.5, 0.5), GlobalCFrame(i * 1.0, 0.0, (i % 7) * 1.0), {1.0, 0.5, 0.5});
+		if(i % 3 == 0) {
+			Part* child = new Part(Sphere(0.2), GlobalCFrame(), {1.0, 0.5, 0.5});
+			main->attach(child, new FixedConstraint(), CFrame(Vec3(0.5, 0.0, 0.0)), CFrame(Vec3(-0.5, 0.0, 0.0)));
+		}
+		parts.push_back(main);
+	}
+	for(int i = 0; i < 1000; i++) {
+		terrainParts.push_back(new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(i * 1.0, -2.0, 0.0), {1.0, 0.5, 0.5}));
+	}
+	World<Part> world(0.01);
+	world.addParts(parts.data(), parts.size());
+	world.addTerrainParts(terrainParts.data(), terrainParts.size());
+	ASSERT_TRUE(world.isValid());
+	ASSERT_STRICT(countParts(world, FREE_PARTS) == 4000);
+	ASSERT_TRUE(world.objectTree.rootNode.getLengthOfLongestBranch() < 16);
+
+	std::ostringstream output;
+	WorldFileWriter().writeWorld(world, output);
+	std::string fileData = output.str();
+	UniqueAlignedPointer<char> alignedData(fileData.size(), WORLD_FILE_ALIGNMENT);
+	std::copy(fileData.begin(), fileData.end(), alignedData.get());
+
+	World<Part> loadedWorld(0.01);
+	WorldFileReader(alignedData.get(), fileData.size()).readWorld(loadedWorld);
+
+	ASSERT_TRUE(loadedWorld.isValid());
+	ASSERT_STRICT(loadedWorld.physicals.size() == world.physicals.size());
+	ASSERT_STRICT(countParts(loadedWorld, FREE_PARTS) == countParts(world, FREE_PARTS));
+	ASSERT_STRICT(countParts(loadedWorld, TERRAIN_PARTS) == countParts(world, TERRAIN_PARTS));
+	ASSERT_STRICT(loadedWorld.objectTree.getNumberOfObjects() == world.objectTree.getNumberOfObjects());
+
+	// physicals keep their order, so they can be compared one by one
+	for(size_t i = 0; i < world.physicals.size(); i++) {
+		ASSERT_STRICT(loadedWorld.physicals[i]->childPhysicals.size() == world.physicals[i]->childPhysicals.size());
+		ASSERT_TOLERANT(loadedWorld.physicals[i]->getMainPart()->getCFrame() == world.physicals[i]->getMainPart()->getCFrame(), 0.000001);
+	}
+}
+
+static std::vector<GlobalCFrame> collectPartCFrames(const World<Part>& world) {
+	std::vector<GlobalCFrame> result;
+	for(const Part& p : world.iterParts()) result.push_back(p.getCFrame());
+	std::sort(result.begin(), result.end(), [](const GlobalCFrame& a, const GlobalCFrame& b) {
+		return a.getPosition().x < b.getPosition().x;
+	});
+	return result;
+}
+
+TEST_CASE(worldCheckpointRestoresEveryTick) {
+	NormalizedPolyhedron* icosaClass = new NormalizedPolyhedron(Library::icosahedron.normalized());
+
+	World<Part> world(0.01);
+	fillTestWorld(world, icosaClass);
+	Part* motorBase = new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(20.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+	Part* motorArm = new Part(Box(0.5, 0.5, 2.0), GlobalCFrame(), {1.0, 0.5, 0.5});
+	ConstantSpeedMotorConstraint* motor = new ConstantSpeedMotorConstraint(1.0);
+	motorBase->attach(motorArm, motor, CFrame(Vec3(0.0, 0.0, 0.5)), CFrame(Vec3(0.0, 0.0, -1.0)));
+	world.addPart(motorBase);
+
+	// a snapshot every 3 captures, so restoring goes through snapshots as well as deltas
+	WorldCheckpointRecorder recorder(3, 10);
+	std::vector<std::vector<GlobalCFrame>> expectedCFrames;
+	std::vector<size_t> expectedPhysicalCounts;
+	Part* addedPart = nullptr;
+	for(int tick = 0; tick < 8; tick++) {
+		if(tick == 2) {
+			addedPart = new Part(Sphere(0.5), GlobalCFrame(30.0, 0.0, 0.0), {1.0, 0.5, 0.5});
+			world.addPart(addedPart);
+			world.addTerrainPart(new Part(Box(1.0, 1.0, 1.0), GlobalCFrame(40.0, -5.0, 0.0), {1.0, 0.5, 0.5}));
+		}
+		if(tick == 4) {
+			addedPart->attach(new Part(Box(0.2, 0.2, 0.2), GlobalCFrame(), {1.0, 0.5, 0.5}), CFrame(Vec3(0.0, 1.0, 0.0)));
+		}
+		if(tick == 6) {
+			world.removePart(addedPart);
+		}
+		// setCFrame moves the motor arm along with the new motor angle
+		motor->update(0.1);
+		for(MotorizedPhysical* phys : world.physicals) {
+			phys->setCFrame(GlobalCFrame(phys->getPosition() + Vec3(0.0, 0.1, 0.0), Rotation::rotY(0.1 * tick)));
+			phys->motionOfCenterOfMass = Motion(Vec3(0.0, 0.1 * tick, 0.0), Vec3(0.0, 0.0, 0.2));
+		}
+
+		world.age++;
+		recorder.capture(world);
+		expectedCFrames.push_back(collectPartCFrames(world));
+		expectedPhysicalCounts.push_back(world.physicals.size());
+	}
+
+	ASSERT_STRICT(recorder.getTickCount() == 8);
+	ASSERT_TRUE(recorder.getDeltaBytes() > 0);
+	ASSERT_FALSE(recorder.hasTick(world.age + 1));
+
+	for(int tick = 0; tick < 8; tick++) {
+		World<Part> restoredWorld(0.01);
+		recorder.restore(38 + tick, restoredWorld);
+
+		ASSERT_TRUE(restoredWorld.isValid());
+		ASSERT_STRICT(restoredWorld.age == 38 + tick);
+		ASSERT_STRICT(restoredWorld.physicals.size() == expectedPhysicalCounts[tick]);
+		std::vector<GlobalCFrame> restoredCFrames = collectPartCFrames(restoredWorld);
+		ASSERT_STRICT(restoredCFrames.size() == expectedCFrames[tick].size());
+		for(size_t i = 0; i < restoredCFrames.size(); i++) {
+			// rotations are stored as floats in deltas
+			ASSERT_TOLERANT(restoredCFrames[i] == expectedCFrames[tick][i], 0.0001);
+		}
+	}
+
+	bool threw = false;
+	try {
+		World<Part> restoredWorld(0.01);
+		recorder.restore(world.age + 1, restoredWorld);
+	} catch(SerializationException&) {
+		threw = true;
+	}
+	ASSERT_TRUE(threw);
+
+	// going back in time replaces the ticks after it
+	world.age = 40;
+	recorder.capture(world);
+	ASSERT_STRICT(recorder.getNewestTick() == 40);
+	ASSERT_FALSE(recorder.hasTick(41));
+}
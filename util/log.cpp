@@ -1,23 +1,32 @@
 #include "log.h"
 
 #include <stack>
-#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <stdarg.h>
 
 #include "terminalColor.h"
 
 namespace Log {
-	Level logLevel = Level::INFO;
+	std::atomic<Level> logLevel(Level::INFO);
 
-	std::stack<std::string> subjects;
-	std::string lastSubject = "";
-	bool newSubject = false;
+	thread_local std::stack<std::string> subjects;
+	thread_local std::string lastSubject = "";
+	thread_local bool newSubject = false;
 
 	std::string delimiter = "\n";
 
-	std::string topSubject() {
+	const std::string& topSubject() {
+		static const std::string noSubject = "";
+
 		if (subjects.empty())
-			return "";
+			return noSubject;
 
 		return subjects.top();
 	}
@@ -56,100 +65,370 @@ namespace Log {
 		return logLevel;
 	}
 
-	void printSubject(std::string subject) {
-		setColor(Color::SUBJECT);
-		std::cout << subject;
-		setColor(Color::NORMAL);
+	void setDelimiter(std::string delimiter) {
+		Log::delimiter = delimiter;
+	}
+
+#pragma region buffers
+
+	/*
+		A formatted message waiting to be written
+	*/
+	struct Record {
+		TerminalColorPair color;
+		char text[LOG_RECORD_SIZE];
+	};
+
+	/*
+		A single producer single consumer ring of records, written by the thread owning it and read by whoever holds writeMutex
+	*/
+	struct RecordRing {
+		Record records[LOG_RING_CAPACITY];
+
+		/*
+			The number of records ever written and read, only the producer changes head and only the consumer changes tail
+		*/
+		std::atomic<size_t> head{0};
+		std::atomic<size_t> tail{0};
+
+		std::atomic<int> droppedCount{0};
+
+		/*
+			Set when the owning thread exits, the writer deletes the ring once it is empty
+		*/
+		std::atomic<bool> abandoned{false};
+
+		/*
+			Returns the slot to fill for the next record, or nullptr if the ring is full
+		*/
+		Record* beginWrite() {
+			size_t currentHead = head.load(std::memory_order_relaxed);
+			if (currentHead - tail.load(std::memory_order_acquire) == LOG_RING_CAPACITY) {
+				droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			return &records[currentHead & (LOG_RING_CAPACITY - 1)];
+		}
+
+		/*
+			Publishes the slot returned by beginWrite
+		*/
+		void endWrite() {
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+	};
+
+	/*
+		Protects the terminal and the consuming side of all rings
+	*/
+	std::mutex writeMutex;
+
+	/*
+		Protects the list of rings
+	*/
+	std::mutex ringsMutex;
+	std::vector<RecordRing*> rings;
+
+	std::mutex wakeMutex;
+	std::condition_variable wakeWriter;
+	std::atomic<bool> writerRunning(false);
+	std::atomic<bool> writerStopped(false);
+
+	/*
+		Writes out all records of all rings and deletes the rings of exited threads, the caller must hold writeMutex
+	*/
+	void drainRings() {
+		std::lock_guard<std::mutex> lock(ringsMutex);
+
+		bool wroteAnything = false;
+		for (size_t i = 0; i < rings.size();) {
+			RecordRing* ring = rings[i];
+			// read before draining, so no record written before the thread exited is missed
+			bool abandoned = ring->abandoned.load(std::memory_order_acquire);
+
+			size_t currentTail = ring->tail.load(std::memory_order_relaxed);
+			size_t currentHead = ring->head.load(std::memory_order_acquire);
+			for (; currentTail != currentHead; currentTail++) {
+				const Record& record = ring->records[currentTail & (LOG_RING_CAPACITY - 1)];
+				setColor(record.color);
+				std::fputs(record.text, stdout);
+				wroteAnything = true;
+			}
+			ring->tail.store(currentTail, std::memory_order_release);
+
+			int droppedCount = ring->droppedCount.exchange(0, std::memory_order_relaxed);
+			if (droppedCount != 0) {
+				setColor(Color::WARNING);
+				std::printf("[WARN]: %d log messages were dropped%s", droppedCount, delimiter.c_str());
+				wroteAnything = true;
+			}
+
+			if (abandoned) {
+				delete ring;
+				rings[i] = rings.back();
+				rings.pop_back();
+			} else {
+				i++;
+			}
+		}
+
+		if (wroteAnything) {
+			setColor(Color::NORMAL);
+			std::fflush(stdout);
+		}
+	}
+
+	/*
+		Owns the background thread writing the rings, stopped and drained one last time at exit
+	*/
+	struct Writer {
+		std::thread thread;
+
+		void start() {
+			thread = std::thread([]() {
+				std::unique_lock<std::mutex> wakeLock(wakeMutex);
+				while (writerRunning) {
+					wakeWriter.wait_for(wakeLock, std::chrono::milliseconds(10));
+
+					std::lock_guard<std::mutex> lock(writeMutex);
+					drainRings();
+				}
+			});
+		}
+
+		~Writer() {
+			if (!writerRunning)
+				return;
+
+			{
+				std::lock_guard<std::mutex> wakeLock(wakeMutex);
+				writerRunning = false;
+			}
+			wakeWriter.notify_one();
+			thread.join();
+			writerStopped = true;
+
+			std::lock_guard<std::mutex> lock(writeMutex);
+			drainRings();
+		}
+	};
+
+	Writer& getWriter() {
+		// constructed on first use, so logging from static initializers of other files is safe
+		static Writer writer;
+		return writer;
+	}
+
+	/*
+		Marks the ring of a thread as abandoned when the thread exits
+	*/
+	struct RingOwner {
+		RecordRing* ring = nullptr;
+
+		~RingOwner() {
+			if (ring != nullptr)
+				ring->abandoned.store(true, std::memory_order_release);
+		}
+	};
+
+	thread_local RingOwner ringOwner;
+
+	/*
+		Returns the ring of the calling thread, creating it and starting the writer if needed
+	*/
+	RecordRing* threadRing() {
+		if (ringOwner.ring == nullptr) {
+			RecordRing* ring = new RecordRing();
+			{
+				std::lock_guard<std::mutex> lock(ringsMutex);
+				rings.push_back(ring);
+			}
+			ringOwner.ring = ring;
+
+			static std::once_flag writerStarted;
+			std::call_once(writerStarted, []() {
+				writerRunning = true;
+				getWriter().start();
+			});
+		}
+
+		return ringOwner.ring;
+	}
+
+	void formatRecord(Record& record, TerminalColorPair color, const char* prefix, const char* format, va_list args) {
+		record.color = color;
+
+		size_t length = std::strlen(prefix);
+		std::memcpy(record.text, prefix, length);
+
+		// keep room for the delimiter when the message is truncated
+		size_t delimiterLength = std::min<size_t>(delimiter.size(), LOG_RECORD_SIZE / 2);
+		size_t room = LOG_RECORD_SIZE - delimiterLength - length;
+		int written = std::vsnprintf(record.text + length, room, format, args);
+		if (written > 0)
+			length += std::min<size_t>(written, room - 1);
+
+		std::memcpy(record.text + length, delimiter.data(), delimiterLength);
+		record.text[length + delimiterLength] = '\0';
+	}
+
+	void pushText(RecordRing* ring, TerminalColorPair color, const std::string& text) {
+		Record* record = ring->beginWrite();
+		if (record == nullptr)
+			return;
+
+		record->color = color;
+		std::snprintf(record->text, LOG_RECORD_SIZE, "%s", text.c_str());
+		ring->endWrite();
+	}
+
+	void printSubject(RecordRing* ring) {
+		if (newSubject && !topSubject().empty())
+			pushText(ring, Color::SUBJECT, "\n[" + topSubject() + "]:\n");
+		if (!emptySubject())
+			pushText(ring, Color::SUBJECT, "|\t");
 		newSubject = false;
 	}
 
-	void setDelimiter(std::string delimiter) {
-		Log::delimiter = delimiter;
+	void logMessage(TerminalColorPair color, const char* prefix, const char* format, va_list args) {
+		if (writerStopped) {
+			// logged during shutdown, after the writer wrote its last records
+			Record record;
+			formatRecord(record, color, prefix, format, args);
+			std::lock_guard<std::mutex> lock(writeMutex);
+			setColor(record.color);
+			std::fputs(record.text, stdout);
+			setColor(Color::NORMAL);
+			return;
+		}
+
+		RecordRing* ring = threadRing();
+		printSubject(ring);
+
+		Record* record = ring->beginWrite();
+		if (record == nullptr)
+			return;
+
+		formatRecord(*record, color, prefix, format, args);
+		ring->endWrite();
+	}
+
+	void flush() {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		drainRings();
 	}
 
-	void debug(std::string format, ...) {
+#pragma endregion
+
+#pragma region rate limiting
+
+	long long steadyNanos() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	RateLimit::RateLimit(int intervalMillis) : intervalNanos(intervalMillis * 1000000LL), nextAllowedNanos(0), suppressedCount(0) {}
+
+	bool RateLimit::allow() {
+		long long now = steadyNanos();
+		long long nextAllowed = nextAllowedNanos.load(std::memory_order_relaxed);
+
+		if (now < nextAllowed || !nextAllowedNanos.compare_exchange_strong(nextAllowed, now + intervalNanos, std::memory_order_relaxed)) {
+			suppressedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		return true;
+	}
+
+	void RateLimit::reportSuppressed() {
+		int suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+		if (suppressed != 0)
+			info("%d similar messages were suppressed", suppressed);
+	}
+
+#pragma endregion
+
+	void debug(const char* format, ...) {
 		if (logLevel != Level::NONE) {
-			if (newSubject && !topSubject().empty()) printSubject("\n[" + topSubject() + "]:\n");
-			if (!emptySubject()) printSubject("|\t");
-			std::string message = "[DEBUG]: " + format + delimiter;
-			setColor(Color::DEBUG);
 			va_list args;
 			va_start(args, format);
-			vprintf(message.c_str(), args);
+			logMessage(Color::DEBUG, "[DEBUG]: ", format, args);
 			va_end(args);
-			setColor(Color::NORMAL);
 		}
 	}
 
-	void info(std::string format, ...) {
+	void info(const char* format, ...) {
 		if (logLevel <= Level::INFO) {
-			if (newSubject && !topSubject().empty()) printSubject("\n[" + topSubject() + "]:\n");
-			if (!emptySubject()) printSubject("|\t");
-			std::string message = "[INFO]: " + format + delimiter;
-			setColor(Color::INFO);
 			va_list args;
 			va_start(args, format);
-			vprintf(message.c_str(), args);
+			logMessage(Color::INFO, "[INFO]: ", format, args);
 			va_end(args);
-			setColor(Color::NORMAL);
 		}
 	}
 
-	void warn(std::string format, ...) {
+	void warn(const char* format, ...) {
 		if (logLevel <= Level::WARNING) {
-			if (newSubject && !topSubject().empty()) printSubject("\n[" + topSubject() + "]:\n");
-			if (!emptySubject()) printSubject("|\t");
-			std::string message = "[WARN]: " + format + delimiter;
-			setColor(Color::WARNING);
 			va_list args;
 			va_start(args, format);
-			vprintf(message.c_str(), args);
+			logMessage(Color::WARNING, "[WARN]: ", format, args);
 			va_end(args);
-			setColor(Color::NORMAL);
 		}
 	}
 
-	void error(std::string format, ...) {
+	void error(const char* format, ...) {
 		if (logLevel <= Level::ERROR) {
-			if (newSubject && !topSubject().empty()) subject("\n[" + topSubject() + "]:\n");
-			if (!emptySubject()) subject("|\t");
-			std::string message = "[ERROR]: " + format + delimiter;
-			setColor(Color::ERROR);
 			va_list args;
 			va_start(args, format);
-			vprintf(message.c_str(), args);
+			logMessage(Color::ERROR, "[ERROR]: ", format, args);
 			va_end(args);
-			setColor(Color::NORMAL);
 		}
 	}
 
-	void fatal(std::string format, ...) {
+	void fatal(const char* format, ...) {
 		if (logLevel <= Level::FATAL) {
-			if (newSubject && !topSubject().empty()) printSubject("\n[" + topSubject() + "]:\n");
-			if (!emptySubject()) printSubject("|\t");
-			std::string message = "[FATAL]: " + format + delimiter;
+			std::lock_guard<std::mutex> lock(writeMutex);
+			drainRings();
+
+			if (newSubject && !topSubject().empty()) {
+				setColor(Color::SUBJECT);
+				std::printf("\n[%s]:\n", topSubject().c_str());
+			}
+			if (!emptySubject()) {
+				setColor(Color::SUBJECT);
+				std::printf("|\t");
+			}
+			newSubject = false;
+
+			std::string message = std::string("[FATAL]: ") + format + delimiter;
 			setColor(Color::FATAL);
 			va_list args;
 			va_start(args, format);
 			vprintf(message.c_str(), args);
 			va_end(args);
 			setColor(Color::NORMAL);
+			std::fflush(stdout);
 		}
 	}
 
-	void print(std::string format,  ...) {
+	void print(const char* format, ...) {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		drainRings();
+
 		setColor(Color::NORMAL);
 		va_list args;
 		va_start(args, format);
-		vprintf(format.c_str(), args);
+		vprintf(format, args);
 		va_end(args);
 	}
 
-	void print(TerminalColorPair color, std::string format, ...) {
+	void print(TerminalColorPair color, const char* format, ...) {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		drainRings();
+
 		setColor(color);
 		va_list args;
 		va_start(args, format);
-		vprintf(format.c_str(), args);
+		vprintf(format, args);
 		va_end(args);
 	}
 }
@@ -1,13 +1,42 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 
 #include "terminalColor.h"
 
-#define LOG_DEBUG(FMT, ...) Log::debug(std::string("[%s:%d] ") + FMT, __FUNCTION__, __LINE__, __VA_ARGS__);
+#define LOG_DEBUG(FMT, ...) Log::debug("[%s:%d] " FMT, __FUNCTION__, __LINE__, __VA_ARGS__);
 
+/*
+	Lets the given log call through at most once every INTERVAL_MILLIS milliseconds for this call site
+	The number of suppressed calls is logged after the next call that gets through
+
+	LOG_RATE_LIMITED(1000, Log::warn("GJK iteration limit reached!"));
+*/
+#define LOG_RATE_LIMITED(INTERVAL_MILLIS, CALL) do { \
+		static Log::RateLimit logRateLimit(INTERVAL_MILLIS); \
+		if (logRateLimit.allow()) { CALL; logRateLimit.reportSuppressed(); } \
+	} while (false)
+
+/*
+	The maximum length of a single log message, longer messages are truncated
+*/
+#define LOG_RECORD_SIZE 256
+
+/*
+	The number of messages each thread can have waiting for the writer, must be a power of two
+	Messages logged while the buffer of a thread is full are dropped and counted
+*/
+#define LOG_RING_CAPACITY 256
+
+/*
+	debug, info, warn and error format the message on the calling thread into a buffer owned by that thread,
+	a background thread writes the buffers to the terminal. These calls never block on the terminal.
+
+	fatal and print write synchronously, after writing out everything that was logged before them
+*/
 namespace Log {
-	
+
 	namespace Color {
 		const TerminalColorPair DEBUG{TerminalColor::GREEN, TerminalColor::BLACK};
 		const TerminalColorPair INFO{TerminalColor::CYAN, TerminalColor::BLACK};
@@ -25,7 +54,10 @@ namespace Log {
 		FATAL = 3,
 		NONE = 4
 	};
-	
+
+	/*
+		Groups the messages logged on this thread while it is alive under the given title
+	*/
 	class subject {
 	public:
 		subject(const std::string& title);
@@ -37,15 +69,42 @@ namespace Log {
 		subject& operator=(const subject&) = delete;
 	};
 
+	/*
+		The state of one rate limited call site, see LOG_RATE_LIMITED
+	*/
+	class RateLimit {
+		long long intervalNanos;
+		std::atomic<long long> nextAllowedNanos;
+		std::atomic<int> suppressedCount;
+
+	public:
+		RateLimit(int intervalMillis);
+
+		/*
+			Returns whether the call site may log now, counts the call as suppressed otherwise
+		*/
+		bool allow();
+
+		/*
+			Logs how many calls were suppressed since the last call that got through, if any
+		*/
+		void reportSuppressed();
+	};
+
 	void setDelimiter(std::string delimiter);
 
-	void debug(std::string format, ...);
-	void info(std::string format, ...);
-	void warn(std::string format, ...);
-	void error(std::string format, ...);
-	void fatal(std::string format, ...);
-	void print(std::string format, ...);
-	void print(TerminalColorPair color, std::string format, ...);
+	void debug(const char* format, ...);
+	void info(const char* format, ...);
+	void warn(const char* format, ...);
+	void error(const char* format, ...);
+	void fatal(const char* format, ...);
+	void print(const char* format, ...);
+	void print(TerminalColorPair color, const char* format, ...);
+
+	/*
+		Writes out all messages logged so far by any thread before returning
+	*/
+	void flush();
 
 	void setLogLevel(Log::Level logLevel);
 	Level getLogLevel();
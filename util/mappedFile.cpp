@@ -0,0 +1,142 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Util {
+
+#ifdef _MSC_VER
+
+MappedFile::MappedFile(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return;
+	}
+
+	this->fileHandle = file;
+	this->fileSize = static_cast<size_t>(size.QuadPart);
+
+	if (this->fileSize == 0) {
+		this->opened = true;
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		close();
+		return;
+	}
+	this->mappingHandle = mapping;
+
+	this->fileData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (this->fileData == nullptr) {
+		close();
+		return;
+	}
+
+	this->opened = true;
+}
+
+void MappedFile::close() {
+	if (fileData != nullptr)
+		UnmapViewOfFile(fileData);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	fileData = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	fileSize = 0;
+	opened = false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+	int file = open(path.c_str(), O_RDONLY);
+	if (file == -1)
+		return;
+
+	struct stat info;
+	if (fstat(file, &info) == -1) {
+		::close(file);
+		return;
+	}
+
+	this->fileSize = static_cast<size_t>(info.st_size);
+
+	if (this->fileSize != 0) {
+		void* mapping = mmap(nullptr, this->fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED) {
+			::close(file);
+			this->fileSize = 0;
+			return;
+		}
+		madvise(mapping, this->fileSize, MADV_SEQUENTIAL);
+		this->fileData = static_cast<const char*>(mapping);
+	}
+
+	// the mapping keeps its own reference to the file
+	::close(file);
+	this->opened = true;
+}
+
+void MappedFile::close() {
+	if (fileData != nullptr)
+		munmap(const_cast<char*>(fileData), fileSize);
+
+	fileData = nullptr;
+	fileSize = 0;
+	opened = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	fileData(other.fileData), fileSize(other.fileSize), opened(other.opened)
+#ifdef _MSC_VER
+	, fileHandle(other.fileHandle), mappingHandle(other.mappingHandle)
+#endif
+{
+	other.fileData = nullptr;
+	other.fileSize = 0;
+	other.opened = false;
+#ifdef _MSC_VER
+	other.fileHandle = nullptr;
+	other.mappingHandle = nullptr;
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	std::swap(this->fileData, other.fileData);
+	std::swap(this->fileSize, other.fileSize);
+	std::swap(this->opened, other.opened);
+#ifdef _MSC_VER
+	std::swap(this->fileHandle, other.fileHandle);
+	std::swap(this->mappingHandle, other.mappingHandle);
+#endif
+	return *this;
+}
+
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Util {
+
+/*
+	Read-only memory mapping of a whole file
+
+	The contents are valid as long as the MappedFile lives, isOpen() is false if the file could not be mapped
+	Empty files are reported as open with size() == 0 and data() == nullptr
+*/
+class MappedFile {
+	const char* fileData = nullptr;
+	size_t fileSize = 0;
+	bool opened = false;
+
+#ifdef _MSC_VER
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+	void close();
+public:
+	MappedFile() = default;
+	MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	inline bool isOpen() const { return opened; }
+	inline const char* data() const { return fileData; }
+	inline size_t size() const { return fileSize; }
+
+	inline const char* begin() const { return fileData; }
+	inline const char* end() const { return fileData + fileSize; }
+};
+
+};
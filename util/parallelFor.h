@@ -0,0 +1,85 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+namespace Util {
+
+inline size_t getHardwareThreadCount() {
+	size_t count = std::thread::hardware_concurrency();
+	return (count != 0) ? count : 1;
+}
+
+/*
+	The most threads parallelFor may use when called from the current thread, 0 for no limit
+	Threads that already run alongside one thread per core, like the workers of the batch runner, set it to 1 so nested loops run serially
+*/
+inline size_t& getThreadLimit() {
+	thread_local size_t limit = 0;
+	return limit;
+}
+
+/*
+	Picks how many chunks to split count elements into, such that each chunk has at least minChunkSize elements
+*/
+inline size_t getChunkCount(size_t count, size_t minChunkSize) {
+	size_t maxChunks = count / minChunkSize;
+	size_t threadCount = getHardwareThreadCount();
+	if(getThreadLimit() != 0) threadCount = std::min(threadCount, getThreadLimit());
+	return std::max<size_t>(1, std::min(maxChunks, threadCount));
+}
+
+/*
+	Splits [0, count) into chunkCount contiguous ranges and calls func(chunkIndex, begin, end) for each, every chunk on its own thread
+	The calling thread runs the first chunk itself. Returns once all chunks are done,
+	the first exception thrown by any chunk is rethrown on the calling thread
+*/
+template<typename Func>
+void parallelForChunks(size_t count, size_t chunkCount, const Func& func) {
+	if(chunkCount <= 1 || count <= 1) {
+		func(size_t(0), size_t(0), count);
+		return;
+	}
+
+	std::vector<std::exception_ptr> exceptions(chunkCount);
+	auto runChunk = [&](size_t chunkIndex) {
+		size_t begin = count * chunkIndex / chunkCount;
+		size_t end = count * (chunkIndex + 1) / chunkCount;
+		try {
+			func(chunkIndex, begin, end);
+		} catch(...) {
+			exceptions[chunkIndex] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(chunkCount - 1);
+	for(size_t i = 1; i < chunkCount; i++) {
+		threads.emplace_back(runChunk, i);
+	}
+	runChunk(0);
+	for(std::thread& t : threads) {
+		t.join();
+	}
+
+	for(std::exception_ptr& e : exceptions) {
+		if(e) std::rethrow_exception(e);
+	}
+}
+
+/*
+	Calls func(i) for every i in [0, count), spread over the available hardware threads
+*/
+template<typename Func>
+void parallelFor(size_t count, size_t minChunkSize, const Func& func) {
+	parallelForChunks(count, getChunkCount(count, minChunkSize), [&func](size_t chunkIndex, size_t begin, size_t end) {
+		for(size_t i = begin; i < end; i++) {
+			func(i);
+		}
+	});
+}
+
+};
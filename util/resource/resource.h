@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <functional>
 
 class ResourceManager;
 
@@ -15,7 +17,19 @@ protected:
 	ResourceAllocator() {};
 
 public:
+	virtual ~ResourceAllocator() {};
+
 	virtual T* load(const std::string& name, const std::string& path) = 0;
+
+	/*
+		Splits a load in a decode stage, which runs on a worker thread, and the returned finalize stage, which runs on the thread owning the graphics context
+		Returns an empty function if the resource could not be decoded
+
+		By default the whole load happens in the finalize stage, allocators that can parse without the graphics context override this
+	*/
+	virtual std::function<T*()> decode(const std::string& name, const std::string& path) {
+		return [this, name, path]() { return load(name, path); };
+	}
 };
 
 #pragma endregion
@@ -43,12 +57,19 @@ protected:
 	Resource(const std::string& name, const std::string& path);
 
 public:
+	virtual ~Resource() {};
+
 	inline virtual ResourceType getType() const = 0;
 	inline virtual std::string getTypeName() const = 0;
 	inline virtual void close() = 0;
 
-	inline std::string getName() const;
-	inline std::string getPath() const;
+	/*
+		Returns an estimate of the memory used by this resource in bytes, used to evict unused resources under the memory budget
+	*/
+	inline virtual std::size_t getSize() const { return 0; }
+
+	std::string getName() const;
+	std::string getPath() const;
 
 	void setName(const std::string& name);
 	void setPath(const std::string& path);
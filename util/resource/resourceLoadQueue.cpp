@@ -0,0 +1,101 @@
+#include "resourceLoadQueue.h"
+
+#include <algorithm>
+
+#include "../parallelFor.h"
+
+/*
+	The maximum number of decode threads, loads are mostly bound by disk and parsing, a few threads are enough to hide both
+*/
+#define RESOURCE_MAX_WORKER_COUNT 4
+
+ResourceLoadQueue::~ResourceLoadQueue() {
+	stop();
+}
+
+void ResourceLoadQueue::workerLoop() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+			if (stopping)
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			runningJobCount++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(jobMutex);
+			runningJobCount--;
+		}
+		jobFinished.notify_all();
+	}
+}
+
+void ResourceLoadQueue::submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+
+		if (workers.empty()) {
+			stopping = false;
+
+			size_t workerCount = std::min<size_t>(Util::getHardwareThreadCount(), RESOURCE_MAX_WORKER_COUNT);
+			for (size_t i = 0; i < workerCount; i++)
+				workers.emplace_back(&ResourceLoadQueue::workerLoop, this);
+		}
+
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+void ResourceLoadQueue::post(std::function<void()> completion) {
+	std::lock_guard<std::mutex> lock(completionMutex);
+	completions.push_back(std::move(completion));
+}
+
+size_t ResourceLoadQueue::runCompletions() {
+	std::vector<std::function<void()>> ready;
+	{
+		std::lock_guard<std::mutex> lock(completionMutex);
+		ready.swap(completions);
+	}
+
+	// completions may start new loads, which post to the emptied list
+	for (std::function<void()>& completion : ready)
+		completion();
+
+	return ready.size();
+}
+
+bool ResourceLoadQueue::isBusy() {
+	std::lock_guard<std::mutex> lock(jobMutex);
+	return !jobs.empty() || runningJobCount != 0;
+}
+
+void ResourceLoadQueue::waitForJobs() {
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobFinished.wait(lock, [this]() { return jobs.empty() && runningJobCount == 0; });
+}
+
+void ResourceLoadQueue::stop() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+		jobs.clear();
+	}
+	jobAvailable.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+
+	std::lock_guard<std::mutex> lock(completionMutex);
+	completions.clear();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+/*
+	Runs the decode stage of resource loads on a pool of worker threads
+
+	Decode jobs must not touch the graphics context or the ResourceManager, they hand their result back with post,
+	posted completions run on the thread that calls runCompletions, which is the thread owning the graphics context
+*/
+class ResourceLoadQueue {
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex jobMutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobFinished;
+	std::deque<std::function<void()>> jobs;
+	int runningJobCount = 0;
+	bool stopping = false;
+
+	std::mutex completionMutex;
+	std::vector<std::function<void()>> completions;
+
+	void workerLoop();
+
+public:
+	ResourceLoadQueue() = default;
+	~ResourceLoadQueue();
+
+	ResourceLoadQueue(const ResourceLoadQueue&) = delete;
+	ResourceLoadQueue& operator=(const ResourceLoadQueue&) = delete;
+
+	/*
+		Queues the given job for a worker, the workers are started on the first job
+	*/
+	void submit(std::function<void()> job);
+
+	/*
+		Queues the given function to run on the next call to runCompletions, safe to call from any thread
+	*/
+	void post(std::function<void()> completion);
+
+	/*
+		Runs all posted completions on the calling thread, returns the number that ran
+	*/
+	size_t runCompletions();
+
+	/*
+		Returns whether any job is queued or running
+	*/
+	bool isBusy();
+
+	/*
+		Blocks until all queued jobs have finished decoding, their completions still have to be run
+	*/
+	void waitForJobs();
+
+	/*
+		Drops the queued jobs and posted completions, and joins the workers after their current job
+	*/
+	void stop();
+};
@@ -3,10 +3,91 @@
 std::unordered_map<ResourceType, Resource*> ResourceManager::defaultResources = {};
 std::unordered_map<std::string, ResourceManager::CountedResource> ResourceManager::resources = {};
 
+std::unordered_map<std::string, std::shared_ptr<ResourceLoadState>> ResourceManager::pendingLoads = {};
+ResourceLoadQueue ResourceManager::loadQueue;
+
+std::size_t ResourceManager::memoryBudget = static_cast<std::size_t>(-1);
+std::size_t ResourceManager::memoryUsed = 0;
+std::size_t ResourceManager::releaseCounter = 0;
+
 ResourceManager::ResourceManager() {
 
 }
 
 ResourceManager::~ResourceManager() {
 	ResourceManager::close();
+}
+
+void ResourceManager::onLoadFinished(const std::string& name, Resource* resource) {
+	auto pending = ResourceManager::pendingLoads.find(name);
+
+	if (pending == ResourceManager::pendingLoads.end()) {
+		// the manager was closed while loading
+		if (resource != nullptr) {
+			resource->close();
+			delete resource;
+		}
+		return;
+	}
+
+	std::shared_ptr<ResourceLoadState> state = pending->second;
+	ResourceManager::pendingLoads.erase(pending);
+
+	auto iterator = ResourceManager::resources.find(name);
+	if (iterator != ResourceManager::resources.end()) {
+		// added synchronously while loading, keep the existing resource
+		if (resource != nullptr) {
+			resource->close();
+			delete resource;
+		}
+		iterator->second.count += state->requestCount;
+		resource = iterator->second.value;
+	} else if (resource == nullptr) {
+		Log::warn("Resource not loaded: (%s)", name.c_str());
+	} else {
+		addOwned(name, resource, state->requestCount);
+	}
+
+	publish(*state, resource);
+
+	evict();
+}
+
+void ResourceManager::publish(ResourceLoadState& state, Resource* resource) {
+	state.ready = true;
+	state.resource = resource;
+
+	for (std::function<void(Resource*)>& callback : state.callbacks)
+		callback(resource);
+	state.callbacks.clear();
+}
+
+void ResourceManager::evict() {
+	while (memoryUsed > memoryBudget) {
+		auto oldest = ResourceManager::resources.end();
+
+		for (auto iterator = ResourceManager::resources.begin(); iterator != ResourceManager::resources.end(); ++iterator) {
+			const CountedResource& resource = iterator->second;
+
+			if (!resource.owned || resource.count > 0)
+				continue;
+
+			if (oldest == ResourceManager::resources.end() || resource.releaseTime < oldest->second.releaseTime)
+				oldest = iterator;
+		}
+
+		if (oldest == ResourceManager::resources.end())
+			return;
+
+		Resource* resource = oldest->second.value;
+		memoryUsed -= oldest->second.size;
+
+		auto defaultResource = ResourceManager::defaultResources.find(resource->getType());
+		if (defaultResource != ResourceManager::defaultResources.end() && defaultResource->second == resource)
+			ResourceManager::defaultResources.erase(defaultResource);
+
+		ResourceManager::resources.erase(oldest);
+		resource->close();
+		delete resource;
+	}
 }
\ No newline at end of file
@@ -5,8 +5,58 @@
 #include <typeinfo>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <cstddef>
 
 #include "resource.h"
+#include "resourceLoadQueue.h"
+
+/*
+	The state of an asynchronous load, shared by all handles requesting the same resource, only used on the thread calling ResourceManager::update
+*/
+struct ResourceLoadState {
+	std::string name;
+	bool ready = false;
+	Resource* resource = nullptr;
+	int requestCount = 0;
+	std::vector<std::function<void(Resource*)>> callbacks;
+};
+
+/*
+	Refers to a resource requested with ResourceManager::addAsync, which is published by ResourceManager::update
+*/
+template<typename T>
+class ResourceHandle {
+	friend ResourceManager;
+
+private:
+	std::shared_ptr<ResourceLoadState> state;
+
+	ResourceHandle(std::shared_ptr<ResourceLoadState> state) : state(state) {}
+
+public:
+	ResourceHandle() = default;
+
+	/*
+		Returns whether the load has finished, successfully or not
+	*/
+	bool isReady() const {
+		return state != nullptr && state->ready;
+	}
+
+	/*
+		Returns the resource once loaded, nullptr while loading or if the load failed
+	*/
+	T* get() const {
+		return isReady() ? static_cast<T*>(state->resource) : nullptr;
+	}
+
+	const std::string& getName() const {
+		return state->name;
+	}
+};
 
 class ResourceManager {
 	friend Resource;
@@ -16,11 +66,53 @@ private:
 	struct CountedResource {
 		Resource* value;
 		int count;
+
+		/*
+			Whether the resource was loaded by the manager, only those are closed and deleted on eviction
+		*/
+		bool owned;
+		std::size_t size;
+
+		/*
+			The value of releaseCounter when the count last dropped to zero, the oldest unused resources are evicted first
+		*/
+		std::size_t releaseTime;
 	};
 
 	static std::unordered_map<ResourceType, Resource*> defaultResources;
 	static std::unordered_map<std::string, CountedResource> resources;
 
+	static std::unordered_map<std::string, std::shared_ptr<ResourceLoadState>> pendingLoads;
+	static ResourceLoadQueue loadQueue;
+
+	static std::size_t memoryBudget;
+	static std::size_t memoryUsed;
+	static std::size_t releaseCounter;
+
+	/*
+		Stores the resource decoded for the given pending load and calls its callbacks
+	*/
+	static void onLoadFinished(const std::string& name, Resource* resource);
+
+	/*
+		Marks the given load as ready with the given resource and calls its callbacks
+	*/
+	static void publish(ResourceLoadState& state, Resource* resource);
+
+	/*
+		Stores a resource loaded by the manager with the given reference count
+	*/
+	static void addOwned(const std::string& name, Resource* resource, int count) {
+		CountedResource countedResource = { resource, count, true, resource->getSize(), 0 };
+		memoryUsed += countedResource.size;
+		ResourceManager::resources.emplace(name, countedResource);
+	}
+
+	/*
+		Closes and deletes unused resources, oldest first, until the memory used is within the budget
+	*/
+	static void evict();
+
 	static void onResourceNameChange(Resource* changedResource, const std::string& newName) {
 		auto iterator = ResourceManager::resources.find(changedResource->getName());
 
@@ -114,7 +206,8 @@ public:
 			auto& resource = (*iterator).second;
 			resource.count++;
 		} else {
-			CountedResource countedResource = { resource, 1 };
+			// not loaded by the manager, so never evicted and not counted in the memory used
+			CountedResource countedResource = { resource, 1, false, 0, 0 };
 			ResourceManager::resources.emplace(resource->name, countedResource);
 		}
 	}
@@ -142,8 +235,8 @@ public:
 			} else {
 				//Log::debug("Loaded resource: (%s, %s)", name.c_str(), path.c_str());
 
-				CountedResource countedResource = { resource, 1 };
-				ResourceManager::resources.emplace(name, countedResource);
+				addOwned(name, resource, 1);
+				evict();
 
 				return resource;
 			}
@@ -155,13 +248,139 @@ public:
 		return add<T>(path, path);
 	}
 
+	/*
+		Requests the given resource without blocking, the file is decoded on a worker thread
+		The resource is published by a later call to update, which then calls onReady with the resource, or nullptr if it could not be loaded
+		Like add, every request counts as a reference, also when the resource is already loaded or loading
+	*/
+	template<typename T, typename = std::enable_if<std::is_base_of<Resource, T>::value>>
+	static ResourceHandle<T> addAsync(const std::string& name, const std::string& path, std::function<void(T*)> onReady = nullptr) {
+		std::function<void(Resource*)> callback;
+		if (onReady)
+			callback = [onReady](Resource* resource) { onReady(static_cast<T*>(resource)); };
+
+		auto iterator = ResourceManager::resources.find(name);
+		if (iterator != ResourceManager::resources.end()) {
+			iterator->second.count++;
+
+			std::shared_ptr<ResourceLoadState> state = std::make_shared<ResourceLoadState>();
+			state->name = name;
+			state->requestCount = 1;
+			if (callback)
+				state->callbacks.push_back(callback);
+
+			// published by update like any other load, so onReady never runs inside addAsync, the reference keeps the resource loaded until then
+			Resource* resource = iterator->second.value;
+			loadQueue.post([state, resource]() {
+				publish(*state, resource);
+			});
+
+			return ResourceHandle<T>(state);
+		}
+
+		auto pending = ResourceManager::pendingLoads.find(name);
+		if (pending != ResourceManager::pendingLoads.end()) {
+			pending->second->requestCount++;
+			if (callback)
+				pending->second->callbacks.push_back(callback);
+
+			return ResourceHandle<T>(pending->second);
+		}
+
+		std::shared_ptr<ResourceLoadState> state = std::make_shared<ResourceLoadState>();
+		state->name = name;
+		state->requestCount = 1;
+		if (callback)
+			state->callbacks.push_back(callback);
+		ResourceManager::pendingLoads.emplace(name, state);
+
+		// the allocator is shared with the finalize stage, which may refer to it
+		auto allocator = std::make_shared<decltype(T::getAllocator())>(T::getAllocator());
+		loadQueue.submit([allocator, name, path]() {
+			std::function<T*()> finalize;
+			try {
+				finalize = allocator->decode(name, path);
+			} catch (...) {
+				finalize = nullptr;
+			}
+
+			loadQueue.post([allocator, finalize, name]() {
+				onLoadFinished(name, finalize ? finalize() : nullptr);
+			});
+		});
+
+		return ResourceHandle<T>(state);
+	}
+
+	template<typename T, typename = std::enable_if<std::is_base_of<Resource, T>::value>>
+	static ResourceHandle<T> addAsync(const std::string& path, std::function<void(T*)> onReady = nullptr) {
+		return addAsync<T>(path, path, onReady);
+	}
+
+	/*
+		Publishes the resources decoded since the last call and calls their callbacks, must be called on the thread owning the graphics context
+	*/
+	static void update() {
+		loadQueue.runCompletions();
+	}
+
+	/*
+		Blocks until all requested resources are published
+	*/
+	static void finish() {
+		// runs at least once, resources that were already loaded are published without a pending load
+		do {
+			loadQueue.waitForJobs();
+			loadQueue.runCompletions();
+		} while (!pendingLoads.empty());
+	}
+
+	/*
+		Drops a reference to the given resource, unused resources stay loaded until the memory budget is exceeded
+	*/
+	static void release(const std::string& name) {
+		auto iterator = ResourceManager::resources.find(name);
+
+		if (iterator == ResourceManager::resources.end()) {
+			Log::error("The released resource is not found (%s)", name.c_str());
+			return;
+		}
+
+		CountedResource& resource = iterator->second;
+		if (resource.count > 0 && --resource.count == 0) {
+			resource.releaseTime = releaseCounter++;
+			evict();
+		}
+	}
+
+	/*
+		Sets the memory that loaded resources may use in bytes, before unused resources are evicted
+	*/
+	static void setMemoryBudget(std::size_t budget) {
+		memoryBudget = budget;
+		evict();
+	}
+
+	static std::size_t getMemoryUsed() {
+		return memoryUsed;
+	}
+
+	static int getReferenceCount(const std::string& name) {
+		auto iterator = ResourceManager::resources.find(name);
+		return (iterator != ResourceManager::resources.end()) ? iterator->second.count : 0;
+	}
+
 	static void close() {
+		loadQueue.stop();
+		pendingLoads.clear();
+
 		for (auto iterator : resources) {
 			iterator.second.value->close();
 		}
 
 		resources.clear();
 		defaultResources.clear();
+		memoryUsed = 0;
 	}
 
 	static bool exists(const std::string& name) {
@@ -50,17 +50,28 @@ char deserialize<char>(std::istream& istream);
 void serializeString(const std::string& str, std::ostream& ostream);
 std::string deserializeString(std::istream& istream);
 
+/*
+	Trivial arrays are written and read with a single stream call
+*/
 template<typename T>
 void serializeArray(const T* data, size_t size, std::ostream& ostream) {
-	for(size_t i = 0; i < size; i++) {
-		serialize<T>(data[i], ostream);
+	if constexpr(std::is_trivially_copyable<T>::value) {
+		serialize(reinterpret_cast<const char*>(data), sizeof(T) * size, ostream);
+	} else {
+		for(size_t i = 0; i < size; i++) {
+			serialize<T>(data[i], ostream);
+		}
 	}
 }
 
 template<typename T>
 void deserializeArray(T* buf, size_t size, std::istream& istream) {
-	for(size_t i = 0; i < size; i++) {
-		buf[i] = deserialize<T>(istream);
+	if constexpr(std::is_trivially_copyable<T>::value) {
+		deserialize(reinterpret_cast<char*>(buf), sizeof(T) * size, istream);
+	} else {
+		for(size_t i = 0; i < size; i++) {
+			buf[i] = deserialize<T>(istream);
+		}
 	}
 }
 